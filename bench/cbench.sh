@@ -0,0 +1,90 @@
+#!/bin/sh
+#
+# The C target against the TM simulator
+# Compiles every program in tm/ and native/ with
+# hw2_binary for the TM and to C (-ftarget=c), builds
+# the latter with cc -O2, runs both on the program's
+# .in file if it has one and compares their output.
+# Prints the median time of -r runs of each, the time
+# cc took, and the speedup of the C binary over the
+# TM. Exits with status 1 when any program differs.
+#
+# usage: cbench.sh [-r runs] [-2 hw2_binary] [-c cc] [program.cm...]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+hw2="$here/../project2/hw2_binary"
+cc=${CC:-gcc}
+runs=3
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -r) runs=$2; shift 2 ;;
+        -2) hw2=$2; shift 2 ;;
+        -c) cc=$2; shift 2 ;;
+        -*) echo "usage: $0 [-r runs] [-2 hw2_binary] [-c cc] [program.cm...]" >&2
+            exit 1 ;;
+        *) break ;;
+    esac
+done
+[ $# -eq 0 ] && set -- "$here"/tm/*.cm "$here"/native/*.cm
+
+if [ ! -x "$hw2" ]; then
+    echo "$hw2 not built" >&2
+    exit 1
+fi
+make -C "$here" tmthreaded >/dev/null || exit 1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now() { date +%s%N; }
+
+# median of the numbers on stdin
+median() { sort -n | awk '{ t[NR] = $1 } END { print t[int((NR + 1) / 2)] }'; }
+
+status=0
+printf "%-10s %6s %10s %10s %10s %8s\n" program result "TM ms" "C ms" "cc ms" speedup
+for src in "$@"; do
+    prog=$(basename "$src" .cm)
+    input=/dev/null
+    [ -f "${src%.cm}.in" ] && input="${src%.cm}.in"
+    cp "$src" "$work/"
+    (cd "$work" && "$hw2" "$prog.cm" >/dev/null 2>&1 && "$hw2" -ftarget=c "$prog.cm" >/dev/null 2>&1)
+    if [ ! -f "$work/$prog.tm" ] || [ ! -f "$work/$prog.c" ]; then
+        printf "%-10s %6s\n" "$prog" "NOCODE"
+        status=1
+        continue
+    fi
+    start=$(now)
+    if ! "$cc" -O2 -o "$work/$prog" "$work/$prog.c" 2> "$work/cc.err"; then
+        printf "%-10s %6s\n" "$prog" "NOCC"
+        sed 's/^/    /' "$work/cc.err" | head -5
+        status=1
+        continue
+    fi
+    ccus=$(( ($(now) - start) / 1000 ))
+    : > "$work/tm.times"
+    : > "$work/c.times"
+    i=0
+    while [ $i -lt "$runs" ]; do
+        start=$(now)
+        "$here/tmthreaded" "$work/$prog.tm" < "$input" > "$work/tm.out" 2>/dev/null
+        mid=$(now)
+        "$work/$prog" < "$input" > "$work/c.out" 2>/dev/null
+        end=$(now)
+        echo $(( (mid - start) / 1000 )) >> "$work/tm.times"
+        echo $(( (end - mid) / 1000 )) >> "$work/c.times"
+        i=$((i + 1))
+    done
+    result=PASS
+    if ! cmp -s "$work/tm.out" "$work/c.out"; then
+        result=FAIL
+        status=1
+    fi
+    tm=$(median < "$work/tm.times")
+    c=$(median < "$work/c.times")
+    printf "%-10s %6s %10.3f %10.3f %10.3f %7.1fx\n" "$prog" "$result" \
+        $(awk -v t="$tm" -v c="$c" -v k="$ccus" 'BEGIN { print t / 1e3, c / 1e3, k / 1e3, (c > 0 ? t / c : 0) }')
+    [ "$result" = FAIL ] && diff "$work/tm.out" "$work/c.out" | head -5 | sed 's/^/    /'
+done
+exit $status
@@ -0,0 +1,333 @@
+/****************************************************/
+/* File: cmgen.c                                    */
+/* Synthetic C- workload generator                  */
+/* Writes a valid C- program of tunable size and    */
+/* shape to standard output                         */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* size and shape parameters, see usage() */
+static int nfuncs = 20;     /* functions besides main */
+static int nstmts = 10;     /* statements per body */
+static int depth = 2;       /* maximum if/while nesting */
+static int width = 4;       /* operands per expression */
+static int comments = 10;   /* percent of statements with a comment */
+static int minIdLen = 1;    /* identifier length range */
+static int maxIdLen = 8;
+static unsigned long seed = 1;
+
+#define NPARAMS 3  /* parameters per function */
+#define NLOCALS 4  /* scalar locals per function */
+#define ARRSIZE 10 /* elements of every array */
+#define NGLOBALS 4 /* global scalars, and as many arrays */
+
+static unsigned long rnd(void)
+{
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    return seed >> 33;
+}
+
+static int choose(int n) { return (int) (rnd() % (unsigned long) n); }
+
+/* Names are prefix-free: the first letter gives the
+ * number k of letters that encode the index, the rest
+ * is filler up to the drawn length. C- identifiers are
+ * letters only, and no keyword has this shape
+ */
+static char * makeName(int index)
+{
+    char code[16];
+    int k = 0, len, i;
+    char * name;
+    do {
+        code[k++] = 'a' + index % 26;
+        index /= 26;
+    } while (index > 0);
+    len = minIdLen + choose(maxIdLen - minIdLen + 1);
+    if (len < k + 1)
+        len = k + 1;
+    name = (char *) malloc(len + 1);
+    name[0] = 'a' + k;
+    for (i = 0; i < k; i++)
+        name[i+1] = code[i];
+    for (i = k + 1; i < len; i++)
+        name[i] = (choose(2) ? 'a' : 'A') + choose(26);
+    name[len] = '\0';
+    return name;
+}
+
+static int nextName = 0;
+static char * globalVar[NGLOBALS], * globalArr[NGLOBALS];
+static char ** funcName;
+static int * funcReturnsInt;
+
+/* names visible in the function being generated */
+static char * param[NPARAMS], * arrParam, * local[NLOCALS], * localArr;
+static char * counter[16]; /* loop counters, never assigned elsewhere */
+static char * active[16]; /* counters of the enclosing loops */
+static int nactive = 0;
+static int current; /* index of the function being generated */
+static int callUsed; /* the body already has its one call */
+
+static void indent(int level)
+{
+    while (level-- > 0)
+        fputs("    ",stdout);
+}
+
+static const char * words[] = {
+    "compute", "the", "next", "value", "of", "table", "loop", "until",
+    "done", "check", "bounds", "update", "result", "and", "store"
+};
+
+static void comment(int level)
+{
+    int n = 2 + choose(8), i;
+    if (choose(100) >= comments)
+        return;
+    indent(level);
+    fputs("/*",stdout);
+    for (i = 0; i < n; i++) {
+        if (i == n / 2 && choose(4) == 0) {
+            putchar('\n');
+            indent(level);
+        }
+        printf(" %s",words[choose(sizeof(words) / sizeof(words[0]))]);
+    }
+    fputs(" */\n",stdout);
+}
+
+/* an in-bounds array index: a constant, or the counter
+ * of an enclosing loop, which stays below 3
+ */
+static void subscript(void)
+{
+    if (nactive > 0 && choose(2))
+        printf("%s",active[choose(nactive)]);
+    else
+        printf("%d",choose(ARRSIZE));
+}
+
+static void operand(void)
+{
+    switch (choose(6)) {
+        case 0: printf("%d",choose(100)); break;
+        case 1: printf("%s",param[choose(NPARAMS)]); break;
+        case 2: printf("%s",globalVar[choose(NGLOBALS)]); break;
+        case 3: printf("%s[",arrParam); subscript(); putchar(']'); break;
+        case 4: printf("%s[",localArr); subscript(); putchar(']'); break;
+        default: printf("%s",local[choose(NLOCALS)]); break;
+    }
+}
+
+/* an additive expression of about width operands,
+ * dividing only by non-zero constants
+ */
+static void expression(int w)
+{
+    int i;
+    if (w < 1)
+        w = 1;
+    for (i = 0; i < w; i++) {
+        if (i > 0) {
+            switch (choose(4)) {
+                case 0: fputs(" + ",stdout); break;
+                case 1: fputs(" - ",stdout); break;
+                case 2: fputs(" * ",stdout); break;
+                default: printf(" / %d",1 + choose(9)); i++; if (i == w) return;
+                         fputs(" + ",stdout); break;
+            }
+        }
+        if (w > 2 && choose(8) == 0) {
+            putchar('(');
+            expression(w / 2);
+            putchar(')');
+            i += w / 2 - 1;
+        }
+        else
+            operand();
+    }
+}
+
+static void condition(void)
+{
+    static const char * rel[] = { "<", "<=", ">", ">=", "==", "!=" };
+    expression(1 + width / 2);
+    printf(" %s ",rel[choose(6)]);
+    expression(1 + width / 2);
+}
+
+static void statement(int level, int nest);
+
+static void block(int level, int nest, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+        statement(level,nest);
+}
+
+static void statement(int level, int nest)
+{
+    int kind = choose(nest < depth ? 10 : 7);
+    comment(level);
+    indent(level);
+    if (kind <= 4 || (kind == 5 && callUsed)) {
+        /* assignment */
+        switch (choose(3)) {
+            case 0: printf("%s = ",local[choose(NLOCALS)]); break;
+            case 1: printf("%s[",localArr); subscript(); fputs("] = ",stdout); break;
+            default: printf("%s = ",globalVar[choose(NGLOBALS)]); break;
+        }
+        expression(width);
+        fputs(";\n",stdout);
+    }
+    else if (kind == 5) {
+        /* at most one call per body, outside loops, to an
+         * earlier function, so execution stays linear */
+        int f = choose(current), i;
+        callUsed = 1;
+        if (funcReturnsInt[f])
+            printf("%s = ",local[choose(NLOCALS)]);
+        printf("%s(",funcName[f]);
+        for (i = 0; i < NPARAMS; i++) {
+            expression(width / 2);
+            fputs(", ",stdout);
+        }
+        printf("%s);\n",localArr);
+    }
+    else if (kind == 6) {
+        fputs("output(",stdout);
+        expression(width);
+        fputs(");\n",stdout);
+    }
+    else if (kind <= 8) {
+        fputs("if (",stdout);
+        condition();
+        fputs(")\n",stdout);
+        indent(level);
+        fputs("{\n",stdout);
+        block(level + 1,nest + 1,1 + choose(3));
+        indent(level);
+        fputs("}\n",stdout);
+        if (choose(2)) {
+            indent(level);
+            fputs("else\n",stdout);
+            indent(level);
+            fputs("{\n",stdout);
+            statement(level + 1,nest + 1);
+            indent(level);
+            fputs("}\n",stdout);
+        }
+    }
+    else {
+        /* a loop of at most 3 iterations */
+        char * i = counter[nest];
+        int saved = callUsed;
+        printf("%s = 0;\n",i);
+        indent(level);
+        printf("while (%s < %d)\n",i,1 + choose(3));
+        indent(level);
+        fputs("{\n",stdout);
+        callUsed = 1;
+        active[nactive++] = i;
+        block(level + 1,nest + 1,1 + choose(3));
+        nactive--;
+        callUsed = saved;
+        indent(level + 1);
+        printf("%s = %s + 1;\n",i,i);
+        indent(level);
+        fputs("}\n",stdout);
+    }
+}
+
+static void function(int f)
+{
+    int i;
+    current = f;
+    callUsed = f == 0;
+    for (i = 0; i < NPARAMS; i++)
+        param[i] = makeName(nextName++);
+    arrParam = makeName(nextName++);
+    for (i = 0; i < NLOCALS; i++)
+        local[i] = makeName(nextName++);
+    localArr = makeName(nextName++);
+    for (i = 0; i <= depth; i++)
+        counter[i] = makeName(nextName++);
+    comment(0);
+    printf("%s %s(",funcReturnsInt[f] ? "int" : "void",funcName[f]);
+    for (i = 0; i < NPARAMS; i++)
+        printf("int %s, ",param[i]);
+    printf("int %s[])\n{\n",arrParam);
+    for (i = 0; i < NLOCALS; i++)
+        printf("    int %s;\n",local[i]);
+    printf("    int %s[%d];\n",localArr,ARRSIZE);
+    for (i = 0; i <= depth; i++)
+        printf("    int %s;\n",counter[i]);
+    for (i = 0; i < NLOCALS; i++)
+        printf("    %s = %s;\n",local[i],param[i % NPARAMS]);
+    for (i = 0; i < ARRSIZE; i++)
+        printf("    %s[%d] = %s[%d];\n",localArr,i,arrParam,i);
+    block(1,0,nstmts);
+    if (funcReturnsInt[f]) {
+        fputs("    return ",stdout);
+        expression(width);
+        fputs(";\n",stdout);
+    }
+    fputs("}\n\n",stdout);
+}
+
+static void usage(const char * prog)
+{
+    fprintf(stderr,
+        "usage: %s [-f functions] [-s statements] [-d depth] [-w width]\n"
+        "          [-c comment%%] [-l minlen:maxlen] [-r seed]\n",prog);
+    exit(1);
+}
+
+int main(int argc, char * argv[])
+{
+    int i;
+    for (i = 1; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+        const char * v = argv[i+1];
+        switch (argv[i][1]) {
+            case 'f': nfuncs = atoi(v); break;
+            case 's': nstmts = atoi(v); break;
+            case 'd': depth = atoi(v); break;
+            case 'w': width = atoi(v); break;
+            case 'c': comments = atoi(v); break;
+            case 'r': seed = strtoul(v,NULL,10); break;
+            case 'l':
+                if (sscanf(v,"%d:%d",&minIdLen,&maxIdLen) != 2)
+                    usage(argv[0]);
+                break;
+            default: usage(argv[0]);
+        }
+    }
+    if (i != argc || nfuncs < 1 || nstmts < 0 || depth < 0 || depth > 14 ||
+        width < 1 || minIdLen < 1 || maxIdLen < minIdLen)
+        usage(argv[0]);
+    funcName = (char **) malloc(nfuncs * sizeof(char *));
+    funcReturnsInt = (int *) malloc(nfuncs * sizeof(int));
+    for (i = 0; i < NGLOBALS; i++) {
+        globalVar[i] = makeName(nextName++);
+        globalArr[i] = makeName(nextName++);
+        printf("int %s;\nint %s[%d];\n",globalVar[i],globalArr[i],ARRSIZE);
+    }
+    putchar('\n');
+    for (i = 0; i < nfuncs; i++) {
+        funcName[i] = makeName(nextName++);
+        funcReturnsInt[i] = choose(3) != 0;
+    }
+    for (i = 0; i < nfuncs; i++)
+        function(i);
+    printf("void main(void)\n{\n    int %s;\n",local[0]);
+    printf("    %s = input();\n",local[0]);
+    for (i = nfuncs - 1; i >= 0 && i >= nfuncs - 3; i--) {
+        printf("    %s(%s, %d, %d, %s);\n",funcName[i],local[0],i,i + 1,globalArr[0]);
+    }
+    printf("    output(%s);\n}\n",local[0]);
+    return 0;
+}
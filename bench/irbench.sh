@@ -0,0 +1,84 @@
+#!/bin/sh
+#
+# Lowering of C- programs to the SSA IR
+# Lowers every program in tm/ and native/ with
+# -fverify-ir, then a program of about 100k lines
+# generated by cmgen, and prints the median time of the
+# ir phase over -r runs from -ftime-report. Exits with
+# status 1 when the IR of any program is not valid and
+# with status 2 when lowering the large one takes more
+# than -l milliseconds.
+#
+# usage: irbench.sh [-r runs] [-l limit-ms] [-2 hw2_binary] [-- cmgen options]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+hw2="$here/../project2/hw2_binary"
+cmgen="$here/cmgen"
+runs=5
+limit=500
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -r) runs=$2; shift 2 ;;
+        -l) limit=$2; shift 2 ;;
+        -2) hw2=$2; shift 2 ;;
+        --) shift; break ;;
+        *) echo "usage: $0 [-r runs] [-l limit-ms] [-2 hw2_binary] [-- cmgen options]" >&2
+           exit 1 ;;
+    esac
+done
+[ $# -eq 0 ] && set -- -f 1500
+
+if [ ! -x "$hw2" ]; then
+    echo "$hw2 not built" >&2
+    exit 1
+fi
+[ -x "$cmgen" ] || make -C "$here" cmgen >/dev/null || exit 1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# milliseconds of the ir phase in the time report on stdin
+irms() { awk '$1 == "ir" { print $2 }'; }
+
+# median of the numbers on stdin
+median() { sort -n | awk '{ t[NR] = $1 } END { print t[int((NR + 1) / 2)] }'; }
+
+status=0
+printf "%-10s %8s %6s %10s\n" program lines result "ir ms"
+for src in "$here"/tm/*.cm "$here"/native/*.cm; do
+    prog=$(basename "$src" .cm)
+    cp "$src" "$work/"
+    if (cd "$work" && "$hw2" -fno-listing -fverify-ir -ftime-report "$prog.cm" 2> "$prog.err" >/dev/null) \
+        && ! grep -q "^IR" "$work/$prog.err"; then
+        result=PASS
+    else
+        result=FAIL
+        status=1
+    fi
+    printf "%-10s %8d %6s %10.3f\n" "$prog" $(wc -l < "$src") "$result" $(irms < "$work/$prog.err")
+    [ "$result" = FAIL ] && grep "^IR" "$work/$prog.err" | head -5 | sed 's/^/    /'
+done
+
+"$cmgen" "$@" > "$work/big.cm" || exit 1
+: > "$work/big.times"
+result=PASS
+i=0
+while [ $i -lt "$runs" ]; do
+    (cd "$work" && "$hw2" -fno-listing -fverify-ir -ftime-report big.cm 2> big.err >/dev/null)
+    grep -q "^IR" "$work/big.err" && result=FAIL
+    irms < "$work/big.err" >> "$work/big.times"
+    i=$((i + 1))
+done
+ms=$(median < "$work/big.times")
+printf "%-10s %8d %6s %10.3f\n" big $(wc -l < "$work/big.cm") "$result" "$ms"
+if [ "$result" = FAIL ]; then
+    grep "^IR" "$work/big.err" | head -5 | sed 's/^/    /'
+    exit 1
+fi
+[ $status -ne 0 ] && exit $status
+if awk -v t="$ms" -v l="$limit" 'BEGIN { exit !(t > l) }'; then
+    echo "lowering took more than $limit ms" >&2
+    exit 2
+fi
+exit 0
@@ -0,0 +1,212 @@
+/****************************************************/
+/* File: lspbench.c                                 */
+/* Keystroke latency of the C- language server      */
+/* Opens a file in hw2_binary --lsp, then types and */
+/* erases a character at random lines, timing each  */
+/* edit until its diagnostics are published         */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static FILE * toServer, * fromServer;
+static unsigned long seed = 1;
+
+static unsigned long rnd(void)
+{
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    return seed >> 33;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static void send(const char * body)
+{
+    fprintf(toServer,"Content-Length: %zu\r\n\r\n%s",strlen(body),body);
+    fflush(toServer);
+}
+
+/* Function receive reads one message and returns it; the
+ * caller frees it
+ */
+static char * receive(void)
+{
+    char header[256];
+    long length = -1;
+    char * body;
+    while (fgets(header,sizeof(header),fromServer) != NULL) {
+        if (strcmp(header,"\r\n") == 0 && length >= 0) {
+            body = (char *) malloc(length + 1);
+            if (fread(body,1,length,fromServer) != (size_t) length)
+                break;
+            body[length] = '\0';
+            return body;
+        }
+        if (strncmp(header,"Content-Length:",15) == 0)
+            length = atol(header + 15);
+    }
+    fprintf(stderr,"lspbench: server closed the connection\n");
+    exit(1);
+}
+
+/* Procedure awaitDiagnostics waits for the next
+ * publishDiagnostics notification
+ */
+static void awaitDiagnostics(void)
+{
+    for (;;) {
+        char * m = receive();
+        int found = strstr(m,"publishDiagnostics") != NULL;
+        free(m);
+        if (found)
+            return;
+    }
+}
+
+/* Procedure sendOpen sends the didOpen of text, escaped
+ * as a JSON string
+ */
+static void sendOpen(const char * text)
+{
+    size_t n = strlen(text), len = 0;
+    char * body = (char *) malloc(2 * n + 256);
+    const char * p;
+    len += sprintf(body,"{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didOpen\","
+                        "\"params\":{\"textDocument\":{\"uri\":\"file:///bench.cm\","
+                        "\"languageId\":\"cminus\",\"version\":1,\"text\":\"");
+    for (p = text; *p != '\0'; p++)
+        if (*p == '\n') { body[len++] = '\\'; body[len++] = 'n'; }
+        else if (*p == '\t') { body[len++] = '\\'; body[len++] = 't'; }
+        else if (*p == '"' || *p == '\\') { body[len++] = '\\'; body[len++] = *p; }
+        else if (*p != '\r') body[len++] = *p;
+    strcpy(body + len,"\"}}}");
+    send(body);
+    free(body);
+}
+
+static void sendEdit(int line, int from, int to, const char * text)
+{
+    char body[512];
+    sprintf(body,"{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didChange\","
+                 "\"params\":{\"textDocument\":{\"uri\":\"file:///bench.cm\"},"
+                 "\"contentChanges\":[{\"range\":{\"start\":{\"line\":%d,\"character\":%d},"
+                 "\"end\":{\"line\":%d,\"character\":%d}},\"text\":\"%s\"}]}}",
+            line,from,line,to,text);
+    send(body);
+}
+
+static int compare(const void * a, const void * b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return x < y ? -1 : x > y;
+}
+
+static char * readFile(const char * name, int * lines)
+{
+    FILE * f = fopen(name,"r");
+    char * text;
+    long n, i;
+    if (f == NULL) {
+        perror(name);
+        exit(1);
+    }
+    fseek(f,0,SEEK_END);
+    n = ftell(f);
+    rewind(f);
+    text = (char *) malloc(n + 1);
+    n = fread(text,1,n,f);
+    text[n] = '\0';
+    fclose(f);
+    for (*lines = 0, i = 0; i < n; i++)
+        if (text[i] == '\n')
+            (*lines)++;
+    return text;
+}
+
+static void usage(const char * prog)
+{
+    fprintf(stderr,"usage: %s [-n edits] [-r seed] hw2_binary file\n",prog);
+    exit(1);
+}
+
+int main(int argc, char * argv[])
+{
+    int edits = 1000, lines, i, toChild[2], fromChild[2];
+    double start, openTime, * times;
+    char * text;
+    pid_t pid;
+    for (i = 1; i + 1 < argc && argv[i][0] == '-'; i += 2)
+        switch (argv[i][1]) {
+            case 'n': edits = atoi(argv[i+1]); break;
+            case 'r': seed = strtoul(argv[i+1],NULL,10); break;
+            default: usage(argv[0]);
+        }
+    if (argc - i != 2 || edits < 2)
+        usage(argv[0]);
+    text = readFile(argv[i+1],&lines);
+    if (lines == 0)
+        usage(argv[0]);
+
+    if (pipe(toChild) != 0 || pipe(fromChild) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    pid = fork();
+    if (pid == 0) {
+        dup2(toChild[0],0);
+        dup2(fromChild[1],1);
+        close(toChild[1]);
+        close(fromChild[0]);
+        execl(argv[i],argv[i],"--lsp",(char *) NULL);
+        perror(argv[i]);
+        _exit(127);
+    }
+    close(toChild[0]);
+    close(fromChild[1]);
+    toServer = fdopen(toChild[1],"w");
+    fromServer = fdopen(fromChild[0],"r");
+
+    send("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{}}");
+    free(receive());
+    start = now();
+    sendOpen(text);
+    awaitDiagnostics();
+    openTime = now() - start;
+
+    /* every other edit erases the character typed before,
+     * so the document is back to the original in the end */
+    times = (double *) malloc(edits * sizeof(double));
+    for (i = 0; i < edits; i += 2) {
+        int line = rnd() % lines;
+        start = now();
+        sendEdit(line,0,0,"x");
+        awaitDiagnostics();
+        times[i] = now() - start;
+        start = now();
+        sendEdit(line,0,1,"");
+        awaitDiagnostics();
+        times[i+1] = now() - start;
+    }
+    edits -= edits % 2;
+    qsort(times,edits,sizeof(double),compare);
+    printf("%d lines, %d bytes\n",lines,(int) strlen(text));
+    printf("open:      %9.3f ms\n",openTime);
+    printf("keystroke: %9.3f ms median, %.3f ms p90, %.3f ms p99, %.3f ms max\n",
+           times[edits / 2],times[edits * 9 / 10],times[edits * 99 / 100],times[edits - 1]);
+
+    send("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"shutdown\"}");
+    free(receive());
+    send("{\"jsonrpc\":\"2.0\",\"method\":\"exit\"}");
+    fclose(toServer);
+    waitpid(pid,&i,0);
+    return 0;
+}
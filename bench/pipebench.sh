@@ -0,0 +1,68 @@
+#!/bin/sh
+#
+# The pipelined scanner and parser against the serial ones
+# Generates a large program with cmgen, parses it with
+# hw2_binary -fstop-after=parse with and without
+# -fpipeline, checks that both give the same listing and
+# prints the median wall time of -r runs of each and the
+# speedup of the pipeline. The speedup needs two cores:
+# on one, the scanner thread only takes turns with the
+# parser. Exits with status 1 when the listings differ.
+#
+# usage: pipebench.sh [-r runs] [-2 hw2_binary] [-- cmgen options]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+hw2="$here/../project2/hw2_binary"
+cmgen="$here/cmgen"
+runs=5
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -r) runs=$2; shift 2 ;;
+        -2) hw2=$2; shift 2 ;;
+        --) shift; break ;;
+        *) echo "usage: $0 [-r runs] [-2 hw2_binary] [-- cmgen options]" >&2
+           exit 1 ;;
+    esac
+done
+[ $# -eq 0 ] && set -- -f 5000
+
+if [ ! -x "$hw2" ]; then
+    echo "$hw2 not built" >&2
+    exit 1
+fi
+[ -x "$cmgen" ] || make -C "$here" cmgen >/dev/null || exit 1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now() { date +%s%N; }
+
+# median of the numbers on stdin
+median() { sort -n | awk '{ t[NR] = $1 } END { print t[int((NR + 1) / 2)] }'; }
+
+"$cmgen" "$@" > "$work/big.cm" || exit 1
+: > "$work/serial.times"
+: > "$work/pipe.times"
+i=0
+while [ $i -lt "$runs" ]; do
+    start=$(now)
+    (cd "$work" && "$hw2" -fstop-after=parse big.cm >/dev/null 2>&1)
+    mid=$(now)
+    mv "$work/big_20181683.txt" "$work/serial.txt"
+    (cd "$work" && "$hw2" -fstop-after=parse -fpipeline big.cm >/dev/null 2>&1)
+    end=$(now)
+    mv "$work/big_20181683.txt" "$work/pipe.txt"
+    echo $(( (mid - start) / 1000 )) >> "$work/serial.times"
+    echo $(( (end - mid) / 1000 )) >> "$work/pipe.times"
+    i=$((i + 1))
+done
+serial=$(median < "$work/serial.times")
+pipe=$(median < "$work/pipe.times")
+echo "$(wc -l < "$work/big.cm") lines, $(wc -c < "$work/big.cm") bytes, $(getconf _NPROCESSORS_ONLN) cores"
+awk -v s="$serial" -v p="$pipe" 'BEGIN { printf "serial %.1f ms, pipelined %.1f ms, speedup %.2fx\n", s / 1e3, p / 1e3, (p > 0 ? s / p : 0) }'
+if ! cmp -s "$work/serial.txt" "$work/pipe.txt"; then
+    echo "listings differ" >&2
+    exit 1
+fi
+exit 0
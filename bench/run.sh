@@ -0,0 +1,108 @@
+#!/bin/sh
+#
+# End-to-end benchmark of the C- compilers
+# Generates programs of growing size with cmgen, runs
+# hw1_binary and hw2_binary over each of them several
+# times and reports tokens/s, nodes/s and MB/s from the
+# median run. Exits with status 2 when the throughput on
+# the largest program falls below a fraction of the
+# smallest one, which flags superlinear scaling.
+#
+# usage: run.sh [-r runs] [-s "sizes"] [-m min-ratio]
+#               [-1 hw1_binary] [-2 hw2_binary] [-- cmgen options]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+runs=5
+sizes="250 500 1000 2000"
+ratio=0.5
+hw1="$here/../project1/hw1_binary"
+hw2="$here/../project2/hw2_binary"
+cmgen="$here/cmgen"
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -r) runs=$2; shift 2 ;;
+        -s) sizes=$2; shift 2 ;;
+        -m) ratio=$2; shift 2 ;;
+        -1) hw1=$2; shift 2 ;;
+        -2) hw2=$2; shift 2 ;;
+        --) shift; break ;;
+        *) echo "usage: $0 [-r runs] [-s \"sizes\"] [-m min-ratio] [-1 hw1_binary] [-2 hw2_binary] [-- cmgen options]" >&2
+           exit 1 ;;
+    esac
+done
+
+[ -x "$cmgen" ] || make -C "$here" cmgen >/dev/null || exit 1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now() { date +%s%N; }
+
+# stats: reads one time in ns per line, prints
+# "median mean stddev min" in milliseconds
+stats() {
+    sort -n | awk '{ t[NR] = $1 / 1e6; s += t[NR]; q += t[NR] * t[NR] }
+        END { m = s / NR; v = q / NR - m * m; if (v < 0) v = 0
+              med = NR % 2 ? t[(NR + 1) / 2] : (t[NR / 2] + t[NR / 2 + 1]) / 2
+              printf "%.3f %.3f %.3f %.3f\n", med, m, sqrt(v), t[1] }'
+}
+
+# bench name binary: benchmarks one compiler on every size
+bench() {
+    name=$1 bin=$2
+    if [ ! -x "$bin" ]; then
+        echo "$name: $bin not built, skipped"
+        return
+    fi
+    echo
+    echo "$name ($runs runs per size)"
+    printf "%8s %10s %9s %9s %10s %9s %12s %12s %8s\n" \
+        functions bytes tokens nodes "median ms" "stddev" tokens/s nodes/s MB/s
+    first=""
+    last=""
+    for size in $sizes; do
+        src="$work/p$size.cm"
+        bytes=$(wc -c < "$src")
+        : > "$work/times"
+        i=0
+        while [ $i -lt "$runs" ]; do
+            start=$(now)
+            if [ "$name" = hw2 ]; then
+                (cd "$work" && "$bin" -ftime-report=json "$src" 2> "$work/report" >/dev/null)
+            else
+                (cd "$work" && "$bin" "$src" >/dev/null 2>&1)
+            fi
+            echo $(( $(now) - start )) >> "$work/times"
+            i=$((i + 1))
+        done
+        if [ "$name" = hw2 ]; then
+            tokens=$(sed -n 's/.*"name":"total"[^}]*"tokens":\([0-9]*\),"nodes":\([0-9]*\).*/\1/p' "$work/report")
+            nodes=$(sed -n 's/.*"name":"total"[^}]*"tokens":\([0-9]*\),"nodes":\([0-9]*\).*/\2/p' "$work/report")
+        else
+            # one listing line per token after the 4 header lines
+            tokens=$(( $(wc -l < "$work/hw1_20181683.txt") - 4 ))
+            nodes=0
+        fi
+        set -- $(stats < "$work/times")
+        line=$(awk -v s="$size" -v b="$bytes" -v t="$tokens" -v n="$nodes" -v med="$1" -v sd="$3" 'BEGIN {
+            printf "%8d %10d %9d %9d %10.3f %9.3f %12.0f %12.0f %8.2f",
+                   s, b, t, n, med, sd, t / med * 1e3, n / med * 1e3, b / med / 1e3 }')
+        echo "$line"
+        mbs=$(echo "$line" | awk '{ print $NF }')
+        [ -z "$first" ] && first=$mbs
+        last=$mbs
+    done
+    if awk -v f="$first" -v l="$last" -v r="$ratio" 'BEGIN { exit !(l < f * r) }'; then
+        echo "$name: throughput fell from $first to $last MB/s, superlinear scaling?"
+        status=2
+    fi
+}
+
+status=0
+for size in $sizes; do
+    "$cmgen" -f "$size" "$@" > "$work/p$size.cm" || exit 1
+done
+bench hw1 "$hw1"
+bench hw2 "$hw2"
+exit $status
@@ -0,0 +1,86 @@
+#!/bin/sh
+#
+# Startup latency of hw2_binary --run against the
+# assemble-and-link path of the x86-64 backend
+# For every program in tm/ and native/, the median wall
+# time of -r runs of
+#   run:  hw2_binary --run prog.cm
+#   link: hw2_binary -ftarget=x86 prog.cm, cc prog.s
+#         runtime.o, ./prog
+# both from the source to the end of the program, on
+# the program's .in file if it has one. The outputs
+# of the two are compared; exits with status 1 when
+# any program differs.
+#
+# usage: runbench.sh [-r runs] [-2 hw2_binary] [-c cc] [program.cm...]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+hw2="$here/../project2/hw2_binary"
+runtime="$here/../project2/runtime.c"
+cc=${CC:-gcc}
+runs=5
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -r) runs=$2; shift 2 ;;
+        -2) hw2=$2; shift 2 ;;
+        -c) cc=$2; shift 2 ;;
+        -*) echo "usage: $0 [-r runs] [-2 hw2_binary] [-c cc] [program.cm...]" >&2
+            exit 1 ;;
+        *) break ;;
+    esac
+done
+[ $# -eq 0 ] && set -- "$here"/tm/*.cm "$here"/native/*.cm
+
+if [ ! -x "$hw2" ]; then
+    echo "$hw2 not built" >&2
+    exit 1
+fi
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+# the runtime is built once, as a project would
+"$cc" -O2 -c -o "$work/runtime.o" "$runtime" || exit 1
+
+now() { date +%s%N; }
+
+# median of the numbers on stdin
+median() { sort -n | awk '{ t[NR] = $1 } END { print t[int((NR + 1) / 2)] }'; }
+
+status=0
+printf "%-10s %6s %10s %10s %8s\n" program result "run ms" "link ms" speedup
+for src in "$@"; do
+    prog=$(basename "$src" .cm)
+    input=/dev/null
+    [ -f "${src%.cm}.in" ] && input="${src%.cm}.in"
+    cp "$src" "$work/"
+    : > "$work/run.times"
+    : > "$work/link.times"
+    i=0
+    while [ $i -lt "$runs" ]; do
+        start=$(now)
+        (cd "$work" && "$hw2" -fno-listing --run "$prog.cm" < "$input" > run.out 2>/dev/null)
+        mid=$(now)
+        (cd "$work" && "$hw2" -fno-listing -ftarget=x86 "$prog.cm" &&
+            "$cc" -o "$prog" "$prog.s" runtime.o &&
+            "./$prog" < "$input" > link.out) 2>/dev/null
+        end=$(now)
+        echo $(( (mid - start) / 1000 )) >> "$work/run.times"
+        echo $(( (end - mid) / 1000 )) >> "$work/link.times"
+        i=$((i + 1))
+    done
+    result=PASS
+    if [ ! -f "$work/$prog" ]; then
+        result=NOLINK
+        status=1
+    elif ! cmp -s "$work/run.out" "$work/link.out"; then
+        result=FAIL
+        status=1
+    fi
+    run=$(median < "$work/run.times")
+    link=$(median < "$work/link.times")
+    printf "%-10s %6s %10.3f %10.3f %7.1fx\n" "$prog" "$result" \
+        $(awk -v r="$run" -v l="$link" 'BEGIN { print r / 1e3, l / 1e3, (r > 0 ? l / r : 0) }')
+    rm -f "$work/$prog" "$work/$prog.s"
+done
+exit $status
@@ -0,0 +1,97 @@
+#!/bin/sh
+#
+# Benchmark of the TM simulator
+# Compiles the programs in tm/ with hw2_binary, runs
+# each of them several times on the threaded and the
+# switch build of the simulator and on the execution
+# loop of the textbook tm (tmtextbook.c), and reports
+# the instructions executed, the median time, MIPS and
+# the speedup over the textbook loop. With -t, also
+# times another reference simulator, driven with the
+# "g" command of the textbook tm. Exits with status 1
+# when a build disagrees with the threaded one on a
+# program's output.
+#
+# usage: tmbench.sh [-r runs] [-p "programs"] [-2 hw2_binary]
+#                   [-t reference-tm]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+runs=5
+programs="fib sieve sort matmul collatz"
+hw2="$here/../project2/hw2_binary"
+ref=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -r) runs=$2; shift 2 ;;
+        -p) programs=$2; shift 2 ;;
+        -2) hw2=$2; shift 2 ;;
+        -t) ref=$2; shift 2 ;;
+        *) echo "usage: $0 [-r runs] [-p \"programs\"] [-2 hw2_binary] [-t reference-tm]" >&2
+           exit 1 ;;
+    esac
+done
+
+if [ ! -x "$hw2" ]; then
+    echo "$hw2 not built" >&2
+    exit 1
+fi
+make -C "$here" tmthreaded tmswitch tmtextbook >/dev/null || exit 1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now() { date +%s%N; }
+
+# median: reads one time in ns per line, prints the
+# median in milliseconds
+median() {
+    sort -n | awk '{ t[NR] = $1 / 1e6 }
+        END { printf "%.3f\n", NR % 2 ? t[(NR + 1) / 2] : (t[NR / 2] + t[NR / 2 + 1]) / 2 }'
+}
+
+# run name program: times one simulator on one program
+# and prints a line of the table
+run() {
+    name=$1 prog=$2
+    : > "$work/times"
+    i=0
+    while [ $i -lt "$runs" ]; do
+        start=$(now)
+        if [ "$name" = reference ]; then
+            printf 'g\nq\n' | "$ref" "$work/$prog.tm" > "$work/$name.out" 2>&1
+        else
+            "$here/tm$name" "$work/$prog.tm" > "$work/$name.out" 2> "$work/$name.err" < /dev/null
+        fi
+        echo $(( $(now) - start )) >> "$work/times"
+        i=$((i + 1))
+    done
+    ms=$(median < "$work/times")
+    [ "$name" = textbook ] && textms=$ms
+    printf "%-8s %-10s %12d %10.3f %10.1f %9.2fx\n" "$prog" "$name" "$count" "$ms" \
+        $(awk -v n="$count" -v ms="$ms" -v t="$textms" 'BEGIN { print (ms > 0 ? n / ms / 1e3 : 0), (ms > 0 ? t / ms : 0) }')
+    if [ "$name" != reference ] && ! cmp -s "$work/threaded.out" "$work/$name.out"; then
+        echo "$prog: $name output differs from threaded"
+        status=1
+    fi
+}
+
+status=0
+echo "TM simulator ($runs runs per program)"
+printf "%-8s %-10s %12s %10s %10s %10s\n" program dispatch instructions "median ms" MIPS "vs textbook"
+for prog in $programs; do
+    cp "$here/tm/$prog.cm" "$work/"
+    (cd "$work" && "$hw2" "$prog.cm" >/dev/null 2>&1)
+    if [ ! -f "$work/$prog.tm" ]; then
+        echo "$prog: no code generated"
+        status=1
+        continue
+    fi
+    "$here/tmthreaded" "$work/$prog.tm" > "$work/threaded.out" 2> "$work/threaded.err" < /dev/null
+    count=$(sed -n 's/Number of instructions executed = //p' "$work/threaded.err")
+    run textbook "$prog"
+    run threaded "$prog"
+    run switch "$prog"
+    [ -n "$ref" ] && run reference "$prog"
+done
+exit $status
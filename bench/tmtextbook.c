@@ -0,0 +1,217 @@
+/****************************************************/
+/* File: tmtextbook.c                               */
+/* The execution loop of the textbook TM simulator  */
+/* Compiler Construction: Principles and Practice   */
+/* Its tm.c is not part of this tree: this keeps    */
+/* what the benchmark measures of it, the iMem      */
+/* array of instruction records and stepTM, which   */
+/* fetches one record per step, decodes its operand */
+/* class and dispatches on its op, driven as by the */
+/* "g" command. Arithmetic wraps around and the     */
+/* memory sizes are those of hw2_tm, so that both   */
+/* print the same output for a program              */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+#define IADDR_SIZE (1 << 20)
+#define DADDR_SIZE 65536
+#define NO_REGS 8
+#define PC_REG 7
+
+#define LINESIZE 256
+#define WORDSIZE 20
+
+typedef enum {
+    opclRR,     /* reg operands r,s,t */
+    opclRM,     /* reg r, mem d+s */
+    opclRA      /* reg r, int d+s */
+} OPCLASS;
+
+typedef enum {
+    /* RR instructions */
+    opHALT, opIN, opOUT, opADD, opSUB, opMUL, opDIV, opRRLim,
+    /* RM instructions */
+    opLD, opST, opRMLim,
+    /* RA instructions */
+    opLDA, opLDC, opJLT, opJLE, opJGT, opJGE, opJEQ, opJNE, opRALim
+} OPCODE;
+
+typedef enum {
+    srOKAY, srHALT, srIMEM_ERR, srDMEM_ERR, srZERODIVIDE
+} STEPRESULT;
+
+typedef struct {
+    int iop;
+    int iarg1;
+    int iarg2;
+    int iarg3;
+} INSTRUCTION;
+
+static int iloc = 0;
+static int traceflag = 0;
+
+static INSTRUCTION iMem[IADDR_SIZE];
+static int dMem[DADDR_SIZE];
+static int reg[NO_REGS];
+
+static const char * opCodeTab[] = {
+    "HALT", "IN", "OUT", "ADD", "SUB", "MUL", "DIV", "????",
+    "LD", "ST", "????",
+    "LDA", "LDC", "JLT", "JLE", "JGT", "JGE", "JEQ", "JNE", "????"
+};
+
+static const char * stepResultTab[] = {
+    "OK", "Halted", "Instruction Memory Fault",
+    "Data Memory Fault", "Division by 0"
+};
+
+static int opClass(int c)
+{
+    if (c <= opRRLim) return opclRR;
+    else if (c <= opRMLim) return opclRM;
+    else return opclRA;
+}
+
+/* Function readInstructions loads the code file into
+ * iMem; returns 0 after reporting a malformed line
+ */
+static int readInstructions(FILE * pgm)
+{
+    char line[LINESIZE], word[WORDSIZE];
+    int lineNo = 0, loc, op, arg1, arg2, arg3, n;
+    for (loc = 0; loc < IADDR_SIZE; loc++) {
+        iMem[loc].iop = opHALT;
+        iMem[loc].iarg1 = iMem[loc].iarg2 = iMem[loc].iarg3 = 0;
+    }
+    while (fgets(line,LINESIZE,pgm) != NULL) {
+        char * p = line;
+        lineNo++;
+        while (isspace((unsigned char) *p))
+            p++;
+        if (*p == '\0' || *p == '*')
+            continue;
+        if (sscanf(p,"%d : %19[A-Z] %n",&loc,word,&n) != 2 || loc < 0 || loc >= IADDR_SIZE) {
+            fprintf(stderr,"Bad instruction at line %d\n",lineNo);
+            return 0;
+        }
+        for (op = opHALT; op < opRALim; op++)
+            if (strcmp(opCodeTab[op],word) == 0)
+                break;
+        if (op == opRALim || strcmp(word,"????") == 0) {
+            fprintf(stderr,"Illegal opcode at line %d\n",lineNo);
+            return 0;
+        }
+        p += n;
+        if (opClass(op) == opclRR ? sscanf(p,"%d , %d , %d",&arg1,&arg2,&arg3) != 3
+                                  : sscanf(p,"%d , %d ( %d )",&arg1,&arg2,&arg3) != 3) {
+            fprintf(stderr,"Bad operands at line %d\n",lineNo);
+            return 0;
+        }
+        iMem[loc].iop = op;
+        iMem[loc].iarg1 = arg1;
+        iMem[loc].iarg2 = arg2;
+        iMem[loc].iarg3 = arg3;
+    }
+    return 1;
+}
+
+static STEPRESULT stepTM(void)
+{
+    INSTRUCTION currentinstruction;
+    int pc;
+    int r = 0, s = 0, t = 0, m = 0;
+
+    pc = reg[PC_REG];
+    if ((pc < 0) || (pc >= IADDR_SIZE))
+        return srIMEM_ERR;
+    reg[PC_REG] = pc + 1;
+    currentinstruction = iMem[pc];
+    switch (opClass(currentinstruction.iop)) {
+        case opclRR:
+            r = currentinstruction.iarg1;
+            s = currentinstruction.iarg2;
+            t = currentinstruction.iarg3;
+            break;
+        case opclRM:
+            r = currentinstruction.iarg1;
+            s = currentinstruction.iarg3;
+            m = currentinstruction.iarg2 + reg[s];
+            if ((m < 0) || (m >= DADDR_SIZE))
+                return srDMEM_ERR;
+            break;
+        case opclRA:
+            r = currentinstruction.iarg1;
+            s = currentinstruction.iarg3;
+            m = currentinstruction.iarg2 + reg[s];
+            break;
+    }
+    switch (currentinstruction.iop) {
+        case opHALT:
+            return srHALT;
+        case opIN:
+            if (scanf("%d",&reg[r]) != 1)
+                return srHALT;
+            break;
+        case opOUT:
+            printf("OUT instruction prints: %d\n",reg[r]);
+            break;
+        case opADD: reg[r] = (int) ((unsigned) reg[s] + (unsigned) reg[t]); break;
+        case opSUB: reg[r] = (int) ((unsigned) reg[s] - (unsigned) reg[t]); break;
+        case opMUL: reg[r] = (int) ((unsigned) reg[s] * (unsigned) reg[t]); break;
+        case opDIV:
+            if (reg[t] != 0 && !(reg[t] == -1 && reg[s] == INT_MIN))
+                reg[r] = reg[s] / reg[t];
+            else
+                return srZERODIVIDE;
+            break;
+        case opLD: reg[r] = dMem[m]; break;
+        case opST: dMem[m] = reg[r]; break;
+        case opLDA: reg[r] = m; break;
+        case opLDC: reg[r] = currentinstruction.iarg2; break;
+        case opJLT: if (reg[r] < 0) reg[PC_REG] = m; break;
+        case opJLE: if (reg[r] <= 0) reg[PC_REG] = m; break;
+        case opJGT: if (reg[r] > 0) reg[PC_REG] = m; break;
+        case opJGE: if (reg[r] >= 0) reg[PC_REG] = m; break;
+        case opJEQ: if (reg[r] == 0) reg[PC_REG] = m; break;
+        case opJNE: if (reg[r] != 0) reg[PC_REG] = m; break;
+    }
+    return srOKAY;
+}
+
+int main(int argc, char * argv[])
+{
+    FILE * pgm;
+    STEPRESULT stepResult = srOKAY;
+    long long stepcnt = 0;
+    if (argc != 2) {
+        fprintf(stderr,"usage: %s <filename>\n",argv[0]);
+        return 1;
+    }
+    pgm = fopen(argv[1],"r");
+    if (pgm == NULL) {
+        fprintf(stderr,"File %s not found\n",argv[1]);
+        return 1;
+    }
+    if (!readInstructions(pgm))
+        return 1;
+    fclose(pgm);
+    dMem[0] = DADDR_SIZE - 1;
+    /* the "g" command */
+    while (stepResult == srOKAY) {
+        iloc = reg[PC_REG];
+        if (traceflag)
+            fprintf(stderr,"%d\n",iloc);
+        stepResult = stepTM();
+        stepcnt++;
+    }
+    fflush(stdout);
+    if (stepResult != srHALT)
+        fprintf(stderr,"Simulation error: %s at location %d\n",stepResultTab[stepResult],iloc);
+    fprintf(stderr,"Number of instructions executed = %lld\n",stepcnt);
+    return stepResult == srHALT ? 0 : 2;
+}
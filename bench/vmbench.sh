@@ -0,0 +1,81 @@
+#!/bin/sh
+#
+# Benchmark of the bytecode VM against the TM simulator
+# Compiles each program in tm/ with hw2_binary for both
+# targets, runs the code on the threaded builds of the
+# VM and of the TM simulator several times, and reports
+# the instructions each executes, the median times and
+# how many times faster the VM runs the program. Exits
+# with status 1 when the two disagree on the output.
+#
+# usage: vmbench.sh [-r runs] [-p "programs"] [-2 hw2_binary]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+runs=5
+programs="fib sieve sort matmul collatz"
+hw2="$here/../project2/hw2_binary"
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -r) runs=$2; shift 2 ;;
+        -p) programs=$2; shift 2 ;;
+        -2) hw2=$2; shift 2 ;;
+        *) echo "usage: $0 [-r runs] [-p \"programs\"] [-2 hw2_binary]" >&2
+           exit 1 ;;
+    esac
+done
+
+if [ ! -x "$hw2" ]; then
+    echo "$hw2 not built" >&2
+    exit 1
+fi
+make -C "$here" tmthreaded vmthreaded >/dev/null || exit 1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now() { date +%s%N; }
+
+# median: reads one time in ns per line, prints the
+# median in milliseconds
+median() {
+    sort -n | awk '{ t[NR] = $1 / 1e6 }
+        END { printf "%.3f\n", NR % 2 ? t[(NR + 1) / 2] : (t[NR / 2] + t[NR / 2 + 1]) / 2 }'
+}
+
+# run machine program: runs the code of program for
+# machine (tm or vm), leaving its output in machine.out,
+# and prints "instructions median-ms"
+run() {
+    machine=$1 prog=$2
+    : > "$work/times"
+    i=0
+    while [ $i -lt "$runs" ]; do
+        start=$(now)
+        "$here/${machine}threaded" "$work/$prog.$machine" > "$work/$machine.out" 2> "$work/$machine.err" < /dev/null
+        echo $(( $(now) - start )) >> "$work/times"
+        i=$((i + 1))
+    done
+    echo "$(sed -n 's/Number of instructions executed = //p' "$work/$machine.err") $(median < "$work/times")"
+}
+
+status=0
+echo "VM against TM ($runs runs per program)"
+printf "%-8s %12s %10s %12s %10s %8s\n" program "TM instrs" "TM ms" "VM instrs" "VM ms" speedup
+for prog in $programs; do
+    cp "$here/tm/$prog.cm" "$work/"
+    (cd "$work" && "$hw2" "$prog.cm" >/dev/null 2>&1 && "$hw2" -ftarget=vm "$prog.cm" >/dev/null 2>&1)
+    if [ ! -f "$work/$prog.tm" ] || [ ! -f "$work/$prog.vm" ]; then
+        echo "$prog: no code generated"
+        status=1
+        continue
+    fi
+    set -- $(run tm "$prog") $(run vm "$prog")
+    printf "%-8s %12d %10.3f %12d %10.3f %8.2f\n" "$prog" "$1" "$2" "$3" "$4" \
+        $(awk -v t="$2" -v v="$4" 'BEGIN { print (v > 0 ? t / v : 0) }')
+    if ! cmp -s "$work/tm.out" "$work/vm.out"; then
+        echo "$prog: VM output differs from TM"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,90 @@
+#!/bin/sh
+#
+# Reuse of cached analyses by the watch mode
+# Generates a program with cmgen and compiles it with
+# hw2_binary --watch -ftime-report through code
+# generation, then edits it three times: rewritten
+# unchanged, moved down a line, and with a statement
+# added to main. After each edit the watcher must reuse
+# the analysis of every function, every function, and
+# every function but main, and its listing and code
+# must be those of a fresh compile. Exits with status 1
+# when an edit is not reused as expected or the outputs
+# differ.
+#
+# usage: watchcheck.sh [-t analyze-threads] [-2 hw2_binary] [-- cmgen options]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+hw2="$here/../project2/hw2_binary"
+cmgen="$here/cmgen"
+threads=3
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -t) threads=$2; shift 2 ;;
+        -2) hw2=$2; shift 2 ;;
+        --) shift; break ;;
+        *) echo "usage: $0 [-t analyze-threads] [-2 hw2_binary] [-- cmgen options]" >&2
+           exit 1 ;;
+    esac
+done
+[ $# -eq 0 ] && set -- -f 200
+
+if [ ! -x "$hw2" ]; then
+    echo "$hw2 not built" >&2
+    exit 1
+fi
+[ -x "$cmgen" ] || make -C "$here" cmgen >/dev/null || exit 1
+work=$(mktemp -d)
+mkdir "$work/watched" "$work/fresh"
+watcher=""
+trap '[ -n "$watcher" ] && kill $watcher 2>/dev/null; rm -rf "$work"' EXIT
+
+"$cmgen" "$@" > "$work/big.cm" || exit 1
+functions=$(grep -c '^[a-z].*(.*)$' "$work/big.cm")
+
+"$hw2" -fanalyze-threads="$threads" -ftime-report --watch "$work/watched" 2> "$work/watch.err" &
+watcher=$!
+compiles=0
+
+# Procedure step puts $work/next.cm in place as the
+# watched source, waits for its compilation and checks
+# that $1 analyses were reused and $2 recorded
+status=0
+step() {
+    compiles=$((compiles + 1))
+    cp "$work/next.cm" "$work/watched/.big.tmp"
+    mv "$work/watched/.big.tmp" "$work/watched/big.cm"
+    i=0
+    while [ "$(grep -c '^Compiled' "$work/watch.err")" -lt $compiles ]; do
+        if [ $i -ge 600 ]; then
+            echo "$3: not compiled" >&2
+            exit 1
+        fi
+        sleep 0.1
+        i=$((i + 1))
+    done
+    counts=$(grep '^analyses:' "$work/watch.err" | sed -n "${compiles}p")
+    cp "$work/next.cm" "$work/fresh/big.cm"
+    (cd "$work/fresh" && "$hw2" big.cm >/dev/null 2>&1)
+    result=PASS
+    [ "$counts" = "analyses: $1 reused, $2 recorded" ] || result=FAIL
+    cmp -s "$work/watched/big.tm" "$work/fresh/big.tm" || result=FAIL
+    tail -n +3 "$work/watched/big_20181683.txt" > "$work/watched.txt"
+    tail -n +3 "$work/fresh/big_20181683.txt" > "$work/fresh.txt"
+    cmp -s "$work/watched.txt" "$work/fresh.txt" || result=FAIL
+    printf "%-10s %-40s %s\n" "$3" "$counts" $result
+    [ $result = FAIL ] && status=1
+}
+
+sleep 0.5
+cp "$work/big.cm" "$work/next.cm"
+step 0 $functions initial
+step $functions 0 unchanged
+{ echo "/* moved */"; cat "$work/big.cm"; } > "$work/next.cm"
+step $functions 0 moved
+sed '$d' "$work/big.cm" > "$work/next.cm"
+{ echo "    output(7);"; echo "}"; } >> "$work/next.cm"
+step $((functions - 1)) 1 edited
+exit $status
@@ -0,0 +1,80 @@
+#!/bin/sh
+#
+# Correctness suite of the x86-64 backend
+# Compiles every program in tm/ and native/ with
+# hw2_binary for the TM and for x86-64, assembles and
+# links the latter with the runtime, runs both on the
+# program's .in file if it has one, and compares their
+# output line by line. A program the TM stops with a
+# runtime error, such as a division by zero, must exit
+# with status 2 after the same output, and any other
+# with status 0. Also prints the time of each run.
+# Exits with status 1 when any program differs.
+#
+# usage: x86check.sh [-2 hw2_binary] [-c cc] [program.cm...]
+#
+
+here=$(cd "$(dirname "$0")" && pwd)
+hw2="$here/../project2/hw2_binary"
+runtime="$here/../project2/runtime.c"
+cc=${CC:-gcc}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -2) hw2=$2; shift 2 ;;
+        -c) cc=$2; shift 2 ;;
+        -*) echo "usage: $0 [-2 hw2_binary] [-c cc] [program.cm...]" >&2
+            exit 1 ;;
+        *) break ;;
+    esac
+done
+[ $# -eq 0 ] && set -- "$here"/tm/*.cm "$here"/native/*.cm
+
+if [ ! -x "$hw2" ]; then
+    echo "$hw2 not built" >&2
+    exit 1
+fi
+make -C "$here" tmthreaded >/dev/null || exit 1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now() { date +%s%N; }
+
+status=0
+printf "%-10s %6s %10s %10s\n" program result "TM ms" "x86 ms"
+for src in "$@"; do
+    prog=$(basename "$src" .cm)
+    input=/dev/null
+    [ -f "${src%.cm}.in" ] && input="${src%.cm}.in"
+    cp "$src" "$work/"
+    (cd "$work" && "$hw2" "$prog.cm" >/dev/null 2>&1 && "$hw2" -ftarget=x86 "$prog.cm" >/dev/null 2>&1)
+    if [ ! -f "$work/$prog.tm" ] || [ ! -f "$work/$prog.s" ]; then
+        printf "%-10s %6s\n" "$prog" "NOCODE"
+        status=1
+        continue
+    fi
+    if ! "$cc" -o "$work/$prog" "$work/$prog.s" "$runtime" 2> "$work/cc.err"; then
+        printf "%-10s %6s\n" "$prog" "NOLINK"
+        sed 's/^/    /' "$work/cc.err" | head -5
+        status=1
+        continue
+    fi
+    start=$(now)
+    "$here/tmthreaded" "$work/$prog.tm" < "$input" > "$work/tm.out" 2> "$work/tm.err"
+    mid=$(now)
+    "$work/$prog" < "$input" > "$work/x86.out" 2>/dev/null
+    rc=$?
+    end=$(now)
+    expected=0
+    grep -q "^Simulation error" "$work/tm.err" && expected=2
+    result=PASS
+    if ! cmp -s "$work/tm.out" "$work/x86.out" || [ $rc -ne $expected ]; then
+        result=FAIL
+        status=1
+    fi
+    printf "%-10s %6s %10.3f %10.3f\n" "$prog" "$result" \
+        $(awk -v s="$start" -v m="$mid" -v e="$end" 'BEGIN { print (m - s) / 1e6, (e - m) / 1e6 }')
+    [ "$result" = FAIL ] && [ $rc -ne $expected ] && echo "    exit status $rc, expected $expected"
+    [ "$result" = FAIL ] && diff "$work/tm.out" "$work/x86.out" | head -5 | sed 's/^/    /'
+done
+exit $status
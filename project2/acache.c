@@ -0,0 +1,95 @@
+/****************************************************/
+/* File: acache.c                                   */
+/* Cache of the analyses of single functions, for  */
+/* the long running compilers                       */
+/* An open hash table of the compiling thread,      */
+/* keyed by subtree hash; it lives in malloc memory */
+/* since syntax trees come and go                   */
+/****************************************************/
+
+#include "globals.h"
+#include "acache.h"
+
+/* the cache is swept once it holds MAXANALYSES; analyses
+ * survive MAXAGE compilations without being used */
+#define MAXANALYSES 65536
+#define MAXAGE 8
+
+static THREADLOCAL Analysis ** table = NULL;
+static THREADLOCAL unsigned size = 0;  /* a power of 2 */
+static THREADLOCAL unsigned count = 0;
+static THREADLOCAL unsigned long generation = 1;
+
+/* Function findSlot returns the slot of key, or the
+ * empty slot where it would go
+ */
+static Analysis ** findSlot(unsigned long key)
+{
+    unsigned i = (unsigned) (key ^ (key >> 32)) & (size - 1);
+    while (table[i] != NULL && table[i]->key != key)
+        i = (i + 1) & (size - 1);
+    return &table[i];
+}
+
+/* Procedure rebuild rehashes the analyses into a table
+ * of newSize slots, dropping those that are too old if
+ * sweep is set
+ */
+static void rebuild(unsigned newSize, int sweep)
+{
+    Analysis ** old = table;
+    unsigned i, oldSize = size;
+    table = (Analysis **) calloc(newSize,sizeof(Analysis *));
+    size = newSize;
+    count = 0;
+    for (i = 0; i < oldSize; i++)
+        if (old[i] != NULL) {
+            if (sweep && old[i]->used + MAXAGE < generation)
+                acacheFree(old[i]);
+            else {
+                *findSlot(old[i]->key) = old[i];
+                count++;
+            }
+        }
+    free(old);
+}
+
+Analysis * acacheFind(unsigned long key)
+{
+    return size > 0 ? *findSlot(key) : NULL;
+}
+
+void acacheStore(Analysis * a)
+{
+    Analysis ** slot;
+    if (2 * (count + 1) > size)
+        rebuild(size ? 2 * size : 1024,FALSE);
+    slot = findSlot(a->key);
+    if (*slot != NULL)
+        acacheFree(*slot);
+    else
+        count++;
+    a->used = generation;
+    *slot = a;
+}
+
+void acacheFree(Analysis * a)
+{
+    free(a->deps);
+    free(a->diags);
+    free(a->links);
+    free(a->locals);
+    free(a);
+}
+
+void acacheSweep(void)
+{
+    if (count >= MAXANALYSES)
+        rebuild(size,TRUE);
+    generation++;
+}
+
+unsigned long acacheGeneration(void)
+{
+    return generation;
+}
@@ -0,0 +1,88 @@
+/****************************************************/
+/* File: acache.h                                   */
+/* Cache of the analyses of single functions, for  */
+/* the long running compilers                       */
+/****************************************************/
+
+#ifndef _ACACHE_H_
+#define _ACACHE_H_
+
+/* a global name the body of a function refers to,
+ * with the signature of what the name meant to it
+ * (0 if undeclared)
+ */
+typedef struct
+{
+    char * name;
+    unsigned long signature;
+} Dependency;
+
+/* an error found in the body; type errors have no name */
+typedef struct
+{
+    int line;          /* relative to the function */
+    const char * message;
+    char * name;
+} Diagnostic;
+
+/* a name the body declares, whose symbol is made anew
+ * when the analysis is reused; kind is a SymbolKind
+ */
+typedef struct
+{
+    int kind;
+    ExpType type;
+    int depth, memloc, size, order;
+} Local;
+
+/* The links of a node: its type in the low 2 bits, and
+ * above them 0 for no symbol, 1 for the global of its
+ * name, or 2 + i for the local i
+ */
+#define LINKTYPE(l) ((ExpType) ((l) & 3))
+#define LINKSYMBOL(l) ((l) >> 2)
+
+/* The analysis of a function body, keyed by the hash of
+ * its subtree, with the links of the nodes below the
+ * function in preorder. Names are interned, so an
+ * analysis is only valid on the thread that made it, as
+ * is the cache
+ */
+typedef struct
+{
+    unsigned long key;
+    Dependency * deps;
+    int ndeps, maxdeps;
+    Diagnostic * diags;
+    int ndiags, maxdiags;
+    int * links;
+    int nlinks, maxlinks;
+    Local * locals;
+    int nlocals, maxlocals;
+    unsigned long used;  /* generation of the last use */
+} Analysis;
+
+/* Function acacheFind returns the analysis stored under
+ * key by the calling thread, or NULL
+ */
+Analysis * acacheFind(unsigned long key);
+
+/* Procedure acacheStore stores a, allocated by malloc,
+ * replacing any analysis of the same key
+ */
+void acacheStore(Analysis * a);
+
+/* Procedure acacheFree frees an analysis not stored */
+void acacheFree(Analysis * a);
+
+/* Procedure acacheSweep ends a compilation: analyses left
+ * unused for a while are dropped once the cache is full
+ */
+void acacheSweep(void);
+
+/* Function acacheGeneration returns the number of the
+ * current compilation, to be set in the analyses it uses
+ */
+unsigned long acacheGeneration(void);
+
+#endif
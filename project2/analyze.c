@@ -0,0 +1,880 @@
+/****************************************************/
+/* File: analyze.c                                  */
+/* Semantic analyzer implementation                 */
+/* for the C- compiler                              */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "analyze.h"
+#include "pool.h"
+#include "trace.h"
+#include "acache.h"
+#include "stats.h"
+#include <pthread.h>
+#include <unistd.h>
+
+int AnalyzeThreads = 0;
+int IncrementalAnalysis = FALSE;
+
+/* function bodies are analyzed side by side only when
+ * there are at least PARALLELMIN functions */
+#define PARALLELMIN 64
+
+/* In a parallel analysis every thread writes its
+ * diagnostics to a log of its own, and a top-level
+ * declaration keeps where in the logs its diagnostics
+ * are; once all are known, they are listed in source
+ * order as a single walk would
+ */
+typedef struct
+{
+    FILE * out;
+    char * text;  /* valid once out is closed */
+    size_t len;
+    long written; /* bytes so far */
+} Log;
+
+/* the diagnostics of one phase of a declaration */
+typedef struct
+{
+    Log * log;
+    long start, end;
+} Span;
+
+typedef struct
+{
+    TreeNode * decl;
+    int order;        /* the globals its body sees */
+    int failed;
+    Span declared;    /* declaring it */
+    Span checked;     /* analyzing the body */
+    unsigned long key;  /* hash of a function, when reusing */
+    Analysis * record;  /* of a function analyzed anew */
+} Item;
+
+/* the function whose body is being analyzed */
+static THREADLOCAL TreeNode * currentFunction = NULL;
+
+/* the declaration being analyzed in parallel and the
+ * log of the thread, NULL in a single walk */
+static THREADLOCAL Item * currentItem = NULL;
+static THREADLOCAL Log * currentLog = NULL;
+
+/* the analysis of the function body being recorded for
+ * reuse, NULL if none */
+static THREADLOCAL Analysis * currentRecord = NULL;
+static THREADLOCAL int recordBase = 0;
+
+/* Procedure report prints an error to the listing, or
+ * to the log of the thread in a parallel analysis, and
+ * records it; errors with a name are symbol errors
+ */
+static void report(int lineno, const char * message, char * name)
+{
+    FILE * out = currentItem == NULL ? listing : currentLog->out;
+    int n;
+    if (name != NULL)
+        n = fprintf(out,"Symbol error at line %d: %s %s\n",lineno,message,name);
+    else
+        n = fprintf(out,"Type error at line %d: %s\n",lineno,message);
+    if (currentItem != NULL) {
+        if (n > 0)
+            currentLog->written += n;
+        currentItem->failed = TRUE;
+    }
+    if (currentRecord != NULL) {
+        Analysis * a = currentRecord;
+        if (a->ndiags == a->maxdiags) {
+            a->maxdiags = a->maxdiags ? 2 * a->maxdiags : 8;
+            a->diags = (Diagnostic *) realloc(a->diags,a->maxdiags * sizeof(Diagnostic));
+        }
+        a->diags[a->ndiags].line = lineno - recordBase;
+        a->diags[a->ndiags].message = message;
+        a->diags[a->ndiags].name = name;
+        a->ndiags++;
+    }
+    Error = TRUE;
+}
+
+static void symbolError(TreeNode * t, const char * message)
+{
+    report(t->lineno,message,t->attr.name);
+}
+
+static void typeError(TreeNode * t, const char * message)
+{
+    report(t->lineno,message,NULL);
+}
+
+static unsigned long mix(unsigned long h, unsigned long v)
+{
+    h = (h ^ v) * 0xFF51AFD7ED558CCDUL;
+    return h ^ (h >> 32);
+}
+
+/* Function signature hashes what a body can learn of
+ * the global s: its kind, its type and, for a function,
+ * its parameters; 0 stands for no declaration
+ */
+static unsigned long signature(Symbol * s)
+{
+    unsigned long h;
+    TreeNode * p;
+    if (s == NULL)
+        return 0;
+    h = mix(mix(1,s->kind),s->type);
+    if (s->kind == FuncSym)
+        for (p = s->decl->child[1]; p != NULL; p = p->sibling)
+            h = mix(h,p->kind.decl + 1);
+    return h | 1;
+}
+
+/* Procedure depend records that the body being recorded
+ * refers to the global name, found as s
+ */
+static void depend(char * name, Symbol * s)
+{
+    Analysis * a = currentRecord;
+    if (a->ndeps == a->maxdeps) {
+        a->maxdeps = a->maxdeps ? 2 * a->maxdeps : 8;
+        a->deps = (Dependency *) realloc(a->deps,a->maxdeps * sizeof(Dependency));
+    }
+    a->deps[a->ndeps].name = name;
+    a->deps[a->ndeps].signature = signature(s);
+    a->ndeps++;
+}
+
+/* Function builtin makes the declaration of a function
+ * the runtime provides: int input(void) or
+ * void output(int x)
+ */
+static TreeNode * builtin(const char * name, ExpType type, int takesInt)
+{
+    TreeNode * t = newDeclNode(FunK);
+    t->lineno = 0;
+    t->attr.name = internString(name);
+    t->child[0] = newExpNode(TypeK);
+    t->child[0]->type = type;
+    if (takesInt) {
+        t->child[1] = newDeclNode(ParamK);
+        t->child[1]->lineno = 0;
+        t->child[1]->attr.name = internString("x");
+        t->child[1]->child[0] = newExpNode(TypeK);
+        t->child[1]->child[0]->type = Integer;
+    }
+    return t;
+}
+
+/* Procedure declare enters the declaration t into the
+ * innermost scope
+ */
+static void declare(TreeNode * t)
+{
+    SymbolKind kind;
+    ExpType type = t->child[0] != NULL ? t->child[0]->type : Integer;
+    int size = 1;
+    switch (t->kind.decl) {
+        case VarK: kind = VarSym; break;
+        case ArrVarK:
+            kind = ArraySym;
+            type = IntegerArray;
+            size = t->child[1] != NULL && t->child[1]->attr.val > 0 ? t->child[1]->attr.val : 1;
+            break;
+        case FunK: kind = FuncSym; break;
+        case ParamK: kind = ParamSym; break;
+        default:
+            kind = ArrParamSym;
+            type = type == Void ? Void : IntegerArray;
+            break;
+    }
+    if (kind != FuncSym && type == Void) {
+        symbolError(t,"void variable");
+        type = Integer;
+    }
+    t->symbol = st_insert(t->attr.name,kind,type,size,t);
+    if (t->symbol == NULL)
+        symbolError(t,"redeclared");
+}
+
+/* Function paramType is the type of an argument that
+ * the parameter p expects
+ */
+static ExpType paramType(TreeNode * p)
+{
+    return p->kind.decl == ArrParamK ? IntegerArray : Integer;
+}
+
+/* Procedure checkCall checks the arguments of the call
+ * t against the parameters of the function called
+ */
+static void checkCall(TreeNode * t)
+{
+    TreeNode * arg = t->child[0];
+    TreeNode * param = t->symbol->decl->child[1];
+    for (; arg != NULL && param != NULL; arg = arg->sibling, param = param->sibling)
+        if (arg->type != paramType(param))
+            typeError(arg,"argument type does not match the parameter");
+    if (arg != NULL || param != NULL)
+        typeError(t,"wrong number of arguments");
+}
+
+/* Procedure checkNode performs type checking at a
+ * single tree node
+ */
+static void checkNode(TreeNode * t)
+{
+    Symbol * s = t->symbol;
+    switch (t->nodekind) {
+        case ExpK:
+            switch (t->kind.exp) {
+                case NumK:
+                    t->type = Integer;
+                    break;
+                case IdK:
+                    t->type = Integer;
+                    if (s == NULL)
+                        break;
+                    if (s->kind == FuncSym)
+                        typeError(t,"function used as a variable");
+                    else
+                        t->type = s->type;
+                    break;
+                case ArrK:
+                    t->type = Integer;
+                    if (s != NULL && s->type != IntegerArray)
+                        typeError(t,"subscript of a name that is not an array");
+                    if (t->child[0] != NULL && t->child[0]->type != Integer)
+                        typeError(t,"array subscript is not an integer");
+                    break;
+                case FunCallK:
+                    t->type = Integer;
+                    if (s == NULL)
+                        break;
+                    if (s->kind != FuncSym)
+                        typeError(t,"call of a name that is not a function");
+                    else {
+                        t->type = s->type;
+                        checkCall(t);
+                    }
+                    break;
+                case simpleK:
+                    if (t->child[0]->type != Integer || t->child[2]->type != Integer)
+                        typeError(t,"comparison of non-integer values");
+                    t->type = Integer;
+                    break;
+                case addK:
+                case mulK:
+                    /* child[0] is the list: operand, operator, operand */
+                    if (t->child[0]->type != Integer ||
+                        t->child[0]->sibling->sibling->type != Integer)
+                        typeError(t,"arithmetic on non-integer values");
+                    t->type = Integer;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case StmtK:
+            switch (t->kind.stmt) {
+                case AssignK:
+                    if (t->child[0]->type != Integer)
+                        typeError(t,"assignment to a non-integer variable");
+                    if (t->child[1]->type != Integer)
+                        typeError(t,"assignment of a non-integer value");
+                    t->type = Integer;
+                    break;
+                case IfK:
+                case WhileK:
+                    if (t->child[0]->type != Integer)
+                        typeError(t,"test is not an integer");
+                    break;
+                case ReturnK:
+                    if (currentFunction == NULL)
+                        break;
+                    if (currentFunction->child[0]->type == Void && t->child[0] != NULL)
+                        typeError(t,"void function returns a value");
+                    else if (currentFunction->child[0]->type == Integer &&
+                             (t->child[0] == NULL || t->child[0]->type != Integer))
+                        typeError(t,"int function must return an integer");
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Procedure openNode is the work done at t on the way
+ * down: declarations enter the innermost scope, names
+ * are linked to their declarations, and functions and
+ * compound statements open scopes. A function body
+ * shares the scope of the parameters. Returns whether
+ * t opened a scope
+ */
+static int openNode(TreeNode * t, int functionBody)
+{
+    if (t->nodekind == DeclK) {
+        declare(t);
+        if (t->kind.decl == FunK) {
+            st_pushScope(t->attr.name);
+            currentFunction = t;
+            return TRUE;
+        }
+    }
+    else if (t->nodekind == StmtK && t->kind.stmt == CompoundK) {
+        if (functionBody)
+            return FALSE;
+        st_pushScope("block");
+        return TRUE;
+    }
+    else if (t->nodekind == ExpK &&
+             (t->kind.exp == IdK || t->kind.exp == ArrK || t->kind.exp == FunCallK)) {
+        t->symbol = st_lookup(t->attr.name);
+        /* the line lists of shared globals are left alone
+         * by a parallel analysis, which does not print them */
+        if (t->symbol == NULL)
+            symbolError(t,"undeclared");
+        else if (currentItem == NULL || t->symbol->depth > 0)
+            st_addLine(t->symbol,t->lineno);
+        if (currentRecord != NULL && (t->symbol == NULL || t->symbol->depth == 0))
+            depend(t->attr.name,t->symbol);
+    }
+    return FALSE;
+}
+
+/* A frame of the traversal stack is a node whose
+ * children are being visited; the siblings of a node
+ * replace it in its frame, so the stack is as deep as
+ * the tree and not as long as its lists
+ */
+typedef struct
+{
+    TreeNode * t;
+    int child;   /* next child to visit */
+    int scoped;  /* t opened a scope */
+} Frame;
+
+static THREADLOCAL Frame * stack = NULL;
+static THREADLOCAL int maxstack = 0;
+
+/* Procedure traceFunction opens the trace span of the
+ * function t of a single walk, as analyzeFunction does
+ * for a parallel one
+ */
+static void traceFunction(TreeNode * t)
+{
+    if (t->nodekind == DeclK && t->kind.decl == FunK)
+        TRACE_BEGIN("analyze function",t->attr.name);
+}
+
+/* Procedure walk analyzes the declaration list root;
+ * with single set only root, a function already
+ * declared, is analyzed
+ */
+static void walk(TreeNode * root, int single)
+{
+    int sp = 1;
+    if (maxstack == 0) {
+        maxstack = 64;
+        stack = (Frame *) malloc(maxstack * sizeof(Frame));
+    }
+    stack[0].t = root;
+    stack[0].child = 0;
+    if (single) {
+        st_pushScope(root->attr.name);
+        currentFunction = root;
+        stack[0].scoped = TRUE;
+    }
+    else {
+        traceFunction(root);
+        stack[0].scoped = openNode(root,FALSE);
+    }
+    while (sp > 0) {
+        Frame * f = &stack[sp-1];
+        TreeNode * t = f->t;
+        if (f->child < MAXCHILDREN) {
+            TreeNode * c = t->child[f->child++];
+            if (c == NULL)
+                continue;
+            if (sp == maxstack) {
+                maxstack *= 2;
+                stack = (Frame *) realloc(stack,maxstack * sizeof(Frame));
+                f = &stack[sp-1];
+            }
+            stack[sp].t = c;
+            stack[sp].scoped = openNode(c,t->nodekind == DeclK && f->child == 3);
+            stack[sp].child = 0;
+            sp++;
+            continue;
+        }
+        /* on the way up: the children have their types */
+        checkNode(t);
+        if (f->scoped)
+            st_popScope();
+        if (t->nodekind == DeclK && t->kind.decl == FunK) {
+            currentFunction = NULL;
+            if (!single)
+                TRACE_END();
+        }
+        if (t->sibling != NULL && !(single && sp == 1)) {
+            f->t = t->sibling;
+            if (!single)
+                traceFunction(f->t);
+            f->scoped = openNode(f->t,FALSE);
+            f->child = 0;
+        }
+        else
+            sp--;
+    }
+}
+
+/* the state shared by the threads of a parallel analysis */
+typedef struct
+{
+    Item * items;
+    int * functions;     /* indices of the function items */
+    GlobalScope * globals;
+    Log * logs;          /* one per thread */
+    int nlogs;
+    pthread_t owner;     /* the compiling thread */
+    pthread_mutex_t lock;
+    void ** nodes;       /* allocations of the helpers */
+    int nnodes;
+} Parallel;
+
+/* Procedure startSpan makes the diagnostics of the
+ * calling thread go to span, claiming a log for the
+ * thread on its first span
+ */
+static void startSpan(Parallel * p, Span * span)
+{
+    if (currentLog == NULL) {
+        currentLog = &p->logs[__atomic_fetch_add(&p->nlogs,1,__ATOMIC_RELAXED)];
+        currentLog->out = open_memstream(&currentLog->text,&currentLog->len);
+        if (currentLog->out == NULL)
+            currentLog->out = stderr;
+    }
+    span->log = currentLog;
+    span->start = currentLog->written;
+}
+
+static void endSpan(Span * span)
+{
+    span->end = span->log->written;
+}
+
+/* the locals of the function being recorded, sorted by
+ * symbol to find their numbers */
+typedef struct
+{
+    Symbol * s;
+    int i;
+} Numbered;
+
+static THREADLOCAL Numbered * numbered = NULL;
+static THREADLOCAL int maxnumbered = 0;
+
+static int compareNumbered(const void * a, const void * b)
+{
+    Symbol * x = ((const Numbered *) a)->s, * y = ((const Numbered *) b)->s;
+    return x < y ? -1 : x > y;
+}
+
+/* Procedure recordLocals records in a the names that
+ * the list t and the nodes below it declare
+ */
+static void recordLocals(Analysis * a, TreeNode * t)
+{
+    int i;
+    for (; t != NULL; t = t->sibling) {
+        Symbol * s = t->symbol;
+        if (t->nodekind == DeclK && s != NULL) {
+            Local * l;
+            if (a->nlocals == a->maxlocals) {
+                a->maxlocals = a->maxlocals ? 2 * a->maxlocals : 8;
+                a->locals = (Local *) realloc(a->locals,a->maxlocals * sizeof(Local));
+            }
+            if (a->nlocals == maxnumbered) {
+                maxnumbered = maxnumbered ? 2 * maxnumbered : 64;
+                numbered = (Numbered *) realloc(numbered,maxnumbered * sizeof(Numbered));
+            }
+            numbered[a->nlocals].s = s;
+            numbered[a->nlocals].i = a->nlocals;
+            l = &a->locals[a->nlocals++];
+            l->kind = s->kind;
+            l->type = s->type;
+            l->depth = s->depth;
+            l->memloc = s->memloc;
+            l->size = s->size;
+            l->order = s->order;
+        }
+        for (i = 0; i < MAXCHILDREN; i++)
+            if (t->child[i] != NULL)
+                recordLocals(a,t->child[i]);
+    }
+}
+
+/* Procedure recordLinks records in a the types and
+ * symbols of the list t and the nodes below it
+ */
+static void recordLinks(Analysis * a, TreeNode * t)
+{
+    int i;
+    for (; t != NULL; t = t->sibling) {
+        Symbol * s = t->symbol;
+        int symbol = 0;
+        if (s != NULL && s->depth == 0)
+            symbol = 1;
+        else if (s != NULL) {
+            Numbered key, * found;
+            key.s = s;
+            found = (Numbered *) bsearch(&key,numbered,a->nlocals,sizeof(Numbered),compareNumbered);
+            if (found != NULL)
+                symbol = 2 + found->i;
+        }
+        if (a->nlinks == a->maxlinks) {
+            a->maxlinks = a->maxlinks ? 2 * a->maxlinks : 64;
+            a->links = (int *) realloc(a->links,a->maxlinks * sizeof(int));
+        }
+        a->links[a->nlinks++] = symbol << 2 | t->type;
+        for (i = 0; i < MAXCHILDREN; i++)
+            if (t->child[i] != NULL)
+                recordLinks(a,t->child[i]);
+    }
+}
+
+/* Procedure recordFunction records in a how the walk
+ * annotated the function fun, for reuse to do the same
+ */
+static void recordFunction(Analysis * a, TreeNode * fun)
+{
+    int i;
+    for (i = 0; i < MAXCHILDREN; i++)
+        if (fun->child[i] != NULL)
+            recordLocals(a,fun->child[i]);
+    if (a->nlocals > 1)
+        qsort(numbered,a->nlocals,sizeof(Numbered),compareNumbered);
+    for (i = 0; i < MAXCHILDREN; i++)
+        if (fun->child[i] != NULL)
+            recordLinks(a,fun->child[i]);
+}
+
+static void analyzeFunction(void * arg, int k)
+{
+    Parallel * p = (Parallel *) arg;
+    Item * item = &p->items[p->functions[k]];
+    TRACE_BEGIN("analyze function",item->decl->attr.name);
+    currentItem = item;
+    currentRecord = item->record;
+    recordBase = item->decl->lineno;
+    startSpan(p,&item->checked);
+    st_useGlobals(p->globals,item->order);
+    /* an empty scope stands for the globals, so that
+     * depths are those of a single walk */
+    st_pushScope("global");
+    walk(item->decl,TRUE);
+    if (currentRecord != NULL)
+        recordFunction(currentRecord,item->decl);
+    st_popScope();
+    st_useGlobals(NULL,0);
+    endSpan(&item->checked);
+    currentItem = NULL;
+    currentRecord = NULL;
+    TRACE_END();
+}
+
+/* Procedure finishHelper hands what a helper thread
+ * allocated (symbols of the tree) to the compiling
+ * thread and frees its tables
+ */
+static void finishHelper(void * arg)
+{
+    Parallel * p = (Parallel *) arg;
+    currentLog = NULL;
+    if (pthread_equal(pthread_self(),p->owner))
+        return;
+    pthread_mutex_lock(&p->lock);
+    p->nodes[p->nnodes++] = detachNodes();
+    pthread_mutex_unlock(&p->lock);
+    st_release();
+    releaseNames();
+    free(stack);
+    stack = NULL;
+    maxstack = 0;
+    free(numbered);
+    numbered = NULL;
+    maxnumbered = 0;
+}
+
+/* Procedure listSpan copies the diagnostics of span to
+ * the listing
+ */
+static void listSpan(Span * span)
+{
+    if (span->log != NULL && span->end > span->start && span->log->text != NULL)
+        fwrite(span->log->text + span->start,1,span->end - span->start,listing);
+}
+
+/* Function hashNode hashes the subtree t, and the
+ * siblings after it if t is not the root, into h. A node
+ * is hashed as one word of its kinds, its line relative
+ * to base (so that a function moved up or down keeps its
+ * hash) and which of its links are set, and one more
+ * for its attribute; names are interned, so their
+ * pointers stand for them
+ */
+static unsigned long hashNode(TreeNode * t, int base, int root, unsigned long h)
+{
+    for (; t != NULL; t = root ? NULL : t->sibling) {
+        unsigned long links = (t->child[0] != NULL) | (t->child[1] != NULL) << 1 |
+                              (t->child[2] != NULL) << 2 | (!root && t->sibling != NULL) << 3;
+        unsigned long attr = 0;
+        int i;
+        if (t->nodekind == DeclK)
+            attr = (unsigned long) t->attr.name;
+        else if (t->nodekind == ExpK)
+            switch (t->kind.exp) {
+                case NumK: attr = (unsigned) t->attr.val; break;
+                case OpK: attr = t->attr.op; break;
+                case TypeK: attr = t->type; break;
+                case IdK:
+                case ArrK:
+                case FunCallK: attr = (unsigned long) t->attr.name; break;
+                default: break;
+            }
+        h = mix(h,(unsigned long) (unsigned) (t->lineno - base) << 32 |
+                  links << 8 | t->nodekind << 4 | (unsigned) t->kind.exp);
+        h = mix(h,attr);
+        for (i = 0; i < MAXCHILDREN; i++)
+            if (t->child[i] != NULL)
+                h = hashNode(t->child[i],base,FALSE,h);
+    }
+    return h;
+}
+
+/* Procedure relink sets the types and symbols of the
+ * list t and the nodes below it as the analysis a
+ * found them, from its link *n on; locals holds the
+ * symbols of its locals, and globals are looked up
+ */
+static void relink(Analysis * a, TreeNode * t, Symbol * locals, int * n)
+{
+    int i;
+    for (; t != NULL; t = t->sibling) {
+        int link = a->links[(*n)++];
+        t->type = LINKTYPE(link);
+        if (LINKSYMBOL(link) == 0)
+            t->symbol = NULL;
+        else if (LINKSYMBOL(link) == 1)
+            t->symbol = st_lookup(t->attr.name);
+        else {
+            t->symbol = &locals[LINKSYMBOL(link) - 2];
+            if (t->nodekind == DeclK) {
+                t->symbol->name = t->attr.name;
+                t->symbol->decl = t;
+            }
+        }
+        for (i = 0; i < MAXCHILDREN; i++)
+            if (t->child[i] != NULL)
+                relink(a,t->child[i],locals,n);
+    }
+}
+
+/* Function relinkFunction annotates the function fun
+ * as the analysis a did, with new symbols for its
+ * locals; returns FALSE if they cannot be allocated
+ */
+static int relinkFunction(Analysis * a, TreeNode * fun)
+{
+    Symbol * locals = NULL;
+    int i, n = 0;
+    if (a->nlocals > 0) {
+        locals = (Symbol *) allocate(a->nlocals * sizeof(Symbol));
+        if (locals == NULL)
+            return FALSE;
+    }
+    for (i = 0; i < a->nlocals; i++) {
+        Symbol * s = &locals[i];
+        Local * l = &a->locals[i];
+        s->name = NULL;
+        s->kind = (SymbolKind) l->kind;
+        s->type = l->type;
+        s->depth = l->depth;
+        s->memloc = l->memloc;
+        s->size = l->size;
+        s->order = l->order;
+        s->decl = NULL;
+        s->lines = s->lastLine = NULL;
+        s->shadowed = s->scopeNext = NULL;
+    }
+    for (i = 0; i < MAXCHILDREN; i++)
+        if (fun->child[i] != NULL)
+            relink(a,fun->child[i],locals,&n);
+    return TRUE;
+}
+
+/* Function reuse lists the cached analysis of the
+ * function item and annotates it, if there is one whose
+ * globals still mean the same; returns FALSE otherwise
+ */
+static int reuse(Parallel * p, Item * item)
+{
+    Analysis * a = acacheFind(item->key);
+    int i, linked, base = item->decl->lineno;
+    if (a == NULL)
+        return FALSE;
+    st_useGlobals(p->globals,item->order);
+    for (i = 0; i < a->ndeps; i++)
+        if (signature(st_lookup(a->deps[i].name)) != a->deps[i].signature)
+            break;
+    linked = i == a->ndeps && relinkFunction(a,item->decl);
+    st_useGlobals(NULL,0);
+    if (!linked)
+        return FALSE;
+    a->used = acacheGeneration();
+    currentItem = item;
+    startSpan(p,&item->checked);
+    for (i = 0; i < a->ndiags; i++)
+        report(base + a->diags[i].line,a->diags[i].message,a->diags[i].name);
+    endSpan(&item->checked);
+    currentItem = NULL;
+    return TRUE;
+}
+
+static int compareDependencies(const void * a, const void * b)
+{
+    char * x = ((const Dependency *) a)->name, * y = ((const Dependency *) b)->name;
+    return x < y ? -1 : x > y;
+}
+
+/* Procedure keep stores the analysis recorded for item,
+ * each global it depends on listed once
+ */
+static void keep(Item * item)
+{
+    Analysis * a = item->record;
+    int i, n = 0;
+    qsort(a->deps,a->ndeps,sizeof(Dependency),compareDependencies);
+    for (i = 0; i < a->ndeps; i++)
+        if (n == 0 || a->deps[n-1].name != a->deps[i].name)
+            a->deps[n++] = a->deps[i];
+    a->ndeps = n;
+    a->key = item->key;
+    acacheStore(a);
+}
+
+/* Procedure analyzeSplit declares the globals of the
+ * declaration list syntaxTree into the open global scope
+ * and closes it, then analyzes the function bodies on
+ * nthreads threads against a read-only copy of it. With
+ * cached set, bodies whose cached analysis still holds
+ * are not analyzed again, and the others are recorded
+ */
+static void analyzeSplit(TreeNode * syntaxTree, int n, int nfunctions, int nthreads, int cached)
+{
+    Parallel p;
+    TreeNode * t;
+    int i, k, order = 1; /* input and output come first */
+    p.items = (Item *) calloc(n,sizeof(Item));
+    p.functions = (int *) malloc(nfunctions * sizeof(int));
+    p.logs = (Log *) calloc(nthreads + 1,sizeof(Log));
+    p.nlogs = 0;
+    for (t = syntaxTree, i = k = 0; t != NULL; t = t->sibling, i++) {
+        Item * item = &p.items[i];
+        item->decl = t;
+        currentItem = item;
+        startSpan(&p,&item->declared);
+        declare(t);
+        endSpan(&item->declared);
+        if (t->symbol != NULL)
+            order = t->symbol->order;
+        item->order = order;
+        if (t->kind.decl == FunK)
+            p.functions[k++] = i;
+    }
+    currentItem = NULL;
+    p.globals = st_shareGlobals();
+    st_popScope();
+    if (cached) {
+        int misses = 0;
+        for (i = 0; i < k; i++) {
+            Item * item = &p.items[p.functions[i]];
+            item->key = hashNode(item->decl,item->decl->lineno,TRUE,0);
+            if (reuse(&p,item))
+                reusedCount++;
+            else {
+                item->record = (Analysis *) calloc(1,sizeof(Analysis));
+                p.functions[misses++] = p.functions[i];
+                recordedCount++;
+            }
+        }
+        k = misses;
+        if (k < PARALLELMIN)
+            nthreads = 1;
+    }
+    currentLog = NULL;
+    p.owner = pthread_self();
+    pthread_mutex_init(&p.lock,NULL);
+    p.nodes = (void **) malloc(nthreads * sizeof(void *));
+    p.nnodes = 0;
+    parallelFor(k,nthreads,analyzeFunction,finishHelper,&p);
+    for (i = 0; i < p.nnodes; i++)
+        attachNodes(p.nodes[i]);
+    for (i = 0; i < p.nlogs; i++)
+        if (p.logs[i].out != stderr)
+            fclose(p.logs[i].out);
+    for (i = 0; i < n; i++) {
+        listSpan(&p.items[i].declared);
+        listSpan(&p.items[i].checked);
+        if (p.items[i].failed)
+            Error = TRUE;
+        if (p.items[i].record != NULL)
+            keep(&p.items[i]);
+    }
+    if (cached)
+        acacheSweep();
+    for (i = 0; i < p.nlogs; i++)
+        free(p.logs[i].text);
+    pthread_mutex_destroy(&p.lock);
+    free(p.nodes);
+    free(p.logs);
+    free(p.functions);
+    free(p.items);
+}
+
+void analyze(TreeNode * syntaxTree, int cached)
+{
+    TreeNode * t, * last = NULL;
+    int n = 0, nfunctions = 0;
+    int nthreads = AnalyzeThreads > 0 ? AnalyzeThreads : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    currentFunction = NULL;
+    st_pushScope("global");
+    declare(builtin("input",Integer,FALSE));
+    declare(builtin("output",Void,TRUE));
+    for (t = syntaxTree; t != NULL; t = t->sibling, n++) {
+        if (t->nodekind == DeclK && t->kind.decl == FunK)
+            nfunctions++;
+        last = t;
+    }
+    /* the scopes are printed in the order of a single walk */
+    if (cached && !TraceAnalyze)
+        analyzeSplit(syntaxTree,n,nfunctions,nthreads,TRUE);
+    else if (nthreads > 1 && nfunctions >= PARALLELMIN && !TraceAnalyze)
+        analyzeSplit(syntaxTree,n,nfunctions,nthreads,FALSE);
+    else {
+        if (syntaxTree != NULL)
+            walk(syntaxTree,FALSE);
+        st_popScope();
+    }
+    if (last == NULL || last->kind.decl != FunK || strcmp(last->attr.name,"main") != 0 ||
+        last->child[0]->type != Void || last->child[1] != NULL) {
+        fprintf(listing,"Symbol error: the last declaration must be void main(void)\n");
+        Error = TRUE;
+    }
+    if (TraceAnalyze)
+        printSymTabStats();
+}
@@ -0,0 +1,35 @@
+/****************************************************/
+/* File: analyze.h                                  */
+/* Semantic analyzer interface for the C- compiler  */
+/****************************************************/
+
+#ifndef _ANALYZE_H_
+#define _ANALYZE_H_
+
+/* AnalyzeThreads is the number of threads that check
+ * function bodies once the globals are declared
+ * (-fanalyze-threads); 0 means one per processor
+ */
+extern int AnalyzeThreads;
+
+/* IncrementalAnalysis = TRUE lets the long running
+ * compilers (--watch, --server) reuse the analyses of
+ * functions that did not change from one compilation
+ * to the next
+ */
+extern int IncrementalAnalysis;
+
+/* Procedure analyze builds the symbol table and
+ * checks types in a single traversal of the syntax
+ * tree: names are linked to their declarations on the
+ * way down and expression types are computed on the
+ * way up. Files of many functions have their bodies
+ * analyzed in parallel, with the same listing. With
+ * cached set, a function whose subtree and globals are
+ * those of an analysis cached by the calling thread
+ * gets its diagnostics, types and symbols from the
+ * cache instead of being analyzed again
+ */
+void analyze(TreeNode *, int cached);
+
+#endif
@@ -0,0 +1,110 @@
+/****************************************************/
+/* File: batch.c                                    */
+/* Batch compilation on a pool of worker threads    */
+/* Every worker compiles whole files, taking the    */
+/* next one from a shared counter                   */
+/****************************************************/
+
+#include "globals.h"
+#include "compile.h"
+#include "util.h"
+#include "symtab.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/* the batch shared by all workers */
+typedef struct
+{
+    char ** files;
+    int nfiles;
+    CompileStatus * status; /* status[i] of files[i] */
+    int next; /* index of the next file to compile */
+} Batch;
+
+static void * worker(void * arg)
+{
+    Batch * batch = (Batch *) arg;
+    int i;
+    while ((i = __atomic_fetch_add(&batch->next,1,__ATOMIC_RELAXED)) < batch->nfiles)
+        batch->status[i] = compileFile(batch->files[i]);
+    return NULL;
+}
+
+/* Procedure workerThread runs worker on a thread of its
+ * own, freeing the tables of the thread when it is done
+ */
+static void * workerThread(void * arg)
+{
+    worker(arg);
+    st_release();
+    releaseNames();
+    return NULL;
+}
+
+static int compareNames(const void * a, const void * b)
+{
+    return strcmp(*(char * const *) a,*(char * const *) b);
+}
+
+/* Function sharedListings reports pairs of sources whose
+ * listings would overwrite each other, which would make
+ * the output depend on the scheduling
+ */
+static int sharedListings(char ** files, int nfiles)
+{
+    char ** names = (char **) malloc(nfiles * sizeof(char *));
+    int i, shared = 0;
+    for (i = 0; i < nfiles; i++)
+    {
+        names[i] = (char *) malloc(FILENAME_MAX);
+        outputName(names[i],files[i],"_20181683.txt");
+    }
+    qsort(names,nfiles,sizeof(char *),compareNames);
+    for (i = 1; i < nfiles; i++)
+        if (strcmp(names[i-1],names[i]) == 0 &&
+            (i == 1 || strcmp(names[i-2],names[i]) != 0))
+        {
+            fprintf(stderr,"Listing %s is shared by several sources\n",names[i]);
+            shared++;
+        }
+    for (i = 0; i < nfiles; i++)
+        free(names[i]);
+    free(names);
+    return shared;
+}
+
+int batchCompile(char ** files, int nfiles, int nthreads)
+{
+    Batch batch;
+    pthread_t * threads;
+    int i, failed = 0;
+    if (sharedListings(files,nfiles) > 0)
+        return nfiles;
+    if (nthreads <= 0)
+        nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > nfiles)
+        nthreads = nfiles;
+    if (nthreads < 1)
+        nthreads = 1;
+    batch.files = files;
+    batch.nfiles = nfiles;
+    batch.status = (CompileStatus *) calloc(nfiles,sizeof(CompileStatus));
+    batch.next = 0;
+    threads = (pthread_t *) malloc(nthreads * sizeof(pthread_t));
+    for (i = 0; i < nthreads; i++)
+        if (pthread_create(&threads[i],NULL,workerThread,&batch) != 0)
+            break;
+    if (i == 0)
+        worker(&batch); /* no thread could be started */
+    while (i > 0)
+        pthread_join(threads[--i],NULL);
+    for (i = 0; i < nfiles; i++)
+    {
+        reportStatus(files[i],batch.status[i]);
+        if (compileFailed(batch.status[i]))
+            failed++;
+    }
+    free(threads);
+    free(batch.status);
+    return failed;
+}
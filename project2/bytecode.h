@@ -0,0 +1,75 @@
+/****************************************************/
+/* File: bytecode.h                                 */
+/* Register bytecode of the C- virtual machine      */
+/* Shared by the generator (vgen.c) and the VM      */
+/* (vm.c). A function's frame is an array of        */
+/* registers: its parameters, locals and            */
+/* temporaries, numbered as the frame locations of  */
+/* the analyzer, so a variable is a register and    */
+/* needs no load or store                           */
+/****************************************************/
+
+#ifndef _BYTECODE_H_
+#define _BYTECODE_H_
+
+/* The code file (<name>.vm) holds one instruction a line,
+ * "loc:  OP  a,b,c", all operands ints, and comment
+ * lines starting with '*'. Memory is one array of words:
+ * the globals from address 0, then the frames. rN is
+ * register N of the running frame, [x] the word at
+ * address x
+ *   HALT                 stop
+ *   ENTER  g,0,0         the first frame starts at g,
+ *                        past the globals
+ *   FUNC   n,0,0         entry of a function whose frame
+ *                        takes n registers
+ *   LI     a,k,0         ra = k
+ *   MOV    a,b,0         ra = rb
+ *   ADD    a,b,c         ra = rb + rc, and SUB MUL DIV
+ *   ADDI   a,b,k         ra = rb + k
+ *   LT     a,b,c         ra = rb < rc ? 1 : 0, and LE GT
+ *                        GE EQ NE
+ *   JMP    0,0,l         go to l
+ *   JZ     a,0,l         go to l if ra == 0, and JNZ
+ *   JLT    a,b,l         go to l if ra < rb, and JLE JGT
+ *                        JGE JEQ JNE
+ *   LDG    a,k,0         ra = [k]
+ *   STG    a,k,0         [k] = ra
+ *   LEA    a,k,0         ra = address of rk
+ *   LDX    a,b,c         ra = [rb + rc]
+ *   STX    a,b,c         [rb + rc] = ra
+ *   CALL   a,f,b         call the function at f, whose
+ *                        frame starts at rb and so holds
+ *                        the arguments there; ra = the
+ *                        value returned
+ *   RET    a,0,0         return ra
+ *   RET0   0,0,0         return from a void function
+ *   IN     a,0,0         ra = integer read
+ *   OUT    a,0,0         print ra
+ * Arithmetic wraps around, and comparisons compare the
+ * wrapped difference rb - rc (ra - rb for jumps) with 0,
+ * as the TM does. A program is ENTER, CALL of main,
+ * HALT, then the functions
+ */
+typedef enum {
+    bcHALT, bcENTER, bcFUNC, bcLI, bcMOV,
+    bcADD, bcSUB, bcMUL, bcDIV, bcADDI,
+    bcLT, bcLE, bcGT, bcGE, bcEQ, bcNE,
+    bcJMP, bcJZ, bcJNZ,
+    bcJLT, bcJLE, bcJGT, bcJGE, bcJEQ, bcJNE,
+    bcLDG, bcSTG, bcLEA, bcLDX, bcSTX,
+    bcCALL, bcRET, bcRET0, bcIN, bcOUT,
+    BCOPS
+} BcOp;
+
+static const char * bcNames[BCOPS] = {
+    "HALT", "ENTER", "FUNC", "LI", "MOV",
+    "ADD", "SUB", "MUL", "DIV", "ADDI",
+    "LT", "LE", "GT", "GE", "EQ", "NE",
+    "JMP", "JZ", "JNZ",
+    "JLT", "JLE", "JGT", "JGE", "JEQ", "JNE",
+    "LDG", "STG", "LEA", "LDX", "STX",
+    "CALL", "RET", "RET0", "IN", "OUT"
+};
+
+#endif
@@ -0,0 +1,350 @@
+/****************************************************/
+/* File: cache.c                                    */
+/* Content-hash compile cache                       */
+/* An entry is named by the SHA-256 of the source   */
+/* and of everything else that shapes the output;   */
+/* it holds the listing without its header line, so */
+/* equal sources under other names share it         */
+/****************************************************/
+
+#include "globals.h"
+#include "cache.h"
+#include "prune.h"
+#include "consteval.h"
+#include "cgen.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+const char * CacheDir = NULL;
+unsigned long long CacheLimit = 1024ULL * 1024 * 1024;
+
+/* stale temporary files are removed after STALETMP seconds */
+#define STALETMP 3600
+
+/**************************************************/
+/***************   SHA-256 (FIPS 180-4)   *********/
+/**************************************************/
+
+typedef struct
+{
+    unsigned int h[8];
+    unsigned char block[64];
+    unsigned long long length;
+    size_t used;
+} Sha256;
+
+static const unsigned int k256[64] = {
+    0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+    0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+    0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+    0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+    0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+    0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+    0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+    0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
+};
+
+#define ROR(x,n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void shaBlock(Sha256 * s)
+{
+    unsigned int w[64], a, b, c, d, e, f, g, h, t1, t2;
+    int i;
+    for (i = 0; i < 16; i++)
+        w[i] = (unsigned int) s->block[4*i] << 24 | (unsigned int) s->block[4*i+1] << 16 |
+               (unsigned int) s->block[4*i+2] << 8 | s->block[4*i+3];
+    for (i = 16; i < 64; i++)
+        w[i] = w[i-16] + (ROR(w[i-15],7) ^ ROR(w[i-15],18) ^ (w[i-15] >> 3)) +
+               w[i-7] + (ROR(w[i-2],17) ^ ROR(w[i-2],19) ^ (w[i-2] >> 10));
+    a = s->h[0]; b = s->h[1]; c = s->h[2]; d = s->h[3];
+    e = s->h[4]; f = s->h[5]; g = s->h[6]; h = s->h[7];
+    for (i = 0; i < 64; i++) {
+        t1 = h + (ROR(e,6) ^ ROR(e,11) ^ ROR(e,25)) + ((e & f) ^ (~e & g)) + k256[i] + w[i];
+        t2 = (ROR(a,2) ^ ROR(a,13) ^ ROR(a,22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    s->h[0] += a; s->h[1] += b; s->h[2] += c; s->h[3] += d;
+    s->h[4] += e; s->h[5] += f; s->h[6] += g; s->h[7] += h;
+}
+
+static void shaInit(Sha256 * s)
+{
+    static const unsigned int h0[8] = {
+        0x6a09e667,0xbb67ae85,0x3c6ef372,0xa54ff53a,0x510e527f,0x9b05688c,0x1f83d9ab,0x5be0cd19
+    };
+    memcpy(s->h,h0,sizeof(h0));
+    s->length = 0;
+    s->used = 0;
+}
+
+static void shaUpdate(Sha256 * s, const void * data, size_t n)
+{
+    const unsigned char * p = (const unsigned char *) data;
+    s->length += n;
+    while (n > 0) {
+        size_t take = 64 - s->used < n ? 64 - s->used : n;
+        memcpy(s->block + s->used,p,take);
+        s->used += take;
+        p += take;
+        n -= take;
+        if (s->used == 64) {
+            shaBlock(s);
+            s->used = 0;
+        }
+    }
+}
+
+/* Procedure shaFinal stores the digest as hex in key */
+static void shaFinal(Sha256 * s, char * key)
+{
+    unsigned long long bits = s->length * 8;
+    unsigned char pad = 0x80, len[8];
+    int i;
+    shaUpdate(s,&pad,1);
+    pad = 0;
+    while (s->used != 56)
+        shaUpdate(s,&pad,1);
+    for (i = 0; i < 8; i++)
+        len[i] = (unsigned char) (bits >> (56 - 8*i));
+    shaUpdate(s,len,8);
+    for (i = 0; i < 32; i++)
+        sprintf(key + 2*i,"%02x",(s->h[i/4] >> (24 - 8*(i%4))) & 0xff);
+}
+
+/**************************************************/
+/***************   cache entries   ****************/
+/**************************************************/
+
+/* Function readAll reads the whole file name into a
+ * malloc'ed buffer; returns NULL if it cannot be read
+ */
+static char * readAll(const char * name, size_t * len)
+{
+    FILE * f = fopen(name,"rb");
+    char * text = NULL;
+    size_t size = 0, n = 0;
+    if (f == NULL)
+        return NULL;
+    for (;;) {
+        if (n == size) {
+            char * bigger = (char *) realloc(text,size = size ? 2 * size : 65536);
+            if (bigger == NULL) {
+                free(text);
+                fclose(f);
+                return NULL;
+            }
+            text = bigger;
+        }
+        n += fread(text + n,1,size - n,f);
+        if (n < size)
+            break;
+    }
+    if (ferror(f)) {
+        free(text);
+        text = NULL;
+    }
+    fclose(f);
+    *len = n;
+    return text;
+}
+
+static int writeAll(const char * name, const char * header, const char * text, size_t len)
+{
+    FILE * f = fopen(name,"wb");
+    int ok;
+    if (f == NULL)
+        return FALSE;
+    ok = (header == NULL || fputs(header,f) >= 0) && fwrite(text,1,len,f) == len;
+    return fclose(f) == 0 && ok;
+}
+
+static void entryPath(char * path, const char * key)
+{
+    snprintf(path,FILENAME_MAX,"%s/%s",CacheDir,key);
+}
+
+int cacheLookup(const char * pgm, Phase phase, const char * listingName,
+                const char * codeName, char * key, CompileStatus * status)
+{
+    static char compiler[64] = "";
+    char config[256], path[FILENAME_MAX], header[FILENAME_MAX + 64];
+    size_t len;
+    char * text = readAll(pgm,&len);
+    unsigned long listinglen, codelen;
+    int stored, hit = FALSE;
+    Sha256 sha;
+    key[0] = '\0';
+    if (text == NULL)
+        return FALSE;
+    /* the compiler is identified like ccache does by
+     * default, by the size and time of its binary */
+    if (compiler[0] == '\0') {
+        struct stat st;
+        if (stat("/proc/self/exe",&st) == 0)
+            snprintf(compiler,sizeof(compiler),"%lld:%lld",
+                     (long long) st.st_size,(long long) st.st_mtime);
+        else
+            strcpy(compiler,"unknown");
+    }
+    snprintf(config,sizeof(config),"hw2 %s phase=%d listing=%d echo=%d scan=%d parse=%d analyze=%d code=%d prune=%d consteval=%d target=%d",
+             compiler,(int) phase,listingName != NULL,EchoSource,TraceScan,TraceParse,TraceAnalyze,TraceCode,
+             PruneUnreachable,EvalConstCalls,(int) CodeTarget);
+    shaInit(&sha);
+    shaUpdate(&sha,config,strlen(config) + 1);
+    /* C code names its source in #line directives */
+    if (phase >= CodePhase && CodeTarget == CTarget)
+        shaUpdate(&sha,pgm,strlen(pgm) + 1);
+    shaUpdate(&sha,text,len);
+    shaFinal(&sha,key);
+    free(text);
+    entryPath(path,key);
+    text = readAll(path,&len);
+    if (text == NULL)
+        return FALSE;
+    if (sscanf(text,"HW2CACHE %d %lu %lu\n",&stored,&listinglen,&codelen) == 3) {
+        char * body = memchr(text,'\n',len);
+        if (body != NULL && (size_t) (++body - text) + listinglen + codelen == len) {
+            snprintf(header,sizeof(header),LISTINGHEADER,pgm);
+            hit = (listingName == NULL || writeAll(listingName,header,body,listinglen)) &&
+                  (codelen == 0 || codeName == NULL ||
+                   writeAll(codeName,NULL,body + listinglen,codelen));
+            *status = (CompileStatus) stored;
+        }
+    }
+    free(text);
+    if (hit)
+        utime(path,NULL); /* most recently used */
+    return hit;
+}
+
+static unsigned long long storedBytes = 0; /* since the last trim */
+static unsigned long tmpCounter = 0;
+static pthread_mutex_t trimLock = PTHREAD_MUTEX_INITIALIZER;
+
+void cacheStore(const char * key, const char * pgm, const char * listingName,
+                const char * codeName, CompileStatus status)
+{
+    char path[FILENAME_MAX], tmp[FILENAME_MAX], header[FILENAME_MAX + 64], entry[96];
+    char * listingText, * codeText = NULL;
+    size_t listinglen, codelen = 0, skip;
+    FILE * f;
+    int ok;
+    if (key[0] == '\0' || (status != CompileOk && status != CompileError))
+        return;
+    snprintf(header,sizeof(header),LISTINGHEADER,pgm);
+    skip = strlen(header);
+    if (listingName == NULL) {
+        /* only the status is kept when there is no listing */
+        listingText = strdup(header);
+        listinglen = skip;
+    }
+    else
+        listingText = readAll(listingName,&listinglen);
+    if (listingText == NULL)
+        return;
+    if (codeName != NULL && (codeText = readAll(codeName,&codelen)) == NULL)
+        codelen = 0;
+    if (listinglen < skip || memcmp(listingText,header,skip) != 0) {
+        free(listingText);
+        free(codeText);
+        return;
+    }
+    snprintf(entry,sizeof(entry),"HW2CACHE %d %lu %lu\n",(int) status,
+             (unsigned long) (listinglen - skip),(unsigned long) codelen);
+    /* written under a unique temporary name and renamed,
+     * so readers never see a partial entry */
+    snprintf(tmp,sizeof(tmp),"%s/tmp.%ld.%lu",CacheDir,(long) getpid(),
+             __atomic_fetch_add(&tmpCounter,1,__ATOMIC_RELAXED));
+    entryPath(path,key);
+    f = fopen(tmp,"wb");
+    if (f == NULL) {
+        free(listingText);
+        free(codeText);
+        return;
+    }
+    ok = fputs(entry,f) >= 0 &&
+         fwrite(listingText + skip,1,listinglen - skip,f) == listinglen - skip &&
+         (codelen == 0 || fwrite(codeText,1,codelen,f) == codelen);
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp,path) != 0)
+        unlink(tmp);
+    free(listingText);
+    free(codeText);
+    if (ok && __atomic_add_fetch(&storedBytes,listinglen + codelen,__ATOMIC_RELAXED) > CacheLimit / 10)
+        cacheTrim();
+}
+
+typedef struct
+{
+    time_t used;
+    unsigned long long size;
+    char * name;
+} Entry;
+
+static int compareEntries(const void * a, const void * b)
+{
+    const Entry * x = (const Entry *) a, * y = (const Entry *) b;
+    return x->used < y->used ? -1 : x->used > y->used;
+}
+
+void cacheTrim(void)
+{
+    char path[FILENAME_MAX];
+    DIR * dir;
+    struct dirent * d;
+    Entry * entries = NULL;
+    int n = 0, max = 0, i;
+    unsigned long long total = 0;
+    time_t now = time(NULL);
+    if (CacheDir == NULL || pthread_mutex_trylock(&trimLock) != 0)
+        return; /* another thread is trimming */
+    __atomic_store_n(&storedBytes,0,__ATOMIC_RELAXED);
+    dir = opendir(CacheDir);
+    if (dir == NULL) {
+        pthread_mutex_unlock(&trimLock);
+        return;
+    }
+    while ((d = readdir(dir)) != NULL) {
+        struct stat st;
+        if (d->d_name[0] == '.')
+            continue;
+        snprintf(path,sizeof(path),"%s/%s",CacheDir,d->d_name);
+        if (stat(path,&st) != 0 || !S_ISREG(st.st_mode))
+            continue;
+        if (strncmp(d->d_name,"tmp.",4) == 0) {
+            if (now - st.st_mtime > STALETMP)
+                unlink(path); /* left by a crashed writer */
+            continue;
+        }
+        if (n == max) {
+            Entry * more = (Entry *) realloc(entries,(max = max ? 2 * max : 256) * sizeof(Entry));
+            if (more == NULL)
+                break;
+            entries = more;
+        }
+        entries[n].used = st.st_mtime;
+        entries[n].size = st.st_size;
+        entries[n].name = strdup(d->d_name);
+        total += st.st_size;
+        n++;
+    }
+    closedir(dir);
+    if (total > CacheLimit) {
+        /* evict down to 90% so that trims stay rare */
+        qsort(entries,n,sizeof(Entry),compareEntries);
+        for (i = 0; i < n && total > CacheLimit / 10 * 9; i++) {
+            snprintf(path,sizeof(path),"%s/%s",CacheDir,entries[i].name);
+            if (unlink(path) == 0)
+                total -= entries[i].size;
+        }
+    }
+    for (i = 0; i < n; i++)
+        free(entries[i].name);
+    free(entries);
+    pthread_mutex_unlock(&trimLock);
+}
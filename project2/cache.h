@@ -0,0 +1,45 @@
+/****************************************************/
+/* File: cache.h                                    */
+/* Content-hash compile cache                       */
+/****************************************************/
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+#include "compile.h"
+
+/* CacheDir names the cache directory (-fcache-dir),
+ * NULL when caching is off; CacheLimit bounds its
+ * size in bytes (-fcache-size)
+ */
+extern const char * CacheDir;
+extern unsigned long long CacheLimit;
+
+/* KEYLEN is the length of a cache key in hex digits */
+#define KEYLEN 64
+
+/* Function cacheLookup hashes the source file pgm
+ * together with the compiler binary, phase and trace
+ * flags into key (KEYLEN+1 bytes). If the cache holds that
+ * key it writes the stored listing to the file listingName,
+ * unless NULL (and the stored code, if any, to codeName), sets
+ * *status and returns TRUE. Otherwise returns FALSE;
+ * key is left empty if pgm could not be read
+ */
+int cacheLookup(const char * pgm, Phase phase, const char * listingName,
+                const char * codeName, char * key, CompileStatus * status);
+
+/* Procedure cacheStore saves the listing just written
+ * to listingName (and code from codeName, unless NULL)
+ * under key, or only the status if listingName is NULL;
+ * the entry appears atomically
+ */
+void cacheStore(const char * key, const char * pgm, const char * listingName,
+                const char * codeName, CompileStatus status);
+
+/* Procedure cacheTrim evicts the least recently used
+ * entries until the cache fits in CacheLimit
+ */
+void cacheTrim(void);
+
+#endif
@@ -0,0 +1,423 @@
+/****************************************************/
+/* File: cgen.c                                     */
+/* The code generator implementation                */
+/* for the C- compiler                              */
+/* (generates code for the TM machine)              */
+/* Compiler Construction: Principles and Practice   */
+/* Kenneth C. Louden                                */
+/* Activation records grow down from the top of     */
+/* memory and globals up from its bottom. Below fp  */
+/* lie the caller's fp, the return address, then    */
+/* the parameters and locals by memory location and */
+/* the temporaries; sizes are known at compile time */
+/* so fp is the only stack register                 */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "code.h"
+#include "cgen.h"
+#include "vgen.h"
+#include "xgen.h"
+#include "ctrans.h"
+
+Target CodeTarget = TmTarget;
+THREADLOCAL const char * CodeSource = NULL;
+
+static const char * targetNames[] = {"tm","vm","x86","c"};
+static const char * targetSuffixes[] = {".tm",".vm",".s",".c"};
+
+int targetNamed(const char * name)
+{
+    int t;
+    for (t = TmTarget; t <= CTarget; t++)
+        if (strcmp(name,targetNames[t]) == 0) {
+            CodeTarget = (Target) t;
+            return TRUE;
+        }
+    return FALSE;
+}
+
+const char * codeSuffix(void)
+{
+    return targetSuffixes[CodeTarget];
+}
+
+/* words at the top of a frame: the caller's fp and
+ * the return address */
+#define FRAMEHEAD 2
+
+/* tmpOffset is the memory offset from fp of the next
+ * temporary; each function starts it below its locals,
+ * and a call builds the frame of the callee there
+ */
+static THREADLOCAL int tmpOffset = 0;
+
+/* prototypes for internal recursive functions */
+static void cGen(TreeNode * tree);
+static void genExp(TreeNode * tree);
+
+/* Function localOffset returns the offset from fp of
+ * the lowest word of the parameter or local s, where
+ * element 0 of an array is
+ */
+static int localOffset(Symbol * s)
+{
+    return -(FRAMEHEAD - 1 + s->memloc + s->size);
+}
+
+/* Procedure genScalar emits op (LD or ST) between reg
+ * and the int variable or parameter s
+ */
+static void genScalar(const char * op, int reg, Symbol * s)
+{
+    if (s->depth == 0)
+        emitRM(op,reg,s->memloc,gp,"global variable");
+    else
+        emitRM(op,reg,localOffset(s),fp,"local variable");
+}
+
+/* Procedure genBase leaves in reg the address of
+ * element 0 of the array or array parameter s
+ */
+static void genBase(Symbol * s, int reg)
+{
+    if (s->depth == 0)
+        emitRM("LDA",reg,s->memloc,gp,"global array");
+    else if (s->kind == ArrParamSym)
+        emitRM("LD",reg,localOffset(s),fp,"array parameter");
+    else
+        emitRM("LDA",reg,localOffset(s),fp,"local array");
+}
+
+/* Procedure genElement leaves in ac the address of the
+ * array element t refers to
+ */
+static void genElement(TreeNode * t)
+{
+    genExp(t->child[0]);
+    genBase(t->symbol,ac1);
+    emitRO("ADD",ac,ac1,ac,"element address");
+}
+
+/* Function isLeaf tells whether t loads into ac with a
+ * single instruction that needs no other register
+ */
+static int isLeaf(TreeNode * t)
+{
+    return t->nodekind == ExpK &&
+           (t->kind.exp == NumK ||
+            (t->kind.exp == IdK && (t->symbol->kind == VarSym || t->symbol->kind == ParamSym)));
+}
+
+/* Procedure genRight moves the left operand from ac to
+ * ac1 and evaluates the right operand t into ac,
+ * keeping the left one in a temporary while t needs
+ * the registers
+ */
+static void genRight(TreeNode * t)
+{
+    if (isLeaf(t)) {
+        emitRM("LDA",ac1,0,ac,"move left operand");
+        genExp(t);
+    }
+    else {
+        emitRM("ST",ac,tmpOffset--,fp,"op: push left");
+        genExp(t);
+        emitRM("LD",ac1,++tmpOffset,fp,"op: load left");
+    }
+}
+
+/* Procedure genReturn emits the return to the caller,
+ * whose value if any is in ac
+ */
+static void genReturn(void)
+{
+    emitRM("LD",ac1,-1,fp,"load return address");
+    emitRM("LD",fp,0,fp,"pop frame");
+    emitRM("LDA",pc,0,ac1,"return");
+}
+
+/* Procedure genCall emits the call t, leaving the value
+ * returned in ac. The runtime's input and output are
+ * single instructions
+ */
+static void genCall(TreeNode * t)
+{
+    Symbol * s = t->symbol;
+    TreeNode * arg;
+    int frame = tmpOffset;
+    if (s->decl->child[2] == NULL) {
+        if (t->child[0] == NULL)
+            emitRO("IN",ac,0,0,"input integer value");
+        else {
+            genExp(t->child[0]);
+            emitRO("OUT",ac,0,0,"output integer value");
+        }
+        return;
+    }
+    /* the arguments go straight to the parameters of
+     * the frame, which starts at the free temporaries */
+    tmpOffset -= FRAMEHEAD;
+    for (arg = t->child[0]; arg != NULL; arg = arg->sibling) {
+        genExp(arg);
+        emitRM("ST",ac,tmpOffset--,fp,"store argument");
+    }
+    emitRM("ST",fp,frame,fp,"call: store old fp");
+    emitRM("LDA",fp,frame,fp,"call: push frame");
+    emitRM("LDA",ac,1,pc,"call: save return address");
+    emitRM_Abs("LDA",pc,s->memloc,"call: jump to function");
+    tmpOffset = frame;
+}
+
+/* Procedure genExp generates code at an expression
+ * node, leaving its value in ac
+ */
+static void genExp(TreeNode * tree)
+{
+    TreeNode * p;
+    const char * op;
+    Symbol * s = tree->symbol;
+    if (tree->nodekind == StmtK) {
+        /* an assignment, whose value is the one assigned */
+        TreeNode * var = tree->child[0];
+        if (var->kind.exp == IdK) {
+            genExp(tree->child[1]);
+            genScalar("ST",ac,var->symbol);
+        }
+        else {
+            genElement(var);
+            emitRM("ST",ac,tmpOffset--,fp,"assign: push address");
+            genExp(tree->child[1]);
+            emitRM("LD",ac1,++tmpOffset,fp,"assign: load address");
+            emitRM("ST",ac,0,ac1,"assign: store value");
+        }
+        return;
+    }
+    switch (tree->kind.exp) {
+        case NumK:
+            emitRM("LDC",ac,tree->attr.val,0,"load const");
+            break;
+        case IdK:
+            /* an array passes its address */
+            if (s->kind == VarSym || s->kind == ParamSym)
+                genScalar("LD",ac,s);
+            else
+                genBase(s,ac);
+            break;
+        case ArrK:
+            genElement(tree);
+            emitRM("LD",ac,0,ac,"load element");
+            break;
+        case FunCallK:
+            genCall(tree);
+            break;
+        case addK:
+        case mulK:
+            /* operand, operator, operand... */
+            genExp(tree->child[0]);
+            for (p = tree->child[0]->sibling; p != NULL && p->sibling != NULL; p = p->sibling->sibling) {
+                genRight(p->sibling);
+                switch (p->attr.op) {
+                    case PLUS: op = "ADD"; break;
+                    case MINUS: op = "SUB"; break;
+                    case TIMES: op = "MUL"; break;
+                    default: op = "DIV"; break;
+                }
+                emitRO(op,ac,ac1,ac,"op");
+            }
+            break;
+        case simpleK:
+            genExp(tree->child[0]);
+            genRight(tree->child[2]);
+            emitRO("SUB",ac,ac1,ac,"op: compare");
+            switch (tree->child[1]->attr.op) {
+                case LT: op = "JLT"; break;
+                case LE: op = "JLE"; break;
+                case GT: op = "JGT"; break;
+                case GE: op = "JGE"; break;
+                case EQ: op = "JEQ"; break;
+                default: op = "JNE"; break;
+            }
+            emitRM(op,ac,2,pc,"br if true");
+            emitRM("LDC",ac,0,ac,"false case");
+            emitRM("LDA",pc,1,pc,"unconditional jmp");
+            emitRM("LDC",ac,1,ac,"true case");
+            break;
+        default:
+            break;
+    }
+}
+
+/* Procedure genStmt generates code at a statement node */
+static void genStmt(TreeNode * tree)
+{
+    int savedLoc1, savedLoc2, currentLoc;
+    switch (tree->kind.stmt) {
+        case CompoundK:
+            cGen(tree->child[1]);
+            break;
+        case IfK:
+            emitComment("-> if");
+            genExp(tree->child[0]);
+            savedLoc1 = emitSkip(1);
+            cGen(tree->child[1]);
+            if (tree->child[2] != NULL) {
+                savedLoc2 = emitSkip(1);
+                currentLoc = emitSkip(0);
+                emitBackup(savedLoc1);
+                emitRM_Abs("JEQ",ac,currentLoc,"if: jmp to else");
+                emitRestore();
+                cGen(tree->child[2]);
+                currentLoc = emitSkip(0);
+                emitBackup(savedLoc2);
+                emitRM_Abs("LDA",pc,currentLoc,"jmp to end");
+                emitRestore();
+            }
+            else {
+                currentLoc = emitSkip(0);
+                emitBackup(savedLoc1);
+                emitRM_Abs("JEQ",ac,currentLoc,"if: jmp to end");
+                emitRestore();
+            }
+            emitComment("<- if");
+            break;
+        case WhileK:
+            emitComment("-> while");
+            savedLoc1 = emitSkip(0);
+            genExp(tree->child[0]);
+            savedLoc2 = emitSkip(1);
+            cGen(tree->child[1]);
+            emitRM_Abs("LDA",pc,savedLoc1,"while: jmp back to test");
+            currentLoc = emitSkip(0);
+            emitBackup(savedLoc2);
+            emitRM_Abs("JEQ",ac,currentLoc,"while: jmp to end");
+            emitRestore();
+            emitComment("<- while");
+            break;
+        case ReturnK:
+            if (tree->child[0] != NULL)
+                genExp(tree->child[0]);
+            genReturn();
+            break;
+        default:
+            genExp(tree);
+            break;
+    }
+}
+
+/* Procedure cGen generates code for the statement
+ * list tree
+ */
+static void cGen(TreeNode * tree)
+{
+    for (; tree != NULL; tree = tree->sibling) {
+        if (tree->nodekind == StmtK)
+            genStmt(tree);
+        else
+            genExp(tree);
+    }
+}
+
+int frameWords(TreeNode * tree)
+{
+    int words = 0;
+    for (; tree != NULL; tree = tree->sibling) {
+        int n = 0, i;
+        if (tree->nodekind == DeclK)
+            n = tree->symbol->memloc + tree->symbol->size;
+        else if (tree->nodekind == StmtK && tree->kind.stmt != AssignK)
+            for (i = 0; i < MAXCHILDREN; i++) {
+                int c = frameWords(tree->child[i]);
+                if (c > n)
+                    n = c;
+            }
+        if (n > words)
+            words = n;
+    }
+    return words;
+}
+
+/* Procedure genFunction generates code for the
+ * function declaration tree, recording its location in
+ * its symbol
+ */
+static void genFunction(TreeNode * tree)
+{
+    Symbol * s = tree->symbol;
+    int params = frameWords(tree->child[1]), locals = frameWords(tree->child[2]);
+    char * comment = NULL;
+    if (TraceCode) {
+        comment = (char *) allocate(strlen(tree->attr.name) + 16);
+        if (comment != NULL)
+            sprintf(comment,"function %s",tree->attr.name);
+    }
+    if (comment != NULL)
+        emitComment(comment);
+    s->memloc = emitSkip(0);
+    emitRM("ST",ac,-1,fp,"store return address");
+    tmpOffset = -(FRAMEHEAD + (params > locals ? params : locals));
+    cGen(tree->child[2]);
+    /* a function may end without return */
+    genReturn();
+}
+
+/**********************************************/
+/* the primary function of the code generator */
+/**********************************************/
+/* Procedure codeGen generates code to a code
+ * file by traversal of the syntax tree. The
+ * second parameter (codefile) is the file name
+ * of the code file, and is used to print the
+ * file name as a comment in the code file
+ */
+void codeGen(TreeNode * syntaxTree, char * codefile)
+{
+    TreeNode * t, * last = NULL;
+    int callMain;
+    char * s = NULL;
+    if (CodeTarget == VmTarget) {
+        vmGen(syntaxTree,codefile);
+        return;
+    }
+    if (CodeTarget == X86Target) {
+        x86Gen(syntaxTree,codefile);
+        return;
+    }
+    if (CodeTarget == CTarget) {
+        cTranslate(syntaxTree,codefile);
+        return;
+    }
+    if (TraceCode) {
+        s = (char *) allocate(strlen(codefile) + 7);
+        if (s != NULL)
+            sprintf(s,"File: %s",codefile);
+    }
+    emitBegin();
+    emitComment("C- Compilation to TM Code");
+    if (s != NULL)
+        emitComment(s);
+    /* generate standard prelude */
+    emitComment("Standard prelude:");
+    emitRM("LD",fp,0,ac,"load maxaddress from location 0");
+    emitRM("ST",ac,0,ac,"clear location 0");
+    emitRM("LDC",gp,0,0,"globals from location 0");
+    emitRM("LDA",ac,1,pc,"save return address");
+    callMain = emitSkip(1);
+    emitRO("HALT",0,0,0,"");
+    emitComment("End of standard prelude.");
+    /* generate code for C- program; main comes last */
+    for (t = syntaxTree; t != NULL; t = t->sibling)
+        if (t->kind.decl == FunK) {
+            genFunction(t);
+            last = t;
+        }
+    emitBackup(callMain);
+    emitRM_Abs("LDA",pc,last->symbol->memloc,"jump to main");
+    emitRestore();
+    /* finish */
+    emitComment("End of execution.");
+    if (!emitFlush(code))
+        fprintf(stderr,"Unable to write code file %s\n",codefile);
+}
@@ -0,0 +1,48 @@
+/****************************************************/
+/* File: cgen.h                                     */
+/* The code generator interface to the C- compiler  */
+/* Compiler Construction: Principles and Practice   */
+/* Kenneth C. Louden                                */
+/****************************************************/
+
+#ifndef _CGEN_H_
+#define _CGEN_H_
+
+/* the machine codeGen writes code for (-ftarget=):
+ * the TM, the register bytecode VM of bytecode.h,
+ * x86-64 Linux as GNU assembler source to link with
+ * runtime.c, or C for the host compiler
+ */
+typedef enum {TmTarget, VmTarget, X86Target, CTarget} Target;
+extern Target CodeTarget;
+
+/* CodeSource is the source file codeGen translates,
+ * named by the #line directives of the C target
+ */
+extern THREADLOCAL const char * CodeSource;
+
+/* Function targetNamed sets CodeTarget to the target
+ * called name; returns FALSE if there is none
+ */
+int targetNamed(const char * name);
+
+/* Function codeSuffix returns the extension of the code
+ * files for CodeTarget, as in ".tm"
+ */
+const char * codeSuffix(void);
+
+/* Function frameWords returns the words the parameters
+ * and locals of the declarations and statements of the
+ * list tree take
+ */
+int frameWords(TreeNode * tree);
+
+/* Procedure codeGen generates code to a code
+ * file by traversal of the syntax tree. The
+ * second parameter (codefile) is the file name
+ * of the code file, and is used to print the
+ * file name as a comment in the code file
+ */
+void codeGen(TreeNode * syntaxTree, char * codefile);
+
+#endif
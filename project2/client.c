@@ -0,0 +1,220 @@
+/****************************************************/
+/* File: client.c                                   */
+/* Command line client of the compile server        */
+/* Also measures request latency against spawning   */
+/* a fresh compiler process per file                */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "protocol.h"
+
+static const char * socketPath = DEFAULTSOCKET;
+static const char * phase = "parse";
+static const char * traces = "parse";
+static int sendSource = 0; /* send file contents instead of paths */
+
+static void usage(const char * prog)
+{
+    fprintf(stderr,"usage: %s [-S socket] [-p scan|parse|analyze] [-t traces] [-b] <filename>...\n",prog);
+    fprintf(stderr,"       %s [-S socket] [-p scan|parse|analyze] [-t traces] [-b] --bench <n> <hw2_binary> <filename>\n",prog);
+    exit(1);
+}
+
+static int connectServer(void)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX,SOCK_STREAM,0);
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path,socketPath,sizeof(addr.sun_path)-1);
+    if (fd < 0 || connect(fd,(struct sockaddr *) &addr,sizeof(addr)) < 0) {
+        fprintf(stderr,"Unable to connect to %s\n",socketPath);
+        exit(1);
+    }
+    return fd;
+}
+
+/* Function readSource reads the whole file name;
+ * returns NULL if it cannot be read
+ */
+static char * readSource(const char * name, size_t * len)
+{
+    FILE * f = fopen(name,"rb");
+    char * text;
+    long n;
+    if (f == NULL)
+        return NULL;
+    fseek(f,0,SEEK_END);
+    n = ftell(f);
+    rewind(f);
+    text = (char *) malloc(n + 1);
+    if (text == NULL || fread(text,1,n,f) != (size_t) n) {
+        free(text);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *len = n;
+    return text;
+}
+
+/* Function request sends one compile request for the
+ * file name (and its text when sendSource is set) and
+ * returns the listing, or NULL if the server failed
+ */
+static char * request(int fd, const char * name, const char * text, size_t len,
+                      int * status, size_t * listinglen)
+{
+    char header[MAXHEADER];
+    char path[PATH_MAX];
+    unsigned long n;
+    char * listing;
+    int hlen;
+    if (text == NULL) {
+        if (realpath(name,path) == NULL)
+            strncpy(path,name,PATH_MAX-1), path[PATH_MAX-1] = '\0';
+        name = path;
+        hlen = snprintf(header,MAXHEADER,"PATH %s %s %lu\n",phase,traces,(unsigned long) strlen(name));
+    }
+    else
+        hlen = snprintf(header,MAXHEADER,"SOURCE %s %s %lu %lu\n",phase,traces,
+                        (unsigned long) strlen(name),(unsigned long) len);
+    if (!writeFull(fd,header,hlen) || !writeFull(fd,name,strlen(name)) ||
+        (text != NULL && !writeFull(fd,text,len)) ||
+        !readHeader(fd,header) || sscanf(header,"%d %lu",status,&n) != 2)
+        return NULL;
+    listing = (char *) malloc(n + 1);
+    if (listing == NULL || !readFull(fd,listing,n)) {
+        free(listing);
+        return NULL;
+    }
+    listing[n] = '\0';
+    *listinglen = n;
+    return listing;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compareTimes(const void * a, const void * b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(const char * what, double * times, int n)
+{
+    double sum = 0;
+    int i;
+    for (i = 0; i < n; i++)
+        sum += times[i];
+    qsort(times,n,sizeof(double),compareTimes);
+    printf("%-8s %d runs  mean %8.3f ms  median %8.3f ms  min %8.3f ms\n",
+           what,n,1e3 * sum / n,1e3 * times[n/2],1e3 * times[0]);
+}
+
+/* Procedure bench compiles name n times through the
+ * server and n times by spawning compiler, and reports
+ * the latency of both
+ */
+static void bench(int n, const char * compiler, const char * name)
+{
+    double * server = (double *) malloc(n * sizeof(double));
+    double * spawn = (double *) malloc(n * sizeof(double));
+    char * text = NULL;
+    size_t len = 0;
+    int i, fd = connectServer();
+    if (sendSource && (text = readSource(name,&len)) == NULL) {
+        fprintf(stderr,"File %s not found\n",name);
+        exit(1);
+    }
+    for (i = 0; i < n; i++) {
+        size_t listinglen;
+        int status;
+        double start = now();
+        char * listing = request(fd,name,text,len,&status,&listinglen);
+        server[i] = now() - start;
+        if (listing == NULL) {
+            fprintf(stderr,"Server failed\n");
+            exit(1);
+        }
+        free(listing);
+    }
+    close(fd);
+    for (i = 0; i < n; i++) {
+        double start = now();
+        pid_t pid = fork();
+        if (pid == 0) {
+            execl(compiler,compiler,name,(char *) NULL);
+            _exit(127);
+        }
+        if (pid < 0 || waitpid(pid,NULL,0) < 0) {
+            fprintf(stderr,"Unable to run %s\n",compiler);
+            exit(1);
+        }
+        spawn[i] = now() - start;
+    }
+    report("server",server,n);
+    report("spawn",spawn,n);
+    free(text);
+    free(server);
+    free(spawn);
+}
+
+int main(int argc, char * argv[])
+{
+    int i, fd, failed = 0;
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i],"-S") == 0 && i+1 < argc) socketPath = argv[++i];
+        else if (strcmp(argv[i],"-p") == 0 && i+1 < argc) phase = argv[++i];
+        else if (strcmp(argv[i],"-t") == 0 && i+1 < argc) traces = argv[++i];
+        else if (strcmp(argv[i],"-b") == 0) sendSource = 1;
+        else if (strcmp(argv[i],"--bench") == 0 && i+3 < argc) {
+            int n = atoi(argv[i+1]);
+            if (n <= 0)
+                usage(argv[0]);
+            bench(n,argv[i+2],argv[i+3]);
+            return 0;
+        }
+        else usage(argv[0]);
+    }
+    if (i == argc)
+        usage(argv[0]);
+    fd = connectServer();
+    for (; i < argc; i++) {
+        char * text = NULL, * listing;
+        size_t len = 0, listinglen;
+        int status;
+        if (sendSource && (text = readSource(argv[i],&len)) == NULL) {
+            fprintf(stderr,"File %s not found\n",argv[i]);
+            failed = 1;
+            continue;
+        }
+        listing = request(fd,argv[i],text,len,&status,&listinglen);
+        if (listing == NULL) {
+            fprintf(stderr,"Server failed on %s\n",argv[i]);
+            exit(1);
+        }
+        fwrite(listing,1,listinglen,stdout);
+        if (status >= 2) {
+            fprintf(stderr,"Unable to compile %s\n",argv[i]);
+            failed = 1;
+        }
+        free(listing);
+        free(text);
+    }
+    close(fd);
+    return failed;
+}
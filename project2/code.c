@@ -0,0 +1,245 @@
+/****************************************************/
+/* File: code.c                                     */
+/* TM Code emitting utilities                       */
+/* implementation for the C- compiler               */
+/* Compiler Construction: Principles and Practice   */
+/* Kenneth C. Louden                                */
+/* Instructions are stored rather than printed, so  */
+/* backpatching rewrites an array entry and the     */
+/* code file is written in one piece                */
+/****************************************************/
+
+#include "globals.h"
+#include "code.h"
+
+typedef struct
+{
+    const char * op;      /* NULL for a skipped location */
+    char registerOnly;
+    char r, s, t;         /* r,s,t or r,d(s) */
+    int d;
+} Instruction;
+
+/* a comment line, printed before the instruction at loc */
+typedef struct
+{
+    int loc;
+    const char * text;
+} Comment;
+
+static THREADLOCAL Instruction * instructions = NULL;
+static THREADLOCAL int maxInstructions = 0;
+
+/* the comments of the instructions, kept if TraceCode */
+static THREADLOCAL const char ** remarks = NULL;
+static THREADLOCAL int maxRemarks = 0;
+
+/* TM location number for current instruction emission */
+static THREADLOCAL int emitLoc = 0;
+
+/* Highest TM location emitted so far
+   For use in conjunction with emitSkip,
+   emitBackup, and emitRestore */
+static THREADLOCAL int highEmitLoc = 0;
+
+static THREADLOCAL Comment * comments = NULL;
+static THREADLOCAL int ncomments = 0, maxComments = 0;
+
+/* the text of the code file, kept for the next program
+ * unless it is large */
+#define KEEPTEXT (1 << 20)
+static THREADLOCAL char * text = NULL;
+static THREADLOCAL size_t textSize = 0;
+
+void emitBegin(void)
+{
+    emitLoc = highEmitLoc = 0;
+    ncomments = 0;
+}
+
+/* Function reserve makes room for the instructions up
+ * to loc, marking the new ones as skipped
+ */
+static void reserve(int loc)
+{
+    int i;
+    if (loc >= maxInstructions) {
+        int old = maxInstructions;
+        while (loc >= maxInstructions)
+            maxInstructions = maxInstructions ? 2 * maxInstructions : 4096;
+        instructions = (Instruction *) realloc(instructions,maxInstructions * sizeof(Instruction));
+        for (i = old; i < maxInstructions; i++)
+            instructions[i].op = NULL;
+    }
+    if (TraceCode && loc >= maxRemarks) {
+        maxRemarks = maxInstructions;
+        remarks = (const char **) realloc(remarks,maxRemarks * sizeof(const char *));
+    }
+}
+
+/* Procedure emit stores an instruction at emitLoc */
+static void emit(const char * op, int registerOnly, int r, int s, int t, int d, const char * c)
+{
+    Instruction * i;
+    reserve(emitLoc);
+    i = &instructions[emitLoc++];
+    i->op = op;
+    i->registerOnly = registerOnly;
+    i->r = r;
+    i->s = s;
+    i->t = t;
+    i->d = d;
+    if (TraceCode)
+        remarks[emitLoc-1] = c;
+    if (highEmitLoc < emitLoc)
+        highEmitLoc = emitLoc;
+}
+
+void emitComment(const char * c)
+{
+    if (!TraceCode)
+        return;
+    if (ncomments == maxComments) {
+        maxComments = maxComments ? 2 * maxComments : 256;
+        comments = (Comment *) realloc(comments,maxComments * sizeof(Comment));
+    }
+    comments[ncomments].loc = emitLoc;
+    comments[ncomments].text = c;
+    ncomments++;
+}
+
+void emitRO(const char * op, int r, int s, int t, const char * c)
+{
+    emit(op,TRUE,r,s,t,0,c);
+}
+
+void emitRM(const char * op, int r, int d, int s, const char * c)
+{
+    emit(op,FALSE,r,s,0,d,c);
+}
+
+int emitSkip(int howMany)
+{
+    int i = emitLoc;
+    emitLoc += howMany;
+    reserve(emitLoc);
+    if (highEmitLoc < emitLoc)
+        highEmitLoc = emitLoc;
+    return i;
+}
+
+void emitBackup(int loc)
+{
+    if (loc > highEmitLoc)
+        emitComment("BUG in emitBackup");
+    emitLoc = loc;
+}
+
+void emitRestore(void)
+{
+    emitLoc = highEmitLoc;
+}
+
+void emitRM_Abs(const char * op, int r, int a, const char * c)
+{
+    emitRM(op,r,a - (emitLoc + 1),pc,c);
+}
+
+/* Function putInt writes n in decimal at p, right
+ * aligned in width columns; returns the end
+ */
+static char * putInt(char * p, int n, int width)
+{
+    char digits[16];
+    unsigned u = n < 0 ? 0u - (unsigned) n : (unsigned) n;
+    int len = 0;
+    do {
+        digits[len++] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+    if (n < 0)
+        digits[len++] = '-';
+    for (; width > len; width--)
+        *p++ = ' ';
+    while (len > 0)
+        *p++ = digits[--len];
+    return p;
+}
+
+/* Function room makes room for n more bytes after the
+ * used bytes of text; returns the end of the text
+ */
+static char * room(size_t used, size_t n)
+{
+    if (used + n > textSize) {
+        while (used + n > textSize)
+            textSize = textSize ? 2 * textSize : 1 << 16;
+        text = (char *) realloc(text,textSize);
+    }
+    return text + used;
+}
+
+int emitFlush(FILE * f)
+{
+    size_t used = 0;
+    int loc, k = 0, ok;
+    for (loc = 0; loc <= highEmitLoc; loc++) {
+        Instruction * i;
+        const char * c, * c2;
+        char * p;
+        size_t oplen;
+        for (; k < ncomments && comments[k].loc == loc; k++) {
+            size_t len = strlen(comments[k].text);
+            p = room(used,len + 3);
+            *p++ = '*';
+            *p++ = ' ';
+            memcpy(p,comments[k].text,len);
+            p[len] = '\n';
+            used += len + 3;
+        }
+        if (loc == highEmitLoc || (i = &instructions[loc])->op == NULL)
+            continue;
+        oplen = strlen(i->op);
+        c = TraceCode ? remarks[loc] : NULL;
+        p = room(used,64 + (c != NULL ? strlen(c) : 0));
+        /* "%3d:  %5s  %d,%d,%d " or "%3d:  %5s  %d,%d(%d) " */
+        p = putInt(p,loc,3);
+        memcpy(p,":  ",3);
+        p += 3;
+        for (; oplen < 5; oplen++)
+            *p++ = ' ';
+        for (c2 = i->op; *c2 != '\0'; c2++)
+            *p++ = *c2;
+        *p++ = ' ';
+        *p++ = ' ';
+        p = putInt(p,i->r,0);
+        *p++ = ',';
+        if (i->registerOnly) {
+            p = putInt(p,i->s,0);
+            *p++ = ',';
+            p = putInt(p,i->t,0);
+        }
+        else {
+            p = putInt(p,i->d,0);
+            *p++ = '(';
+            p = putInt(p,i->s,0);
+            *p++ = ')';
+        }
+        *p++ = ' ';
+        if (c != NULL) {
+            size_t len = strlen(c);
+            *p++ = '\t';
+            memcpy(p,c,len);
+            p += len;
+        }
+        *p++ = '\n';
+        used = p - text;
+    }
+    ok = used == 0 || fwrite(text,1,used,f) == used;
+    if (textSize > KEEPTEXT) {
+        free(text);
+        text = NULL;
+        textSize = 0;
+    }
+    return ok;
+}
@@ -0,0 +1,98 @@
+/****************************************************/
+/* File: code.h                                     */
+/* Code emitting utilities for the C- compiler      */
+/* and interface to the TM machine                  */
+/* Compiler Construction: Principles and Practice   */
+/* Kenneth C. Louden                                */
+/****************************************************/
+
+#ifndef _CODE_H_
+#define _CODE_H_
+
+/* pc = program counter */
+#define  pc 7
+
+/* fp = "frame pointer" points to the activation record
+ * of the running function: the caller's fp, then the
+ * return address, then parameters and locals
+ */
+#define  fp 6
+
+/* gp = "global pointer" points to the bottom of memory
+ * for (global) variable storage; it holds 0
+ */
+#define  gp 5
+
+/* accumulators */
+#define  ac 0
+#define  ac1 1
+
+/* The instructions are kept in memory as they are
+ * emitted, so that emitBackup only moves back in an
+ * array, and are formatted and written at once by
+ * emitFlush. All emitting state belongs to the calling
+ * thread
+ */
+
+/* Procedure emitBegin starts the code of a program */
+void emitBegin(void);
+
+/* Procedure emitComment adds a comment line
+ * with comment c to the code, if TraceCode is set
+ */
+void emitComment(const char * c);
+
+/* Procedure emitRO emits a register-only
+ * TM instruction
+ * op = the opcode
+ * r = target register
+ * s = 1st source register
+ * t = 2nd source register
+ * c = a comment to be printed if TraceCode is TRUE
+ */
+void emitRO(const char * op, int r, int s, int t, const char * c);
+
+/* Procedure emitRM emits a register-to-memory
+ * TM instruction
+ * op = the opcode
+ * r = target register
+ * d = the offset
+ * s = the base register
+ * c = a comment to be printed if TraceCode is TRUE
+ */
+void emitRM(const char * op, int r, int d, int s, const char * c);
+
+/* Function emitSkip skips "howMany" code
+ * locations for later backpatch. It also
+ * returns the current code position
+ */
+int emitSkip(int howMany);
+
+/* Procedure emitBackup backs up to
+ * loc = a previously skipped location
+ */
+void emitBackup(int loc);
+
+/* Procedure emitRestore restores the current
+ * code position to the highest previously
+ * unemitted position
+ */
+void emitRestore(void);
+
+/* Procedure emitRM_Abs converts an absolute reference
+ * to a pc-relative reference when emitting a
+ * register-to-memory TM instruction
+ * op = the opcode
+ * r = target register
+ * a = the absolute location in memory
+ * c = a comment to be printed if TraceCode is TRUE
+ */
+void emitRM_Abs(const char * op, int r, int a, const char * c);
+
+/* Function emitFlush formats the code emitted since
+ * emitBegin into a buffer and writes it to f with a
+ * single fwrite; returns FALSE if the write fails
+ */
+int emitFlush(FILE * f);
+
+#endif
@@ -0,0 +1,94 @@
+/****************************************************/
+/* File: compile.h                                  */
+/* Compilation driver for the C- compiler           */
+/* Single files and batches of files compiled       */
+/* concurrently by a pool of worker threads         */
+/****************************************************/
+
+#ifndef _COMPILE_H_
+#define _COMPILE_H_
+
+/* CompileStatus is the outcome of compiling one file;
+ * CompileError means the listing reports errors in
+ * the source program
+ */
+typedef enum {CompileOk, CompileError, NoSource, NoListing, NoCode} CompileStatus;
+
+/* LISTINGHEADER starts every listing, naming its source */
+#define LISTINGHEADER "\nC MINUS COMPILATION: %s\n"
+
+/* Phase is the last phase a compilation runs */
+typedef enum {ScanPhase, ParsePhase, AnalyzePhase, CodePhase} Phase;
+
+/* LastPhase is the last phase of the compilations of
+ * compileFile (-fstop-after)
+ */
+extern Phase LastPhase;
+
+/* Function phaseNamed sets *phase to the phase called
+ * name (scan, parse, analyze or codegen); returns FALSE
+ * if that phase is not part of this build
+ */
+int phaseNamed(const char * name, Phase * phase);
+
+/* Procedure outputName stores in buf (of FILENAME_MAX
+ * bytes) the source name pgm without its extension,
+ * followed by suffix
+ */
+void outputName(char * buf, const char * pgm, const char * suffix);
+
+/* Function compileSource runs the phases up to phase
+ * over the open source file, writing the listing for pgm
+ * to listing. All state lives in the calling thread, so
+ * several files may be compiled at once on different
+ * threads
+ */
+CompileStatus compileSource(const char * pgm, Phase phase);
+
+/* Function compileFile runs the phases up to LastPhase
+ * over the source file pgm, writing its listing next to
+ * it unless WriteListing is FALSE
+ */
+CompileStatus compileFile(const char * pgm);
+
+/* Procedure reportStatus explains to the user why the
+ * compilation of pgm failed
+ */
+void reportStatus(const char * pgm, CompileStatus status);
+
+/* Function compileFailed tells whether status counts as
+ * a failure of the run: always for files that could not
+ * be compiled, and for errors in the program when there
+ * is no listing to report them
+ */
+int compileFailed(CompileStatus status);
+
+/* Function batchCompile compiles the nfiles source files
+ * on nthreads worker threads (0 = one per processor) and
+ * reports failures in input order, independently of the
+ * scheduling; it returns the number of files that
+ * failed, as told by compileFailed
+ */
+int batchCompile(char ** files, int nfiles, int nthreads);
+
+/* Function compileServer serves compile requests on the
+ * Unix domain socket path until it is killed, keeping
+ * interned names and node blocks warm between requests;
+ * it returns FALSE if the socket cannot be set up
+ */
+int compileServer(const char * path);
+
+/* Function watchDirectory compiles every C- source under
+ * dir, then recompiles each source as soon as it changes,
+ * until it is killed; it returns FALSE if dir cannot be
+ * watched
+ */
+int watchDirectory(const char * dir);
+
+/* Function lspServer serves the Language Server Protocol
+ * on standard input and output until the client exits;
+ * it returns FALSE if the client exits without shutdown
+ */
+int lspServer(void);
+
+#endif
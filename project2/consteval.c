@@ -0,0 +1,428 @@
+/****************************************************/
+/* File: consteval.c                                */
+/* Compile-time evaluation of calls to pure         */
+/* functions                                        */
+/* Purity is assumed and then withdrawn along the   */
+/* call graph from the functions that break it, so  */
+/* recursive functions stay pure; calls are folded  */
+/* innermost first, so their values can serve as    */
+/* the constant arguments of enclosing calls        */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "symtab.h"
+#include "consteval.h"
+
+int EvalConstCalls = FALSE;
+
+/* steps (nodes visited) an evaluation may take, and
+ * all evaluations of a compilation together */
+#define MAXSTEPS 1000000L
+#define MAXBUDGET 20000000L
+
+/* calls an evaluation may nest */
+#define MAXDEPTH 256
+
+/* words of parameters and locals a pure function may
+ * take */
+#define MAXFRAME 65536
+
+typedef struct
+{
+    TreeNode * decl;
+    int pure;
+    int frameSize;     /* words of parameters and locals */
+    int firstCaller;   /* its callers are callers[firstCaller..] */
+    int ncallers;
+} Function;
+
+typedef struct
+{
+    Function * fns;
+    int nfns;
+    int * slots;       /* open hash table of function symbols:
+                        * an index into fns, -1 if empty */
+    unsigned size;
+    int * calls;       /* caller and callee pairs */
+    int ncalls, maxcalls;
+    int * callers;
+    long steps;        /* left to the evaluation */
+    long budget;       /* left to the compilation */
+    int depth;         /* calls being evaluated */
+} Program;
+
+/* the words of a call being evaluated; a local is set
+ * once assigned */
+typedef struct
+{
+    int * words;
+    char * set;
+} Frame;
+
+typedef enum {Next, Returned, Failed} Outcome;
+
+static unsigned hashSymbol(const Symbol * s)
+{
+    unsigned long h = (unsigned long) s;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDUL;
+    h ^= h >> 33;
+    return (unsigned) h;
+}
+
+/* Function findSlot returns the slot of the function
+ * symbol s, or the empty slot where it would go
+ */
+static int * findSlot(Program * p, const Symbol * s)
+{
+    unsigned i = hashSymbol(s) & (p->size - 1);
+    while (p->slots[i] >= 0 && p->fns[p->slots[i]].decl->symbol != s)
+        i = (i + 1) & (p->size - 1);
+    return &p->slots[i];
+}
+
+/* Function functionOf returns the index of the function
+ * s declares, or -1 for the runtime's or a non-function
+ */
+static int functionOf(Program * p, const Symbol * s)
+{
+    if (s == NULL || s->kind != FuncSym)
+        return -1;
+    return *findSlot(p,s);
+}
+
+static void addCall(Program * p, int caller, int callee)
+{
+    if (p->ncalls == p->maxcalls) {
+        p->maxcalls = p->maxcalls ? 2 * p->maxcalls : 256;
+        p->calls = (int *) realloc(p->calls,2 * p->maxcalls * sizeof(int));
+    }
+    p->calls[2*p->ncalls] = caller;
+    p->calls[2*p->ncalls+1] = callee;
+    p->ncalls++;
+}
+
+/* Procedure scanBody records the calls the subtree t of
+ * function f makes and the words its declarations take,
+ * and makes f impure if t refers to a global variable,
+ * an array parameter or the runtime; the rest of an
+ * impure function is of no interest
+ */
+static void scanBody(Program * p, int f, TreeNode * t)
+{
+    Function * fn = &p->fns[f];
+    for (; t != NULL && fn->pure; t = t->sibling) {
+        Symbol * s = t->symbol;
+        int i;
+        if (t->nodekind == DeclK) {
+            if (s == NULL || s->kind == ArrParamSym)
+                fn->pure = FALSE;
+            else if (s->memloc + s->size > fn->frameSize)
+                fn->frameSize = s->memloc + s->size;
+        }
+        else if (t->nodekind == ExpK && t->kind.exp == FunCallK) {
+            int callee = functionOf(p,s);
+            if (callee < 0)
+                fn->pure = FALSE;
+            else
+                addCall(p,f,callee);
+        }
+        else if (t->nodekind == ExpK && (t->kind.exp == IdK || t->kind.exp == ArrK)) {
+            if (s == NULL || s->depth == 0 || s->kind == FuncSym || s->kind == ArrParamSym)
+                fn->pure = FALSE;
+        }
+        for (i = 0; i < MAXCHILDREN; i++)
+            scanBody(p,f,t->child[i]);
+    }
+}
+
+/* Procedure findPure makes impure every function that
+ * calls an impure one, by a walk back along the calls
+ */
+static void findPure(Program * p)
+{
+    int * work = (int *) malloc((p->nfns + 1) * sizeof(int));
+    int nwork = 0, i;
+    p->callers = (int *) malloc((p->ncalls + 1) * sizeof(int));
+    for (i = 0; i < p->nfns; i++)
+        p->fns[i].ncallers = 0;
+    for (i = 0; i < p->ncalls; i++)
+        p->fns[p->calls[2*i+1]].ncallers++;
+    p->fns[0].firstCaller = 0;
+    for (i = 1; i < p->nfns; i++)
+        p->fns[i].firstCaller = p->fns[i-1].firstCaller + p->fns[i-1].ncallers;
+    for (i = 0; i < p->nfns; i++)
+        p->fns[i].ncallers = 0;
+    for (i = 0; i < p->ncalls; i++) {
+        Function * callee = &p->fns[p->calls[2*i+1]];
+        p->callers[callee->firstCaller + callee->ncallers++] = p->calls[2*i];
+    }
+    for (i = 0; i < p->nfns; i++)
+        if (!p->fns[i].pure)
+            work[nwork++] = i;
+    while (nwork > 0) {
+        Function * fn = &p->fns[work[--nwork]];
+        for (i = 0; i < fn->ncallers; i++) {
+            int caller = p->callers[fn->firstCaller + i];
+            if (p->fns[caller].pure) {
+                p->fns[caller].pure = FALSE;
+                work[nwork++] = caller;
+            }
+        }
+    }
+    free(work);
+}
+
+static int evalExp(Program * p, TreeNode * t, Frame * fr, int * v);
+static Outcome exec(Program * p, TreeNode * t, Frame * fr, int * v);
+
+/* Function locate returns the word of the frame fr the
+ * variable t refers to, or -1 if it has none there or
+ * its index is out of bounds
+ */
+static int locate(Program * p, TreeNode * t, Frame * fr)
+{
+    Symbol * s = t->symbol;
+    int i;
+    if (fr == NULL || s == NULL || s->depth == 0 || t->nodekind != ExpK)
+        return -1;
+    if (t->kind.exp == IdK)
+        return s->kind == VarSym || s->kind == ParamSym ? s->memloc : -1;
+    if (t->kind.exp != ArrK || s->kind != ArraySym || t->child[0] == NULL ||
+        !evalExp(p,t->child[0],fr,&i) || i < 0 || i >= s->size)
+        return -1;
+    return s->memloc + i;
+}
+
+/* Function arith applies op to a and b into *v as the
+ * machine would, wrapping around on overflow and
+ * comparing by the sign of the wrapped difference;
+ * returns FALSE for a division the machine would trap on
+ */
+static int arith(TokenType op, int a, int b, int * v)
+{
+    int d = (int) ((unsigned) a - (unsigned) b);
+    switch (op) {
+        case PLUS: *v = (int) ((unsigned) a + (unsigned) b); return TRUE;
+        case MINUS: *v = (int) ((unsigned) a - (unsigned) b); return TRUE;
+        case TIMES: *v = (int) ((unsigned) a * (unsigned) b); return TRUE;
+        case OVER:
+            if (b == 0 || (a == INT_MIN && b == -1))
+                return FALSE;
+            *v = a / b;
+            return TRUE;
+        case LT: *v = d < 0; return TRUE;
+        case LE: *v = d <= 0; return TRUE;
+        case GT: *v = d > 0; return TRUE;
+        case GE: *v = d >= 0; return TRUE;
+        case EQ: *v = d == 0; return TRUE;
+        case NE: *v = d != 0; return TRUE;
+        default: return FALSE;
+    }
+}
+
+/* Function call evaluates the call t of a pure function
+ * with arguments from the frame fr, NULL when they must
+ * be constant, into *v; returns FALSE if it fails
+ */
+static int call(Program * p, TreeNode * t, Frame * fr, int * v)
+{
+    int f = functionOf(p,t->symbol), ok = TRUE;
+    Function * fn;
+    Frame callee;
+    TreeNode * arg, * param;
+    if (f < 0 || !p->fns[f].pure || p->depth == MAXDEPTH)
+        return FALSE;
+    fn = &p->fns[f];
+    callee.words = (int *) malloc((fn->frameSize + 1) * sizeof(int));
+    callee.set = (char *) calloc(fn->frameSize + 1,1);
+    for (arg = t->child[0], param = fn->decl->child[1]; ok && arg != NULL && param != NULL;
+         arg = arg->sibling, param = param->sibling) {
+        ok = evalExp(p,arg,fr,&callee.words[param->symbol->memloc]);
+        callee.set[param->symbol->memloc] = TRUE;
+    }
+    if (ok && arg == NULL && param == NULL) {
+        p->depth++;
+        ok = exec(p,fn->decl->child[2],&callee,v) == Returned;
+        p->depth--;
+    }
+    else
+        ok = FALSE;
+    free(callee.set);
+    free(callee.words);
+    return ok;
+}
+
+/* Function evalExp evaluates the expression t in the
+ * frame fr into *v; returns FALSE if it fails
+ */
+static int evalExp(Program * p, TreeNode * t, Frame * fr, int * v)
+{
+    TreeNode * op;
+    int a, b, loc;
+    if (t == NULL || --p->steps < 0)
+        return FALSE;
+    if (t->nodekind == StmtK && t->kind.stmt == AssignK) {
+        if (!evalExp(p,t->child[1],fr,&a) || (loc = locate(p,t->child[0],fr)) < 0)
+            return FALSE;
+        fr->words[loc] = a;
+        fr->set[loc] = TRUE;
+        *v = a;
+        return TRUE;
+    }
+    if (t->nodekind != ExpK)
+        return FALSE;
+    switch (t->kind.exp) {
+        case NumK:
+            *v = t->attr.val;
+            return TRUE;
+        case IdK:
+        case ArrK:
+            if ((loc = locate(p,t,fr)) < 0 || !fr->set[loc])
+                return FALSE;
+            *v = fr->words[loc];
+            return TRUE;
+        case FunCallK:
+            return call(p,t,fr,v);
+        case simpleK:
+            return t->child[1] != NULL && evalExp(p,t->child[0],fr,&a) &&
+                   evalExp(p,t->child[2],fr,&b) && arith(t->child[1]->attr.op,a,b,v);
+        case addK:
+        case mulK:
+            /* operand, operator, operand... */
+            if (!evalExp(p,t->child[0],fr,v))
+                return FALSE;
+            for (op = t->child[0]->sibling; op != NULL; op = op->sibling->sibling)
+                if (op->sibling == NULL || !evalExp(p,op->sibling,fr,&b) ||
+                    !arith(op->attr.op,*v,b,v))
+                    return FALSE;
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+/* Function exec runs the statement list t in the frame
+ * fr, leaving the value returned in *v
+ */
+static Outcome exec(Program * p, TreeNode * t, Frame * fr, int * v)
+{
+    for (; t != NULL; t = t->sibling) {
+        Outcome o = Next;
+        TreeNode * d;
+        int c;
+        if (--p->steps < 0)
+            return Failed;
+        if (t->nodekind != StmtK || t->kind.stmt == AssignK) {
+            if (!evalExp(p,t,fr,&c))
+                return Failed;
+            continue;
+        }
+        switch (t->kind.stmt) {
+            case CompoundK:
+                /* the words of a block are those of the
+                 * one before it */
+                for (d = t->child[0]; d != NULL; d = d->sibling)
+                    memset(fr->set + d->symbol->memloc,0,d->symbol->size);
+                o = exec(p,t->child[1],fr,v);
+                break;
+            case IfK:
+                if (!evalExp(p,t->child[0],fr,&c))
+                    return Failed;
+                o = exec(p,c ? t->child[1] : t->child[2],fr,v);
+                break;
+            case WhileK:
+                while (o == Next) {
+                    if (!evalExp(p,t->child[0],fr,&c))
+                        return Failed;
+                    if (!c)
+                        break;
+                    o = exec(p,t->child[1],fr,v);
+                }
+                break;
+            case ReturnK:
+                return evalExp(p,t->child[0],fr,v) ? Returned : Failed;
+            default:
+                return Failed;
+        }
+        if (o != Next)
+            return o;
+    }
+    return Next;
+}
+
+/* Procedure fold replaces the calls of the subtree t
+ * that evaluate to constants, innermost first
+ */
+static void fold(Program * p, TreeNode * t, int * folded)
+{
+    for (; t != NULL; t = t->sibling) {
+        int i, v, f;
+        for (i = 0; i < MAXCHILDREN; i++)
+            fold(p,t->child[i],folded);
+        if (t->nodekind != ExpK || t->kind.exp != FunCallK || p->budget <= 0)
+            continue;
+        f = functionOf(p,t->symbol);
+        if (f < 0 || !p->fns[f].pure)
+            continue;
+        p->steps = p->budget < MAXSTEPS ? p->budget : MAXSTEPS;
+        p->budget -= p->steps;
+        p->depth = 0;
+        if (call(p,t,NULL,&v)) {
+            t->kind.exp = NumK;
+            t->attr.val = v;
+            t->child[0] = NULL;
+            t->symbol = NULL;
+            t->type = Integer;
+            (*folded)++;
+        }
+        if (p->steps > 0)
+            p->budget += p->steps;
+    }
+}
+
+int evalConstCalls(TreeNode * syntaxTree)
+{
+    Program p;
+    TreeNode * t;
+    int n = 0, i, pure = 0, folded = 0;
+    for (t = syntaxTree; t != NULL; t = t->sibling)
+        if (t->nodekind == DeclK && t->kind.decl == FunK && t->symbol != NULL)
+            n++;
+    p.fns = (Function *) malloc((n + 1) * sizeof(Function));
+    p.nfns = 0;
+    for (p.size = 16; p.size < 2 * (unsigned) n; p.size *= 2)
+        ;
+    p.slots = (int *) malloc(p.size * sizeof(int));
+    memset(p.slots,-1,p.size * sizeof(int));
+    p.calls = p.callers = NULL;
+    p.ncalls = p.maxcalls = 0;
+    p.budget = MAXBUDGET;
+    for (t = syntaxTree; t != NULL; t = t->sibling)
+        if (t->nodekind == DeclK && t->kind.decl == FunK && t->symbol != NULL) {
+            Function * fn = &p.fns[p.nfns];
+            fn->decl = t;
+            fn->pure = t->symbol->type == Integer && t->child[2] != NULL;
+            fn->frameSize = 0;
+            *findSlot(&p,t->symbol) = p.nfns++;
+        }
+    for (i = 0; i < p.nfns; i++) {
+        scanBody(&p,i,p.fns[i].decl->child[1]);
+        scanBody(&p,i,p.fns[i].decl->child[2]);
+        if (p.fns[i].frameSize > MAXFRAME)
+            p.fns[i].pure = FALSE;
+    }
+    findPure(&p);
+    for (i = 0; i < p.nfns; i++)
+        pure += p.fns[i].pure;
+    if (pure > 0)
+        fold(&p,syntaxTree,&folded);
+    fprintf(listing,"\nEvaluated %d calls at compile time (%d of %d functions pure)\n",
+            folded,pure,n);
+    free(p.callers);
+    free(p.calls);
+    free(p.slots);
+    free(p.fns);
+    return folded;
+}
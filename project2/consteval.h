@@ -0,0 +1,32 @@
+/****************************************************/
+/* File: consteval.h                                */
+/* Compile-time evaluation of calls to pure         */
+/* functions                                        */
+/****************************************************/
+
+#ifndef _CONSTEVAL_H_
+#define _CONSTEVAL_H_
+
+/* EvalConstCalls = TRUE (-fconst-eval) makes the
+ * compilations replace, once the program is analyzed
+ * without error, the calls of pure functions whose
+ * arguments are constant by the values they return
+ */
+extern int EvalConstCalls;
+
+/* Function evalConstCalls finds the pure functions of
+ * the analyzed declaration list syntaxTree: those that
+ * return int, take only int parameters, refer to no
+ * global variable and call only pure functions, so they
+ * neither write globals or array parameters nor do
+ * input or output. Each of their calls with constant
+ * arguments is run by an interpreter over the tree,
+ * within step and recursion limits, and becomes the
+ * number it returns; a call that would divide by zero,
+ * index out of bounds or read an unset local is left
+ * to run time. Reports the counts to the listing and
+ * returns the number of calls replaced
+ */
+int evalConstCalls(TreeNode * syntaxTree);
+
+#endif
@@ -0,0 +1,566 @@
+/****************************************************/
+/* File: ctrans.c                                   */
+/* Translator of C- to C for the C- compiler        */
+/* Every name of the program becomes cm_<name>, so  */
+/* that none is a C keyword or a name of the C      */
+/* library; arrays, array parameters and blocks map */
+/* to their C equivalents. Arithmetic goes through  */
+/* the functions of the prelude, which wrap around  */
+/* as on the TM, where C leaves the overflow of int */
+/* undefined, and so do comparisons, which test the */
+/* sign of the difference as the TM does. Operands  */
+/* whose order of evaluation shows, through calls   */
+/* and assignments, go to temporaries first, left   */
+/* to right as on the other targets. The #line      */
+/* directives carry the lines of the source to the  */
+/* debugger and the profiler                        */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "cgen.h"
+#include "ctrans.h"
+#include <stdarg.h>
+#include <limits.h>
+
+/* the runtime, written at the top of every program;
+ * inline keeps the compiler quiet about the functions
+ * a program does not use
+ */
+static const char * prelude[] = {
+    "#include <stdio.h>",
+    "#include <stdlib.h>",
+    "#include <limits.h>",
+    "",
+    "static inline int rt_add(int a, int b) { return (int) ((unsigned) a + (unsigned) b); }",
+    "static inline int rt_sub(int a, int b) { return (int) ((unsigned) a - (unsigned) b); }",
+    "static inline int rt_mul(int a, int b) { return (int) ((unsigned) a * (unsigned) b); }",
+    "static inline int rt_cmp(int a, int b) { return rt_sub(a,b); }",
+    "",
+    "static inline void rt_error(const char * message)",
+    "{",
+    "    fflush(stdout);",
+    "    fprintf(stderr,\"Runtime error: %s\\n\",message);",
+    "    exit(2);",
+    "}",
+    "",
+    "static inline int rt_div(int a, int b)",
+    "{",
+    "    if (b == 0)",
+    "        rt_error(\"division by zero\");",
+    "    if (b == -1 && a == INT_MIN)",
+    "        rt_error(\"division overflow\");",
+    "    return a / b;",
+    "}",
+    "",
+    "static inline int cm_input(void)",
+    "{",
+    "    int n;",
+    "    if (scanf(\"%d\",&n) != 1)",
+    "        rt_error(\"no integer to input\");",
+    "    return n;",
+    "}",
+    "",
+    "static inline void cm_output(int n)",
+    "{",
+    "    printf(\"OUT instruction prints: %d\\n\",n);",
+    "}",
+    NULL
+};
+
+/* the operands hoisted into temporaries rt_t<n> for
+ * the statement being written, and the number of the
+ * last temporary of the function
+ */
+static THREADLOCAL TreeNode ** hoisted = NULL;
+static THREADLOCAL int * hoistedTemp = NULL;
+static THREADLOCAL int nhoisted = 0, maxhoisted = 0;
+static THREADLOCAL int temps = 0;
+
+/* stack of the operand lists being hoisted */
+static THREADLOCAL TreeNode ** operands = NULL;
+static THREADLOCAL int noperands = 0, maxoperands = 0;
+
+/* nesting of the line being written */
+static THREADLOCAL int indent = 0;
+
+/* the source line of the next line written, or 0
+ * before the first #line directive
+ */
+static THREADLOCAL int cline = 0;
+
+/* prototypes for internal recursive functions */
+static void cGen(TreeNode * tree);
+static void genExp(TreeNode * tree);
+
+/* Procedure begin indents the line to be written */
+static void begin(void)
+{
+    fprintf(code,"%*s",4 * indent,"");
+}
+
+/* Procedure end ends the line being written with s */
+static void end(const char * s)
+{
+    fprintf(code,"%s\n",s);
+    if (cline > 0)
+        cline++;
+}
+
+/* Procedure emit prints a line, formatted as by printf
+ * and indented, to the code file
+ */
+static void emit(const char * fmt, ...)
+{
+    va_list ap;
+    begin();
+    va_start(ap,fmt);
+    vfprintf(code,fmt,ap);
+    va_end(ap);
+    end("");
+}
+
+/* Procedure at attributes the next line written to
+ * line of the source, with a #line directive unless
+ * it already is
+ */
+static void at(int line)
+{
+    const char * p;
+    if (line == cline || line <= 0)
+        return;
+    fprintf(code,"#line %d \"",line);
+    for (p = CodeSource; *p; p++) {
+        if (*p == '"' || *p == '\\')
+            putc('\\',code);
+        putc(*p,code);
+    }
+    fprintf(code,"\"\n");
+    cline = line;
+}
+
+/* Procedure genNum prints the number k, negative ones
+ * in parentheses
+ */
+static void genNum(int k)
+{
+    if (k == INT_MIN)
+        fprintf(code,"(-%d - 1)",INT_MAX);
+    else if (k < 0)
+        fprintf(code,"(%d)",k);
+    else
+        fprintf(code,"%d",k);
+}
+
+/* Procedure genCalls prints the calls of the runtime
+ * for the operators from op on, the last one first, so
+ * that the first one is applied first
+ */
+static void genCalls(TreeNode * op)
+{
+    if (op == NULL || op->sibling == NULL)
+        return;
+    genCalls(op->sibling->sibling);
+    switch (op->attr.op) {
+        case PLUS: fprintf(code,"rt_add("); break;
+        case MINUS: fprintf(code,"rt_sub("); break;
+        case TIMES: fprintf(code,"rt_mul("); break;
+        default: fprintf(code,"rt_div("); break;
+    }
+}
+
+/* Procedure genAssign prints the assignment tree */
+static void genAssign(TreeNode * tree)
+{
+    genExp(tree->child[0]);
+    fprintf(code," = ");
+    genExp(tree->child[1]);
+}
+
+/* Function effects tells whether evaluating tree
+ * calls a function or assigns
+ */
+static int effects(TreeNode * tree)
+{
+    TreeNode * p;
+    int i;
+    if (tree->nodekind == StmtK || tree->kind.exp == FunCallK)
+        return TRUE;
+    for (i = 0; i < MAXCHILDREN; i++)
+        for (p = tree->child[i]; p != NULL; p = p->sibling)
+            if (p->nodekind != ExpK || p->kind.exp != OpK)
+                if (effects(p))
+                    return TRUE;
+    return FALSE;
+}
+
+/* Function tempOf returns the temporary holding the
+ * value of tree, or 0 if it has none
+ */
+static int tempOf(TreeNode * tree)
+{
+    int i;
+    for (i = 0; i < nhoisted; i++)
+        if (hoisted[i] == tree)
+            return hoistedTemp[i];
+    return 0;
+}
+
+/* Procedure pushOperand adds tree to the operand list
+ * on top of the stack
+ */
+static void pushOperand(TreeNode * tree)
+{
+    if (noperands == maxoperands) {
+        maxoperands = maxoperands ? 2 * maxoperands : 64;
+        operands = (TreeNode **) realloc(operands,maxoperands * sizeof(TreeNode *));
+    }
+    operands[noperands++] = tree;
+}
+
+static void genTemps(TreeNode * tree);
+
+/* Function fixed tells whether the value of tree, a
+ * number or the address of an array, cannot change
+ */
+static int fixed(TreeNode * tree)
+{
+    return tree->nodekind == ExpK && (tree->kind.exp == NumK ||
+           (tree->kind.exp == IdK && (tree->symbol->kind == ArraySym || tree->symbol->kind == ArrParamSym)));
+}
+
+/* Procedure hoist prints the declaration of a new
+ * temporary holding the value of tree
+ */
+static void hoist(TreeNode * tree)
+{
+    genTemps(tree);
+    begin();
+    fprintf(code,"int rt_t%d = ",++temps);
+    genExp(tree);
+    end(";");
+    if (nhoisted == maxhoisted) {
+        maxhoisted = maxhoisted ? 2 * maxhoisted : 16;
+        hoisted = (TreeNode **) realloc(hoisted,maxhoisted * sizeof(TreeNode *));
+        hoistedTemp = (int *) realloc(hoistedTemp,maxhoisted * sizeof(int));
+    }
+    hoisted[nhoisted] = tree;
+    hoistedTemp[nhoisted++] = temps;
+}
+
+/* Procedure genTemps fixes the order C leaves open in
+ * evaluating the operands of tree, its arguments or
+ * the subscript and value of an assignment: the other
+ * targets go from left to right. Every operand before
+ * the last one that calls or assigns, and that one if
+ * an operand follows whose value it may change, is
+ * hoisted into a temporary; numbers and arrays stay
+ * in place
+ */
+static void genTemps(TreeNode * tree)
+{
+    int base = noperands, last = -1, after = FALSE, k;
+    TreeNode * p;
+    if (!effects(tree))
+        return;
+    if (tree->nodekind == StmtK) {
+        if (tree->child[0]->kind.exp == ArrK)
+            pushOperand(tree->child[0]->child[0]);
+        pushOperand(tree->child[1]);
+    }
+    else
+        switch (tree->kind.exp) {
+            case ArrK:
+                pushOperand(tree->child[0]);
+                break;
+            case FunCallK:
+                for (p = tree->child[0]; p != NULL; p = p->sibling)
+                    pushOperand(p);
+                break;
+            case addK:
+            case mulK:
+                for (p = tree->child[0]; p != NULL; p = p->sibling != NULL ? p->sibling->sibling : NULL)
+                    pushOperand(p);
+                break;
+            case simpleK:
+                pushOperand(tree->child[0]);
+                pushOperand(tree->child[2]);
+                break;
+            default:
+                break;
+        }
+    for (k = base; k < noperands; k++)
+        if (effects(operands[k]))
+            last = k;
+    for (k = last + 1; k < noperands; k++)
+        if (!fixed(operands[k]))
+            after = TRUE;
+    for (k = base; k < noperands; k++) {
+        TreeNode * op = operands[k];
+        if (fixed(op))
+            continue;
+        if (k < last || (k == last && after))
+            hoist(op);
+        else if (k == last)
+            genTemps(op);
+    }
+    noperands = base;
+}
+
+/* Procedure startStmt prints the temporaries of the
+ * expression tree of a new statement
+ */
+static void startStmt(TreeNode * tree)
+{
+    nhoisted = 0;
+    genTemps(tree);
+}
+
+/* Procedure genExp prints the expression tree */
+static void genExp(TreeNode * tree)
+{
+    TreeNode * p;
+    int temp = tempOf(tree);
+    if (temp > 0) {
+        fprintf(code,"rt_t%d",temp);
+        return;
+    }
+    if (tree->nodekind == StmtK) {
+        /* an assignment, whose value is the one assigned */
+        putc('(',code);
+        genAssign(tree);
+        putc(')',code);
+        return;
+    }
+    switch (tree->kind.exp) {
+        case NumK:
+            genNum(tree->attr.val);
+            break;
+        case IdK:
+            fprintf(code,"cm_%s",tree->attr.name);
+            break;
+        case ArrK:
+            fprintf(code,"cm_%s[",tree->attr.name);
+            genExp(tree->child[0]);
+            putc(']',code);
+            break;
+        case FunCallK:
+            fprintf(code,"cm_%s(",tree->attr.name);
+            for (p = tree->child[0]; p != NULL; p = p->sibling) {
+                genExp(p);
+                if (p->sibling != NULL)
+                    fprintf(code,", ");
+            }
+            putc(')',code);
+            break;
+        case addK:
+        case mulK:
+            /* operand, operator, operand... */
+            genCalls(tree->child[0]->sibling);
+            genExp(tree->child[0]);
+            for (p = tree->child[0]->sibling; p != NULL && p->sibling != NULL; p = p->sibling->sibling) {
+                fprintf(code,", ");
+                genExp(p->sibling);
+                putc(')',code);
+            }
+            break;
+        case simpleK:
+            fprintf(code,"(rt_cmp(");
+            genExp(tree->child[0]);
+            fprintf(code,", ");
+            genExp(tree->child[2]);
+            switch (tree->child[1]->attr.op) {
+                case LT: fprintf(code,") < 0)"); break;
+                case LE: fprintf(code,") <= 0)"); break;
+                case GT: fprintf(code,") > 0)"); break;
+                case GE: fprintf(code,") >= 0)"); break;
+                case EQ: fprintf(code,") == 0)"); break;
+                default: fprintf(code,") != 0)"); break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Procedure genCondition prints the condition tree of
+ * an if or a while, in parentheses
+ */
+static void genCondition(TreeNode * tree)
+{
+    if (tree->nodekind == ExpK && tree->kind.exp == simpleK)
+        genExp(tree);
+    else {
+        putc('(',code);
+        genExp(tree);
+        putc(')',code);
+    }
+}
+
+/* Procedure genDecl prints the declaration of the
+ * variable tree
+ */
+static void genDecl(TreeNode * tree, const char * storage)
+{
+    at(tree->lineno);
+    if (tree->kind.decl == ArrVarK)
+        emit("%sint cm_%s[%d];",storage,tree->attr.name,tree->symbol->size);
+    else
+        emit("%sint cm_%s;",storage,tree->attr.name);
+}
+
+/* Procedure genBlock prints the statement tree as a
+ * block of its own
+ */
+static void genBlock(TreeNode * tree)
+{
+    if (tree != NULL && tree->nodekind == StmtK && tree->kind.stmt == CompoundK)
+        cGen(tree);
+    else {
+        emit("{");
+        indent++;
+        cGen(tree);
+        indent--;
+        emit("}");
+    }
+}
+
+/* Procedure genStmt prints the statement tree. The
+ * line of an if or a while is that of its condition,
+ * as the parser leaves them at their last line
+ */
+static void genStmt(TreeNode * tree)
+{
+    TreeNode * p;
+    if (tree->kind.stmt == IfK || tree->kind.stmt == WhileK)
+        at(tree->child[0]->lineno);
+    else if (tree->kind.stmt != CompoundK)
+        at(tree->lineno);
+    switch (tree->kind.stmt) {
+        case CompoundK:
+            emit("{");
+            indent++;
+            for (p = tree->child[0]; p != NULL; p = p->sibling)
+                genDecl(p,"");
+            cGen(tree->child[1]);
+            indent--;
+            emit("}");
+            break;
+        case IfK:
+            startStmt(tree->child[0]);
+            begin();
+            fprintf(code,"if ");
+            genCondition(tree->child[0]);
+            end("");
+            genBlock(tree->child[1]);
+            if (tree->child[2] != NULL) {
+                emit("else");
+                genBlock(tree->child[2]);
+            }
+            break;
+        case WhileK:
+            if (effects(tree->child[0])) {
+                /* the temporaries are set on every test */
+                emit("for (;;)");
+                emit("{");
+                indent++;
+                startStmt(tree->child[0]);
+                begin();
+                fprintf(code,"if (!");
+                genCondition(tree->child[0]);
+                end(")");
+                indent++;
+                emit("break;");
+                indent--;
+                genBlock(tree->child[1]);
+                indent--;
+                emit("}");
+                break;
+            }
+            begin();
+            fprintf(code,"while ");
+            genCondition(tree->child[0]);
+            end("");
+            genBlock(tree->child[1]);
+            break;
+        case ReturnK:
+            if (tree->child[0] != NULL)
+                startStmt(tree->child[0]);
+            begin();
+            fprintf(code,"return");
+            if (tree->child[0] != NULL) {
+                putc(' ',code);
+                genExp(tree->child[0]);
+            }
+            end(";");
+            break;
+        default:
+            startStmt(tree);
+            begin();
+            genAssign(tree);
+            end(";");
+            break;
+    }
+}
+
+/* Procedure cGen prints the statement list tree */
+static void cGen(TreeNode * tree)
+{
+    for (; tree != NULL; tree = tree->sibling) {
+        if (tree->nodekind == StmtK)
+            genStmt(tree);
+        else {
+            at(tree->lineno);
+            startStmt(tree);
+            begin();
+            genExp(tree);
+            end(";");
+        }
+    }
+}
+
+/* Procedure genFunction prints the function
+ * declaration tree, whose body is a compound statement
+ */
+static void genFunction(TreeNode * tree)
+{
+    TreeNode * p;
+    int first = TRUE;
+    temps = 0;
+    at(tree->lineno);
+    fprintf(code,"static %s cm_%s(",tree->symbol->type == Void ? "void" : "int",tree->attr.name);
+    for (p = tree->child[1]; p != NULL; p = p->sibling) {
+        if (p->nodekind != DeclK || p->symbol == NULL)
+            break;
+        fprintf(code,"%sint %scm_%s",first ? "" : ", ",p->kind.decl == ArrParamK ? "* " : "",p->attr.name);
+        first = FALSE;
+    }
+    end(first ? "void)" : ")");
+    cGen(tree->child[2]);
+    emit("");
+}
+
+void cTranslate(TreeNode * syntaxTree, char * codefile)
+{
+    TreeNode * t;
+    int i;
+    indent = 0;
+    cline = 0;
+    fprintf(code,"/* C- Compilation to C */\n");
+    if (TraceCode)
+        fprintf(code,"/* File: %s */\n",codefile);
+    for (i = 0; prelude[i] != NULL; i++)
+        fprintf(code,"%s\n",prelude[i]);
+    putc('\n',code);
+    for (t = syntaxTree; t != NULL; t = t->sibling) {
+        if (t->kind.decl == FunK)
+            genFunction(t);
+        else
+            genDecl(t,"static ");
+    }
+    /* main comes last */
+    fprintf(code,"int main(void)\n{\n    cm_main();\n    return 0;\n}\n");
+    if (fflush(code) != 0 || ferror(code))
+        fprintf(stderr,"Unable to write code file %s\n",codefile);
+}
@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: ctrans.h                                   */
+/* Translator of C- to C, built by the host         */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _CTRANS_H_
+#define _CTRANS_H_
+
+/* Procedure cTranslate writes the analyzed syntaxTree
+ * as a C program to the code file, with #line
+ * directives naming the source file CodeSource; the
+ * file name codefile is printed as a comment if
+ * TraceCode is set
+ */
+void cTranslate(TreeNode * syntaxTree, char * codefile);
+
+#endif
@@ -43,11 +43,17 @@ typedef int TokenType;
     //ASSIGN, EQ, NE, LT, LE, GT, GE, PLUS, MINUS, TIMES, OVER, LPAREN, RPAREN, LBRACE, RBRACE, LCURLY, RCURLY, SEMI, COMMA
    //} TokenType;
 
-extern FILE* source; /* source code text file */
-extern FILE* listing; /* listing output text file */
-extern FILE* code; /* code text file for TM simulator */
+/* THREADLOCAL marks the per-compilation state below, so
+ * that batch mode can compile several files at once with
+ * every worker thread owning its own copy
+ */
+#define THREADLOCAL __thread
+
+extern THREADLOCAL FILE* source; /* source code text file */
+extern THREADLOCAL FILE* listing; /* listing output text file */
+extern THREADLOCAL FILE* code; /* code text file for TM simulator */
 
-extern int lineno; /* source line number for listing */
+extern THREADLOCAL int lineno; /* source line number for listing */
 
 /**************************************************/
 /***********   Syntax tree for parsing ************/
@@ -80,6 +86,8 @@ typedef struct treeNode
         char * name; 
     } attr;
      ExpType type; /* for type checking of exps */
+     /* declaration a name refers to, set by buildSymtab */
+     struct symbol * symbol;
    } TreeNode;
 
 /**************************************************/
@@ -114,6 +122,12 @@ extern int TraceAnalyze;
  */
 extern int TraceCode;
 
+/* WriteListing = FALSE skips the listing file, and
+ * with it all formatting work: the compiler only tells
+ * whether each file compiled
+ */
+extern int WriteListing;
+
 /* Error = TRUE prevents further passes if an error occurs */
-extern int Error; 
+extern THREADLOCAL int Error; 
 #endif
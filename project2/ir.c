@@ -0,0 +1,1207 @@
+/****************************************************/
+/* File: ir.c                                       */
+/* Lowering of C- to the SSA representation         */
+/* A function is first lowered to blocks where the  */
+/* scalar variables are read and written by get and */
+/* set. The blocks the entry cannot reach are       */
+/* dropped, the rest ordered in reverse postorder   */
+/* and their dominators found by the iteration of   */
+/* Cooper, Harvey and Kennedy. Phis go on the       */
+/* iterated dominance frontiers of the blocks       */
+/* setting each variable read in another block than */
+/* it is set (semi-pruned SSA), a walk of the       */
+/* dominator tree then replaces every get by the    */
+/* value it reads, and the phis left unused are     */
+/* removed. Nothing recurses over the blocks, so    */
+/* long functions do not exhaust the stack          */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "ir.h"
+#include <stdint.h>
+
+int DumpIR = FALSE;
+int VerifyIR = FALSE;
+
+static const char * opNames[IROPS] = {
+    "undef", "const", "param", "global", "local", "phi",
+    "add", "sub", "mul", "div",
+    "lt", "le", "gt", "ge", "eq", "ne",
+    "elem", "load", "store", "call",
+    "br", "cbr", "ret",
+    "get", "set"
+};
+
+/* a Binding is what a parameter or local stands for:
+ * a variable, or the address of an array; it is only
+ * valid in the function numbered fn
+ */
+typedef struct
+{
+    Symbol * s;
+    int fn;
+    int var;
+    IrInst * base;
+} Binding;
+
+/* a DefSite is a block setting a variable */
+typedef struct
+{
+    IrBlock * block;
+    int next;
+} DefSite;
+
+/* the state of the lowering of a function; the arrays
+ * grow as needed and are kept for the next function
+ */
+static THREADLOCAL int fnCount = 0;
+static THREADLOCAL IrBlock * cur;
+static THREADLOCAL IrBlock * entry;
+static THREADLOCAL IrInst * hoistPoint;
+static THREADLOCAL IrInst * undefValue;
+static THREADLOCAL int line = 0;
+
+/* the blocks in order of creation */
+static THREADLOCAL IrBlock ** all = NULL;
+static THREADLOCAL int nall = 0, maxall = 0;
+
+static THREADLOCAL Binding * table = NULL;
+static THREADLOCAL int tableSize = 0, nbound = 0;
+
+/* the variables of the function */
+static THREADLOCAL int nvars = 0, maxvars = 0;
+static THREADLOCAL Symbol ** varSym = NULL;
+static THREADLOCAL int * killedIn = NULL;   /* block setting it last */
+static THREADLOCAL int * lastDef = NULL;    /* last block in defs */
+static THREADLOCAL int * defHead = NULL;
+static THREADLOCAL char * nonLocal = NULL;  /* read before set in a block */
+static THREADLOCAL IrInst ** curValue = NULL;
+
+static THREADLOCAL DefSite * defs = NULL;
+static THREADLOCAL int ndefs = 0, maxdefs = 0;
+
+/* undo log of curValue while renaming */
+static THREADLOCAL int * logVar = NULL;
+static THREADLOCAL IrInst ** logValue = NULL;
+static THREADLOCAL int nlog = 0, maxlog = 0;
+
+/* phis found dead while pruning */
+static THREADLOCAL IrInst ** dead = NULL;
+static THREADLOCAL int maxdead = 0;
+
+/* stack of the walks over the blocks; while renaming
+ * each level remembers the log length at its entry
+ */
+static THREADLOCAL IrBlock ** walkBlock = NULL;
+static THREADLOCAL int * walkNext = NULL;
+static THREADLOCAL int * logMark = NULL;
+static THREADLOCAL int maxwalk = 0;
+
+/* Function grow doubles *max until it reaches n;
+ * returns FALSE if it already does, and the arrays of
+ * *max elements need no realloc
+ */
+static int grow(int * max, int n)
+{
+    if (n <= *max)
+        return FALSE;
+    while (*max < n)
+        *max = *max ? 2 * *max : 64;
+    return TRUE;
+}
+
+/* Function lookup returns the binding of s in the
+ * function being lowered, inserting an empty one if
+ * there is none
+ */
+static Binding * lookup(Symbol * s)
+{
+    unsigned h;
+    if (2 * (nbound + 1) > tableSize) {
+        Binding * old = table;
+        int oldSize = tableSize, i;
+        tableSize = tableSize ? 2 * tableSize : 64;
+        table = (Binding *) calloc(tableSize,sizeof(Binding));
+        nbound = 0;
+        for (i = 0; i < oldSize; i++)
+            if (old[i].s != NULL && old[i].fn == fnCount) {
+                Binding * b = lookup(old[i].s);
+                *b = old[i];
+            }
+        free(old);
+    }
+    h = (unsigned) (((uintptr_t) s >> 4) * 2654435761u) & (tableSize - 1);
+    while (table[h].s != NULL && table[h].fn == fnCount && table[h].s != s)
+        h = (h + 1) & (tableSize - 1);
+    if (table[h].s != s || table[h].fn != fnCount) {
+        table[h].s = s;
+        table[h].fn = fnCount;
+        table[h].var = -1;
+        table[h].base = NULL;
+        nbound++;
+    }
+    return &table[h];
+}
+
+/* Function newVar makes s a variable of the function */
+static int newVar(Symbol * s)
+{
+    int v = nvars++;
+    if (grow(&maxvars,nvars)) {
+        varSym = (Symbol **) realloc(varSym,maxvars * sizeof(Symbol *));
+        killedIn = (int *) realloc(killedIn,maxvars * sizeof(int));
+        lastDef = (int *) realloc(lastDef,maxvars * sizeof(int));
+        defHead = (int *) realloc(defHead,maxvars * sizeof(int));
+        nonLocal = (char *) realloc(nonLocal,maxvars);
+        curValue = (IrInst **) realloc(curValue,maxvars * sizeof(IrInst *));
+    }
+    varSym[v] = s;
+    killedIn[v] = lastDef[v] = defHead[v] = -1;
+    nonLocal[v] = FALSE;
+    curValue[v] = NULL;
+    lookup(s)->var = v;
+    return v;
+}
+
+static IrBlock * newBlock(void)
+{
+    IrBlock * b = (IrBlock *) allocate(sizeof(IrBlock));
+    memset(b,0,sizeof(IrBlock));
+    b->id = nall;
+    if (grow(&maxall,nall + 1))
+        all = (IrBlock **) realloc(all,maxall * sizeof(IrBlock *));
+    all[nall++] = b;
+    return b;
+}
+
+/* Function newInst returns an instruction with room
+ * for nargs operands, in no block
+ */
+static IrInst * newInst(IrOp op, IrType type, int nargs)
+{
+    IrInst * i = (IrInst *) allocate(sizeof(IrInst) + nargs * sizeof(IrInst *));
+    i->op = op;
+    i->type = type;
+    i->id = -1;
+    i->k = 0;
+    i->symbol = NULL;
+    i->args = nargs > 0 ? (IrInst **) (i + 1) : NULL;
+    i->nargs = nargs;
+    i->line = line;
+    i->block = NULL;
+    i->next = NULL;
+    i->var = -1;
+    i->repl = NULL;
+    return i;
+}
+
+/* Function append adds i to the end of the current block */
+static IrInst * append(IrInst * i)
+{
+    i->block = cur;
+    if (cur->last == NULL)
+        cur->first = i;
+    else
+        cur->last->next = i;
+    cur->last = i;
+    return i;
+}
+
+/* Function hoist adds i to the entry block, after the
+ * parameters and the instructions hoisted before it
+ */
+static IrInst * hoist(IrInst * i)
+{
+    i->block = entry;
+    if (hoistPoint == NULL) {
+        i->next = entry->first;
+        entry->first = i;
+    }
+    else {
+        i->next = hoistPoint->next;
+        hoistPoint->next = i;
+    }
+    if (entry->last == hoistPoint)
+        entry->last = i;
+    hoistPoint = i;
+    return i;
+}
+
+static IrInst * emit1(IrOp op, IrType type, IrInst * a)
+{
+    IrInst * i = newInst(op,type,1);
+    i->args[0] = a;
+    return append(i);
+}
+
+static IrInst * emit2(IrOp op, IrType type, IrInst * a, IrInst * b)
+{
+    IrInst * i = newInst(op,type,2);
+    i->args[0] = a;
+    i->args[1] = b;
+    return append(i);
+}
+
+static IrInst * constant(int k)
+{
+    IrInst * i = newInst(IrConst,IrInt,0);
+    i->k = k;
+    return append(i);
+}
+
+static int terminated(IrBlock * b)
+{
+    return b->last != NULL && b->last->op >= IrBr && b->last->op <= IrRet;
+}
+
+/* Procedure jump ends the current block with a jump to b */
+static void jump(IrBlock * b)
+{
+    append(newInst(IrBr,IrNone,0));
+    cur->succ[0] = b;
+    cur->nsucc = 1;
+}
+
+/* Procedure branch ends the current block with a jump
+ * to t if c is not 0, to f otherwise
+ */
+static void branch(IrInst * c, IrBlock * t, IrBlock * f)
+{
+    emit1(IrCbr,IrNone,c);
+    cur->succ[0] = t;
+    cur->succ[1] = f;
+    cur->nsucc = 2;
+}
+
+/* Function readVar reads the variable v */
+static IrInst * readVar(int v)
+{
+    IrInst * i = newInst(IrGet,IrInt,0);
+    i->var = v;
+    if (killedIn[v] != cur->id)
+        nonLocal[v] = TRUE;
+    return append(i);
+}
+
+/* Procedure writeVar sets the variable v to x */
+static void writeVar(int v, IrInst * x)
+{
+    IrInst * i = emit1(IrSet,IrNone,x);
+    i->var = v;
+    killedIn[v] = cur->id;
+    if (lastDef[v] != cur->id) {
+        if (grow(&maxdefs,ndefs + 1))
+            defs = (DefSite *) realloc(defs,maxdefs * sizeof(DefSite));
+        defs[ndefs].block = cur;
+        defs[ndefs].next = defHead[v];
+        defHead[v] = ndefs++;
+        lastDef[v] = cur->id;
+    }
+}
+
+/* Function base returns the address of element 0 of
+ * the array or array parameter s
+ */
+static IrInst * base(Symbol * s)
+{
+    IrInst * i;
+    if (s->depth > 0)
+        return lookup(s)->base;
+    i = newInst(IrGlobal,IrAddr,0);
+    i->symbol = s;
+    return append(i);
+}
+
+static IrInst * lowerExp(TreeNode * tree);
+
+/* Function lowerAssign lowers the assignment tree;
+ * returns the value assigned
+ */
+static IrInst * lowerAssign(TreeNode * tree)
+{
+    TreeNode * var = tree->child[0];
+    Symbol * s = var->symbol;
+    IrInst * addr, * v;
+    line = tree->lineno;
+    if (var->kind.exp == IdK && s->depth > 0) {
+        v = lowerExp(tree->child[1]);
+        writeVar(lookup(s)->var,v);
+        return v;
+    }
+    if (var->kind.exp == IdK)
+        addr = base(s);
+    else
+        addr = emit2(IrElem,IrAddr,base(s),lowerExp(var->child[0]));
+    v = lowerExp(tree->child[1]);
+    emit2(IrStore,IrNone,addr,v);
+    return v;
+}
+
+/* Function comparison returns the instruction of the
+ * comparison operator op
+ */
+static IrOp comparison(TokenType op)
+{
+    switch (op) {
+        case LT: return IrLt;
+        case LE: return IrLe;
+        case GT: return IrGt;
+        case GE: return IrGe;
+        case EQ: return IrEq;
+        default: return IrNe;
+    }
+}
+
+/* Function lowerExp lowers the expression tree;
+ * returns its value, NULL for a call of a void function
+ */
+static IrInst * lowerExp(TreeNode * tree)
+{
+    Symbol * s = tree->symbol;
+    TreeNode * p;
+    IrInst * i, * v;
+    int n;
+    if (tree->nodekind == StmtK)
+        return lowerAssign(tree);
+    line = tree->lineno;
+    switch (tree->kind.exp) {
+        case NumK:
+            return constant(tree->attr.val);
+        case IdK:
+            if (s->kind == ArraySym || s->kind == ArrParamSym)
+                return base(s);
+            if (s->depth == 0)
+                return emit1(IrLoad,IrInt,base(s));
+            return readVar(lookup(s)->var);
+        case ArrK:
+            v = lowerExp(tree->child[0]);
+            return emit1(IrLoad,IrInt,emit2(IrElem,IrAddr,base(s),v));
+        case FunCallK:
+            n = 0;
+            for (p = tree->child[0]; p != NULL; p = p->sibling)
+                n++;
+            i = newInst(IrCall,s->type == Void ? IrNone : IrInt,n);
+            i->symbol = s;
+            for (p = tree->child[0], n = 0; p != NULL; p = p->sibling, n++)
+                i->args[n] = lowerExp(p);
+            line = tree->lineno;
+            return append(i);
+        case addK:
+        case mulK:
+            /* operand, operator, operand... */
+            v = lowerExp(tree->child[0]);
+            for (p = tree->child[0]->sibling; p != NULL && p->sibling != NULL; p = p->sibling->sibling) {
+                IrInst * right = lowerExp(p->sibling);
+                IrOp op = p->attr.op == PLUS ? IrAdd : p->attr.op == MINUS ? IrSub
+                        : p->attr.op == TIMES ? IrMul : IrDiv;
+                line = p->lineno;
+                v = emit2(op,IrInt,v,right);
+            }
+            return v;
+        case simpleK:
+            v = lowerExp(tree->child[0]);
+            i = lowerExp(tree->child[2]);
+            line = tree->lineno;
+            return emit2(comparison(tree->child[1]->attr.op),IrInt,v,i);
+        default:
+            return NULL;
+    }
+}
+
+static void lowerStmts(TreeNode * tree);
+
+/* Procedure lowerStmt lowers the statement tree */
+static void lowerStmt(TreeNode * tree)
+{
+    TreeNode * p;
+    IrBlock * b1, * b2, * b3;
+    IrInst * c;
+    if (tree->nodekind != StmtK) {
+        lowerExp(tree);
+        return;
+    }
+    switch (tree->kind.stmt) {
+        case CompoundK:
+            for (p = tree->child[0]; p != NULL; p = p->sibling) {
+                if (p->symbol == NULL)
+                    continue;
+                if (p->kind.decl == ArrVarK) {
+                    IrInst * a = newInst(IrLocal,IrAddr,0);
+                    a->k = p->symbol->size;
+                    a->symbol = p->symbol;
+                    a->line = p->lineno;
+                    lookup(p->symbol)->base = hoist(a);
+                }
+                else
+                    newVar(p->symbol);
+            }
+            lowerStmts(tree->child[1]);
+            break;
+        case IfK:
+            c = lowerExp(tree->child[0]);
+            b1 = newBlock();
+            b3 = newBlock();
+            b2 = tree->child[2] != NULL ? newBlock() : b3;
+            branch(c,b1,b2);
+            cur = b1;
+            lowerStmts(tree->child[1]);
+            if (!terminated(cur))
+                jump(b3);
+            if (tree->child[2] != NULL) {
+                cur = b2;
+                lowerStmts(tree->child[2]);
+                if (!terminated(cur))
+                    jump(b3);
+            }
+            cur = b3;
+            break;
+        case WhileK:
+            b1 = newBlock();
+            b2 = newBlock();
+            b3 = newBlock();
+            jump(b1);
+            cur = b1;
+            c = lowerExp(tree->child[0]);
+            branch(c,b2,b3);
+            cur = b2;
+            lowerStmts(tree->child[1]);
+            if (!terminated(cur))
+                jump(b1);
+            cur = b3;
+            break;
+        case ReturnK:
+            c = tree->child[0] != NULL ? lowerExp(tree->child[0]) : NULL;
+            line = tree->lineno;
+            if (c != NULL)
+                emit1(IrRet,IrNone,c);
+            else
+                append(newInst(IrRet,IrNone,0));
+            /* what follows cannot be reached */
+            cur = newBlock();
+            break;
+        default:
+            lowerAssign(tree);
+            break;
+    }
+}
+
+static void lowerStmts(TreeNode * tree)
+{
+    for (; tree != NULL; tree = tree->sibling)
+        lowerStmt(tree);
+}
+
+/* Procedure order numbers the blocks the entry
+ * reaches in reverse postorder into fn->blocks; the
+ * others get the id -1
+ */
+static void order(IrFunction * fn)
+{
+    int i, sp = 0, n = 0;
+    if (grow(&maxwalk,nall + 1)) {
+        walkBlock = (IrBlock **) realloc(walkBlock,maxwalk * sizeof(IrBlock *));
+        walkNext = (int *) realloc(walkNext,maxwalk * sizeof(int));
+        logMark = (int *) realloc(logMark,maxwalk * sizeof(int));
+    }
+    for (i = 0; i < nall; i++)
+        all[i]->mark = FALSE;
+    fn->blocks = (IrBlock **) allocate(nall * sizeof(IrBlock *));
+    walkBlock[sp] = entry;
+    walkNext[sp++] = 0;
+    entry->mark = TRUE;
+    while (sp > 0) {
+        IrBlock * b = walkBlock[sp - 1];
+        if (walkNext[sp - 1] < b->nsucc) {
+            IrBlock * s = b->succ[walkNext[sp - 1]++];
+            if (!s->mark) {
+                s->mark = TRUE;
+                walkBlock[sp] = s;
+                walkNext[sp++] = 0;
+            }
+        }
+        else {
+            /* postorder, filled from the end */
+            fn->blocks[nall - 1 - n++] = b;
+            sp--;
+        }
+    }
+    fn->blocks += nall - n;
+    fn->nblocks = n;
+    for (i = 0; i < nall; i++)
+        all[i]->id = -1;
+    for (i = 0; i < n; i++)
+        fn->blocks[i]->id = i;
+}
+
+/* Procedure linkPreds lists the predecessors of every
+ * block, in the order of the blocks
+ */
+static void linkPreds(IrFunction * fn)
+{
+    int i, k;
+    for (i = 0; i < fn->nblocks; i++)
+        fn->blocks[i]->npreds = 0;
+    for (i = 0; i < fn->nblocks; i++)
+        for (k = 0; k < fn->blocks[i]->nsucc; k++)
+            fn->blocks[i]->succ[k]->npreds++;
+    for (i = 0; i < fn->nblocks; i++) {
+        IrBlock * b = fn->blocks[i];
+        b->preds = (IrBlock **) allocate(b->npreds * sizeof(IrBlock *));
+        b->npreds = 0;
+    }
+    for (i = 0; i < fn->nblocks; i++) {
+        IrBlock * b = fn->blocks[i];
+        for (k = 0; k < b->nsucc; k++) {
+            b->predIndex[k] = b->succ[k]->npreds;
+            b->succ[k]->preds[b->succ[k]->npreds++] = b;
+        }
+    }
+}
+
+static IrBlock * intersect(IrBlock * a, IrBlock * b)
+{
+    while (a != b) {
+        while (a->id > b->id)
+            a = a->idom;
+        while (b->id > a->id)
+            b = b->idom;
+    }
+    return a;
+}
+
+/* Procedure dominators finds the immediate dominator of
+ * every block, builds the dominator tree and numbers it
+ * in preorder and postorder
+ */
+static void dominators(IrFunction * fn)
+{
+    int i, j, changed = TRUE, sp = 0, pre = 0, post = 0;
+    for (i = 0; i < fn->nblocks; i++)
+        fn->blocks[i]->idom = NULL;
+    entry->idom = entry;
+    while (changed) {
+        changed = FALSE;
+        for (i = 1; i < fn->nblocks; i++) {
+            IrBlock * b = fn->blocks[i], * d = NULL;
+            for (j = 0; j < b->npreds; j++)
+                if (b->preds[j]->idom != NULL)
+                    d = d == NULL ? b->preds[j] : intersect(b->preds[j],d);
+            if (b->idom != d) {
+                b->idom = d;
+                changed = TRUE;
+            }
+        }
+    }
+    entry->idom = NULL;
+    for (i = 0; i < fn->nblocks; i++)
+        fn->blocks[i]->nchildren = 0;
+    for (i = 1; i < fn->nblocks; i++)
+        fn->blocks[i]->idom->nchildren++;
+    for (i = 0; i < fn->nblocks; i++) {
+        IrBlock * b = fn->blocks[i];
+        b->children = (IrBlock **) allocate(b->nchildren * sizeof(IrBlock *));
+        b->nchildren = 0;
+    }
+    for (i = 1; i < fn->nblocks; i++) {
+        IrBlock * d = fn->blocks[i]->idom;
+        d->children[d->nchildren++] = fn->blocks[i];
+    }
+    walkBlock[sp] = entry;
+    walkNext[sp++] = 0;
+    entry->domPre = pre++;
+    while (sp > 0) {
+        IrBlock * b = walkBlock[sp - 1];
+        if (walkNext[sp - 1] < b->nchildren) {
+            IrBlock * c = b->children[walkNext[sp - 1]++];
+            c->domPre = pre++;
+            walkBlock[sp] = c;
+            walkNext[sp++] = 0;
+        }
+        else {
+            b->domPost = post++;
+            sp--;
+        }
+    }
+}
+
+int irDominates(IrBlock * a, IrBlock * b)
+{
+    return a->domPre <= b->domPre && b->domPost <= a->domPost;
+}
+
+/* Procedure frontiers finds the dominance frontier of
+ * every block: the joins it reaches without dominating
+ * them. The walk is made twice, to count, then to fill
+ */
+static void frontiers(IrFunction * fn)
+{
+    int pass, i, j;
+    for (i = 0; i < fn->nblocks; i++) {
+        fn->blocks[i]->ndf = 0;
+        fn->blocks[i]->mark = -1;
+    }
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < fn->nblocks; i++) {
+            IrBlock * b = fn->blocks[i];
+            if (b->npreds < 2)
+                continue;
+            for (j = 0; j < b->npreds; j++) {
+                IrBlock * r = b->preds[j];
+                while (r != b->idom && r->mark != b->id + pass * fn->nblocks) {
+                    if (pass == 1)
+                        r->df[r->ndf] = b;
+                    r->ndf++;
+                    r->mark = b->id + pass * fn->nblocks;
+                    r = r->idom;
+                }
+            }
+        }
+        if (pass == 0)
+            for (i = 0; i < fn->nblocks; i++) {
+                IrBlock * b = fn->blocks[i];
+                b->df = (IrBlock **) allocate(b->ndf * sizeof(IrBlock *));
+                b->ndf = 0;
+            }
+    }
+}
+
+/* Procedure placePhis puts the phis of the variables
+ * read in another block than they are set in on the
+ * iterated dominance frontiers of the blocks setting
+ * them
+ */
+static void placePhis(IrFunction * fn)
+{
+    int v, d, i, n;
+    for (i = 0; i < fn->nblocks; i++)
+        fn->blocks[i]->phiFor = fn->blocks[i]->workFor = -1;
+    for (v = 0; v < nvars; v++) {
+        if (!nonLocal[v])
+            continue;
+        n = 0;
+        for (d = defHead[v]; d >= 0; d = defs[d].next)
+            if (defs[d].block->id >= 0) {
+                defs[d].block->workFor = v;
+                walkBlock[n++] = defs[d].block;
+            }
+        while (n > 0) {
+            IrBlock * b = walkBlock[--n];
+            for (i = 0; i < b->ndf; i++) {
+                IrBlock * f = b->df[i];
+                IrInst * phi;
+                if (f->phiFor == v)
+                    continue;
+                f->phiFor = v;
+                phi = newInst(IrPhi,IrInt,f->npreds);
+                phi->var = v;
+                phi->symbol = varSym[v];
+                phi->line = f->first != NULL ? f->first->line : 0;
+                memset(phi->args,0,f->npreds * sizeof(IrInst *));
+                phi->block = f;
+                phi->next = f->first;
+                f->first = phi;
+                if (f->last == NULL)
+                    f->last = phi;
+                if (f->workFor != v) {
+                    f->workFor = v;
+                    walkBlock[n++] = f;
+                }
+            }
+        }
+    }
+}
+
+/* Function undef returns the value of the variables
+ * read before they are set, hoisted to the entry
+ * block once renaming is done
+ */
+static IrInst * undef(void)
+{
+    if (undefValue == NULL) {
+        undefValue = newInst(IrUndef,IrInt,0);
+        undefValue->block = entry;
+    }
+    return undefValue;
+}
+
+/* Procedure setValue makes x the value of the variable
+ * v, logging the value it had
+ */
+static void setValue(int v, IrInst * x)
+{
+    if (grow(&maxlog,nlog + 1)) {
+        logVar = (int *) realloc(logVar,maxlog * sizeof(int));
+        logValue = (IrInst **) realloc(logValue,maxlog * sizeof(IrInst *));
+    }
+    logVar[nlog] = v;
+    logValue[nlog++] = curValue[v];
+    curValue[v] = x;
+}
+
+/* Procedure renameBlock replaces the gets of block b by
+ * the values they read, drops its gets and sets, and
+ * gives the phis of its successors their values from b
+ */
+static void renameBlock(IrBlock * b)
+{
+    IrInst * i, * prev = NULL, * next;
+    int j, k;
+    for (i = b->first; i != NULL; i = next) {
+        next = i->next;
+        for (j = 0; j < i->nargs; j++)
+            if (i->args[j] != NULL && i->args[j]->op == IrGet)
+                i->args[j] = i->args[j]->repl;
+        if (i->op == IrGet || i->op == IrSet) {
+            if (i->op == IrGet)
+                i->repl = curValue[i->var] != NULL ? curValue[i->var] : undef();
+            else
+                setValue(i->var,i->args[0]);
+            if (prev == NULL)
+                b->first = next;
+            else
+                prev->next = next;
+            continue;
+        }
+        if (i->op == IrPhi)
+            setValue(i->var,i);
+        prev = i;
+    }
+    b->last = prev;
+    for (k = 0; k < b->nsucc; k++)
+        for (i = b->succ[k]->first; i != NULL && i->op == IrPhi; i = i->next)
+            i->args[b->predIndex[k]] = curValue[i->var] != NULL ? curValue[i->var] : undef();
+}
+
+/* Procedure renameAll walks the dominator tree in
+ * preorder, renaming each block with the values set by
+ * the blocks dominating it
+ */
+static void renameAll(void)
+{
+    int sp = 0, v;
+    for (v = 0; v < nvars; v++)
+        curValue[v] = NULL;
+    nlog = 0;
+    walkBlock[sp] = entry;
+    walkNext[sp] = 0;
+    logMark[sp++] = 0;
+    renameBlock(entry);
+    while (sp > 0) {
+        IrBlock * b = walkBlock[sp - 1];
+        if (walkNext[sp - 1] < b->nchildren) {
+            IrBlock * c = b->children[walkNext[sp - 1]++];
+            walkBlock[sp] = c;
+            walkNext[sp] = 0;
+            logMark[sp++] = nlog;
+            renameBlock(c);
+        }
+        else {
+            sp--;
+            while (nlog > logMark[sp]) {
+                nlog--;
+                curValue[logVar[nlog]] = logValue[nlog];
+            }
+        }
+    }
+}
+
+/* Procedure kill marks the phi i dead and pushes it
+ * on the stack of dead phis, of height *n
+ */
+static void kill(IrInst * i, int * n)
+{
+    i->k = -1;
+    if (grow(&maxdead,*n + 1))
+        dead = (IrInst **) realloc(dead,maxdead * sizeof(IrInst *));
+    dead[(*n)++] = i;
+}
+
+/* Procedure prunePhis removes the phis whose values
+ * are not used but by dead phis, which semi-pruned
+ * placement leaves where a variable is dead, e.g. at
+ * the exit of a loop. The k of a phi, and of the undef,
+ * counts their uses meanwhile
+ */
+static void prunePhis(IrFunction * fn)
+{
+    int b, j, n = 0;
+    IrInst * i, * prev;
+    if (undefValue != NULL)
+        undefValue->k = 0;
+    for (b = 0; b < fn->nblocks; b++)
+        for (i = fn->blocks[b]->first; i != NULL && i->op == IrPhi; i = i->next)
+            i->k = 0;
+    for (b = 0; b < fn->nblocks; b++)
+        for (i = fn->blocks[b]->first; i != NULL; i = i->next)
+            for (j = 0; j < i->nargs; j++)
+                if (i->args[j] != i && (i->args[j]->op == IrPhi || i->args[j]->op == IrUndef))
+                    i->args[j]->k++;
+    for (b = 0; b < fn->nblocks; b++)
+        for (i = fn->blocks[b]->first; i != NULL && i->op == IrPhi; i = i->next)
+            if (i->k == 0)
+                kill(i,&n);
+    while (n > 0) {
+        i = dead[--n];
+        for (j = 0; j < i->nargs; j++)
+            if (i->args[j] != i && (i->args[j]->op == IrPhi || i->args[j]->op == IrUndef)
+                && --i->args[j]->k == 0 && i->args[j]->op == IrPhi)
+                kill(i->args[j],&n);
+    }
+    for (b = 0; b < fn->nblocks; b++) {
+        IrBlock * bl = fn->blocks[b];
+        for (prev = NULL, i = bl->first; i != NULL && i->op == IrPhi; i = i->next)
+            if (i->k < 0) {
+                if (prev == NULL)
+                    bl->first = i->next;
+                else
+                    prev->next = i->next;
+                if (bl->last == i)
+                    bl->last = prev;
+            }
+            else
+                prev = i;
+    }
+}
+
+/* Procedure number gives the values their numbers,
+ * in block order, and the instructions their positions
+ */
+static void number(IrFunction * fn)
+{
+    int i, n = 0, pos;
+    IrInst * p;
+    for (i = 0; i < fn->nblocks; i++)
+        for (p = fn->blocks[i]->first, pos = 0; p != NULL; p = p->next) {
+            p->id = p->type == IrNone ? -1 : n++;
+            p->pos = pos++;
+        }
+    fn->nvalues = n;
+}
+
+/* Function lowerFunction lowers the function
+ * declaration tree
+ */
+static IrFunction * lowerFunction(TreeNode * tree)
+{
+    IrFunction * fn = (IrFunction *) allocate(sizeof(IrFunction));
+    TreeNode * p;
+    int n = 0;
+    fnCount++;
+    nall = nvars = ndefs = nbound = 0;
+    hoistPoint = undefValue = NULL;
+    fn->decl = tree;
+    fn->next = NULL;
+    line = tree->lineno;
+    cur = entry = newBlock();
+    for (p = tree->child[1]; p != NULL; p = p->sibling) {
+        IrInst * i;
+        if (p->nodekind != DeclK || p->symbol == NULL)
+            break;
+        i = newInst(IrParam,p->kind.decl == ArrParamK ? IrAddr : IrInt,0);
+        i->k = n++;
+        i->symbol = p->symbol;
+        hoist(i);
+        if (i->type == IrAddr)
+            lookup(p->symbol)->base = i;
+        else
+            writeVar(newVar(p->symbol),i);
+    }
+    lowerStmts(tree->child[2]);
+    /* a function may end without return */
+    if (!terminated(cur))
+        append(newInst(IrRet,IrNone,0));
+    order(fn);
+    linkPreds(fn);
+    dominators(fn);
+    frontiers(fn);
+    placePhis(fn);
+    renameAll();
+    prunePhis(fn);
+    if (undefValue != NULL && undefValue->k > 0)
+        hoist(undefValue);
+    number(fn);
+    return fn;
+}
+
+IrFunction * lowerProgram(TreeNode * syntaxTree)
+{
+    IrFunction * first = NULL, * last = NULL;
+    TreeNode * t;
+    for (t = syntaxTree; t != NULL; t = t->sibling)
+        if (t->nodekind == DeclK && t->kind.decl == FunK) {
+            IrFunction * fn = lowerFunction(t);
+            if (last == NULL)
+                first = fn;
+            else
+                last->next = fn;
+            last = fn;
+        }
+    return first;
+}
+
+/* Procedure dumpInst writes the instruction i to out */
+static void dumpInst(FILE * out, IrInst * i)
+{
+    int j;
+    fprintf(out,"    ");
+    if (i->id >= 0)
+        fprintf(out,"%%%d = ",i->id);
+    fprintf(out,"%s",opNames[i->op]);
+    switch (i->op) {
+        case IrConst:
+        case IrLocal:
+            fprintf(out," %d",i->k);
+            break;
+        case IrParam:
+            fprintf(out," %d %s",i->k,i->type == IrAddr ? "addr" : "int");
+            break;
+        case IrGlobal:
+            fprintf(out," @%s",i->symbol->name);
+            break;
+        case IrPhi:
+            for (j = 0; j < i->nargs; j++)
+                fprintf(out,"%s [%%%d, b%d]",j > 0 ? "," : "",
+                        i->args[j] != NULL ? i->args[j]->id : -1,i->block->preds[j]->id);
+            break;
+        case IrCall:
+            fprintf(out," @%s(",i->symbol->name);
+            for (j = 0; j < i->nargs; j++)
+                fprintf(out,"%s%%%d",j > 0 ? ", " : "",i->args[j]->id);
+            fprintf(out,")");
+            break;
+        case IrBr:
+            fprintf(out," b%d",i->block->succ[0]->id);
+            break;
+        case IrCbr:
+            fprintf(out," %%%d, b%d, b%d",i->args[0]->id,i->block->succ[0]->id,i->block->succ[1]->id);
+            break;
+        default:
+            for (j = 0; j < i->nargs; j++)
+                fprintf(out,"%s %%%d",j > 0 ? "," : "",i->args[j]->id);
+            break;
+    }
+    /* the names of the parameters, locals and phis */
+    if (i->symbol != NULL && i->op != IrGlobal && i->op != IrCall)
+        fprintf(out,"    ; %s",i->symbol->name);
+    fprintf(out,"\n");
+}
+
+void irDump(FILE * out, IrFunction * functions)
+{
+    IrFunction * fn;
+    IrInst * p;
+    int i, j;
+    for (fn = functions; fn != NULL; fn = fn->next) {
+        fprintf(out,"function %s, %d block%s, %d value%s\n",fn->decl->attr.name,
+                fn->nblocks,fn->nblocks == 1 ? "" : "s",fn->nvalues,fn->nvalues == 1 ? "" : "s");
+        for (i = 0; i < fn->nblocks; i++) {
+            IrBlock * b = fn->blocks[i];
+            fprintf(out,"b%d:",b->id);
+            if (b->npreds > 0) {
+                fprintf(out,"    ; preds");
+                for (j = 0; j < b->npreds; j++)
+                    fprintf(out," b%d",b->preds[j]->id);
+                fprintf(out,", idom b%d",b->idom->id);
+            }
+            fprintf(out,"\n");
+            for (p = b->first; p != NULL; p = p->next)
+                dumpInst(out,p);
+        }
+        fprintf(out,"\n");
+    }
+}
+
+/* the function and block being verified, and the
+ * errors found
+ */
+static THREADLOCAL IrFunction * vfn;
+static THREADLOCAL IrBlock * vblock;
+static THREADLOCAL FILE * verrors;
+static THREADLOCAL int nerrors;
+
+/* Procedure fail reports the error message at the
+ * instruction i, or at the block if i is NULL
+ */
+static void fail(IrInst * i, const char * message)
+{
+    fprintf(verrors,"IR error in %s, b%d",vfn->decl->attr.name,vblock->id);
+    if (i != NULL)
+        fprintf(verrors,", %s %%%d",opNames[i->op],i->id);
+    fprintf(verrors,": %s\n",message);
+    nerrors++;
+}
+
+/* Function owned tells whether b is a block of vfn */
+static int owned(IrBlock * b)
+{
+    return b != NULL && b->id >= 0 && b->id < vfn->nblocks && vfn->blocks[b->id] == b;
+}
+
+/* Procedure checkOperand checks that the operand j of i
+ * is a value of type t of vfn defined where it
+ * dominates i
+ */
+static void checkOperand(IrInst * i, int j, IrType t)
+{
+    IrInst * a = i->args[j];
+    IrBlock * at = i->block;
+    if (a == NULL || a->type == IrNone || !owned(a->block)) {
+        fail(i,"operand is no value of the function");
+        return;
+    }
+    if (a->type != t)
+        fail(i,t == IrInt ? "operand is no int" : "operand is no address");
+    if (i->op == IrPhi) {
+        at = i->block->preds[j];
+        if (a->block != at && !irDominates(a->block,at))
+            fail(i,"operand does not dominate the predecessor");
+    }
+    else if (a->block == at ? a->pos >= i->pos : !irDominates(a->block,at))
+        fail(i,"operand does not dominate its use");
+}
+
+/* Procedure checkInst checks the instruction i, the
+ * last of its block if last is set
+ */
+static void checkInst(IrInst * i, int last)
+{
+    int j, arity = 0, builtin;
+    TreeNode * p;
+    IrType t = IrInt;
+    if (i->block != vblock)
+        fail(i,"instruction is not in its block");
+    if (i->op >= IrGet) {
+        fail(i,"variable access left after renaming");
+        return;
+    }
+    if ((i->op >= IrBr && i->op <= IrRet) != last)
+        fail(i,last ? "block does not end in a terminator" : "terminator inside a block");
+    switch (i->op) {
+        case IrPhi:
+            if (i->nargs != vblock->npreds)
+                fail(i,"phi does not have a value for each predecessor");
+            for (j = 0; j < i->nargs && j < vblock->npreds; j++)
+                checkOperand(i,j,IrInt);
+            return;
+        case IrCall:
+            /* the parameters of input and output have no symbol */
+            builtin = i->symbol->decl->child[2] == NULL;
+            p = i->symbol->decl->child[1];
+            for (j = 0; j < i->nargs; j++, p = p->sibling) {
+                if (p == NULL || p->nodekind != DeclK || (p->symbol == NULL && !builtin)) {
+                    fail(i,"call has too many arguments");
+                    return;
+                }
+                checkOperand(i,j,p->kind.decl == ArrParamK ? IrAddr : IrInt);
+            }
+            if (p != NULL && p->nodekind == DeclK && (p->symbol != NULL || builtin))
+                fail(i,"call has too few arguments");
+            if (i->type != (i->symbol->type == Void ? IrNone : IrInt))
+                fail(i,"call has the wrong type");
+            return;
+        case IrUndef: case IrConst: case IrParam: case IrGlobal: case IrLocal: case IrBr:
+            arity = 0;
+            t = i->op == IrGlobal || i->op == IrLocal ? IrAddr : i->op == IrBr ? IrNone : IrInt;
+            if (i->op == IrParam)
+                t = i->type;
+            break;
+        case IrElem:
+            arity = 2;
+            t = IrAddr;
+            checkOperand(i,0,IrAddr);
+            checkOperand(i,1,IrInt);
+            break;
+        case IrLoad:
+            arity = 1;
+            checkOperand(i,0,IrAddr);
+            break;
+        case IrStore:
+            arity = 2;
+            t = IrNone;
+            checkOperand(i,0,IrAddr);
+            checkOperand(i,1,IrInt);
+            break;
+        case IrCbr:
+            arity = 1;
+            t = IrNone;
+            checkOperand(i,0,IrInt);
+            break;
+        case IrRet:
+            arity = i->nargs > 0 ? 1 : 0;
+            t = IrNone;
+            if (arity == 1)
+                checkOperand(i,0,IrInt);
+            break;
+        default:
+            /* arithmetic and comparisons */
+            arity = 2;
+            checkOperand(i,0,IrInt);
+            checkOperand(i,1,IrInt);
+            break;
+    }
+    if (i->nargs != arity)
+        fail(i,"wrong number of operands");
+    if (i->type != t)
+        fail(i,"wrong type");
+}
+
+/* Procedure checkBlock checks the block b of vfn */
+static void checkBlock(IrBlock * b)
+{
+    IrInst * i;
+    int j, k, phis = TRUE, n;
+    vblock = b;
+    if (b->first == NULL) {
+        fail(NULL,"empty block");
+        return;
+    }
+    n = b->last->op == IrBr ? 1 : b->last->op == IrCbr ? 2 : 0;
+    if (b->nsucc != n)
+        fail(NULL,"successors do not match the terminator");
+    for (k = 0; k < b->nsucc; k++)
+        if (!owned(b->succ[k]) || b->predIndex[k] < 0 || b->predIndex[k] >= b->succ[k]->npreds
+                || b->succ[k]->preds[b->predIndex[k]] != b)
+            fail(NULL,"successor does not list the block as predecessor");
+    for (j = 0; j < b->npreds; j++) {
+        IrBlock * p = b->preds[j];
+        int found = FALSE;
+        if (!owned(p))
+            fail(NULL,"predecessor is no block of the function");
+        else
+            for (k = 0; k < p->nsucc; k++)
+                found |= p->succ[k] == b && p->predIndex[k] == j;
+        if (!found)
+            fail(NULL,"predecessor does not list the block as successor");
+        else if (b->idom != NULL && !irDominates(b->idom,p))
+            fail(NULL,"immediate dominator does not dominate a predecessor");
+    }
+    if (b->id == 0 ? b->idom != NULL || b->npreds > 0 : b->idom == NULL || b->npreds == 0)
+        fail(NULL,b->id == 0 ? "entry block has predecessors" : "block is not reached from the entry");
+    for (i = b->first; i != NULL; i = i->next) {
+        if (i->op != IrPhi)
+            phis = FALSE;
+        else if (!phis)
+            fail(i,"phi after other instructions");
+        checkInst(i,i == b->last);
+        if (i->next == NULL && i != b->last)
+            fail(i,"block does not end at its last instruction");
+    }
+}
+
+int irVerify(IrFunction * functions, FILE * errors)
+{
+    int i;
+    verrors = errors;
+    nerrors = 0;
+    for (vfn = functions; vfn != NULL; vfn = vfn->next)
+        for (i = 0; i < vfn->nblocks; i++) {
+            vblock = vfn->blocks[i];
+            if (vblock->id != i)
+                fail(NULL,"block is out of order");
+            else
+                checkBlock(vblock);
+        }
+    return nerrors;
+}
@@ -0,0 +1,133 @@
+/****************************************************/
+/* File: ir.h                                       */
+/* SSA intermediate representation of C- programs   */
+/* A function is a graph of basic blocks whose      */
+/* instructions are values in SSA form: the scalar  */
+/* parameters and locals become values, merged by   */
+/* phi instructions; global variables and arrays    */
+/* stay in memory, reached by load and store        */
+/****************************************************/
+
+#ifndef _IR_H_
+#define _IR_H_
+
+/* DumpIR = TRUE (-fdump-ir) makes the compilations
+ * lower the analyzed program to the IR and write it to
+ * <name>.ir; VerifyIR = TRUE (-fverify-ir) makes them
+ * lower it and check it with irVerify, reporting any
+ * error on stderr
+ */
+extern int DumpIR;
+extern int VerifyIR;
+
+/* the instructions, %n the values they take:
+ *   undef                  value of a variable read
+ *                          before it is set
+ *   const k
+ *   param k                parameter k, an int or the
+ *                          address of an array
+ *   global @x              address of the global x
+ *   local k                address of a local array of
+ *                          k words, in the frame
+ *   phi [%a, b0], ...      the value from each
+ *                          predecessor, in their order
+ *   add %a, %b             and sub mul div, wrapping
+ *                          around
+ *   lt %a, %b              1 or 0, and le gt ge eq ne
+ *   elem %a, %i            address of word %i of the
+ *                          array at %a
+ *   load %a, store %a, %v
+ *   call @f(%a, ...)       also of input and output
+ *   br b, cbr %c, b1, b2   jump, to b1 if %c is not 0
+ *   ret, ret %v
+ * get and set read and write the scalar variables
+ * while a function is lowered, before SSA form
+ */
+typedef enum {
+    IrUndef, IrConst, IrParam, IrGlobal, IrLocal, IrPhi,
+    IrAdd, IrSub, IrMul, IrDiv,
+    IrLt, IrLe, IrGt, IrGe, IrEq, IrNe,
+    IrElem, IrLoad, IrStore, IrCall,
+    IrBr, IrCbr, IrRet,
+    IrGet, IrSet,
+    IROPS
+} IrOp;
+
+/* IrNone for instructions that are no value */
+typedef enum {IrNone, IrInt, IrAddr} IrType;
+
+typedef struct irInst
+{
+    IrOp op;
+    IrType type;
+    int id;                  /* value number, -1 if no value */
+    int pos;                 /* position in its block */
+    int k;                   /* of const, param and local;
+                              * uses of phi and undef while
+                              * pruning */
+    struct symbol * symbol;  /* global, local, parameter,
+                              * variable of a phi, function
+                              * called */
+    struct irInst ** args;
+    int nargs;
+    int line;                /* source line */
+    struct irBlock * block;
+    struct irInst * next;
+    int var;                 /* of get, set and phi while
+                              * lowering */
+    struct irInst * repl;    /* value a get reads */
+} IrInst;
+
+typedef struct irBlock
+{
+    int id;                  /* index in reverse postorder */
+    IrInst * first, * last;  /* phis first, terminator last */
+    struct irBlock * succ[2];
+    int nsucc;
+    int predIndex[2];        /* index of this block among the
+                              * predecessors of each successor */
+    struct irBlock ** preds;
+    int npreds;
+    struct irBlock * idom;   /* NULL for the entry */
+    struct irBlock ** children; /* in the dominator tree */
+    int nchildren;
+    int domPre, domPost;     /* numbering of the dominator tree */
+    /* scratch of the lowering */
+    int mark, phiFor, workFor, ndf;
+    struct irBlock ** df;
+} IrBlock;
+
+typedef struct irFunction
+{
+    TreeNode * decl;
+    IrBlock ** blocks;       /* reverse postorder, entry first */
+    int nblocks;
+    int nvalues;
+    struct irFunction * next;
+} IrFunction;
+
+/* Function lowerProgram lowers the functions of the
+ * analyzed declaration list syntaxTree to the IR;
+ * returns them in declaration order. The IR lives until
+ * the next freeNodes, as the tree does
+ */
+IrFunction * lowerProgram(TreeNode * syntaxTree);
+
+/* Function irDominates tells whether block a dominates
+ * block b
+ */
+int irDominates(IrBlock * a, IrBlock * b);
+
+/* Procedure irDump writes the functions to out */
+void irDump(FILE * out, IrFunction * functions);
+
+/* Function irVerify checks the structure of the
+ * functions: blocks ending in one terminator, edges
+ * matching both ways, phis first with a value for each
+ * predecessor, the arity and types of operands, and
+ * every use dominated by its definition. Reports each
+ * error to errors and returns their number
+ */
+int irVerify(IrFunction * functions, FILE * errors);
+
+#endif
@@ -0,0 +1,842 @@
+/****************************************************/
+/* File: jit.c                                      */
+/* In-memory x86-64 code for the C- compiler        */
+/* The code is that of xgen.c, frames, calls and    */
+/* all, encoded by a small instruction encoder into */
+/* a buffer instead of printed. Jumps, calls and    */
+/* global operands are left as fixups, relocated    */
+/* once the code and the globals behind it have     */
+/* their place in the mapping. input and output     */
+/* are called through their addresses in this       */
+/* process                                          */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "cgen.h"
+#include "jit.h"
+#include <stdint.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* the registers, numbered as in the encodings */
+enum {RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, NOREG = -1};
+
+/* the registers of the first arguments, in order */
+static const int argRegs[] = {RDI, RSI, RDX, RCX, R8, R9};
+#define NARGREGS 6
+
+/* the condition codes of jcc and setcc; a code xor 1
+ * is its negation
+ */
+enum {CC_E = 4, CC_NE = 5, CC_L = 12, CC_GE = 13, CC_LE = 14, CC_G = 15};
+
+/* opcodes taking a register and a register or memory
+ * operand; those above 0xFF take two bytes
+ */
+#define ADD_RM  0x03    /* reg += r/m */
+#define SUB_RM  0x2B    /* reg -= r/m */
+#define CMP_RM  0x3B    /* compare reg with r/m */
+#define MOVSXD  0x63    /* reg = sign extended r/m */
+#define TEST    0x85
+#define MOV_MR  0x89    /* r/m = reg */
+#define MOV_RM  0x8B    /* reg = r/m */
+#define LEA     0x8D    /* reg = address of m */
+#define SETCC   0x0F90  /* r/m = condition, plus the code */
+#define IMUL_RM 0x0FAF  /* reg *= r/m */
+#define MOVZB   0x0FB6  /* reg = zero extended r/m byte */
+
+/* the opcode extensions of the immediate forms */
+#define EXT_ADD 0
+#define EXT_SUB 5
+#define EXT_CMP 7
+
+/* Operand is the register or memory operand of an
+ * instruction, or an immediate. A memory operand is
+ * reg + disp, plus index * 4 if it has an index; a
+ * global is the word at byte offset disp of the
+ * globals, addressed from %rip
+ */
+typedef enum {ImmOp, RegOp, MemOp, GlobalOp} OperandKind;
+typedef struct
+{
+    OperandKind kind;
+    int reg;
+    int index;
+    int disp;    /* value of an immediate */
+} Operand;
+
+/* a fixup is a 32-bit field at site, relative to the
+ * end of its instruction, to be set to a label, the
+ * entry of a function or a global
+ */
+typedef enum {LabelFix, CallFix, GlobalFix} FixupKind;
+typedef struct
+{
+    FixupKind kind;
+    int site;
+    int target;  /* label, or offset in the globals */
+    Symbol * fn;
+} Fixup;
+
+struct JitCodeRec
+{
+    unsigned char * base;   /* the code, then the globals */
+    size_t size;            /* bytes mapped */
+    size_t codeSize;        /* bytes mapped executable */
+    int main;               /* offset of main */
+};
+
+/* the code being encoded */
+static THREADLOCAL unsigned char * text = NULL;
+static THREADLOCAL int textLen = 0, textSize = 0;
+
+static THREADLOCAL Fixup * fixups = NULL;
+static THREADLOCAL int nfixups = 0, maxfixups = 0;
+
+/* where each label is in the code */
+static THREADLOCAL int * labelAt = NULL;
+static THREADLOCAL int labels = 0, maxlabels = 0;
+
+/* words pushed on the stack since the prologue */
+static THREADLOCAL int depth = 0;
+
+/* offset of main in the code */
+static THREADLOCAL int mainEntry = 0;
+
+/* prototypes for internal recursive functions */
+static void cGen(TreeNode * tree);
+static void genExp(TreeNode * tree);
+
+/* Procedure byte appends b to the code */
+static void byte(int b)
+{
+    if (textLen == textSize) {
+        textSize = textSize ? 2 * textSize : 4096;
+        text = (unsigned char *) realloc(text,textSize);
+    }
+    text[textLen++] = (unsigned char) b;
+}
+
+/* Procedure word appends the 32 bits of w to the code */
+static void word(int w)
+{
+    byte(w);
+    byte(w >> 8);
+    byte(w >> 16);
+    byte(w >> 24);
+}
+
+/* Procedure fixup records the 32-bit field about to
+ * be appended as a fixup
+ */
+static void fixup(FixupKind kind, int target, Symbol * fn)
+{
+    if (nfixups == maxfixups) {
+        maxfixups = maxfixups ? 2 * maxfixups : 256;
+        fixups = (Fixup *) realloc(fixups,maxfixups * sizeof(Fixup));
+    }
+    fixups[nfixups].kind = kind;
+    fixups[nfixups].site = textLen;
+    fixups[nfixups].target = target;
+    fixups[nfixups].fn = fn;
+    nfixups++;
+}
+
+/* Function newLabel returns a label not yet placed */
+static int newLabel(void)
+{
+    if (labels == maxlabels) {
+        maxlabels = maxlabels ? 2 * maxlabels : 256;
+        labelAt = (int *) realloc(labelAt,maxlabels * sizeof(int));
+    }
+    return labels++;
+}
+
+/* Procedure place puts label at the end of the code */
+static void place(int label)
+{
+    labelAt[label] = textLen;
+}
+
+static Operand imm(int k)
+{
+    Operand x = {ImmOp, NOREG, NOREG, k};
+    return x;
+}
+
+static Operand reg(int r)
+{
+    Operand x = {RegOp, r, NOREG, 0};
+    return x;
+}
+
+static Operand mem(int base, int disp)
+{
+    Operand x = {MemOp, base, NOREG, disp};
+    return x;
+}
+
+/* Function element returns the operand base + index * 4 */
+static Operand element(int base, int index)
+{
+    Operand x = {MemOp, base, index, 0};
+    return x;
+}
+
+/* Function global returns the global word at byte
+ * offset disp
+ */
+static Operand global(int disp)
+{
+    Operand x = {GlobalOp, NOREG, NOREG, disp};
+    return x;
+}
+
+/* Function small tells whether k fits a byte */
+static int small(int k)
+{
+    return k >= -128 && k < 128;
+}
+
+/* Procedure rex emits the REX prefix of the register r
+ * and the operand x, if they need one
+ */
+static void rex(int wide, int r, Operand x)
+{
+    int prefix = 0x40 | (wide ? 8 : 0) | (r & 8 ? 4 : 0);
+    if (x.kind == MemOp && x.index != NOREG && (x.index & 8))
+        prefix |= 2;
+    if ((x.kind == RegOp || x.kind == MemOp) && (x.reg & 8))
+        prefix |= 1;
+    if (prefix != 0x40)
+        byte(prefix);
+}
+
+/* Procedure modrm emits the ModRM byte of the register
+ * r and the operand x, with the SIB byte and the
+ * displacement it needs. A global is left as a fixup;
+ * no instruction has an immediate after one, so its
+ * field ends the instruction
+ */
+static void modrm(int r, Operand x)
+{
+    int base = x.reg & 7, mod;
+    r = (r & 7) << 3;
+    if (x.kind == RegOp) {
+        byte(0xC0 | r | base);
+        return;
+    }
+    if (x.kind == GlobalOp) {
+        byte(0x05 | r);
+        fixup(GlobalFix,x.disp,NULL);
+        word(0);
+        return;
+    }
+    /* [rbp] takes a displacement, [rsp] a SIB byte */
+    if (x.disp == 0 && base != RBP)
+        mod = 0x00;
+    else
+        mod = small(x.disp) ? 0x40 : 0x80;
+    if (x.index == NOREG && base != RSP)
+        byte(mod | r | base);
+    else {
+        byte(mod | r | 4);
+        byte(x.index == NOREG ? 0x20 | base : 0x80 | (x.index & 7) << 3 | base);
+    }
+    if (mod == 0x40)
+        byte(x.disp);
+    else if (mod == 0x80)
+        word(x.disp);
+}
+
+/* Procedure insn emits the instruction op of the
+ * register r and the operand x, on 64 bits if wide
+ */
+static void insn(int wide, int op, int r, Operand x)
+{
+    rex(wide,r,x);
+    if (op > 0xFF)
+        byte(op >> 8);
+    byte(op & 0xFF);
+    modrm(r,x);
+}
+
+/* Procedure aluImm emits the operation ext of the
+ * group of add, sub and cmp on the register r and the
+ * immediate k
+ */
+static void aluImm(int wide, int ext, int r, int k)
+{
+    insn(wide,small(k) ? 0x83 : 0x81,ext,reg(r));
+    if (small(k))
+        byte(k);
+    else
+        word(k);
+}
+
+/* Procedure alu emits the operation op, or ext with an
+ * immediate, of %eax and x
+ */
+static void alu(int op, int ext, Operand x)
+{
+    if (x.kind == ImmOp)
+        aluImm(FALSE,ext,RAX,x.disp);
+    else
+        insn(FALSE,op,RAX,x);
+}
+
+/* Procedure load emits the move of x to the 32-bit
+ * register r
+ */
+static void load(int r, Operand x)
+{
+    if (x.kind == ImmOp) {
+        if (r & 8)
+            byte(0x41);
+        byte(0xB8 | (r & 7));
+        word(x.disp);
+    }
+    else
+        insn(FALSE,MOV_RM,r,x);
+}
+
+/* Procedure push pushes %rax */
+static void push(void)
+{
+    byte(0x50);
+    depth++;
+}
+
+/* Procedure pop pops into the register r */
+static void pop(int r)
+{
+    if (r & 8)
+        byte(0x41);
+    byte(0x58 | (r & 7));
+    depth--;
+}
+
+/* Procedure jump emits a jump to label if the
+ * condition cc holds, or always if cc is negative
+ */
+static void jump(int cc, int label)
+{
+    if (cc < 0)
+        byte(0xE9);
+    else {
+        byte(0x0F);
+        byte(0x80 | cc);
+    }
+    fixup(LabelFix,label,NULL);
+    word(0);
+}
+
+/* Procedure leave emits the epilogue, leave and ret */
+static void leave(void)
+{
+    byte(0xC9);
+    byte(0xC3);
+}
+
+/* Procedure adjustStack adds k to %rsp */
+static void adjustStack(int k)
+{
+    if (k < 0)
+        aluImm(TRUE,EXT_SUB,RSP,-k);
+    else
+        aluImm(TRUE,EXT_ADD,RSP,k);
+}
+
+/* the runtime of the programs run in memory; a runtime
+ * error jumps back to jitRun, with the signal that
+ * raised it or NOINPUT in failure
+ */
+static sigjmp_buf runtimeError;
+static volatile sig_atomic_t failure;
+#define NOINPUT (-1)
+
+static int jitInput(void)
+{
+    int n;
+    if (scanf("%d",&n) != 1) {
+        failure = NOINPUT;
+        siglongjmp(runtimeError,1);
+    }
+    return n;
+}
+
+static void jitOutput(int n)
+{
+    printf("OUT instruction prints: %d\n",n);
+}
+
+/* Function offset returns the offset from %rbp of the
+ * parameter or local s, where element 0 of an array is
+ */
+static int offset(Symbol * s)
+{
+    return -8 * (s->memloc + s->size);
+}
+
+/* Function leaf tells whether t is a number or an int
+ * variable, one operand of an instruction; if so it
+ * sets *x to the operand
+ */
+static int leaf(TreeNode * t, Operand * x)
+{
+    Symbol * s = t->symbol;
+    if (t->nodekind != ExpK)
+        return FALSE;
+    if (t->kind.exp == NumK)
+        *x = imm(t->attr.val);
+    else if (t->kind.exp == IdK && (s->kind == VarSym || s->kind == ParamSym))
+        *x = s->depth == 0 ? global(4 * s->memloc) : mem(RBP,offset(s));
+    else
+        return FALSE;
+    return TRUE;
+}
+
+/* Procedure genBase leaves in %rax the address of
+ * element 0 of the array or array parameter s
+ */
+static void genBase(Symbol * s)
+{
+    if (s->depth == 0)
+        insn(TRUE,LEA,RAX,global(4 * s->memloc));
+    else if (s->kind == ArrParamSym)
+        insn(TRUE,MOV_RM,RAX,mem(RBP,offset(s)));
+    else
+        insn(TRUE,LEA,RAX,mem(RBP,offset(s)));
+}
+
+/* Procedure genIndex leaves in %rax the address of
+ * element 0 of the array t refers to and in %rcx its
+ * index
+ */
+static void genIndex(TreeNode * t)
+{
+    genExp(t->child[0]);
+    insn(TRUE,MOVSXD,RCX,reg(RAX));
+    genBase(t->symbol);
+}
+
+/* Procedure genRight evaluates the right operand t
+ * into %ecx, keeping the left one in %eax
+ */
+static void genRight(TreeNode * t)
+{
+    Operand x;
+    if (leaf(t,&x))
+        load(RCX,x);
+    else {
+        push();
+        genExp(t);
+        insn(FALSE,MOV_RM,RCX,reg(RAX));
+        pop(RAX);
+    }
+}
+
+/* Procedure genCompare compares the operands of the
+ * comparison t, the left one against the right one; an
+ * ordering tests the sign of their wrapped difference,
+ * as the TM does
+ */
+static void genCompare(TreeNode * t)
+{
+    Operand x;
+    TokenType op = t->child[1]->attr.op;
+    genExp(t->child[0]);
+    if (!leaf(t->child[2],&x)) {
+        genRight(t->child[2]);
+        x = reg(RCX);
+    }
+    if (op == EQ || op == NE)
+        alu(CMP_RM,EXT_CMP,x);
+    else {
+        alu(SUB_RM,EXT_SUB,x);
+        insn(FALSE,TEST,RAX,reg(RAX));
+    }
+}
+
+/* Function condition returns the condition code of the
+ * comparison operator op, or of its negation if sense
+ * is not set
+ */
+static int condition(TokenType op, int sense)
+{
+    int cc;
+    switch (op) {
+        case LT: cc = CC_L; break;
+        case LE: cc = CC_LE; break;
+        case GT: cc = CC_G; break;
+        case GE: cc = CC_GE; break;
+        case EQ: cc = CC_E; break;
+        default: cc = CC_NE; break;
+    }
+    return sense ? cc : cc ^ 1;
+}
+
+/* Procedure genCall generates the call t, leaving the
+ * value returned in %eax, with the argument passing of
+ * xgen.c. A call of a function of the program is
+ * relocated once all are placed; input and output are
+ * called at their addresses
+ */
+static void genCall(TreeNode * t)
+{
+    Symbol * s = t->symbol;
+    TreeNode * arg;
+    int n = 0, nstack, pad, i;
+    for (arg = t->child[0]; arg != NULL; arg = arg->sibling)
+        n++;
+    nstack = n > NARGREGS ? n - NARGREGS : 0;
+    pad = (depth + nstack) % 2;
+    if (nstack + pad > 0) {
+        adjustStack(-8 * (nstack + pad));
+        depth += nstack + pad;
+    }
+    for (arg = t->child[0], i = 0; arg != NULL; arg = arg->sibling, i++) {
+        genExp(arg);
+        if (i == n - 1 && i < NARGREGS)
+            insn(TRUE,MOV_MR,RAX,reg(argRegs[i]));
+        else if (i < NARGREGS)
+            push();
+        else
+            insn(TRUE,MOV_MR,RAX,mem(RSP,8 * i));
+    }
+    for (i = (n <= NARGREGS ? n - 1 : NARGREGS) - 1; i >= 0; i--)
+        pop(argRegs[i]);
+    if (s->decl->child[2] == NULL) {
+        /* movabs $address,%rax; call *%rax */
+        uint64_t address = t->child[0] == NULL ? (uint64_t) (uintptr_t) jitInput
+                                               : (uint64_t) (uintptr_t) jitOutput;
+        byte(0x48);
+        byte(0xB8);
+        word((int) address);
+        word((int) (address >> 32));
+        insn(FALSE,0xFF,2,reg(RAX));
+    }
+    else {
+        byte(0xE8);
+        fixup(CallFix,0,s);
+        word(0);
+    }
+    if (nstack + pad > 0) {
+        adjustStack(8 * (nstack + pad));
+        depth -= nstack + pad;
+    }
+}
+
+/* Procedure genExp generates code at an expression
+ * node, leaving its value in %eax, or in %rax the
+ * address an array passes
+ */
+static void genExp(TreeNode * tree)
+{
+    TreeNode * p;
+    Symbol * s = tree->symbol;
+    Operand x;
+    if (tree->nodekind == StmtK) {
+        /* an assignment, whose value is the one assigned */
+        TreeNode * var = tree->child[0];
+        if (var->kind.exp == IdK) {
+            genExp(tree->child[1]);
+            leaf(var,&x);
+            insn(FALSE,MOV_MR,RAX,x);
+        }
+        else if (leaf(tree->child[1],&x)) {
+            genIndex(var);
+            insn(TRUE,LEA,RDX,element(RAX,RCX));
+            load(RAX,x);
+            insn(FALSE,MOV_MR,RAX,mem(RDX,0));
+        }
+        else {
+            genIndex(var);
+            insn(TRUE,LEA,RAX,element(RAX,RCX));
+            push();
+            genExp(tree->child[1]);
+            pop(RDX);
+            insn(FALSE,MOV_MR,RAX,mem(RDX,0));
+        }
+        return;
+    }
+    switch (tree->kind.exp) {
+        case NumK:
+            load(RAX,imm(tree->attr.val));
+            break;
+        case IdK:
+            /* an array passes its address */
+            if (leaf(tree,&x))
+                load(RAX,x);
+            else
+                genBase(s);
+            break;
+        case ArrK:
+            genIndex(tree);
+            load(RAX,element(RAX,RCX));
+            break;
+        case FunCallK:
+            genCall(tree);
+            break;
+        case addK:
+        case mulK:
+            /* operand, operator, operand... */
+            genExp(tree->child[0]);
+            for (p = tree->child[0]->sibling; p != NULL && p->sibling != NULL; p = p->sibling->sibling) {
+                TreeNode * right = p->sibling;
+                if (p->attr.op == OVER) {
+                    genRight(right);
+                    byte(0x99);                     /* cltd */
+                    insn(FALSE,0xF7,7,reg(RCX));    /* idivl %ecx */
+                    continue;
+                }
+                if (!leaf(right,&x)) {
+                    genRight(right);
+                    x = reg(RCX);
+                }
+                switch (p->attr.op) {
+                    case PLUS: alu(ADD_RM,EXT_ADD,x); break;
+                    case MINUS: alu(SUB_RM,EXT_SUB,x); break;
+                    default:
+                        if (x.kind == ImmOp) {
+                            insn(FALSE,small(x.disp) ? 0x6B : 0x69,RAX,reg(RAX));
+                            if (small(x.disp))
+                                byte(x.disp);
+                            else
+                                word(x.disp);
+                        }
+                        else
+                            insn(FALSE,IMUL_RM,RAX,x);
+                        break;
+                }
+            }
+            break;
+        case simpleK:
+            genCompare(tree);
+            insn(FALSE,SETCC | condition(tree->child[1]->attr.op,TRUE),0,reg(RAX));
+            insn(FALSE,MOVZB,RAX,reg(RAX));
+            break;
+        default:
+            break;
+    }
+}
+
+/* Procedure genBranch emits a jump to label taken when
+ * the condition tree is true if sense is set, false
+ * otherwise
+ */
+static void genBranch(TreeNode * tree, int sense, int label)
+{
+    if (tree->nodekind == ExpK && tree->kind.exp == simpleK) {
+        genCompare(tree);
+        jump(condition(tree->child[1]->attr.op,sense),label);
+    }
+    else {
+        genExp(tree);
+        insn(FALSE,TEST,RAX,reg(RAX));
+        jump(sense ? CC_NE : CC_E,label);
+    }
+}
+
+/* Procedure genStmt generates code at a statement node */
+static void genStmt(TreeNode * tree)
+{
+    int label1, label2;
+    switch (tree->kind.stmt) {
+        case CompoundK:
+            cGen(tree->child[1]);
+            break;
+        case IfK:
+            label1 = newLabel();
+            genBranch(tree->child[0],FALSE,label1);
+            cGen(tree->child[1]);
+            if (tree->child[2] != NULL) {
+                label2 = newLabel();
+                jump(-1,label2);
+                place(label1);
+                cGen(tree->child[2]);
+                place(label2);
+            }
+            else
+                place(label1);
+            break;
+        case WhileK:
+            /* the test comes after the body */
+            label1 = newLabel();
+            label2 = newLabel();
+            jump(-1,label2);
+            place(label1);
+            cGen(tree->child[1]);
+            place(label2);
+            genBranch(tree->child[0],TRUE,label1);
+            break;
+        case ReturnK:
+            if (tree->child[0] != NULL)
+                genExp(tree->child[0]);
+            leave();
+            break;
+        default:
+            genExp(tree);
+            break;
+    }
+}
+
+/* Procedure cGen generates code for the statement
+ * list tree
+ */
+static void cGen(TreeNode * tree)
+{
+    for (; tree != NULL; tree = tree->sibling) {
+        if (tree->nodekind == StmtK)
+            genStmt(tree);
+        else
+            genExp(tree);
+    }
+}
+
+/* Procedure genFunction generates code for the
+ * function declaration tree, whose entry becomes the
+ * memloc of its symbol
+ */
+static void genFunction(TreeNode * tree)
+{
+    TreeNode * p;
+    int params = frameWords(tree->child[1]), locals = frameWords(tree->child[2]);
+    int words = params > locals ? params : locals, i = 0;
+    tree->symbol->memloc = textLen;
+    if (strcmp(tree->attr.name,"main") == 0)
+        mainEntry = textLen;
+    byte(0x55);                                 /* pushq %rbp */
+    insn(TRUE,MOV_MR,RSP,reg(RBP));             /* movq %rsp,%rbp */
+    if (words > 0)
+        adjustStack(-16 * ((words + 1) / 2));
+    for (p = tree->child[1]; p != NULL; p = p->sibling, i++) {
+        if (p->nodekind != DeclK || p->symbol == NULL)
+            break;
+        if (i < NARGREGS)
+            insn(TRUE,MOV_MR,argRegs[i],mem(RBP,offset(p->symbol)));
+        else {
+            insn(TRUE,MOV_RM,RAX,mem(RBP,16 + 8 * (i - NARGREGS)));
+            insn(TRUE,MOV_MR,RAX,mem(RBP,offset(p->symbol)));
+        }
+    }
+    depth = 0;
+    cGen(tree->child[2]);
+    /* a function may end without return */
+    leave();
+}
+
+/* Procedure relocate sets every fixup of the code, whose
+ * globals start at byte data
+ */
+static void relocate(int data)
+{
+    int i, target;
+    for (i = 0; i < nfixups; i++) {
+        Fixup * f = &fixups[i];
+        switch (f->kind) {
+            case LabelFix: target = labelAt[f->target]; break;
+            case CallFix: target = f->fn->memloc; break;
+            default: target = data + f->target; break;
+        }
+        target -= f->site + 4;
+        text[f->site] = (unsigned char) target;
+        text[f->site + 1] = (unsigned char) (target >> 8);
+        text[f->site + 2] = (unsigned char) (target >> 16);
+        text[f->site + 3] = (unsigned char) (target >> 24);
+    }
+}
+
+JitCode * jitCompile(TreeNode * syntaxTree)
+{
+    TreeNode * t;
+    JitCode * p;
+    size_t page = sysconf(_SC_PAGESIZE), globals = 0;
+    void * base;
+#if !defined(__x86_64__)
+    return NULL;
+#endif
+    textLen = nfixups = labels = 0;
+    for (t = syntaxTree; t != NULL; t = t->sibling) {
+        if (t->kind.decl == FunK)
+            genFunction(t);
+        else if (4 * (size_t) (t->symbol->memloc + t->symbol->size) > globals)
+            globals = 4 * (t->symbol->memloc + t->symbol->size);
+    }
+    p = (JitCode *) malloc(sizeof(JitCode));
+    p->codeSize = (textLen + page - 1) / page * page;
+    p->size = p->codeSize + (globals + page - 1) / page * page;
+    p->main = mainEntry;
+    /* the globals are the zeroed pages after the code */
+    base = mmap(NULL,p->size,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+    if (base == MAP_FAILED) {
+        free(p);
+        return NULL;
+    }
+    p->base = (unsigned char *) base;
+    relocate(p->codeSize);
+    memcpy(p->base,text,textLen);
+    if (mprotect(p->base,p->codeSize,PROT_READ | PROT_EXEC) != 0) {
+        jitFree(p);
+        return NULL;
+    }
+    return p;
+}
+
+/* Procedure trap ends the run at a signal */
+static void trap(int sig)
+{
+    failure = sig;
+    siglongjmp(runtimeError,1);
+}
+
+int jitRun(JitCode * p)
+{
+    void (*entry)(void) = (void (*)(void)) (p->base + p->main);
+    struct sigaction sa, oldFpe, oldSegv;
+    stack_t ss;
+    /* a stack overflow is caught on a stack of its own */
+    ss.ss_size = SIGSTKSZ;
+    ss.ss_sp = malloc(ss.ss_size);
+    ss.ss_flags = 0;
+    sigaltstack(&ss,NULL);
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler = trap;
+    sa.sa_flags = SA_ONSTACK;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGFPE,&sa,&oldFpe);
+    sigaction(SIGSEGV,&sa,&oldSegv);
+    failure = 0;
+    if (sigsetjmp(runtimeError,1) == 0)
+        entry();
+    sigaction(SIGFPE,&oldFpe,NULL);
+    sigaction(SIGSEGV,&oldSegv,NULL);
+    ss.ss_flags = SS_DISABLE;
+    sigaltstack(&ss,NULL);
+    free(ss.ss_sp);
+    fflush(stdout);
+    switch (failure) {
+        case 0:
+            return 0;
+        case NOINPUT:
+            fprintf(stderr,"Runtime error: no integer to input\n");
+            break;
+        case SIGFPE:
+            fprintf(stderr,"Runtime error: division by zero\n");
+            break;
+        default:
+            fprintf(stderr,"Runtime error: stack overflow or memory access out of bounds\n");
+            break;
+    }
+    return 2;
+}
+
+void jitFree(JitCode * p)
+{
+    munmap(p->base,p->size);
+    free(p);
+}
@@ -0,0 +1,34 @@
+/****************************************************/
+/* File: jit.h                                      */
+/* In-memory x86-64 code for the C- compiler        */
+/* (--run): the analyzed tree is encoded straight   */
+/* to machine code in an executable mapping and     */
+/* run, with no assembler, linker or code file      */
+/****************************************************/
+
+#ifndef _JIT_H_
+#define _JIT_H_
+
+/* JitCode is a program encoded in memory, its code
+ * and its globals
+ */
+typedef struct JitCodeRec JitCode;
+
+/* Function jitCompile encodes the analyzed syntaxTree,
+ * with the frames and calls of the x86-64 target; returns
+ * NULL if the code cannot be mapped, or on a host that
+ * is not x86-64
+ */
+JitCode * jitCompile(TreeNode * syntaxTree);
+
+/* Function jitRun calls main of the program p; input
+ * and output read stdin and print as the TM does. Returns
+ * 0, or 2 after a runtime error, which it reports on
+ * stderr
+ */
+int jitRun(JitCode * p);
+
+/* Procedure jitFree unmaps the program p */
+void jitFree(JitCode * p);
+
+#endif
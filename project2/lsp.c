@@ -0,0 +1,941 @@
+/****************************************************/
+/* File: lsp.c                                      */
+/* Language Server Protocol mode: JSON-RPC over     */
+/* standard input and output, publishing syntax     */
+/* diagnostics, document symbols and definitions    */
+/* A document is kept as a list of chunks, one per  */
+/* top-level declaration, each with its own syntax  */
+/* tree. An edit reparses only the chunks it        */
+/* overlaps; the trees of the others are reused     */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "scan.h"
+#include "parse.h"
+#include "stats.h"
+#include "compile.h"
+#include <strings.h>
+#include <errno.h>
+
+/* the node blocks are compacted by reparsing every open
+ * document once this many nodes are unreachable, and
+ * more of them are garbage than alive
+ */
+#define GARBAGELIMIT (1 << 20)
+
+/* LSP symbol kinds */
+#define SYMBOLFUNCTION 12
+#define SYMBOLVARIABLE 13
+
+/* messages longer than this are refused */
+#define MAXMESSAGE (64L << 20)
+
+/* A chunk is the text of one top-level declaration:
+ * it runs from the end of the previous one up to and
+ * including the ';' or '}' that closes it at brace
+ * depth 0. Only the last chunk may be left unclosed
+ */
+typedef struct
+{
+    int start, end;   /* byte range in the document */
+    int line;         /* line of start, from 0 */
+    int lines;        /* newlines within the range */
+    int closed;       /* ends at a declaration boundary */
+    int empty;        /* only blanks and comments */
+    TreeNode * tree;  /* NULL if empty or not parsed */
+    unsigned long nodes; /* nodes allocated by its parse */
+    int errorLine;    /* line of its syntax error, or -1 */
+    char * error;     /* message of its syntax error */
+} Chunk;
+
+typedef struct document
+{
+    char * uri;
+    char * text;
+    int len, size;
+    Chunk * chunks;
+    int nchunks, maxchunks;
+    struct document * next;
+} Document;
+
+static Document * documents = NULL;
+static unsigned long liveNodes = 0, garbageNodes = 0;
+
+/**************************************************/
+/*************   JSON reading          ************/
+/**************************************************/
+
+static const char * skipSpace(const char * p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        p++;
+    return p;
+}
+
+/* Function skipValue returns the end of the JSON value
+ * starting at p
+ */
+static const char * skipValue(const char * p)
+{
+    p = skipSpace(p);
+    if (*p == '"') {
+        for (p++; *p != '\0' && *p != '"'; p++)
+            if (*p == '\\' && p[1] != '\0')
+                p++;
+        return *p == '"' ? p + 1 : p;
+    }
+    if (*p == '{' || *p == '[') {
+        char close = *p == '{' ? '}' : ']';
+        p = skipSpace(p + 1);
+        while (*p != '\0' && *p != close) {
+            p = skipValue(p);
+            p = skipSpace(p);
+            if (*p == ':' || *p == ',')
+                p = skipSpace(p + 1);
+        }
+        return *p == close ? p + 1 : p;
+    }
+    while (*p != '\0' && strchr(",}] \t\r\n",*p) == NULL)
+        p++;
+    return p;
+}
+
+/* Function member returns the value of key in the JSON
+ * object at obj, or NULL if obj has no such member
+ */
+static const char * member(const char * obj, const char * key)
+{
+    size_t keylen = strlen(key);
+    if (obj == NULL || *(obj = skipSpace(obj)) != '{')
+        return NULL;
+    obj = skipSpace(obj + 1);
+    while (*obj == '"') {
+        const char * name = obj + 1;
+        const char * value;
+        obj = skipValue(obj);
+        value = skipSpace(obj);
+        if (*value != ':')
+            return NULL;
+        value = skipSpace(value + 1);
+        if ((size_t) (obj - name - 1) == keylen && strncmp(name,key,keylen) == 0)
+            return value;
+        obj = skipSpace(skipValue(value));
+        if (*obj == ',')
+            obj = skipSpace(obj + 1);
+    }
+    return NULL;
+}
+
+static long numberValue(const char * p, long otherwise)
+{
+    return p != NULL && (isdigit((unsigned char) *p) || *p == '-') ? strtol(p,NULL,10) : otherwise;
+}
+
+/* Function stringValue returns a newly allocated copy of
+ * the JSON string at p with its escapes decoded, and its
+ * length in len. A truncated escape at the end of the
+ * message ends the string; a \u with fewer than 4 hex
+ * digits takes those there are, and one with none
+ * stands for '?'
+ */
+static char * stringValue(const char * p, int * len)
+{
+    char * s, * q;
+    if (p == NULL || *p != '"')
+        return NULL;
+    s = q = (char *) malloc(skipValue(p) - p);
+    if (s == NULL)
+        return NULL;
+    for (p++; *p != '\0' && *p != '"'; p++) {
+        unsigned c;
+        int n;
+        if (*p != '\\') {
+            *q++ = *p;
+            continue;
+        }
+        if (p[1] == '\0')
+            break;
+        switch (*++p) {
+            case 'n': *q++ = '\n'; break;
+            case 't': *q++ = '\t'; break;
+            case 'r': *q++ = '\r'; break;
+            case 'b': *q++ = '\b'; break;
+            case 'f': *q++ = '\f'; break;
+            case 'u':
+                /* sscanf stops at the closing quote or the end */
+                if (sscanf(p + 1,"%4x%n",&c,&n) != 1) {
+                    c = '?';
+                    n = 0;
+                }
+                p += n;
+                if (c < 0x80)
+                    *q++ = c;
+                else if (c < 0x800) {
+                    *q++ = 0xC0 | c >> 6;
+                    *q++ = 0x80 | (c & 0x3F);
+                } else {
+                    *q++ = 0xE0 | c >> 12;
+                    *q++ = 0x80 | (c >> 6 & 0x3F);
+                    *q++ = 0x80 | (c & 0x3F);
+                }
+                break;
+            default: *q++ = *p; break;
+        }
+    }
+    *q = '\0';
+    if (len != NULL)
+        *len = q - s;
+    return s;
+}
+
+/**************************************************/
+/*************   JSON writing          ************/
+/**************************************************/
+
+static void putString(FILE * out, const char * s)
+{
+    putc('"',out);
+    for (; *s != '\0'; s++)
+        if (*s == '"' || *s == '\\')
+            fprintf(out,"\\%c",*s);
+        else if (*s == '\n')
+            fputs("\\n",out);
+        else if ((unsigned char) *s < 0x20)
+            fprintf(out,"\\u%04x",*s);
+        else
+            putc(*s,out);
+    putc('"',out);
+}
+
+static void putRange(FILE * out, int line1, int char1, int line2, int char2)
+{
+    fprintf(out,"{\"start\":{\"line\":%d,\"character\":%d},"
+                "\"end\":{\"line\":%d,\"character\":%d}}",line1,char1,line2,char2);
+}
+
+/* Procedure sendMessage frames the JSON body with its
+ * Content-Length header on standard output
+ */
+static void sendMessage(const char * body, size_t len)
+{
+    fprintf(stdout,"Content-Length: %zu\r\n\r\n",len);
+    fwrite(body,1,len,stdout);
+    fflush(stdout);
+}
+
+/* Function startMessage opens a memory stream holding a
+ * response to the request id, or a notification if id
+ * is NULL; finishMessage closes and sends it
+ */
+static FILE * startMessage(const char * id, char ** body, size_t * len)
+{
+    FILE * out = open_memstream(body,len);
+    fputs("{\"jsonrpc\":\"2.0\",",out);
+    if (id != NULL)
+        fprintf(out,"\"id\":%.*s,\"result\":",(int) (skipValue(id) - id),id);
+    return out;
+}
+
+static void finishMessage(FILE * out, char ** body, size_t * len)
+{
+    fputc('}',out);
+    fclose(out);
+    sendMessage(*body,*len);
+    free(*body);
+}
+
+/**************************************************/
+/*************   Chunks                ************/
+/**************************************************/
+
+/* Function splitChunk fills in c with the chunk that
+ * starts at start, which must be a declaration boundary
+ */
+static void splitChunk(const char * text, int len, int start, int line, Chunk * c)
+{
+    int p = start, depth = 0;
+    c->start = start;
+    c->line = line;
+    c->lines = 0;
+    c->closed = FALSE;
+    c->empty = TRUE;
+    c->tree = NULL;
+    c->nodes = 0;
+    c->errorLine = -1;
+    c->error = NULL;
+    while (p < len && !c->closed) {
+        char ch = text[p++];
+        if (ch == '\n')
+            c->lines++;
+        else if (ch == ' ' || ch == '\t' || ch == '\r')
+            continue;
+        else if (ch == '/' && p < len && text[p] == '*') {
+            for (p++; p < len && !(text[p] == '*' && p + 1 < len && text[p+1] == '/'); p++)
+                if (text[p] == '\n')
+                    c->lines++;
+            p = p < len ? p + 2 : len;
+        }
+        else {
+            c->empty = FALSE;
+            if (ch == '{')
+                depth++;
+            else if (ch == '}' && --depth <= 0)
+                c->closed = TRUE;
+            else if (ch == ';' && depth == 0)
+                c->closed = TRUE;
+        }
+    }
+    c->end = p;
+}
+
+/* Procedure parseChunk parses the text of c on its own,
+ * with the listing captured to recover its syntax error
+ */
+static void parseChunk(Document * doc, Chunk * c)
+{
+    char * text;
+    size_t textlen;
+    unsigned long before = nodeCount;
+    int errline;
+    if (c->empty)
+        return;
+    source = fmemopen(doc->text + c->start,c->end - c->start,"r");
+    listing = open_memstream(&text,&textlen);
+    lineno = 0;
+    Error = FALSE;
+    c->tree = parse();
+    resetScanner();
+    fclose(source);
+    fclose(listing);
+    c->nodes = nodeCount - before;
+    liveNodes += c->nodes;
+    if (Error && sscanf(text,"Syntax error at line %d",&errline) == 1) {
+        /* "Current token: " is followed by the tab separated
+         * output of printToken, empty at the end of input */
+        char * token = strstr(text,"Current token: ");
+        char * q;
+        int n = 0;
+        c->tree = NULL;
+        c->errorLine = c->line + errline - 1;
+        c->error = (char *) malloc(textlen + 32);
+        q = c->error + sprintf(c->error,"syntax error at ");
+        for (token = token != NULL ? token + 15 : ""; *token != '\0'; token++)
+            if (!isspace((unsigned char) *token))
+                q[n++] = *token;
+            else if (n > 0 && q[n-1] != ' ')
+                q[n++] = ' ';
+        if (n > 0 && q[n-1] == ' ')
+            n--;
+        strcpy(q + n,n > 0 ? "" : "end of declaration");
+    }
+    free(text);
+}
+
+static void dropChunk(Chunk * c)
+{
+    liveNodes -= c->nodes;
+    garbageNodes += c->nodes;
+    free(c->error);
+}
+
+static void growChunks(Document * doc, int n)
+{
+    if (n > doc->maxchunks) {
+        doc->maxchunks = n + n / 2 + 16;
+        doc->chunks = (Chunk *) realloc(doc->chunks,doc->maxchunks * sizeof(Chunk));
+    }
+}
+
+/* Procedure reparseAll parses every chunk of every open
+ * document afresh; run on a clean arena it compacts the
+ * syntax trees
+ */
+static void reparseAll(void)
+{
+    Document * doc;
+    int i;
+    freeNodes();
+    liveNodes = garbageNodes = 0;
+    for (doc = documents; doc != NULL; doc = doc->next)
+        for (i = 0; i < doc->nchunks; i++) {
+            free(doc->chunks[i].error);
+            doc->chunks[i].error = NULL;
+            doc->chunks[i].errorLine = -1;
+            doc->chunks[i].nodes = 0;
+            parseChunk(doc,&doc->chunks[i]);
+        }
+}
+
+/* Function chunkAt returns the index of the chunk that
+ * holds byte offset, or nchunks past the last one
+ */
+static int chunkAt(Document * doc, int offset)
+{
+    int lo = 0, hi = doc->nchunks;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (doc->chunks[mid].end <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Function offsetOf converts a line and character into
+ * a byte offset. C- sources are ASCII, so characters
+ * and UTF-16 code units are bytes
+ */
+static int offsetOf(Document * doc, int line, int character)
+{
+    int lo = 0, hi = doc->nchunks, p = 0, l = 0;
+    /* start from the last chunk beginning on an earlier
+     * line, as chunks may begin in the middle of a line */
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (doc->chunks[mid].line < line)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo > 0) {
+        p = doc->chunks[lo-1].start;
+        l = doc->chunks[lo-1].line;
+    }
+    while (l < line && p < doc->len)
+        if (doc->text[p++] == '\n')
+            l++;
+    while (character-- > 0 && p < doc->len && doc->text[p] != '\n')
+        p++;
+    return p;
+}
+
+/* Procedure positionOf converts a byte offset into a
+ * line and character
+ */
+static void positionOf(Document * doc, int offset, int * line, int * character)
+{
+    int i = chunkAt(doc,offset), p, lineStart;
+    if (i == doc->nchunks)
+        i--;
+    if (i < 0) {
+        *line = *character = 0;
+        return;
+    }
+    *line = doc->chunks[i].line;
+    for (p = lineStart = doc->chunks[i].start; p < offset; p++)
+        if (doc->text[p] == '\n') {
+            (*line)++;
+            lineStart = p + 1;
+        }
+    while (lineStart > 0 && doc->text[lineStart-1] != '\n')
+        lineStart--;
+    *character = offset - lineStart;
+}
+
+/* Function nameColumn returns the column of the word
+ * name on line, or 0 if the line does not hold it
+ */
+static int nameColumn(Document * doc, int line, const char * name)
+{
+    int start = offsetOf(doc,line,0), p = start;
+    size_t n = strlen(name);
+    while (p < doc->len && doc->text[p] != '\n') {
+        if (isalpha((unsigned char) doc->text[p])) {
+            int q = p;
+            while (q < doc->len && isalpha((unsigned char) doc->text[q]))
+                q++;
+            if ((size_t) (q - p) == n && strncmp(doc->text + p,name,n) == 0)
+                return p - start;
+            p = q;
+        }
+        else
+            p++;
+    }
+    return 0;
+}
+
+/* Procedure applyEdit replaces the bytes [from,to) with
+ * the n bytes of text, then resplits and reparses from
+ * the first chunk the edit touches until a boundary of
+ * the new text falls on an old boundary past the edit;
+ * all later chunks keep their trees
+ */
+static void applyEdit(Document * doc, int from, int to, const char * text, int n)
+{
+    int delta = n - (to - from), lineDelta = 0;
+    int first, last, pos, line, i, nnew = 0, maxnew = 8;
+    Chunk * fresh = (Chunk *) malloc(maxnew * sizeof(Chunk));
+    for (i = from; i < to; i++)
+        if (doc->text[i] == '\n')
+            lineDelta--;
+    for (i = 0; i < n; i++)
+        if (text[i] == '\n')
+            lineDelta++;
+    first = chunkAt(doc,from);
+    if (first == doc->nchunks && first > 0 && !doc->chunks[first-1].closed)
+        first--;
+    if (first < doc->nchunks) {
+        pos = doc->chunks[first].start;
+        line = doc->chunks[first].line;
+    } else {
+        pos = doc->len;
+        line = first > 0 ? doc->chunks[first-1].line + doc->chunks[first-1].lines : 0;
+    }
+
+    if (doc->len + delta + 1 > doc->size) {
+        doc->size = (doc->len + delta + 1) * 2;
+        doc->text = (char *) realloc(doc->text,doc->size);
+    }
+    memmove(doc->text + to + delta,doc->text + to,doc->len - to);
+    memcpy(doc->text + from,text,n);
+    doc->len += delta;
+    doc->text[doc->len] = '\0';
+
+    last = first;
+    while (pos < doc->len) {
+        if (nnew == maxnew)
+            fresh = (Chunk *) realloc(fresh,(maxnew *= 2) * sizeof(Chunk));
+        splitChunk(doc->text,doc->len,pos,line,&fresh[nnew]);
+        pos = fresh[nnew].end;
+        line += fresh[nnew].lines;
+        nnew++;
+        if (pos < from + n)
+            continue;
+        while (last < doc->nchunks &&
+               (doc->chunks[last].end < to || doc->chunks[last].end + delta < pos))
+            last++;
+        if (last < doc->nchunks && doc->chunks[last].end + delta == pos) {
+            last++;
+            break;
+        }
+    }
+    if (pos >= doc->len)
+        last = doc->nchunks;
+
+    for (i = first; i < last; i++)
+        dropChunk(&doc->chunks[i]);
+    growChunks(doc,doc->nchunks - (last - first) + nnew);
+    memmove(doc->chunks + first + nnew,doc->chunks + last,
+            (doc->nchunks - last) * sizeof(Chunk));
+    doc->nchunks += nnew - (last - first);
+    for (i = first + nnew; i < doc->nchunks; i++) {
+        doc->chunks[i].start += delta;
+        doc->chunks[i].end += delta;
+        doc->chunks[i].line += lineDelta;
+        if (doc->chunks[i].errorLine >= 0)
+            doc->chunks[i].errorLine += lineDelta;
+    }
+    if (garbageNodes > GARBAGELIMIT && garbageNodes > liveNodes) {
+        memcpy(doc->chunks + first,fresh,nnew * sizeof(Chunk));
+        reparseAll();
+    } else
+        for (i = 0; i < nnew; i++) {
+            doc->chunks[first+i] = fresh[i];
+            parseChunk(doc,&doc->chunks[first+i]);
+        }
+    free(fresh);
+}
+
+/**************************************************/
+/*************   Documents             ************/
+/**************************************************/
+
+static Document * findDocument(const char * params)
+{
+    char * uri = stringValue(member(member(params,"textDocument"),"uri"),NULL);
+    Document * doc;
+    if (uri == NULL)
+        return NULL;
+    for (doc = documents; doc != NULL; doc = doc->next)
+        if (strcmp(doc->uri,uri) == 0)
+            break;
+    free(uri);
+    return doc;
+}
+
+static void publishDiagnostics(Document * doc, int closing)
+{
+    char * body;
+    size_t len;
+    FILE * out = startMessage(NULL,&body,&len);
+    int i, n = 0;
+    fputs("\"method\":\"textDocument/publishDiagnostics\",\"params\":{\"uri\":",out);
+    putString(out,doc->uri);
+    fputs(",\"diagnostics\":[",out);
+    for (i = 0; !closing && i < doc->nchunks; i++)
+        if (doc->chunks[i].error != NULL) {
+            fputs(n++ > 0 ? ",{\"range\":" : "{\"range\":",out);
+            putRange(out,doc->chunks[i].errorLine,0,doc->chunks[i].errorLine + 1,0);
+            fputs(",\"severity\":1,\"source\":\"hw2\",\"message\":",out);
+            putString(out,doc->chunks[i].error);
+            fputc('}',out);
+        }
+    fputs("]}",out);
+    finishMessage(out,&body,&len);
+}
+
+static void didOpen(const char * params)
+{
+    const char * item = member(params,"textDocument");
+    Document * doc = (Document *) calloc(1,sizeof(Document));
+    int len = 0;
+    char * text = stringValue(member(item,"text"),&len);
+    doc->uri = stringValue(member(item,"uri"),NULL);
+    if (doc->uri == NULL) {
+        free(doc);
+        free(text);
+        return;
+    }
+    doc->size = 1;
+    doc->text = (char *) malloc(doc->size);
+    doc->text[0] = '\0';
+    doc->next = documents;
+    documents = doc;
+    applyEdit(doc,0,0,text != NULL ? text : "",len);
+    free(text);
+    publishDiagnostics(doc,FALSE);
+}
+
+static void didChange(const char * params)
+{
+    Document * doc = findDocument(params);
+    const char * change = member(params,"contentChanges");
+    if (doc == NULL || change == NULL || *change != '[')
+        return;
+    for (change = skipSpace(change + 1); *change == '{'; ) {
+        const char * range = member(change,"range");
+        int len = 0, from = 0, to = doc->len;
+        char * text = stringValue(member(change,"text"),&len);
+        if (range != NULL) {
+            const char * start = member(range,"start"), * end = member(range,"end");
+            from = offsetOf(doc,numberValue(member(start,"line"),0),
+                            numberValue(member(start,"character"),0));
+            to = offsetOf(doc,numberValue(member(end,"line"),0),
+                          numberValue(member(end,"character"),0));
+            if (to < from)
+                to = from;
+        }
+        if (text != NULL)
+            applyEdit(doc,from,to,text,len);
+        free(text);
+        change = skipSpace(skipValue(change));
+        if (*change == ',')
+            change = skipSpace(change + 1);
+    }
+    publishDiagnostics(doc,FALSE);
+}
+
+static void didClose(const char * params)
+{
+    Document * doc = findDocument(params), ** link;
+    int i;
+    if (doc == NULL)
+        return;
+    publishDiagnostics(doc,TRUE);
+    for (link = &documents; *link != doc; link = &(*link)->next)
+        ;
+    *link = doc->next;
+    for (i = 0; i < doc->nchunks; i++)
+        dropChunk(&doc->chunks[i]);
+    free(doc->chunks);
+    free(doc->text);
+    free(doc->uri);
+    free(doc);
+}
+
+/**************************************************/
+/*************   Requests              ************/
+/**************************************************/
+
+/* Procedure putSymbol writes the DocumentSymbol of the
+ * declaration t; the range of a global runs to the end
+ * of its chunk, locals cover their line
+ */
+static void putSymbol(FILE * out, Document * doc, TreeNode * t, int line, int endOffset)
+{
+    int column = nameColumn(doc,line,t->attr.name);
+    int endLine = line + 1, endChar = 0;
+    if (endOffset >= 0)
+        positionOf(doc,endOffset,&endLine,&endChar);
+    fputs("{\"name\":",out);
+    putString(out,t->attr.name);
+    fprintf(out,",\"kind\":%d,\"range\":",t->kind.decl == FunK ? SYMBOLFUNCTION : SYMBOLVARIABLE);
+    putRange(out,line,0,endLine,endChar);
+    fputs(",\"selectionRange\":",out);
+    putRange(out,line,column,line,column + (int) strlen(t->attr.name));
+}
+
+/* Procedure putLocals writes the local declarations
+ * found anywhere in the statement list t
+ */
+static int putLocals(FILE * out, Document * doc, Chunk * c, TreeNode * t, int n)
+{
+    int i;
+    for (; t != NULL; t = t->sibling) {
+        if (t->nodekind == DeclK && (t->kind.decl == VarK || t->kind.decl == ArrVarK)) {
+            fputs(n++ > 0 ? "," : "",out);
+            putSymbol(out,doc,t,c->line + t->lineno - 1,-1);
+            fputc('}',out);
+        }
+        if (t->nodekind != ExpK)
+            for (i = 0; i < MAXCHILDREN; i++)
+                n = putLocals(out,doc,c,t->child[i],n);
+    }
+    return n;
+}
+
+static void documentSymbol(const char * id, const char * params)
+{
+    Document * doc = findDocument(params);
+    char * body;
+    size_t len;
+    FILE * out = startMessage(id,&body,&len);
+    int i, n = 0;
+    TreeNode * t;
+    fputc('[',out);
+    for (i = 0; doc != NULL && i < doc->nchunks; i++) {
+        Chunk * c = &doc->chunks[i];
+        for (t = c->tree; t != NULL; t = t->sibling) {
+            if (t->nodekind != DeclK)
+                continue;
+            fputs(n++ > 0 ? "," : "",out);
+            putSymbol(out,doc,t,c->line + t->lineno - 1,c->end);
+            if (t->kind.decl == FunK) {
+                fputs(",\"children\":[",out);
+                putLocals(out,doc,c,t->child[2],0);
+                fputc(']',out);
+            }
+            fputc('}',out);
+        }
+    }
+    fputc(']',out);
+    finishMessage(out,&body,&len);
+}
+
+/* Function findLocal returns the declaration of name in
+ * the statement list t nearest before line, if any; C-
+ * declares locals at the top of compound statements, so
+ * the nearest one before the use is the one in scope
+ * unless a nested block has already closed
+ */
+static TreeNode * findLocal(TreeNode * t, const char * name, int line, TreeNode * best)
+{
+    int i;
+    for (; t != NULL; t = t->sibling) {
+        if (t->nodekind == DeclK && t->attr.name == name && t->lineno <= line &&
+            (best == NULL || t->lineno >= best->lineno))
+            best = t;
+        if (t->nodekind != ExpK)
+            for (i = 0; i < MAXCHILDREN; i++)
+                best = findLocal(t->child[i],name,line,best);
+    }
+    return best;
+}
+
+static void definition(const char * id, const char * params)
+{
+    Document * doc = findDocument(params);
+    const char * position = member(params,"position");
+    char * body, * name;
+    size_t len;
+    FILE * out = startMessage(id,&body,&len);
+    TreeNode * found = NULL, * t;
+    Chunk * where = NULL;
+    int offset, start, end, i;
+    if (doc == NULL) {
+        fputs("null",out);
+        finishMessage(out,&body,&len);
+        return;
+    }
+    offset = offsetOf(doc,numberValue(member(position,"line"),0),
+                      numberValue(member(position,"character"),0));
+    for (start = offset; start > 0 && isalpha((unsigned char) doc->text[start-1]); start--)
+        ;
+    for (end = offset; end < doc->len && isalpha((unsigned char) doc->text[end]); end++)
+        ;
+    if (end > start) {
+        char saved = doc->text[end];
+        doc->text[end] = '\0';
+        name = internString(doc->text + start);
+        doc->text[end] = saved;
+        i = chunkAt(doc,start);
+        if (i < doc->nchunks && (t = doc->chunks[i].tree) != NULL &&
+            t->nodekind == DeclK && t->kind.decl == FunK) {
+            int line = 0, character;
+            positionOf(doc,start,&line,&character);
+            line = line - doc->chunks[i].line + 1;
+            found = findLocal(t->child[1],name,line,NULL);
+            found = findLocal(t->child[2],name,line,found);
+            where = &doc->chunks[i];
+        }
+        for (i = 0; found == NULL && i < doc->nchunks; i++)
+            for (t = doc->chunks[i].tree; t != NULL; t = t->sibling)
+                if (t->nodekind == DeclK && t->attr.name == name) {
+                    found = t;
+                    where = &doc->chunks[i];
+                    break;
+                }
+    }
+    if (found == NULL)
+        fputs("null",out);
+    else {
+        int line = where->line + found->lineno - 1;
+        int column = nameColumn(doc,line,found->attr.name);
+        fputs("{\"uri\":",out);
+        putString(out,doc->uri);
+        fputs(",\"range\":",out);
+        putRange(out,line,column,line,column + (int) strlen(found->attr.name));
+        fputc('}',out);
+    }
+    finishMessage(out,&body,&len);
+}
+
+static void initialize(const char * id)
+{
+    char * body;
+    size_t len;
+    FILE * out = startMessage(id,&body,&len);
+    fputs("{\"capabilities\":{\"textDocumentSync\":{\"openClose\":true,\"change\":2},"
+          "\"documentSymbolProvider\":true,\"definitionProvider\":true},"
+          "\"serverInfo\":{\"name\":\"hw2_binary\"}}",out);
+    finishMessage(out,&body,&len);
+}
+
+static void respondNull(const char * id)
+{
+    char * body;
+    size_t len;
+    FILE * out = startMessage(id,&body,&len);
+    fputs("null",out);
+    finishMessage(out,&body,&len);
+}
+
+/* Procedure respondError answers the request id, or
+ * with a null id if it is NULL, with the error code
+ */
+static void respondError(const char * id, int code, const char * message)
+{
+    char * body;
+    size_t len;
+    FILE * out = open_memstream(&body,&len);
+    if (id == NULL)
+        id = "null";
+    fprintf(out,"{\"jsonrpc\":\"2.0\",\"id\":%.*s,"
+                "\"error\":{\"code\":%d,\"message\":\"%s\"}}",
+            (int) (skipValue(id) - id),id,code,message);
+    fclose(out);
+    sendMessage(body,len);
+    free(body);
+}
+
+static void methodNotFound(const char * id)
+{
+    respondError(id,-32601,"method not found");
+}
+
+/* Function skipBody reads and drops the length bytes
+ * of a refused message; returns FALSE at end of input
+ */
+static int skipBody(long length)
+{
+    char buf[4096];
+    while (length > 0) {
+        size_t take = length < (long) sizeof(buf) ? (size_t) length : sizeof(buf);
+        if (fread(buf,1,take,stdin) != take)
+            return FALSE;
+        length -= (long) take;
+    }
+    return TRUE;
+}
+
+/* Function readMessage reads one framed JSON-RPC message
+ * from standard input; returns NULL at end of input. A
+ * message whose Content-Length is not a number, or is
+ * over MAXMESSAGE or cannot be allocated, is answered
+ * with an error and skipped as far as its length allows
+ */
+static char * readMessage(void)
+{
+    char header[256];
+    long length = -1;
+    int invalid = FALSE;
+    char * body;
+    while (fgets(header,sizeof(header),stdin) != NULL) {
+        if (strcmp(header,"\r\n") == 0 || strcmp(header,"\n") == 0) {
+            if (invalid) {
+                respondError(NULL,-32600,"invalid Content-Length");
+                invalid = FALSE;
+                continue;
+            }
+            if (length < 0)
+                continue;
+            body = length > MAXMESSAGE ? NULL : (char *) malloc(length + 1);
+            if (body == NULL) {
+                respondError(NULL,-32600,length > MAXMESSAGE ? "message too large" : "out of memory");
+                if (!skipBody(length))
+                    return NULL;
+                length = -1;
+                continue;
+            }
+            if (fread(body,1,length,stdin) != (size_t) length) {
+                free(body);
+                return NULL;
+            }
+            body[length] = '\0';
+            return body;
+        }
+        if (strncasecmp(header,"Content-Length:",15) == 0) {
+            char * end;
+            errno = 0;
+            length = strtol(header + 15,&end,10);
+            while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n')
+                end++;
+            invalid = end == header + 15 || *end != '\0' || errno != 0 || length < 0;
+            if (invalid)
+                length = -1;
+        }
+    }
+    return NULL;
+}
+
+int lspServer(void)
+{
+    int shutdown = FALSE;
+    char * message;
+    EchoSource = TraceScan = TraceParse = FALSE;
+    while ((message = readMessage()) != NULL) {
+        const char * id = member(message,"id");
+        const char * params = member(message,"params");
+        char * method = stringValue(member(message,"method"),NULL);
+        if (method == NULL)
+            ;
+        else if (strcmp(method,"initialize") == 0 && id != NULL)
+            initialize(id);
+        else if (strcmp(method,"textDocument/didOpen") == 0)
+            didOpen(params);
+        else if (strcmp(method,"textDocument/didChange") == 0)
+            didChange(params);
+        else if (strcmp(method,"textDocument/didClose") == 0)
+            didClose(params);
+        else if (strcmp(method,"textDocument/documentSymbol") == 0 && id != NULL)
+            documentSymbol(id,params);
+        else if (strcmp(method,"textDocument/definition") == 0 && id != NULL)
+            definition(id,params);
+        else if (strcmp(method,"shutdown") == 0 && id != NULL) {
+            shutdown = TRUE;
+            respondNull(id);
+        }
+        else if (strcmp(method,"exit") == 0) {
+            free(method);
+            free(message);
+            return shutdown;
+        }
+        else if (id != NULL)
+            methodNotFound(id);
+        free(method);
+        free(message);
+    }
+    return shutdown;
+}
@@ -7,35 +7,46 @@
 
 #include "globals.h"
 
-/* set NO_PARSE to TRUE to get a scanner-only compiler */
-/* For project1(scanner), FALSE -> TRUE */
-#define NO_PARSE FALSE
+/* The phases to run are chosen at run time with
+ * -fstop-after; NO_ANALYZE and NO_CODE leave out the
+ * phases that are not part of this build
+ */
 /* set NO_ANALYZE to TRUE to get a parser-only compiler */
-#define NO_ANALYZE TRUE
+#define NO_ANALYZE FALSE
 
 /* set NO_CODE to TRUE to get a compiler that does not
  * generate code
  */
-#define NO_CODE TRUE
+#define NO_CODE FALSE
 
 #include "util.h"
-#if NO_PARSE
+#include "compile.h"
+#include "stats.h"
+#include "trace.h"
+#include "pipeline.h"
+#include "writer.h"
+#include "cache.h"
+#include "xref.h"
+#include "prune.h"
+#include "consteval.h"
+#include "ir.h"
+#include <errno.h>
+#include <sys/stat.h>
 #include "scan.h"
-#else
 #include "parse.h"
 #if !NO_ANALYZE
 #include "analyze.h"
 #if !NO_CODE
 #include "cgen.h"
-#endif
+#include "jit.h"
 #endif
 #endif
 
 /* allocate global variables */
-int lineno = 0;
-FILE * source;
-FILE * listing;
-FILE * code;
+THREADLOCAL int lineno = 0;
+THREADLOCAL FILE * source;
+THREADLOCAL FILE * listing;
+THREADLOCAL FILE * code;
 
 /* allocate and set tracing flags */
 int EchoSource = FALSE; 
@@ -43,83 +54,551 @@ int TraceScan = FALSE;
 int TraceParse = TRUE;
 int TraceAnalyze = FALSE;
 int TraceCode = FALSE;
+int WriteListing = TRUE;
 
-int Error = FALSE;
+/* the last phase of every compilation, the last one
+ * built unless -fstop-after says otherwise
+ */
+Phase LastPhase = NO_ANALYZE ? ParsePhase : NO_CODE ? AnalyzePhase : CodePhase;
 
-int main( int argc, char * argv[] )
-{ 
-    /* ---------------------- START PROJECT 1,2 -------------------------*/
+THREADLOCAL int Error = FALSE;
 
-    TreeNode * syntaxTree;
-    char pgm[120]; /* source code file name */
-    if (argc != 2)
-    {
-        fprintf(stderr,"usage: %s <filename>\n",argv[0]);
-        exit(1);
-    }
-    /* input file open */
-    strcpy(pgm,argv[1]) ;
-    if (strchr (pgm, '.') == NULL)
-        strcat(pgm,".tny");
-    source = fopen(pgm,"r");
-    if (source==NULL)
+#if !NO_ANALYZE && !NO_CODE
+/* with --run the code is encoded in memory to jitted
+ * instead of written to a code file
+ */
+static int RunInMemory = FALSE;
+static JitCode * jitted = NULL;
+#endif
+
+static const char * phaseNames[] = {"scan","parse","analyze","codegen"};
+
+/* Function phaseNamed sets *phase to the phase called
+ * name; returns FALSE if there is no such phase in this
+ * build
+ */
+int phaseNamed(const char * name, Phase * phase)
+{
+    int p;
+    for (p = ScanPhase; p <= CodePhase; p++)
+        if (strcmp(name,phaseNames[p]) == 0) {
+            if ((p >= AnalyzePhase && NO_ANALYZE) || (p >= CodePhase && NO_CODE))
+                return FALSE;
+            *phase = (Phase) p;
+            return TRUE;
+        }
+    return FALSE;
+}
+
+/* Procedure outputName stores in buf the source name pgm
+ * without its extension, followed by suffix
+ */
+void outputName(char * buf, const char * pgm, const char * suffix)
+{
+    const char * base = strrchr(pgm,'/');
+    const char * dot = strrchr(base == NULL ? pgm : base,'.');
+    int len = dot == NULL ? (int) strlen(pgm) : (int) (dot - pgm);
+    snprintf(buf,FILENAME_MAX,"%.*s%s",len,pgm,suffix);
+}
+
+#if !NO_ANALYZE
+/* Procedure lowerToIR lowers the analyzed syntaxTree
+ * of pgm to the IR, writing it to <name>.ir for
+ * -fdump-ir and checking it for -fverify-ir
+ */
+static void lowerToIR(TreeNode * syntaxTree, const char * pgm)
+{
+    IrFunction * ir;
+    startPhase("ir");
+    ir = lowerProgram(syntaxTree);
+    endPhase();
+    if (VerifyIR && irVerify(ir,stderr) > 0)
+        fprintf(stderr,"IR of %s is not valid\n",pgm);
+    if (DumpIR)
     {
-        fprintf(stderr,"File %s not found\n",pgm);
-        exit(1);
+        char irfile[FILENAME_MAX];
+        FILE * f;
+        outputName(irfile,pgm,".ir");
+        f = fopen(irfile,"w");
+        if (f == NULL || (irDump(f,ir), fclose(f) != 0))
+            fprintf(stderr,"Unable to write IR file %s\n",irfile);
     }
+}
+#endif
 
-    //listing = stdout; /* send listing to screen */
-    char source_file[120];
-    strcpy(source_file, pgm);
-    char *output = strtok(pgm, ".");
-    strcat(output,"_20181683.txt");
-    listing = fopen(output,"w");
-    fprintf(listing,"\nC MINUS COMPILATION: %s\n",source_file);
+/* Function compileSource runs the phases up to phase over
+ * the open source file, writing the listing for pgm
+ */
+CompileStatus compileSource(const char * pgm, Phase phase)
+{ 
+    /* ---------------------- START PROJECT 1,2 -------------------------*/
+
+    TreeNode * syntaxTree;
+    CompileStatus status = CompileOk;
+    lineno = 0;
+    Error = FALSE;
+    if (WriteListing)
+        fprintf(listing,LISTINGHEADER,pgm);
     
-    #if NO_PARSE
-    fprintf(listing,"\tline number\t\t\ttoken\t\t\tlexeme\n");
-    fprintf(listing,"================================================================================\n");
+    if (phase == ScanPhase)
+    {
+        if (WriteListing)
+        {
+            fprintf(listing,"\tline number\t\t\ttoken\t\t\tlexeme\n");
+            fprintf(listing,"================================================================================\n");
+        }
+        startPhase("scan");
         while (getToken()!=ENDFILE);
-
+        endPhase();
+    }
      /* ---------------------- END PROJECT 1 -------------------------*/
-    #else
+    else
+    {
+        startPhase("parse");
         syntaxTree = parse();
+        endPhase();
         if (TraceParse) {
+            startPhase("tree");
             fprintf(listing,"\nSyntax tree:\n");
             printTree(syntaxTree);
+            endPhase();
         }
     /* ---------------------- END PROJECT 2 -------------------------*/
 
     #if !NO_ANALYZE
-        if (! Error)
+        if (PruneUnreachable && phase >= AnalyzePhase && ! Error)
+        {
+            startPhase("prune");
+            syntaxTree = prune(syntaxTree);
+            endPhase();
+        }
+        if (phase >= AnalyzePhase && ! Error)
         {
-            if (TraceAnalyze) fprintf(listing,"\nBuilding Symbol Table...\n");
-            buildSymtab(syntaxTree);
-            if (TraceAnalyze) fprintf(listing,"\nChecking Types...\n");
-            typeCheck(syntaxTree);
+            startPhase("analyze");
+            if (TraceAnalyze) fprintf(listing,"\nBuilding Symbol Table and Checking Types...\n");
+            analyze(syntaxTree,IncrementalAnalysis);
             if (TraceAnalyze) fprintf(listing,"\nType Checking Finished\n");
+            endPhase();
+            if (EvalConstCalls && ! Error)
+            {
+                startPhase("consteval");
+                evalConstCalls(syntaxTree);
+                endPhase();
+            }
+            if ((DumpIR || VerifyIR) && ! Error)
+                lowerToIR(syntaxTree,pgm);
+            if (WriteXref)
+            {
+                startPhase("xref");
+                if (!writeXref(syntaxTree,pgm))
+                    fprintf(stderr,"Unable to write cross-reference index for %s\n",pgm);
+                endPhase();
+            }
         }
     #if !NO_CODE
-    if (! Error)
+    if (phase >= CodePhase && ! Error && RunInMemory)
+    {
+        startPhase("jit");
+        jitted = jitCompile(syntaxTree);
+        endPhase();
+        if (jitted == NULL)
+            status = NoCode;
+    }
+    else if (phase >= CodePhase && ! Error)
     {
-        char * codefile;
-        int fnlen = strcspn(pgm,".");
-        codefile = (char *) calloc(fnlen+4, sizeof(char));
-        strncpy(codefile,pgm,fnlen);
-        strcat(codefile,".tm");
+        char codefile[FILENAME_MAX];
+        outputName(codefile,pgm,codeSuffix());
         code = fopen(codefile,"w");
         if (code == NULL)
+            status = NoCode;
+        else
         {
-            printf("Unable to open %s\n",codefile);
-            exit(1);
+            startPhase("codegen");
+            CodeSource = pgm;
+            codeGen(syntaxTree,codefile);
+            fclose(code);
+            endPhase();
         }
-        codeGen(syntaxTree,codefile);
-        fclose(code);
-}
-    #endif
+    }
     #endif
     #endif
+    }
+    if (status == CompileOk && Error)
+        status = CompileError;
+    resetScanner();
+    freeNodes();
+    reportPhases(pgm);
+    return status;
+}
+
+/* Function discardListing returns the listing stream of
+ * -fno-listing runs, which throws away the few error
+ * messages left to write; each thread keeps its own
+ */
+static FILE * discardListing(void)
+{
+    static THREADLOCAL FILE * discard = NULL;
+    if (discard == NULL)
+        discard = fopen("/dev/null","w");
+    return discard;
+}
+
+/* Function compileFile compiles the source file pgm,
+ * writing its listing next to it
+ */
+CompileStatus compileFile(const char * pgm)
+{ 
+    CompileStatus status;
+    Phase phase = LastPhase;
+    char output[FILENAME_MAX];
+    char codefile[FILENAME_MAX];
+    char key[KEYLEN+1];
+    const char * listingOutput = WriteListing ? output : NULL;
+    const char * codeOutput = phase < CodePhase ? NULL : codefile;
+    outputName(output,pgm,"_20181683.txt");
+#if !NO_ANALYZE && !NO_CODE
+    outputName(codefile,pgm,codeSuffix());
+#endif
+    /* the cache does not keep indexes or IR */
+    if (CacheDir != NULL && !WriteXref && !DumpIR && !VerifyIR)
+    {
+        int hit;
+        TRACE_BEGIN("cache lookup",pgm);
+        hit = cacheLookup(pgm,phase,listingOutput,codeOutput,key,&status);
+        TRACE_END();
+        if (hit)
+            return status;
+    }
+    /* input file open */
+    source = fopen(pgm,"r");
+    if (source==NULL)
+        return NoSource;
+    TRACE_BEGIN("compile",pgm);
+
+    //listing = stdout; /* send listing to screen */
+    listing = WriteListing ? openListing(output) : discardListing();
+    if (listing==NULL)
+    {
+        fclose(source);
+        TRACE_END();
+        return NoListing;
+    }
+    status = compileSource(pgm,phase);
+    if (WriteListing) {
+        TRACE_BEGIN("write listing",NULL);
+        fclose(listing);
+        TRACE_END();
+    }
     fclose(source);
+    if (CacheDir != NULL && !WriteXref && !DumpIR && !VerifyIR)
+        cacheStore(key,pgm,listingOutput,codeOutput,status);
+    TRACE_END();
+    return status;
+}
+
+#if !NO_ANALYZE && !NO_CODE
+/* Function runFile compiles the source file pgm in
+ * memory and runs it (--run), with no code file and
+ * no cache; returns the exit status of hw2_binary: 1 if
+ * it cannot be compiled, 2 after a runtime error
+ */
+static int runFile(const char * pgm)
+{
+    CompileStatus status;
+    char output[FILENAME_MAX];
+    int result;
+    outputName(output,pgm,"_20181683.txt");
+    source = fopen(pgm,"r");
+    if (source==NULL)
+    {
+        reportStatus(pgm,NoSource);
+        return 1;
+    }
+    listing = WriteListing ? openListing(output) : discardListing();
+    if (listing==NULL)
+    {
+        fclose(source);
+        reportStatus(pgm,NoListing);
+        return 1;
+    }
+    RunInMemory = TRUE;
+    status = compileSource(pgm,CodePhase);
+    if (WriteListing)
+        fclose(listing);
+    fclose(source);
+    if (status == NoCode)
+    {
+        fprintf(stderr,"Unable to map code for %s\n",pgm);
+        return 1;
+    }
+    if (status != CompileOk)
+    {
+        if (WriteListing)
+            fprintf(stderr,"Errors in %s, see %s\n",pgm,output);
+        else
+            reportStatus(pgm,status);
+        return 1;
+    }
+    result = jitRun(jitted);
+    jitFree(jitted);
+    return result;
+}
+#endif
+
+/* Procedure reportStatus explains to the user why the
+ * compilation of pgm failed
+ */
+void reportStatus(const char * pgm, CompileStatus status)
+{
+    switch (status) {
+        case NoSource:
+            fprintf(stderr,"File %s not found\n",pgm);
+            break;
+        case NoListing:
+            fprintf(stderr,"Unable to open listing file for %s\n",pgm);
+            break;
+        case NoCode:
+            fprintf(stderr,"Unable to open code file for %s\n",pgm);
+            break;
+        case CompileError:
+            if (!WriteListing)
+                fprintf(stderr,"Errors in %s\n",pgm);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Function compileFailed tells whether status fails the
+ * run; errors in the source program only do so when
+ * there is no listing to report them in
+ */
+int compileFailed(CompileStatus status)
+{
+    return status != CompileOk && (status != CompileError || !WriteListing);
+}
+
+/* Function setTrace sets the trace flag named name, as
+ * in -ftrace-scan; returns FALSE if there is none
+ */
+static int setTrace(const char * name, int on)
+{
+    if (strcmp(name,"echo") == 0) EchoSource = on;
+    else if (strcmp(name,"scan") == 0) TraceScan = on;
+    else if (strcmp(name,"parse") == 0) TraceParse = on;
+    else if (strcmp(name,"analyze") == 0) TraceAnalyze = on;
+    else if (strcmp(name,"code") == 0) TraceCode = on;
+    else return FALSE;
+    return TRUE;
+}
+
+/* Function addSource appends the source name arg to the
+ * file list, supplying the default .tny extension
+ */
+static void addSource(char *** files, int * nfiles, int * maxfiles, const char * arg)
+{
+    const char * base = strrchr(arg,'/');
+    char * pgm = (char *) malloc(strlen(arg)+5);
+    strcpy(pgm,arg);
+    if (strchr(base == NULL ? arg : base,'.') == NULL)
+        strcat(pgm,".tny");
+    if (*nfiles == *maxfiles)
+    {
+        *maxfiles = *maxfiles ? 2 * *maxfiles : 16;
+        *files = (char **) realloc(*files,*maxfiles * sizeof(char *));
+    }
+    (*files)[(*nfiles)++] = pgm;
+}
+
+/* Function readResponseFile adds every line of the file
+ * name to the file list; returns FALSE if it cannot be read
+ */
+static int readResponseFile(char *** files, int * nfiles, int * maxfiles, const char * name)
+{
+    char line[FILENAME_MAX];
+    FILE * f = fopen(name,"r");
+    if (f == NULL)
+        return FALSE;
+    while (fgets(line,sizeof(line),f) != NULL)
+    {
+        int len = strlen(line);
+        while (len > 0 && isspace((unsigned char) line[len-1]))
+            line[--len] = '\0';
+        if (len > 0)
+            addSource(files,nfiles,maxfiles,line);
+    }
+    fclose(f);
+    return TRUE;
+}
+
+static void usage(const char * prog)
+{
+    fprintf(stderr,"usage: %s [-j threads] [-fanalyze-threads=<n>] [-fpipeline] [-fasync-listing]\n"
+                   "          [-fstop-after=scan|parse|analyze|codegen]\n"
+                   "          [-f[no-]trace-echo|scan|parse|analyze|code] [-fno-listing] [-fxref]\n"
+                   "          [-fprune-unreachable] [-fconst-eval] [-fdump-ir] [-fverify-ir]\n"
+                   "          [-ftarget=tm|vm|x86|c]\n"
+                   "          [-ftime-report[=json]] [-ftime-trace=<file>]\n"
+                   "          [-fcache-dir=<dir>] [-fcache-size=<MB>]\n"
+                   "          <filename>... | @listfile\n",prog);
+    fprintf(stderr,"       %s [options] --run <filename>\n",prog);
+    fprintf(stderr,"       %s [options] --server <socket>\n",prog);
+    fprintf(stderr,"       %s [options] --watch <directory>\n",prog);
+    fprintf(stderr,"       %s --lsp\n",prog);
+    exit(1);
+}
+
+int main( int argc, char * argv[] )
+{ 
+    char ** files = NULL;
+    int nfiles = 0, maxfiles = 0;
+    int nthreads = 0;
+    const char * traceFile = NULL;
+    const char * serverSocket = NULL;
+    const char * watchDir = NULL;
+    const char * runSource = NULL;
+    int lsp = FALSE;
+    int i, failed;
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i],"--server") == 0 && i+1 < argc)
+            serverSocket = argv[++i];
+        else if (strcmp(argv[i],"--watch") == 0 && i+1 < argc)
+            watchDir = argv[++i];
+        else if (strcmp(argv[i],"--lsp") == 0)
+            lsp = TRUE;
+#if !NO_ANALYZE && !NO_CODE
+        else if (strcmp(argv[i],"--run") == 0 && i+1 < argc)
+            runSource = argv[++i];
+#endif
+        else if (strncmp(argv[i],"-j",2) == 0)
+        {
+            const char * n = argv[i][2] ? argv[i]+2 : argv[++i];
+            if (n == NULL || (nthreads = atoi(n)) <= 0)
+                usage(argv[0]);
+        }
+        else if (strncmp(argv[i],"-fstop-after=",13) == 0)
+        {
+            if (!phaseNamed(argv[i]+13,&LastPhase))
+            {
+                fprintf(stderr,"Phase %s is not part of this compiler\n",argv[i]+13);
+                exit(1);
+            }
+        }
+        else if (strncmp(argv[i],"-ftrace-",8) == 0)
+        {
+            if (!setTrace(argv[i]+8,TRUE))
+                usage(argv[0]);
+        }
+        else if (strncmp(argv[i],"-fno-trace-",11) == 0)
+        {
+            if (!setTrace(argv[i]+11,FALSE))
+                usage(argv[0]);
+        }
+        else if (strncmp(argv[i],"-fanalyze-threads=",18) == 0)
+        {
+            if ((AnalyzeThreads = atoi(argv[i]+18)) <= 0)
+                usage(argv[0]);
+        }
+        else if (strcmp(argv[i],"-fno-listing") == 0)
+            WriteListing = FALSE;
+        else if (strcmp(argv[i],"-fxref") == 0)
+            WriteXref = TRUE;
+        else if (strcmp(argv[i],"-fprune-unreachable") == 0)
+            PruneUnreachable = TRUE;
+        else if (strcmp(argv[i],"-fconst-eval") == 0)
+            EvalConstCalls = TRUE;
+        else if (strcmp(argv[i],"-fdump-ir") == 0)
+            DumpIR = TRUE;
+        else if (strcmp(argv[i],"-fverify-ir") == 0)
+            VerifyIR = TRUE;
+#if !NO_ANALYZE && !NO_CODE
+        else if (strncmp(argv[i],"-ftarget=",9) == 0)
+        {
+            if (!targetNamed(argv[i]+9))
+                usage(argv[0]);
+        }
+#endif
+        else if (strcmp(argv[i],"-fpipeline") == 0)
+            PipelineScan = TRUE;
+        else if (strcmp(argv[i],"-fasync-listing") == 0)
+            AsyncListing = TRUE;
+        else if (strncmp(argv[i],"-fcache-dir=",12) == 0 && argv[i][12])
+            CacheDir = argv[i]+12;
+        else if (strncmp(argv[i],"-fcache-size=",13) == 0)
+        {
+            if ((CacheLimit = strtoull(argv[i]+13,NULL,10) << 20) == 0)
+                usage(argv[0]);
+        }
+        else if (strcmp(argv[i],"-ftime-report") == 0)
+            TimeReport = TextReport;
+        else if (strcmp(argv[i],"-ftime-report=json") == 0)
+            TimeReport = JsonReport;
+        else if (strncmp(argv[i],"-ftime-trace=",13) == 0 && argv[i][13])
+        {
+            traceFile = argv[i]+13;
+            TraceEvents = TRUE;
+        }
+        else if (argv[i][0] == '@')
+        {
+            if (!readResponseFile(&files,&nfiles,&maxfiles,argv[i]+1))
+            {
+                fprintf(stderr,"File %s not found\n",argv[i]+1);
+                exit(1);
+            }
+        }
+        else
+            addSource(&files,&nfiles,&maxfiles,argv[i]);
+    }
+    if ((nfiles > 0) + (serverSocket != NULL) + (watchDir != NULL) + (runSource != NULL) + lsp != 1)
+        usage(argv[0]);
+    if (lsp)
+        return lspServer() ? 0 : 1;
+    /* without a listing nothing is traced, so no time
+     * goes into formatting */
+    if (!WriteListing)
+        EchoSource = TraceScan = TraceParse = TraceAnalyze = TraceCode = FALSE;
+    if (CacheDir == NULL)
+        CacheDir = getenv("HW2_CACHE_DIR");
+    if (CacheDir != NULL && mkdir(CacheDir,0777) != 0 && errno != EEXIST)
+    {
+        fprintf(stderr,"Unable to create cache directory %s\n",CacheDir);
+        exit(1);
+    }
+    /* files compiled side by side already keep the
+     * processors busy */
+    if (AnalyzeThreads == 0 && (nfiles > 1 || nthreads > 0))
+        AnalyzeThreads = 1;
+#if !NO_ANALYZE && !NO_CODE
+    if (runSource != NULL)
+        return runFile(runSource);
+#endif
+    IncrementalAnalysis = serverSocket != NULL || watchDir != NULL;
+    if (serverSocket != NULL)
+    {
+        /* the files are named after the names the clients send */
+        WriteXref = DumpIR = FALSE;
+        return compileServer(serverSocket) ? 0 : 1;
+    }
+    if (watchDir != NULL)
+        return watchDirectory(watchDir) ? 0 : 1;
+    if (nfiles == 1 && nthreads == 0)
+    {
+        CompileStatus status = compileFile(files[0]);
+        reportStatus(files[0],status);
+        failed = compileFailed(status);
+    }
+    else
+        failed = batchCompile(files,nfiles,nthreads) > 0;
+    if (CacheDir != NULL)
+        cacheTrim();
+    if (traceFile != NULL && !writeTrace(traceFile))
+    {
+        fprintf(stderr,"Unable to write trace %s\n",traceFile);
+        failed = TRUE;
+    }
+    if (failed)
+        exit(1);
     return 0;
 }
 
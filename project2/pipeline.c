@@ -0,0 +1,168 @@
+/****************************************************/
+/* File: pipeline.c                                 */
+/* Scanner running on its own thread, feeding the   */
+/* parser through a lock-free token ring            */
+/* The ring has a single producer (the scanner      */
+/* thread) and a single consumer (the parser), so   */
+/* head and tail need only acquire/release ordering */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "scan.h"
+#include "stats.h"
+#include "pipeline.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+int PipelineScan = FALSE;
+
+/* RINGSIZE is the number of tokens the scanner may run
+ * ahead of the parser; a power of two
+ */
+#define RINGSIZE 4096
+
+/* SPINS is the number of polls before a waiting side
+ * yields its processor
+ */
+#define SPINS 64
+
+typedef struct
+{
+    TokenType token;
+    int lineno; /* line of the token, as getToken leaves it */
+    char lexeme[MAXTOKENLEN+1];
+} TokenRecord;
+
+typedef struct
+{
+    /* written by the consumer */
+    _Alignas(64) atomic_size_t head;
+    atomic_int stop; /* the parser is done, scanner must exit */
+    /* written by the producer */
+    _Alignas(64) atomic_size_t tail;
+    size_t headCache; /* producer's last view of head */
+    /* the scanner thread's copy of the file globals */
+    FILE * source;
+    FILE * listing;
+    pthread_t thread;
+    _Alignas(64) TokenRecord ring[RINGSIZE];
+} Pipeline;
+
+/* a compiling thread runs at most one pipeline */
+static THREADLOCAL Pipeline * running = NULL;
+static THREADLOCAL size_t tailCache; /* consumer's last view of tail */
+
+static void backoff(int * spins)
+{
+    if (++*spins < SPINS)
+        __asm__ __volatile__("" ::: "memory");
+    else {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+/* Function push appends a token for the parser, waiting
+ * while the ring is full; returns FALSE when the parser
+ * no longer wants tokens
+ */
+static int push(Pipeline * p, TokenType token)
+{
+    size_t tail = atomic_load_explicit(&p->tail,memory_order_relaxed);
+    TokenRecord * r;
+    int spins = 0;
+    while (tail - p->headCache == RINGSIZE) {
+        if (atomic_load_explicit(&p->stop,memory_order_relaxed))
+            return FALSE;
+        p->headCache = atomic_load_explicit(&p->head,memory_order_acquire);
+        if (tail - p->headCache == RINGSIZE)
+            backoff(&spins);
+    }
+    r = &p->ring[tail & (RINGSIZE - 1)];
+    r->token = token;
+    r->lineno = lineno;
+    strcpy(r->lexeme,tokenString);
+    atomic_store_explicit(&p->tail,tail + 1,memory_order_release);
+    return TRUE;
+}
+
+static void * scanner(void * arg)
+{
+    Pipeline * p = (Pipeline *) arg;
+    TokenType token;
+    source = p->source;
+    listing = p->listing;
+    lineno = 0;
+    do {
+        token = scanToken();
+        if (!push(p,token))
+            break;
+        /* the parser rejects a comment error, and the
+         * scanner must not be asked for more */
+        if (token == COMMENTERROR) {
+            push(p,ENDFILE);
+            break;
+        }
+    } while (token != ENDFILE);
+    resetScanner();
+    return NULL;
+}
+
+int startPipeline(void)
+{
+    /* the size of Pipeline is a multiple of its alignment */
+    Pipeline * p = (Pipeline *) aligned_alloc(_Alignof(Pipeline),sizeof(Pipeline));
+    if (p == NULL)
+        return FALSE;
+    atomic_init(&p->head,0);
+    atomic_init(&p->tail,0);
+    atomic_init(&p->stop,FALSE);
+    p->headCache = 0;
+    p->source = source;
+    p->listing = listing;
+    if (pthread_create(&p->thread,NULL,scanner,p) != 0) {
+        free(p);
+        return FALSE;
+    }
+    running = p;
+    tailCache = 0;
+    return TRUE;
+}
+
+TokenType pipelineToken(void)
+{
+    Pipeline * p = running;
+    size_t head = atomic_load_explicit(&p->head,memory_order_relaxed);
+    TokenRecord * r;
+    TokenType token;
+    int spins = 0;
+    while (head == tailCache) {
+        tailCache = atomic_load_explicit(&p->tail,memory_order_acquire);
+        if (head == tailCache)
+            backoff(&spins);
+    }
+    r = &p->ring[head & (RINGSIZE - 1)];
+    token = r->token;
+    lineno = r->lineno;
+    strcpy(tokenString,r->lexeme);
+    atomic_store_explicit(&p->head,head + 1,memory_order_release);
+    tokenCount++;
+    if (TraceScan) {
+        fprintf(listing,"\t%d ",lineno);
+        printToken(token,tokenString);
+    }
+    return token;
+}
+
+void stopPipeline(void)
+{
+    Pipeline * p = running;
+    if (p == NULL)
+        return;
+    atomic_store_explicit(&p->stop,TRUE,memory_order_relaxed);
+    pthread_join(p->thread,NULL);
+    free(p);
+    running = NULL;
+}
@@ -0,0 +1,32 @@
+/****************************************************/
+/* File: pipeline.h                                 */
+/* Scanner running on its own thread, feeding the   */
+/* parser through a lock-free token ring            */
+/****************************************************/
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+/* PipelineScan = TRUE makes parse run the scanner on a
+ * second thread, so that scanning and parsing overlap
+ */
+extern int PipelineScan;
+
+/* Function startPipeline starts scanning source on a
+ * new thread; returns FALSE if no thread could be
+ * started, in which case getToken must be used
+ */
+int startPipeline(void);
+
+/* Function pipelineToken returns the next token of the
+ * scanner thread, setting tokenString and lineno and
+ * tracing it just as getToken does
+ */
+TokenType pipelineToken(void);
+
+/* Procedure stopPipeline stops the scanner thread, which
+ * may be ahead of the parser, and waits for it
+ */
+void stopPipeline(void);
+
+#endif
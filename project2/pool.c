@@ -0,0 +1,130 @@
+/****************************************************/
+/* File: pool.c                                     */
+/* Work-stealing loop over independent tasks        */
+/* Every thread owns a range of task indices: it    */
+/* takes them from the front, thieves split off the */
+/* back half. Tasks take microseconds at least, so  */
+/* a lock per range costs nothing measurable        */
+/****************************************************/
+
+#include "globals.h"
+#include "pool.h"
+#include <pthread.h>
+
+/* a range on a cache line of its own, so that owners
+ * taking tasks do not slow each other down */
+typedef struct
+{
+    pthread_mutex_t lock;
+    int next, end;  /* indices not yet taken */
+} __attribute__((aligned(64))) Range;
+
+typedef struct
+{
+    Range * ranges;
+    int nthreads;
+    void (*work)(void *, int);
+    void (*finish)(void *);
+    void * arg;
+} Pool;
+
+typedef struct
+{
+    Pool * pool;
+    int self;
+} Worker;
+
+/* Function steal moves the back half of the range of
+ * another thread to the range of self and returns its
+ * first index, or -1 if every range is empty. Only one
+ * lock is held at a time
+ */
+static int steal(Pool * p, int self)
+{
+    int k;
+    for (k = 1; k < p->nthreads; k++) {
+        Range * victim = &p->ranges[(self + k) % p->nthreads];
+        int from = 0, to = 0;
+        pthread_mutex_lock(&victim->lock);
+        if (victim->next < victim->end) {
+            to = victim->end;
+            from = to - (to - victim->next + 1) / 2;
+            victim->end = from;
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (from < to) {
+            Range * own = &p->ranges[self];
+            pthread_mutex_lock(&own->lock);
+            own->next = from + 1;
+            own->end = to;
+            pthread_mutex_unlock(&own->lock);
+            return from;
+        }
+    }
+    return -1;
+}
+
+/* Function takeTask returns the next task of self, or
+ * -1 when there is none left anywhere
+ */
+static int takeTask(Pool * p, int self)
+{
+    Range * own = &p->ranges[self];
+    int i = -1;
+    pthread_mutex_lock(&own->lock);
+    if (own->next < own->end)
+        i = own->next++;
+    pthread_mutex_unlock(&own->lock);
+    return i >= 0 ? i : steal(p,self);
+}
+
+static void * runWorker(void * arg)
+{
+    Worker * w = (Worker *) arg;
+    int i;
+    while ((i = takeTask(w->pool,w->self)) >= 0)
+        w->pool->work(w->pool->arg,i);
+    if (w->pool->finish != NULL)
+        w->pool->finish(w->pool->arg);
+    return NULL;
+}
+
+void parallelFor(int n, int nthreads, void (*work)(void *, int),
+                 void (*finish)(void *), void * arg)
+{
+    Pool pool;
+    Worker * workers;
+    pthread_t * threads;
+    int i, started;
+    if (nthreads > n)
+        nthreads = n;
+    if (nthreads < 1)
+        nthreads = 1;
+    pool.ranges = (Range *) aligned_alloc(64,nthreads * sizeof(Range));
+    pool.nthreads = nthreads;
+    pool.work = work;
+    pool.finish = finish;
+    pool.arg = arg;
+    workers = (Worker *) malloc(nthreads * sizeof(Worker));
+    threads = (pthread_t *) malloc(nthreads * sizeof(pthread_t));
+    for (i = 0; i < nthreads; i++) {
+        pthread_mutex_init(&pool.ranges[i].lock,NULL);
+        pool.ranges[i].next = (int) ((long) n * i / nthreads);
+        pool.ranges[i].end = (int) ((long) n * (i + 1) / nthreads);
+        workers[i].pool = &pool;
+        workers[i].self = i;
+    }
+    /* threads that could not be started leave their
+     * ranges to be stolen */
+    for (started = 1; started < nthreads; started++)
+        if (pthread_create(&threads[started],NULL,runWorker,&workers[started]) != 0)
+            break;
+    runWorker(&workers[0]);
+    while (--started > 0)
+        pthread_join(threads[started],NULL);
+    for (i = 0; i < nthreads; i++)
+        pthread_mutex_destroy(&pool.ranges[i].lock);
+    free(pool.ranges);
+    free(workers);
+    free(threads);
+}
@@ -0,0 +1,19 @@
+/****************************************************/
+/* File: pool.h                                     */
+/* Work-stealing loop over independent tasks        */
+/****************************************************/
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+/* Procedure parallelFor calls work(arg,i) for every i
+ * from 0 to n-1 on nthreads threads, the caller being
+ * one of them. Each thread starts on its own share of
+ * the indices and, once done, steals half the remaining
+ * share of another. Every thread then calls finish(arg),
+ * unless NULL, before parallelFor returns
+ */
+void parallelFor(int n, int nthreads, void (*work)(void *, int),
+                 void (*finish)(void *), void * arg);
+
+#endif
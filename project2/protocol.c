@@ -0,0 +1,61 @@
+/****************************************************/
+/* File: protocol.c                                 */
+/* Socket I/O shared by the compile server and      */
+/* its clients                                      */
+/****************************************************/
+
+#include "protocol.h"
+#include <errno.h>
+#include <unistd.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+int readFull(int fd, void * buf, size_t n)
+{
+    char * p = (char *) buf;
+    while (n > 0) {
+        ssize_t got = read(fd,p,n);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return FALSE;
+        p += got;
+        n -= got;
+    }
+    return TRUE;
+}
+
+int writeFull(int fd, const void * buf, size_t n)
+{
+    const char * p = (const char *) buf;
+    while (n > 0) {
+        ssize_t put = write(fd,p,n);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0)
+            return FALSE;
+        p += put;
+        n -= put;
+    }
+    return TRUE;
+}
+
+int readHeader(int fd, char * buf)
+{
+    int i;
+    for (i = 0; i < MAXHEADER; i++) {
+        if (!readFull(fd,buf+i,1))
+            return FALSE;
+        if (buf[i] == '\n') {
+            buf[i] = '\0';
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
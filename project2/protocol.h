@@ -0,0 +1,51 @@
+/****************************************************/
+/* File: protocol.h                                 */
+/* Wire format between the compile server and its   */
+/* clients over a Unix domain socket                */
+/****************************************************/
+
+#ifndef _PROTOCOL_H_
+#define _PROTOCOL_H_
+
+#include <stddef.h>
+
+/* socket used when the client is given none */
+#define DEFAULTSOCKET "/tmp/hw2_server.sock"
+
+/* MAXHEADER is the maximum length of a header line */
+#define MAXHEADER 256
+
+/* A request is a header line followed by its payload:
+ *
+ *   PATH <phase> <traces> <pathlen>\n<path>
+ *   SOURCE <phase> <traces> <namelen> <sourcelen>\n<name><source>
+ *
+ * phase is scan, parse or analyze, traces is - or a
+ * comma separated list of echo, scan, parse and analyze.
+ * PATH compiles a file read by the server, SOURCE
+ * compiles the bytes that follow, using name in the
+ * listing; neither writes a file. The response is
+ *
+ *   <status> <listinglen>\n<listing>
+ *
+ * where status is a CompileStatus. A connection carries
+ * any number of requests.
+ */
+
+/* Function readFull reads exactly n bytes from fd;
+ * returns FALSE on error or end of file
+ */
+int readFull(int fd, void * buf, size_t n);
+
+/* Function writeFull writes n bytes to fd;
+ * returns FALSE on error
+ */
+int writeFull(int fd, const void * buf, size_t n);
+
+/* Function readHeader reads a header line of at most
+ * MAXHEADER bytes into buf, without its newline;
+ * returns FALSE on error, end of file or overflow
+ */
+int readHeader(int fd, char * buf);
+
+#endif
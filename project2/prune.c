@@ -0,0 +1,155 @@
+/****************************************************/
+/* File: prune.c                                    */
+/* Removal of the functions main cannot reach       */
+/* The call graph is explored from main before the  */
+/* names are resolved, so a name keeps every global */
+/* declaration of that name; only the bodies of     */
+/* reachable functions are ever walked              */
+/****************************************************/
+
+#include "globals.h"
+#include "prune.h"
+
+int PruneUnreachable = FALSE;
+
+/* a top-level declaration; those of the same name are
+ * chained */
+typedef struct
+{
+    TreeNode * t;
+    int live;
+    int sameName;  /* next declaration of the name, or -1 */
+} Decl;
+
+typedef struct
+{
+    Decl * decls;
+    int * slots;   /* open hash table of names: the first
+                    * declaration of each, -1 if empty */
+    unsigned size;
+    int * work;    /* reachable functions not yet walked */
+    int nwork;
+} Graph;
+
+static unsigned hashName(const char * name)
+{
+    unsigned long h = (unsigned long) name;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDUL;
+    h ^= h >> 33;
+    return (unsigned) h;
+}
+
+/* Function findSlot returns the slot of the interned
+ * name, or the empty slot where it would go
+ */
+static int * findSlot(Graph * g, const char * name)
+{
+    unsigned i = hashName(name) & (g->size - 1);
+    while (g->slots[i] >= 0 && g->decls[g->slots[i]].t->attr.name != name)
+        i = (i + 1) & (g->size - 1);
+    return &g->slots[i];
+}
+
+/* Procedure reach marks the declarations named name as
+ * live, queueing the functions to be walked. Variables
+ * and functions of the name are kept alike, so that a
+ * misuse is reported as it would be without pruning
+ */
+static void reach(Graph * g, const char * name)
+{
+    int d;
+    for (d = *findSlot(g,name); d >= 0; d = g->decls[d].sameName) {
+        Decl * decl = &g->decls[d];
+        if (decl->live)
+            continue;
+        decl->live = TRUE;
+        if (decl->t->kind.decl == FunK)
+            g->work[g->nwork++] = d;
+    }
+}
+
+/* Procedure walkBody reaches every global the names of
+ * the subtree t may refer to
+ */
+static void walkBody(Graph * g, TreeNode * t)
+{
+    for (; t != NULL; t = t->sibling) {
+        int i;
+        if (t->nodekind == ExpK &&
+            (t->kind.exp == FunCallK || t->kind.exp == IdK || t->kind.exp == ArrK))
+            reach(g,t->attr.name);
+        for (i = 0; i < MAXCHILDREN; i++)
+            walkBody(g,t->child[i]);
+    }
+}
+
+/* Function countNodes returns the number of nodes of
+ * the subtree t, without its siblings
+ */
+static unsigned long countNodes(TreeNode * t)
+{
+    unsigned long n = 1;
+    int i;
+    for (i = 0; i < MAXCHILDREN; i++) {
+        TreeNode * c;
+        for (c = t->child[i]; c != NULL; c = c->sibling)
+            n += countNodes(c);
+    }
+    return n;
+}
+
+TreeNode * prune(TreeNode * syntaxTree)
+{
+    Graph g;
+    TreeNode * t, * last = NULL, * head = NULL;
+    int n = 0, i, deadFunctions = 0, deadVariables = 0;
+    unsigned long deadNodes = 0;
+    for (t = syntaxTree; t != NULL; t = t->sibling, n++)
+        last = t;
+    if (last == NULL || last->nodekind != DeclK || last->kind.decl != FunK ||
+        strcmp(last->attr.name,"main") != 0)
+        return syntaxTree;
+    g.decls = (Decl *) malloc(n * sizeof(Decl));
+    g.work = (int *) malloc(n * sizeof(int));
+    g.nwork = 0;
+    for (g.size = 16; g.size < 2 * (unsigned) n; g.size *= 2)
+        ;
+    g.slots = (int *) malloc(g.size * sizeof(int));
+    memset(g.slots,-1,g.size * sizeof(int));
+    /* chained in reverse, so that each chain is in order */
+    for (t = syntaxTree, i = 0; t != NULL; t = t->sibling, i++)
+        g.decls[i].t = t;
+    for (i = n - 1; i >= 0; i--) {
+        int * slot = findSlot(&g,g.decls[i].t->attr.name);
+        g.decls[i].live = FALSE;
+        g.decls[i].sameName = *slot;
+        *slot = i;
+    }
+    g.decls[n-1].live = TRUE;
+    g.work[g.nwork++] = n - 1;
+    while (g.nwork > 0)
+        walkBody(&g,g.decls[g.work[--g.nwork]].t->child[2]);
+
+    /* the live declarations keep their order */
+    for (i = n - 1; i >= 0; i--) {
+        t = g.decls[i].t;
+        if (g.decls[i].live) {
+            t->sibling = head;
+            head = t;
+        }
+        else {
+            if (t->kind.decl == FunK)
+                deadFunctions++;
+            else
+                deadVariables++;
+            deadNodes += countNodes(t);
+        }
+    }
+    fprintf(listing,"\nPruned %d unreachable functions and %d unused globals (%lu nodes)\n",
+            deadFunctions,deadVariables,deadNodes);
+    free(g.slots);
+    free(g.work);
+    free(g.decls);
+    return head;
+}
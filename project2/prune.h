@@ -0,0 +1,25 @@
+/****************************************************/
+/* File: prune.h                                    */
+/* Removal of the functions main cannot reach       */
+/****************************************************/
+
+#ifndef _PRUNE_H_
+#define _PRUNE_H_
+
+/* PruneUnreachable = TRUE (-fprune-unreachable) makes
+ * the compilations drop, right after parsing, the
+ * functions main cannot call and the global variables
+ * no remaining function refers to; errors in them are
+ * no longer reported
+ */
+extern int PruneUnreachable;
+
+/* Function prune removes the unreachable declarations
+ * from the declaration list syntaxTree and reports
+ * their number to the listing; returns the new list.
+ * A list whose last declaration is no function main
+ * is left alone, for analysis to reject
+ */
+TreeNode * prune(TreeNode * syntaxTree);
+
+#endif
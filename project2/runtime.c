@@ -0,0 +1,45 @@
+/****************************************************/
+/* File: runtime.c                                  */
+/* Runtime of the C- programs compiled for x86-64   */
+/* (-ftarget=x86): link it with the assembled code, */
+/* as in gcc prog.s runtime.c -o prog               */
+/* input and output behave as the IN and OUT of the */
+/* TM simulator, so the runs compare line by line   */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void cm_main(void);
+
+int cm_input(void)
+{
+    int n;
+    if (scanf("%d",&n) != 1) {
+        fflush(stdout);
+        fprintf(stderr,"Runtime error: no integer to input\n");
+        exit(2);
+    }
+    return n;
+}
+
+void cm_output(int n)
+{
+    printf("OUT instruction prints: %d\n",n);
+}
+
+/* Procedure rt_divide ends the program at a division
+ * by divisor that has no result, as the TM does
+ */
+void rt_divide(int divisor)
+{
+    fflush(stdout);
+    fprintf(stderr,"Runtime error: %s\n",divisor == 0 ? "division by zero" : "division overflow");
+    exit(2);
+}
+
+int main(void)
+{
+    cm_main();
+    return 0;
+}
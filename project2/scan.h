@@ -14,12 +14,23 @@
 #define MAXTOKENLEN 40
 
 /* tokenString array stores the lexeme of each token */
-extern char tokenString[MAXTOKENLEN+1];
+extern THREADLOCAL char tokenString[MAXTOKENLEN+1];
 
 /* function getToken returns the 
  * next token in source file
  */
 TokenType getToken(void);
-    
+
+/* function scanToken returns the next token like
+ * getToken, without counting or tracing it
+ */
+TokenType scanToken(void);
+
+/* Procedure resetScanner discards the scanner state
+ * of the calling thread, so that the next getToken
+ * starts reading a new source file
+ */
+void resetScanner(void);
+
 
 #endif
@@ -0,0 +1,139 @@
+/****************************************************/
+/* File: server.c                                   */
+/* Compile server: a long running compiler serving  */
+/* requests over a Unix domain socket               */
+/* The server compiles on a single thread, so the   */
+/* interned names and node blocks of that thread    */
+/* stay warm from one request to the next           */
+/****************************************************/
+
+#include "globals.h"
+#include "compile.h"
+#include "protocol.h"
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* Function setTraces sets the trace flags named in the
+ * comma separated list traces and clears the others;
+ * returns FALSE if a name is unknown
+ */
+static int setTraces(char * traces)
+{
+    char * name;
+    EchoSource = TraceScan = TraceParse = TraceAnalyze = TraceCode = FALSE;
+    if (strcmp(traces,"-") == 0)
+        return TRUE;
+    for (name = strtok(traces,","); name != NULL; name = strtok(NULL,","))
+        if (strcmp(name,"echo") == 0) EchoSource = TRUE;
+        else if (strcmp(name,"scan") == 0) TraceScan = TRUE;
+        else if (strcmp(name,"parse") == 0) TraceParse = TRUE;
+        else if (strcmp(name,"analyze") == 0) TraceAnalyze = TRUE;
+        else return FALSE;
+    return TRUE;
+}
+
+/* Function respond sends a status and a listing */
+static int respond(int fd, CompileStatus status, const char * text, size_t len)
+{
+    char header[MAXHEADER];
+    int n = snprintf(header,MAXHEADER,"%d %lu\n",(int) status,(unsigned long) len);
+    return writeFull(fd,header,n) && writeFull(fd,text,len);
+}
+
+/* Function serveRequest reads one request from fd,
+ * compiles it and sends the response; returns FALSE
+ * when the connection is over
+ */
+static int serveRequest(int fd)
+{
+    char header[MAXHEADER];
+    char verb[16], phaseName[16], traces[64];
+    char * name, * text = NULL;
+    unsigned long namelen, srclen = 0;
+    size_t textlen = 0;
+    CompileStatus status;
+    int saved[5], fields, ok;
+    Phase phase;
+    if (!readHeader(fd,header))
+        return FALSE;
+    fields = sscanf(header,"%15s %15s %63s %lu %lu",verb,phaseName,traces,&namelen,&srclen);
+    if (fields < 4 || namelen == 0 || namelen >= FILENAME_MAX ||
+        (strcmp(verb,"PATH") == 0 ? fields != 4 : strcmp(verb,"SOURCE") != 0 || fields != 5))
+        return FALSE;
+    /* code generation would write <name>.tm, and the
+     * name comes from the client */
+    if (!phaseNamed(phaseName,&phase) || phase > AnalyzePhase)
+        return FALSE;
+    name = (char *) malloc(namelen + 1 + srclen);
+    if (name == NULL || !readFull(fd,name,namelen + srclen)) {
+        free(name);
+        return FALSE;
+    }
+    memmove(name + namelen + 1,name + namelen,srclen);
+    name[namelen] = '\0';
+    saved[0] = EchoSource; saved[1] = TraceScan; saved[2] = TraceParse;
+    saved[3] = TraceAnalyze; saved[4] = TraceCode;
+    if (!setTraces(traces))
+        status = CompileError;
+    else {
+        if (verb[0] == 'P')
+            source = fopen(name,"r");
+        else if (srclen == 0)
+            source = fopen("/dev/null","r");
+        else
+            source = fmemopen(name + namelen + 1,srclen,"r");
+        listing = open_memstream(&text,&textlen);
+        if (source == NULL)
+            status = NoSource;
+        else if (listing == NULL)
+            status = NoListing;
+        else
+            status = compileSource(name,phase);
+        if (source != NULL) fclose(source);
+        if (listing != NULL) fclose(listing);
+    }
+    EchoSource = saved[0]; TraceScan = saved[1]; TraceParse = saved[2];
+    TraceAnalyze = saved[3]; TraceCode = saved[4];
+    ok = respond(fd,status,text,textlen);
+    free(text);
+    free(name);
+    return ok;
+}
+
+int compileServer(const char * path)
+{
+    struct sockaddr_un addr;
+    int fd;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr,"Socket path %s is too long\n",path);
+        return FALSE;
+    }
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path,path);
+    fd = socket(AF_UNIX,SOCK_STREAM,0);
+    unlink(path);
+    if (fd < 0 || bind(fd,(struct sockaddr *) &addr,sizeof(addr)) < 0 || listen(fd,16) < 0) {
+        fprintf(stderr,"Unable to listen on %s: %s\n",path,strerror(errno));
+        return FALSE;
+    }
+    signal(SIGPIPE,SIG_IGN);
+    for (;;) {
+        int conn = accept(fd,NULL,NULL);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            fprintf(stderr,"accept: %s\n",strerror(errno));
+            break;
+        }
+        while (serveRequest(conn))
+            ;
+        close(conn);
+    }
+    close(fd);
+    unlink(path);
+    return FALSE;
+}
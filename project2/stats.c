@@ -0,0 +1,138 @@
+/****************************************************/
+/* File: stats.c                                    */
+/* Per-phase timing and memory report               */
+/* Phases are measured only at their boundaries, so */
+/* the report is cheap enough to stay enabled       */
+/****************************************************/
+
+#include "globals.h"
+#include "stats.h"
+#include "trace.h"
+#include <time.h>
+#include <sys/resource.h>
+
+THREADLOCAL unsigned long tokenCount = 0;
+THREADLOCAL unsigned long nodeCount = 0;
+THREADLOCAL unsigned long bytesAllocated = 0;
+THREADLOCAL unsigned long reusedCount = 0;
+THREADLOCAL unsigned long recordedCount = 0;
+
+ReportKind TimeReport = NoReport;
+
+/* MAXPHASES is the maximum number of phases reported
+ * for one compilation
+ */
+#define MAXPHASES 8
+
+typedef struct
+{
+    const char * name;
+    double wall, cpu; /* seconds */
+    long peakRss; /* kilobytes */
+    unsigned long tokens, nodes, bytes;
+} PhaseStat;
+
+static THREADLOCAL PhaseStat phases[MAXPHASES+1]; /* and the total */
+static THREADLOCAL int nphases = 0;
+
+static double seconds(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock,&ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void startPhase(const char * name)
+{
+    PhaseStat * p;
+    TRACE_BEGIN(name,NULL);
+    if (TimeReport == NoReport || nphases == MAXPHASES)
+        return;
+    p = &phases[nphases];
+    p->name = name;
+    p->tokens = tokenCount;
+    p->nodes = nodeCount;
+    p->bytes = bytesAllocated;
+    p->cpu = seconds(CLOCK_THREAD_CPUTIME_ID);
+    p->wall = seconds(CLOCK_MONOTONIC);
+}
+
+void endPhase(void)
+{
+    PhaseStat * p;
+    struct rusage usage;
+    TRACE_END();
+    if (TimeReport == NoReport || nphases == MAXPHASES)
+        return;
+    p = &phases[nphases++];
+    p->wall = seconds(CLOCK_MONOTONIC) - p->wall;
+    p->cpu = seconds(CLOCK_THREAD_CPUTIME_ID) - p->cpu;
+    p->tokens = tokenCount - p->tokens;
+    p->nodes = nodeCount - p->nodes;
+    p->bytes = bytesAllocated - p->bytes;
+    getrusage(RUSAGE_SELF,&usage);
+    p->peakRss = usage.ru_maxrss;
+}
+
+void reportPhases(const char * pgm)
+{
+    char report[MAXPHASES * 160 + FILENAME_MAX + 256];
+    PhaseStat total;
+    int i, n = 0;
+    if (TimeReport == NoReport)
+        return;
+    memset(&total,0,sizeof(total));
+    total.name = "total";
+    for (i = 0; i < nphases; i++)
+    {
+        total.wall += phases[i].wall;
+        total.cpu += phases[i].cpu;
+        total.tokens += phases[i].tokens;
+        total.nodes += phases[i].nodes;
+        total.bytes += phases[i].bytes;
+        if (phases[i].peakRss > total.peakRss)
+            total.peakRss = phases[i].peakRss;
+    }
+    phases[nphases] = total;
+    /* the report is formatted first and written at once,
+     * so reports of concurrent compilations never mix */
+    if (TimeReport == JsonReport)
+    {
+        n += snprintf(report+n,sizeof(report)-n,"{\"file\":\"");
+        for (i = 0; pgm[i] && n < FILENAME_MAX; i++)
+        {
+            if (pgm[i] == '"' || pgm[i] == '\\')
+                report[n++] = '\\';
+            report[n++] = pgm[i];
+        }
+        n += snprintf(report+n,sizeof(report)-n,"\",\"phases\":[");
+        for (i = 0; i <= nphases; i++)
+            n += snprintf(report+n,sizeof(report)-n,
+                "%s{\"name\":\"%s\",\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"peak_rss_kb\":%ld,"
+                "\"tokens\":%lu,\"nodes\":%lu,\"bytes\":%lu}",
+                i ? "," : "",phases[i].name,1e3*phases[i].wall,1e3*phases[i].cpu,
+                phases[i].peakRss,phases[i].tokens,phases[i].nodes,phases[i].bytes);
+        n += snprintf(report+n,sizeof(report)-n,"]");
+        if (reusedCount + recordedCount > 0)
+            n += snprintf(report+n,sizeof(report)-n,",\"reused\":%lu,\"recorded\":%lu",
+                reusedCount,recordedCount);
+        n += snprintf(report+n,sizeof(report)-n,"}\n");
+    }
+    else
+    {
+        n += snprintf(report+n,sizeof(report)-n,
+            "\nTime report for %s:\n%-10s %10s %10s %12s %10s %10s %12s\n",
+            pgm,"phase","wall ms","cpu ms","peak RSS KB","tokens","nodes","bytes");
+        for (i = 0; i <= nphases; i++)
+            n += snprintf(report+n,sizeof(report)-n,"%-10s %10.3f %10.3f %12ld %10lu %10lu %12lu\n",
+                phases[i].name,1e3*phases[i].wall,1e3*phases[i].cpu,
+                phases[i].peakRss,phases[i].tokens,phases[i].nodes,phases[i].bytes);
+        if (reusedCount + recordedCount > 0)
+            n += snprintf(report+n,sizeof(report)-n,"analyses: %lu reused, %lu recorded\n",
+                reusedCount,recordedCount);
+    }
+    fwrite(report,1,n,stderr);
+    nphases = 0;
+    tokenCount = nodeCount = bytesAllocated = 0;
+    reusedCount = recordedCount = 0;
+}
@@ -0,0 +1,44 @@
+/****************************************************/
+/* File: stats.h                                    */
+/* Per-phase timing and memory report               */
+/****************************************************/
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+/* counters of the current compilation on the calling
+ * thread: tokens returned by getToken, syntax tree
+ * nodes created and bytes taken from the node blocks
+ */
+extern THREADLOCAL unsigned long tokenCount;
+extern THREADLOCAL unsigned long nodeCount;
+extern THREADLOCAL unsigned long bytesAllocated;
+
+/* functions of the current compilation whose analysis
+ * the cache of the calling thread held, and those it
+ * did not and that were analyzed and recorded; both
+ * stay 0 unless the analysis is cached
+ */
+extern THREADLOCAL unsigned long reusedCount;
+extern THREADLOCAL unsigned long recordedCount;
+
+/* TimeReport selects the report printed to stderr
+ * after every compilation (-ftime-report)
+ */
+typedef enum {NoReport, TextReport, JsonReport} ReportKind;
+extern ReportKind TimeReport;
+
+/* Procedure startPhase begins measuring the phase name,
+ * which lasts until the matching endPhase; both do
+ * nothing unless a report or a trace was requested
+ */
+void startPhase(const char * name);
+void endPhase(void);
+
+/* Procedure reportPhases prints the phases measured
+ * since the last report for the source file pgm and
+ * resets the counters
+ */
+void reportPhases(const char * pgm);
+
+#endif
@@ -0,0 +1,274 @@
+/****************************************************/
+/* File: symtab.c                                   */
+/* Symbol table implementation for the C- compiler  */
+/* Names are interned, so the open hash table is    */
+/* keyed by the name pointer: probing compares      */
+/* pointers and never strings                       */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+
+/* A slot binds a name to its innermost declaration.
+ * Slots are never emptied: a name whose scopes are all
+ * closed keeps its slot with a NULL binding, ready for
+ * the next declaration. The table belongs to the thread
+ * and outlives compilations like the interned names
+ * do, whose number bounds its size
+ */
+typedef struct
+{
+    char * name;
+    Symbol * binding;
+} Slot;
+
+typedef struct
+{
+    const char * name;
+    Symbol * symbols;  /* declared in this scope, latest first */
+    int location;      /* next free memory location */
+    int count;         /* symbols declared so far */
+} Scope;
+
+struct globalScope
+{
+    Symbol ** table;   /* open hash table, keyed by name */
+    unsigned size;     /* a power of 2 */
+};
+
+static THREADLOCAL Slot * slots = NULL;
+static THREADLOCAL unsigned nslots = 0;
+static THREADLOCAL unsigned nused = 0;
+
+static THREADLOCAL Scope * scopes = NULL;
+static THREADLOCAL int depth = -1;
+static THREADLOCAL int maxdepth = 0;
+
+/* the globals st_lookup falls back on */
+static THREADLOCAL GlobalScope * shared = NULL;
+static THREADLOCAL int sharedOrder = 0;
+
+/* probe statistics, for TraceAnalyze */
+static THREADLOCAL unsigned long lookups = 0;
+static THREADLOCAL unsigned long probes = 0;
+static THREADLOCAL unsigned long longest = 0;
+static THREADLOCAL unsigned long nsymbols = 0;
+
+/* Function hashName mixes all the bits of the name
+ * pointer (the MurmurHash3 finalizer): names allocated
+ * one after the other differ in few of them
+ */
+static unsigned hashName(const char * name)
+{
+    unsigned long h = (unsigned long) name;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDUL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53UL;
+    h ^= h >> 33;
+    return (unsigned) h;
+}
+
+/* Function findSlot returns the slot of name, claiming
+ * an empty one if name has none; the table is kept at
+ * most half full
+ */
+static Slot * findSlot(char * name)
+{
+    unsigned i, n = 1;
+    if (2 * (nused + 1) > nslots) {
+        Slot * old = slots;
+        unsigned oldSize = nslots;
+        nslots = nslots ? 2 * nslots : 1024;
+        slots = (Slot *) calloc(nslots,sizeof(Slot));
+        for (i = 0; i < oldSize; i++)
+            if (old[i].name != NULL) {
+                unsigned j = hashName(old[i].name) & (nslots - 1);
+                while (slots[j].name != NULL)
+                    j = (j + 1) & (nslots - 1);
+                slots[j] = old[i];
+            }
+        free(old);
+    }
+    lookups++;
+    for (i = hashName(name) & (nslots - 1); slots[i].name != NULL && slots[i].name != name;
+         i = (i + 1) & (nslots - 1))
+        n++;
+    probes += n;
+    if (n > longest)
+        longest = n;
+    if (slots[i].name == NULL) {
+        slots[i].name = name;
+        slots[i].binding = NULL;
+        nused++;
+    }
+    return &slots[i];
+}
+
+void st_pushScope(const char * name)
+{
+    if (++depth == maxdepth) {
+        maxdepth = maxdepth ? 2 * maxdepth : 16;
+        scopes = (Scope *) realloc(scopes,maxdepth * sizeof(Scope));
+    }
+    scopes[depth].name = name;
+    scopes[depth].symbols = NULL;
+    scopes[depth].count = 0;
+    /* a function starts its frame afresh, a block goes on
+     * from the enclosing one */
+    scopes[depth].location = depth <= 1 ? 0 : scopes[depth-1].location;
+}
+
+static const char * kindNames[] = {"variable","array","function","parameter","array param"};
+static const char * typeNames[] = {"void","int","int[]"};
+
+/* Procedure printScope prints the symbols of the scope,
+ * in declaration order, with their line references
+ */
+static void printScope(Scope * scope)
+{
+    Symbol * s, * reversed = NULL;
+    LineList l;
+    while ((s = scope->symbols) != NULL) {
+        scope->symbols = s->scopeNext;
+        s->scopeNext = reversed;
+        reversed = s;
+    }
+    fprintf(listing,"\nScope %s (depth %d):\n",scope->name,depth);
+    fprintf(listing,"Name           Kind         Type   Location  Line Numbers\n");
+    fprintf(listing,"-------------  -----------  -----  --------  ------------\n");
+    for (s = reversed; s != NULL; s = s->scopeNext) {
+        fprintf(listing,"%-14s %-12s %-6s ",s->name,kindNames[s->kind],typeNames[s->type]);
+        if (s->kind == FuncSym)
+            fprintf(listing,"%8s ","-");
+        else
+            fprintf(listing,"%8d ",s->memloc);
+        for (l = s->lines; l != NULL; l = l->next)
+            fprintf(listing," %4d",l->lineno);
+        fprintf(listing,"\n");
+    }
+    scope->symbols = reversed;
+}
+
+void st_popScope(void)
+{
+    Symbol * s;
+    if (depth < 0)
+        return;
+    if (TraceAnalyze && scopes[depth].symbols != NULL)
+        printScope(&scopes[depth]);
+    /* each name of the scope gets its outer declaration
+     * back; the slots were found when they were declared */
+    for (s = scopes[depth].symbols; s != NULL; s = s->scopeNext)
+        findSlot(s->name)->binding = s->shadowed;
+    depth--;
+}
+
+Symbol * st_insert(char * name, SymbolKind kind, ExpType type, int size, TreeNode * decl)
+{
+    Slot * slot = findSlot(name);
+    Symbol * s;
+    if (slot->binding != NULL && slot->binding->depth == depth)
+        return NULL;
+    s = (Symbol *) allocate(sizeof(Symbol));
+    if (s == NULL) {
+        fprintf(listing,"Out of memory error at line %d\n",lineno);
+        return NULL;
+    }
+    s->name = name;
+    s->kind = kind;
+    s->type = type;
+    s->depth = depth;
+    s->size = size;
+    s->order = scopes[depth].count++;
+    s->memloc = kind == FuncSym ? 0 : scopes[depth].location;
+    scopes[depth].location += kind == FuncSym ? 0 : size;
+    s->decl = decl;
+    s->lines = s->lastLine = NULL;
+    s->shadowed = slot->binding;
+    s->scopeNext = scopes[depth].symbols;
+    scopes[depth].symbols = s;
+    slot->binding = s;
+    nsymbols++;
+    st_addLine(s,decl != NULL ? decl->lineno : 0);
+    return s;
+}
+
+Symbol * st_lookup(char * name)
+{
+    Symbol * s = findSlot(name)->binding;
+    unsigned i;
+    if (s != NULL || shared == NULL)
+        return s;
+    for (i = hashName(name) & (shared->size - 1); (s = shared->table[i]) != NULL;
+         i = (i + 1) & (shared->size - 1))
+        if (s->name == name)
+            return s->order <= sharedOrder ? s : NULL;
+    return NULL;
+}
+
+GlobalScope * st_shareGlobals(void)
+{
+    GlobalScope * g = (GlobalScope *) allocate(sizeof(GlobalScope));
+    Symbol * s;
+    unsigned i;
+    if (g == NULL)
+        return NULL;
+    for (g->size = 16; g->size < 2 * (unsigned) scopes[depth].count; g->size *= 2)
+        ;
+    g->table = (Symbol **) allocate(g->size * sizeof(Symbol *));
+    if (g->table == NULL)
+        return NULL;
+    memset(g->table,0,g->size * sizeof(Symbol *));
+    for (s = scopes[depth].symbols; s != NULL; s = s->scopeNext) {
+        for (i = hashName(s->name) & (g->size - 1); g->table[i] != NULL; i = (i + 1) & (g->size - 1))
+            ;
+        g->table[i] = s;
+    }
+    return g;
+}
+
+void st_useGlobals(GlobalScope * g, int order)
+{
+    shared = g;
+    sharedOrder = order;
+}
+
+void st_release(void)
+{
+    free(slots);
+    free(scopes);
+    slots = NULL;
+    scopes = NULL;
+    nslots = nused = 0;
+    depth = -1;
+    maxdepth = 0;
+    shared = NULL;
+}
+
+void st_addLine(Symbol * s, int lineno)
+{
+    LineList l;
+    if (lineno <= 0 || (s->lastLine != NULL && s->lastLine->lineno == lineno))
+        return;
+    l = (LineList) allocate(sizeof(struct lineListRec));
+    if (l == NULL)
+        return;
+    l->lineno = lineno;
+    l->next = NULL;
+    if (s->lastLine == NULL)
+        s->lines = l;
+    else
+        s->lastLine->next = l;
+    s->lastLine = l;
+}
+
+void printSymTabStats(void)
+{
+    fprintf(listing,"\nSymbol table: %lu symbols, %u names in %u slots (load %.2f)\n",
+            nsymbols,nused,nslots,nslots ? (double) nused / nslots : 0.0);
+    fprintf(listing,"Symbol table: %lu accesses, %.3f probes per access, longest probe %lu\n",
+            lookups,lookups ? (double) probes / lookups : 0.0,longest);
+    lookups = probes = longest = nsymbols = 0;
+}
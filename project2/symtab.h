@@ -0,0 +1,97 @@
+/****************************************************/
+/* File: symtab.h                                   */
+/* Symbol table interface for the C- compiler       */
+/* Scoped symbol table: an open hash table keyed by */
+/* interned name holds the innermost declaration of */
+/* each name, shadowed ones are chained behind it   */
+/****************************************************/
+
+#ifndef _SYMTAB_H_
+#define _SYMTAB_H_
+
+typedef enum {VarSym, ArraySym, FuncSym, ParamSym, ArrParamSym} SymbolKind;
+
+/* the list of line numbers of the source
+ * code in which a name is referenced
+ */
+typedef struct lineListRec
+{
+    int lineno;
+    struct lineListRec * next;
+} * LineList;
+
+/* Memory locations count words. Globals are numbered
+ * from 0 in declaration order; in a function, the
+ * parameters come first from 0 and the locals follow,
+ * the locals of a closed block being reused by the next
+ */
+typedef struct symbol
+{
+    char * name;      /* interned, so names compare as pointers */
+    SymbolKind kind;
+    ExpType type;     /* of a variable, returned by a function */
+    int depth;        /* nesting of the scope, 0 for globals */
+    int memloc;       /* memory location of a variable, code
+                       * location of a function once generated */
+    int size;         /* words taken by a variable */
+    int order;        /* declarations of the scope before it */
+    TreeNode * decl;  /* declaration node */
+    LineList lines, lastLine;
+    struct symbol * shadowed;  /* outer declaration of the name */
+    struct symbol * scopeNext; /* next of the same scope */
+} Symbol;
+
+/* Procedure st_pushScope opens a scope, named after its
+ * function for the listing
+ */
+void st_pushScope(const char * name);
+
+/* Procedure st_popScope closes the innermost scope,
+ * printing its symbols to the listing if TraceAnalyze
+ */
+void st_popScope(void);
+
+/* Function st_insert declares name in the innermost scope
+ * and records the declaration line; returns NULL if the
+ * scope already declares name
+ */
+Symbol * st_insert(char * name, SymbolKind kind, ExpType type, int size, TreeNode * decl);
+
+/* Function st_lookup returns the innermost declaration
+ * of name, or NULL if there is none
+ */
+Symbol * st_lookup(char * name);
+
+/* A global scope shared by threads that analyze
+ * function bodies side by side; it is read only
+ */
+typedef struct globalScope GlobalScope;
+
+/* Function st_shareGlobals copies the innermost scope,
+ * which must be the global one, into a GlobalScope
+ * that lives until the next freeNodes
+ */
+GlobalScope * st_shareGlobals(void);
+
+/* Procedure st_useGlobals makes st_lookup of the calling
+ * thread fall back on g for names its own scopes do not
+ * declare, seeing only the globals whose order is at
+ * most order as declaration before use demands; g is
+ * NULL to stop
+ */
+void st_useGlobals(GlobalScope * g, int order);
+
+/* Procedure st_release frees the table of the calling
+ * thread, which is about to end
+ */
+void st_release(void);
+
+/* Procedure st_addLine records a reference to s at lineno */
+void st_addLine(Symbol * s, int lineno);
+
+/* Procedure printSymTabStats prints the size and probe
+ * counts of the hash table to the listing
+ */
+void printSymTabStats(void);
+
+#endif
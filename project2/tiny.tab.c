@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,17 +45,17 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0.4"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
 #define YYPUSH 0
@@ -61,8 +66,8 @@
 
 
 
-/* Copy the first part of user declarations.  */
-#line 7 "tiny.y" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 7 "tiny.y"
 
 #define YYPARSER /* distinguishes Yacc output from other code files */
 
@@ -70,127 +75,207 @@
 #include "globals.h"
 #include "util.h"
 #include "parse.h"
+#include "trace.h"
+#include "pipeline.h"
 
 #define YYSTYPE TreeNode *
 
-static char * savedName; /* for use in assignments */
-static int savedLineNo;  /* ditto */
-static TreeNode * savedTree; /* stores syntax tree for later return */
-static int yylex(void);
+static THREADLOCAL char * savedName; /* for use in assignments */
+static THREADLOCAL int savedLineNo;  /* ditto */
+static THREADLOCAL TreeNode * savedTree; /* stores syntax tree for later return */
+static THREADLOCAL TokenType currentToken; /* lookahead for yyerror */
+static THREADLOCAL double declStart; /* trace time the declaration began */
+static THREADLOCAL int pipelined; /* tokens come from the scanner thread */
+static int yylex(YYSTYPE *);
 int yyerror(char *);
+static TreeNode * pushSibling(TreeNode *, TreeNode *);
+static TreeNode * reverseList(TreeNode *);
 
 
-#line 84 "tiny.tab.c" /* yacc.c:339  */
+#line 96 "tiny.tab.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULLPTR nullptr
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
 #  else
-#   define YY_NULLPTR 0
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "tiny.tab.h".  */
-#ifndef YY_YY_TINY_TAB_H_INCLUDED
-# define YY_YY_TINY_TAB_H_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    IF = 258,
-    ELSE = 259,
-    INT = 260,
-    RETURN = 261,
-    VOID = 262,
-    WHILE = 263,
-    ID = 264,
-    NUM = 265,
-    ASSIGN = 266,
-    EQ = 267,
-    NE = 268,
-    LT = 269,
-    LE = 270,
-    GT = 271,
-    GE = 272,
-    PLUS = 273,
-    MINUS = 274,
-    TIMES = 275,
-    OVER = 276,
-    LPAREN = 277,
-    RPAREN = 278,
-    LBRACE = 279,
-    RBRACE = 280,
-    LCURLY = 281,
-    RCURLY = 282,
-    SEMI = 283,
-    COMMA = 284,
-    ERROR = 285,
-    COMMENTERROR = 286
-  };
-#endif
+#include "tiny.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_IF = 3,                         /* IF  */
+  YYSYMBOL_ELSE = 4,                       /* ELSE  */
+  YYSYMBOL_INT = 5,                        /* INT  */
+  YYSYMBOL_RETURN = 6,                     /* RETURN  */
+  YYSYMBOL_VOID = 7,                       /* VOID  */
+  YYSYMBOL_WHILE = 8,                      /* WHILE  */
+  YYSYMBOL_ID = 9,                         /* ID  */
+  YYSYMBOL_NUM = 10,                       /* NUM  */
+  YYSYMBOL_ASSIGN = 11,                    /* ASSIGN  */
+  YYSYMBOL_EQ = 12,                        /* EQ  */
+  YYSYMBOL_NE = 13,                        /* NE  */
+  YYSYMBOL_LT = 14,                        /* LT  */
+  YYSYMBOL_LE = 15,                        /* LE  */
+  YYSYMBOL_GT = 16,                        /* GT  */
+  YYSYMBOL_GE = 17,                        /* GE  */
+  YYSYMBOL_PLUS = 18,                      /* PLUS  */
+  YYSYMBOL_MINUS = 19,                     /* MINUS  */
+  YYSYMBOL_TIMES = 20,                     /* TIMES  */
+  YYSYMBOL_OVER = 21,                      /* OVER  */
+  YYSYMBOL_LPAREN = 22,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 23,                    /* RPAREN  */
+  YYSYMBOL_LBRACE = 24,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 25,                    /* RBRACE  */
+  YYSYMBOL_LCURLY = 26,                    /* LCURLY  */
+  YYSYMBOL_RCURLY = 27,                    /* RCURLY  */
+  YYSYMBOL_SEMI = 28,                      /* SEMI  */
+  YYSYMBOL_COMMA = 29,                     /* COMMA  */
+  YYSYMBOL_ERROR = 30,                     /* ERROR  */
+  YYSYMBOL_COMMENTERROR = 31,              /* COMMENTERROR  */
+  YYSYMBOL_YYACCEPT = 32,                  /* $accept  */
+  YYSYMBOL_program = 33,                   /* program  */
+  YYSYMBOL_id = 34,                        /* id  */
+  YYSYMBOL_num = 35,                       /* num  */
+  YYSYMBOL_36_declaration_list = 36,       /* declaration-list  */
+  YYSYMBOL_declaration = 37,               /* declaration  */
+  YYSYMBOL_38_var_declaration = 38,        /* var-declaration  */
+  YYSYMBOL_39_1 = 39,                      /* @1  */
+  YYSYMBOL_40_type_specifier = 40,         /* type-specifier  */
+  YYSYMBOL_41_fun_declaration = 41,        /* fun-declaration  */
+  YYSYMBOL_42_2 = 42,                      /* @2  */
+  YYSYMBOL_params = 43,                    /* params  */
+  YYSYMBOL_44_params_list = 44,            /* params-list  */
+  YYSYMBOL_param = 45,                     /* param  */
+  YYSYMBOL_46_compound_stmt = 46,          /* compound-stmt  */
+  YYSYMBOL_47_local_declarations = 47,     /* local-declarations  */
+  YYSYMBOL_48_statement_list = 48,         /* statement-list  */
+  YYSYMBOL_statement = 49,                 /* statement  */
+  YYSYMBOL_50_expression_stmt = 50,        /* expression-stmt  */
+  YYSYMBOL_51_selection_stmt = 51,         /* selection-stmt  */
+  YYSYMBOL_52_iteration_stmt = 52,         /* iteration-stmt  */
+  YYSYMBOL_53_return_stmt = 53,            /* return-stmt  */
+  YYSYMBOL_expression = 54,                /* expression  */
+  YYSYMBOL_var = 55,                       /* var  */
+  YYSYMBOL_56_3 = 56,                      /* @3  */
+  YYSYMBOL_57_simple_expression = 57,      /* simple-expression  */
+  YYSYMBOL_58_additive_expression = 58,    /* additive-expression  */
+  YYSYMBOL_term = 59,                      /* term  */
+  YYSYMBOL_factor = 60,                    /* factor  */
+  YYSYMBOL_call = 61,                      /* call  */
+  YYSYMBOL_62_4 = 62,                      /* @4  */
+  YYSYMBOL_args = 63,                      /* args  */
+  YYSYMBOL_64_arg_list = 64                /* arg-list  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef int YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
 
 
-extern YYSTYPE yylval;
 
-int yyparse (void);
+#ifdef short
+# undef short
+#endif
 
-#endif /* !YY_YY_TINY_TAB_H_INCLUDED  */
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-/* Copy the second part of user declarations.  */
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
-#line 167 "tiny.tab.c" /* yacc.c:358  */
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#else
-typedef signed char yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -198,15 +283,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -220,47 +318,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
-#endif
-
-#if !defined _Noreturn \
-     && (!defined __STDC_VERSION__ || __STDC_VERSION__ < 201112)
-# if defined _MSC_VER && 1200 <= _MSC_VER
-#  define _Noreturn __declspec (noreturn)
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
 # else
-#  define _Noreturn YY_ATTRIBUTE ((__noreturn__))
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -273,8 +367,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -339,8 +447,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -349,17 +456,17 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -372,11 +479,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -388,12 +495,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -412,21 +519,24 @@ union yyalloc
 /* YYNNTS -- Number of nonterminals.  */
 #define YYNNTS  33
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  68
+#define YYNRULES  66
 /* YYNSTATES -- Number of states.  */
 #define YYNSTATES  112
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   286
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -460,62 +570,63 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,    37,    37,    43,    48,    55,    67,    73,    77,    83,
-      90,    89,   103,   108,   116,   115,   129,   133,   139,   151,
-     157,   163,   171,   178,   183,   194,   199,   210,   215,   219,
-     223,   227,   231,   237,   241,   247,   253,   262,   270,   275,
-     282,   288,   294,   300,   299,   311,   311,   319,   327,   335,
-     343,   351,   359,   365,   378,   391,   397,   410,   423,   429,
-     433,   437,   441,   450,   449,   461,   466,   471,   482
+       0,    49,    49,    55,    60,    67,    71,    77,    83,    91,
+      98,    97,   111,   116,   124,   123,   137,   141,   147,   151,
+     157,   163,   171,   179,   184,   189,   194,   199,   203,   207,
+     211,   215,   221,   225,   231,   237,   246,   254,   259,   266,
+     272,   278,   284,   283,   295,   303,   311,   319,   327,   335,
+     343,   349,   362,   375,   381,   394,   407,   413,   417,   421,
+     425,   434,   433,   445,   450,   455,   459
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "IF", "ELSE", "INT", "RETURN", "VOID",
-  "WHILE", "ID", "NUM", "ASSIGN", "EQ", "NE", "LT", "LE", "GT", "GE",
-  "PLUS", "MINUS", "TIMES", "OVER", "LPAREN", "RPAREN", "LBRACE", "RBRACE",
-  "LCURLY", "RCURLY", "SEMI", "COMMA", "ERROR", "COMMENTERROR", "$accept",
-  "program", "id", "num", "declaration-list", "declaration",
-  "var-declaration", "@1", "type-specifier", "fun-declaration", "@2",
-  "params", "params-list", "param", "compound-stmt", "local-declarations",
-  "statement-list", "statement", "expression-stmt", "selection-stmt",
-  "iteration-stmt", "return-stmt", "expression", "var", "@3",
-  "simple-expression", "additive-expression", "term", "factor", "call",
-  "@4", "args", "arg-list", YY_NULLPTR
+  "\"end of file\"", "error", "\"invalid token\"", "IF", "ELSE", "INT",
+  "RETURN", "VOID", "WHILE", "ID", "NUM", "ASSIGN", "EQ", "NE", "LT", "LE",
+  "GT", "GE", "PLUS", "MINUS", "TIMES", "OVER", "LPAREN", "RPAREN",
+  "LBRACE", "RBRACE", "LCURLY", "RCURLY", "SEMI", "COMMA", "ERROR",
+  "COMMENTERROR", "$accept", "program", "id", "num", "declaration-list",
+  "declaration", "var-declaration", "@1", "type-specifier",
+  "fun-declaration", "@2", "params", "params-list", "param",
+  "compound-stmt", "local-declarations", "statement-list", "statement",
+  "expression-stmt", "selection-stmt", "iteration-stmt", "return-stmt",
+  "expression", "var", "@3", "simple-expression", "additive-expression",
+  "term", "factor", "call", "@4", "args", "arg-list", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -95
+#define YYPACT_NINF (-95)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-95)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -64
+#define YYTABLE_NINF (-62)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
       19,   -95,   -95,     3,    19,   -95,   -95,    24,   -95,   -95,
@@ -532,26 +643,26 @@ static const yytype_int8 yypact[] =
      -95,   -95
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
        0,    12,    13,     0,     2,     6,     7,     0,     8,     1,
        5,     3,     0,    14,    10,     9,     0,     0,    13,     0,
-       0,    16,    19,     4,     0,    20,    23,     0,     0,     0,
-      25,    15,    18,    11,    21,    27,    24,     0,     0,     0,
-       0,     0,     0,    45,    22,    34,    42,    62,    29,    26,
-      28,    30,    31,    32,     0,    60,    41,    52,    55,    58,
-      61,    45,    38,     0,    45,     0,     0,     0,    33,    45,
+       0,    16,    19,     4,     0,    20,     0,     0,     0,     0,
+      24,    15,    18,    11,    21,    26,    23,     0,     0,     0,
+       0,     0,     0,     0,    22,    33,    41,    60,    28,    25,
+      27,    29,    30,    31,     0,    58,    40,    50,    53,    56,
+      59,     0,    37,     0,     0,     0,     0,     0,    32,     0,
        0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,    39,     0,    59,    45,    45,    40,    60,    50,    51,
-      47,    46,    48,    49,    53,    54,    56,    57,    23,    23,
-       0,    68,     0,    65,    35,    37,    44,    64,    45,    23,
-      67,    36
+       0,    38,     0,    57,     0,    64,    39,    58,    48,    49,
+      45,    44,    46,    47,    51,    52,    54,    55,     0,     0,
+       0,    66,     0,    63,    34,    36,    43,    62,     0,     0,
+      65,    35
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
      -95,   -95,    -6,    92,   -95,   106,    84,   -95,     5,   -95,
@@ -560,24 +671,24 @@ static const yytype_int8 yypgoto[] =
      -95,   -95,   -95
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     3,    46,    47,     4,     5,     6,    17,     7,     8,
+       0,     3,    46,    47,     4,     5,     6,    17,     7,     8,
       16,    20,    21,    22,    48,    35,    38,    49,    50,    51,
       52,    53,    54,    55,    66,    56,    57,    58,    59,    60,
       67,   102,   103
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int8 yytable[] =
 {
       63,    12,    65,     9,   104,   105,    11,    23,    14,    11,
       23,    40,    15,    25,    41,   111,    42,    11,    23,    43,
       80,    19,    43,    82,     1,    62,     2,     1,    86,    18,
-      43,    39,    19,    11,    30,    44,    45,   -63,    28,   -43,
+      43,    39,    19,    11,    30,    44,    45,   -61,    28,   -42,
       37,    78,    79,   100,   101,    40,    76,    77,    41,    23,
       42,    11,    23,    87,    87,    87,    87,    87,    87,    87,
       87,    87,    87,    13,    43,    14,   -17,   110,    30,    15,
@@ -604,9 +715,9 @@ static const yytype_int8 yycheck[] =
        4,    -1,    27,    -1,    26,    -1,    -1,    -1,    -1,    35
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     5,     7,    33,    36,    37,    38,    40,    41,     0,
       37,     9,    34,    22,    24,    28,    42,    39,     7,    40,
@@ -622,64 +733,64 @@ static const yytype_uint8 yystos[] =
       54,    49
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
        0,    32,    33,    34,    35,    36,    36,    37,    37,    38,
       39,    38,    40,    40,    42,    41,    43,    43,    44,    44,
-      45,    45,    46,    46,    47,    47,    48,    48,    49,    49,
-      49,    49,    49,    50,    50,    51,    51,    52,    53,    53,
-      54,    54,    55,    56,    55,    57,    57,    57,    57,    57,
-      57,    57,    57,    58,    58,    58,    59,    59,    59,    60,
-      60,    60,    60,    62,    61,    63,    63,    64,    64
+      45,    45,    46,    47,    47,    48,    48,    49,    49,    49,
+      49,    49,    50,    50,    51,    51,    52,    53,    53,    54,
+      54,    55,    56,    55,    57,    57,    57,    57,    57,    57,
+      57,    58,    58,    58,    59,    59,    59,    60,    60,    60,
+      60,    62,    61,    63,    63,    64,    64
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
        0,     2,     1,     1,     1,     2,     1,     1,     1,     3,
        0,     7,     1,     1,     0,     7,     1,     1,     3,     1,
-       2,     4,     4,     0,     2,     0,     2,     0,     1,     1,
-       1,     1,     1,     2,     1,     5,     7,     5,     2,     3,
-       3,     1,     1,     0,     5,     0,     3,     3,     3,     3,
-       3,     3,     1,     3,     3,     1,     3,     3,     1,     3,
-       1,     1,     1,     0,     5,     1,     0,     3,     1
+       2,     4,     4,     2,     0,     2,     0,     1,     1,     1,
+       1,     1,     2,     1,     5,     7,     5,     2,     3,     3,
+       1,     1,     0,     5,     3,     3,     3,     3,     3,     3,
+       1,     3,     3,     1,     3,     3,     1,     3,     1,     1,
+       1,     0,     5,     1,     0,     3,     1
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 
 /* Enable debugging if requested.  */
@@ -696,55 +807,52 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value); \
+                  Kind, Value); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -753,7 +861,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -776,21 +884,21 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, int yyrule)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &(yyvsp[(yyi + 1) - (yynrhs)])
-                                              );
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -805,8 +913,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -829,255 +937,31 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-static YYSIZE_T
-yystrlen (const char *yystr)
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
 
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
 
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-        switch (*++yyp)
-          {
-          case '\'':
-          case ',':
-            goto do_not_strip_quotes;
-
-          case '\\':
-            if (*++yyp != '\\')
-              goto do_not_strip_quotes;
-            /* Fall through.  */
-          default:
-            if (yyres)
-              yyres[yyn] = *yyp;
-            yyn++;
-            break;
-
-          case '"':
-            if (yyres)
-              yyres[yyn] = '\0';
-            return yyn;
-          }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
-
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
-  }
-
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
 {
-  YYUSE (yyvaluep);
+  YY_USE (yyvaluep);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
 
 
-/* The lookahead symbol.  */
-int yychar;
-
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 /*----------.
@@ -1087,43 +971,49 @@ int yynerrs;
 int
 yyparse (void)
 {
-    int yystate;
-    /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
+/* Lookahead token kind.  */
+int yychar;
 
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
+
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1131,71 +1021,75 @@ yyparse (void)
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
                     &yystacksize);
-
         yyss = yyss1;
         yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
@@ -1203,30 +1097,31 @@ yyparse (void)
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1237,18 +1132,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = yylex ();
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex (&yylval);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1276,15 +1182,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1299,7 +1203,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1319,668 +1223,630 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 38 "tiny.y" /* yacc.c:1646  */
-    {
-                        savedTree = (yyvsp[0]);
+  case 2: /* program: declaration-list  */
+#line 50 "tiny.y"
+                    {
+                        savedTree = reverseList(yyvsp[0]);
                     }
-#line 1328 "tiny.tab.c" /* yacc.c:1646  */
+#line 1232 "tiny.tab.c"
     break;
 
-  case 3:
-#line 44 "tiny.y" /* yacc.c:1646  */
+  case 3: /* id: ID  */
+#line 56 "tiny.y"
     {
-        savedName = copyString(tokenString); 
+        savedName = internString(tokenString); 
     }
-#line 1336 "tiny.tab.c" /* yacc.c:1646  */
+#line 1240 "tiny.tab.c"
     break;
 
-  case 4:
-#line 49 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = newExpNode(NumK);
-            (yyval)->attr.val = atoi(tokenString);
+  case 4: /* num: NUM  */
+#line 61 "tiny.y"
+        {
+            yyval = newExpNode(NumK);
+            yyval->attr.val = atoi(tokenString);
         }
-#line 1345 "tiny.tab.c" /* yacc.c:1646  */
+#line 1249 "tiny.tab.c"
     break;
 
-  case 5:
-#line 56 "tiny.y" /* yacc.c:1646  */
-    {
-                                YYSTYPE t = (yyvsp[-1]);
-                                if (t != NULL){
-                                    while (t->sibling != NULL){
-                                        t = t->sibling;
-                                    }
-                                    t->sibling = (yyvsp[0]);
-                                    (yyval) = (yyvsp[-1]); 
-                                }
-                                else (yyval) = (yyvsp[0]);
+  case 5: /* declaration-list: declaration-list declaration  */
+#line 68 "tiny.y"
+                            {
+                                yyval = pushSibling(yyvsp[-1],yyvsp[0]);
                             }
-#line 1361 "tiny.tab.c" /* yacc.c:1646  */
+#line 1257 "tiny.tab.c"
     break;
 
-  case 6:
-#line 68 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = (yyvsp[0]);
+  case 6: /* declaration-list: declaration  */
+#line 72 "tiny.y"
+                            {
+                                yyval = yyvsp[0];
                             }
-#line 1369 "tiny.tab.c" /* yacc.c:1646  */
+#line 1265 "tiny.tab.c"
     break;
 
-  case 7:
-#line 74 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = (yyvsp[0]);
+  case 7: /* declaration: var-declaration  */
+#line 78 "tiny.y"
+                    {
+                        yyval = yyvsp[0];
+                        TRACE_SPAN("parse variable",yyval->attr.name,declStart);
+                        declStart = TRACE_MARK();
                     }
-#line 1377 "tiny.tab.c" /* yacc.c:1646  */
+#line 1275 "tiny.tab.c"
     break;
 
-  case 8:
-#line 78 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = (yyvsp[0]);
+  case 8: /* declaration: fun-declaration  */
+#line 84 "tiny.y"
+                    {
+                        yyval = yyvsp[0];
+                        TRACE_SPAN("parse function",yyval->attr.name,declStart);
+                        declStart = TRACE_MARK();
                     }
-#line 1385 "tiny.tab.c" /* yacc.c:1646  */
+#line 1285 "tiny.tab.c"
     break;
 
-  case 9:
-#line 84 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = newDeclNode(VarK);
-                                (yyval)->child[0] = (yyvsp[-2]);
-                                (yyval)->attr.name = savedName;
+  case 9: /* var-declaration: type-specifier id SEMI  */
+#line 92 "tiny.y"
+                            {
+                                yyval = newDeclNode(VarK);
+                                yyval->child[0] = yyvsp[-2];
+                                yyval->attr.name = savedName;
                             }
-#line 1395 "tiny.tab.c" /* yacc.c:1646  */
+#line 1295 "tiny.tab.c"
     break;
 
-  case 10:
-#line 90 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = newDeclNode(ArrVarK);
-                                (yyval)->child[0] = newExpNode(TypeK);
-                                (yyval)->child[0]->type = IntegerArray;
-                                (yyval)->attr.name = savedName;
+  case 10: /* @1: %empty  */
+#line 98 "tiny.y"
+                            {
+                                yyval = newDeclNode(ArrVarK);
+                                yyval->child[0] = newExpNode(TypeK);
+                                yyval->child[0]->type = IntegerArray;
+                                yyval->attr.name = savedName;
                             }
-#line 1406 "tiny.tab.c" /* yacc.c:1646  */
+#line 1306 "tiny.tab.c"
     break;
 
-  case 11:
-#line 97 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = (yyvsp[-3]);
-                                (yyval)->child[1] = (yyvsp[-2]);
+  case 11: /* var-declaration: type-specifier id LBRACE @1 num RBRACE SEMI  */
+#line 105 "tiny.y"
+                            {
+                                yyval = yyvsp[-3];
+                                yyval->child[1] = yyvsp[-2];
                             }
-#line 1415 "tiny.tab.c" /* yacc.c:1646  */
+#line 1315 "tiny.tab.c"
     break;
 
-  case 12:
-#line 104 "tiny.y" /* yacc.c:1646  */
-    {
-                            (yyval) = newExpNode(TypeK);
-                            (yyval)->type = Integer;
+  case 12: /* type-specifier: INT  */
+#line 112 "tiny.y"
+                        {
+                            yyval = newExpNode(TypeK);
+                            yyval->type = Integer;
                         }
-#line 1424 "tiny.tab.c" /* yacc.c:1646  */
+#line 1324 "tiny.tab.c"
     break;
 
-  case 13:
-#line 109 "tiny.y" /* yacc.c:1646  */
-    {
-                            (yyval) = newExpNode(TypeK);
-                            (yyval)->type = Void;
+  case 13: /* type-specifier: VOID  */
+#line 117 "tiny.y"
+                        {
+                            yyval = newExpNode(TypeK);
+                            yyval->type = Void;
                         }
-#line 1433 "tiny.tab.c" /* yacc.c:1646  */
+#line 1333 "tiny.tab.c"
     break;
 
-  case 14:
-#line 116 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = newDeclNode(FunK);
-                                (yyval)->child[0] = (yyvsp[-2]);
-                                (yyval)->attr.name = savedName;
+  case 14: /* @2: %empty  */
+#line 124 "tiny.y"
+                            {
+                                yyval = newDeclNode(FunK);
+                                yyval->child[0] = yyvsp[-2];
+                                yyval->attr.name = savedName;
                             }
-#line 1443 "tiny.tab.c" /* yacc.c:1646  */
+#line 1343 "tiny.tab.c"
     break;
 
-  case 15:
-#line 122 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = (yyvsp[-3]);
-                                (yyval)->child[1] = (yyvsp[-2]);
-                                (yyval)->child[2] = (yyvsp[0]);
+  case 15: /* fun-declaration: type-specifier id LPAREN @2 params RPAREN compound-stmt  */
+#line 130 "tiny.y"
+                            {
+                                yyval = yyvsp[-3];
+                                yyval->child[1] = yyvsp[-2];
+                                yyval->child[2] = yyvsp[0];
                             }
-#line 1453 "tiny.tab.c" /* yacc.c:1646  */
+#line 1353 "tiny.tab.c"
     break;
 
-  case 16:
-#line 130 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = (yyvsp[0]);
+  case 16: /* params: params-list  */
+#line 138 "tiny.y"
+            {
+                yyval = reverseList(yyvsp[0]);
             }
-#line 1461 "tiny.tab.c" /* yacc.c:1646  */
+#line 1361 "tiny.tab.c"
     break;
 
-  case 17:
-#line 134 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = NULL;
+  case 17: /* params: VOID  */
+#line 142 "tiny.y"
+            {
+                yyval = NULL;
             }
-#line 1469 "tiny.tab.c" /* yacc.c:1646  */
+#line 1369 "tiny.tab.c"
     break;
 
-  case 18:
-#line 140 "tiny.y" /* yacc.c:1646  */
-    {
-                YYSTYPE t = (yyvsp[-2]);
-                if (t != NULL){
-                    while (t->sibling != NULL){
-                        t = t->sibling;
-                    }
-                    t->sibling = (yyvsp[0]);
-                    (yyval) = (yyvsp[-2]); 
-                }
-                else (yyval) = (yyvsp[-2]);
+  case 18: /* params-list: params-list COMMA param  */
+#line 148 "tiny.y"
+            {
+                yyval = pushSibling(yyvsp[-2],yyvsp[0]);
             }
-#line 1485 "tiny.tab.c" /* yacc.c:1646  */
+#line 1377 "tiny.tab.c"
     break;
 
-  case 19:
-#line 152 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = (yyvsp[0]);
+  case 19: /* params-list: param  */
+#line 152 "tiny.y"
+            {
+                yyval = yyvsp[0];
             }
-#line 1493 "tiny.tab.c" /* yacc.c:1646  */
+#line 1385 "tiny.tab.c"
     break;
 
-  case 20:
-#line 158 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = newDeclNode(ParamK);
-                (yyval)->child[0] = (yyvsp[-1]);
-                (yyval)->attr.name = savedName;
+  case 20: /* param: type-specifier id  */
+#line 158 "tiny.y"
+            {
+                yyval = newDeclNode(ParamK);
+                yyval->child[0] = yyvsp[-1];
+                yyval->attr.name = savedName;
             }
-#line 1503 "tiny.tab.c" /* yacc.c:1646  */
+#line 1395 "tiny.tab.c"
     break;
 
-  case 21:
-#line 164 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = newDeclNode(ArrParamK);
-                (yyval)->child[0] = (yyvsp[-3]);
-                (yyval)->attr.name = savedName;
+  case 21: /* param: type-specifier id LBRACE RBRACE  */
+#line 164 "tiny.y"
+            {
+                yyval = newDeclNode(ArrParamK);
+                yyval->child[0] = yyvsp[-3];
+                yyval->attr.name = savedName;
             }
-#line 1513 "tiny.tab.c" /* yacc.c:1646  */
+#line 1405 "tiny.tab.c"
     break;
 
-  case 22:
-#line 172 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = newStmtNode(CompoundK);
-                                (yyval)->child[0] = (yyvsp[-2]);
-                                (yyval)->child[1] = (yyvsp[-1]);
+  case 22: /* compound-stmt: LCURLY local-declarations statement-list RCURLY  */
+#line 172 "tiny.y"
+                            {
+                                yyval = newStmtNode(CompoundK);
+                                yyval->child[0] = reverseList(yyvsp[-2]);
+                                yyval->child[1] = reverseList(yyvsp[-1]);
                             }
-#line 1523 "tiny.tab.c" /* yacc.c:1646  */
+#line 1415 "tiny.tab.c"
     break;
 
-  case 23:
-#line 178 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = NULL;
-                            }
-#line 1531 "tiny.tab.c" /* yacc.c:1646  */
-    break;
-
-  case 24:
-#line 184 "tiny.y" /* yacc.c:1646  */
-    {
-                                    YYSTYPE t = (yyvsp[-1]);
-                                    if (t != NULL){
-                                        while (t->sibling != NULL)
-                                            t = t->sibling;
-                                        t->sibling = (yyvsp[0]);
-                                        (yyval) = (yyvsp[-1]); }
-                                    else (yyval) = (yyvsp[0]);
+  case 23: /* local-declarations: local-declarations var-declaration  */
+#line 180 "tiny.y"
+                                {
+                                    yyval = pushSibling(yyvsp[-1],yyvsp[0]);
                                 }
-#line 1545 "tiny.tab.c" /* yacc.c:1646  */
+#line 1423 "tiny.tab.c"
     break;
 
-  case 25:
-#line 194 "tiny.y" /* yacc.c:1646  */
-    {
-                                    (yyval) = NULL;
+  case 24: /* local-declarations: %empty  */
+#line 184 "tiny.y"
+                                {
+                                    yyval = NULL;
                                 }
-#line 1553 "tiny.tab.c" /* yacc.c:1646  */
+#line 1431 "tiny.tab.c"
     break;
 
-  case 26:
-#line 200 "tiny.y" /* yacc.c:1646  */
-    {
-                            YYSTYPE t = (yyvsp[-1]);
-                            if (t != NULL){
-                                while (t->sibling != NULL)
-                                    t = t->sibling;
-                                t->sibling = (yyvsp[0]);
-                                (yyval) = (yyvsp[-1]); }
-                            else (yyval) = (yyvsp[0]);
+  case 25: /* statement-list: statement-list statement  */
+#line 190 "tiny.y"
+                        {
+                            yyval = pushSibling(yyvsp[-1],yyvsp[0]);
                         }
-#line 1567 "tiny.tab.c" /* yacc.c:1646  */
+#line 1439 "tiny.tab.c"
     break;
 
-  case 27:
-#line 210 "tiny.y" /* yacc.c:1646  */
-    {
-                            (yyval) = NULL;
+  case 26: /* statement-list: %empty  */
+#line 194 "tiny.y"
+                        {
+                            yyval = NULL;
                         }
-#line 1575 "tiny.tab.c" /* yacc.c:1646  */
+#line 1447 "tiny.tab.c"
     break;
 
-  case 28:
-#line 216 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = (yyvsp[0]);
+  case 27: /* statement: expression-stmt  */
+#line 200 "tiny.y"
+                    {
+                        yyval = yyvsp[0];
                     }
-#line 1583 "tiny.tab.c" /* yacc.c:1646  */
+#line 1455 "tiny.tab.c"
     break;
 
-  case 29:
-#line 220 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = (yyvsp[0]);
+  case 28: /* statement: compound-stmt  */
+#line 204 "tiny.y"
+                    {
+                        yyval = yyvsp[0];
                     }
-#line 1591 "tiny.tab.c" /* yacc.c:1646  */
+#line 1463 "tiny.tab.c"
     break;
 
-  case 30:
-#line 224 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = (yyvsp[0]);
+  case 29: /* statement: selection-stmt  */
+#line 208 "tiny.y"
+                    {
+                        yyval = yyvsp[0];
                     }
-#line 1599 "tiny.tab.c" /* yacc.c:1646  */
+#line 1471 "tiny.tab.c"
     break;
 
-  case 31:
-#line 228 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = (yyvsp[0]);
+  case 30: /* statement: iteration-stmt  */
+#line 212 "tiny.y"
+                    {
+                        yyval = yyvsp[0];
                     }
-#line 1607 "tiny.tab.c" /* yacc.c:1646  */
+#line 1479 "tiny.tab.c"
     break;
 
-  case 32:
-#line 232 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = (yyvsp[0]);
+  case 31: /* statement: return-stmt  */
+#line 216 "tiny.y"
+                    {
+                        yyval = yyvsp[0];
                     }
-#line 1615 "tiny.tab.c" /* yacc.c:1646  */
+#line 1487 "tiny.tab.c"
     break;
 
-  case 33:
-#line 238 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = (yyvsp[-1]);
+  case 32: /* expression-stmt: expression SEMI  */
+#line 222 "tiny.y"
+                            {
+                                yyval = yyvsp[-1];
                             }
-#line 1623 "tiny.tab.c" /* yacc.c:1646  */
+#line 1495 "tiny.tab.c"
     break;
 
-  case 34:
-#line 242 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = NULL;
+  case 33: /* expression-stmt: SEMI  */
+#line 226 "tiny.y"
+                            {
+                                yyval = NULL;
                             }
-#line 1631 "tiny.tab.c" /* yacc.c:1646  */
+#line 1503 "tiny.tab.c"
     break;
 
-  case 35:
-#line 248 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = newStmtNode(IfK);
-                                (yyval)->child[0] = (yyvsp[-2]);
-                                (yyval)->child[1] = (yyvsp[0]);
+  case 34: /* selection-stmt: IF LPAREN expression RPAREN statement  */
+#line 232 "tiny.y"
+                            {
+                                yyval = newStmtNode(IfK);
+                                yyval->child[0] = yyvsp[-2];
+                                yyval->child[1] = yyvsp[0];
                             }
-#line 1641 "tiny.tab.c" /* yacc.c:1646  */
+#line 1513 "tiny.tab.c"
     break;
 
-  case 36:
-#line 254 "tiny.y" /* yacc.c:1646  */
-    {
-                                (yyval) = newStmtNode(IfK);
-                                (yyval)->child[0] = (yyvsp[-4]);
-                                (yyval)->child[1] = (yyvsp[-2]);
-                                (yyval)->child[2] = (yyvsp[0]);
+  case 35: /* selection-stmt: IF LPAREN expression RPAREN statement ELSE statement  */
+#line 238 "tiny.y"
+                            {
+                                yyval = newStmtNode(IfK);
+                                yyval->child[0] = yyvsp[-4];
+                                yyval->child[1] = yyvsp[-2];
+                                yyval->child[2] = yyvsp[0];
                             }
-#line 1652 "tiny.tab.c" /* yacc.c:1646  */
+#line 1524 "tiny.tab.c"
     break;
 
-  case 37:
-#line 263 "tiny.y" /* yacc.c:1646  */
-    {
-                            (yyval) = newStmtNode(WhileK);
-                            (yyval)->child[0] = (yyvsp[-2]);
-                            (yyval)->child[1] = (yyvsp[0]);
+  case 36: /* iteration-stmt: WHILE LPAREN expression RPAREN statement  */
+#line 247 "tiny.y"
+                        {
+                            yyval = newStmtNode(WhileK);
+                            yyval->child[0] = yyvsp[-2];
+                            yyval->child[1] = yyvsp[0];
                         }
-#line 1662 "tiny.tab.c" /* yacc.c:1646  */
+#line 1534 "tiny.tab.c"
     break;
 
-  case 38:
-#line 271 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = newStmtNode(ReturnK);
-                        (yyval)->attr.name = NULL;
+  case 37: /* return-stmt: RETURN SEMI  */
+#line 255 "tiny.y"
+                    {
+                        yyval = newStmtNode(ReturnK);
+                        yyval->attr.name = NULL;
                     }
-#line 1671 "tiny.tab.c" /* yacc.c:1646  */
+#line 1543 "tiny.tab.c"
     break;
 
-  case 39:
-#line 276 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = newStmtNode(ReturnK);
-                        (yyval)->child[0] = (yyvsp[-1]);
+  case 38: /* return-stmt: RETURN expression SEMI  */
+#line 260 "tiny.y"
+                    {
+                        yyval = newStmtNode(ReturnK);
+                        yyval->child[0] = yyvsp[-1];
                     }
-#line 1680 "tiny.tab.c" /* yacc.c:1646  */
+#line 1552 "tiny.tab.c"
     break;
 
-  case 40:
-#line 283 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = newStmtNode(AssignK);
-                        (yyval)->child[0] = (yyvsp[-2]);
-                        (yyval)->child[1] = (yyvsp[0]);
+  case 39: /* expression: var ASSIGN expression  */
+#line 267 "tiny.y"
+                    {
+                        yyval = newStmtNode(AssignK);
+                        yyval->child[0] = yyvsp[-2];
+                        yyval->child[1] = yyvsp[0];
                     }
-#line 1690 "tiny.tab.c" /* yacc.c:1646  */
+#line 1562 "tiny.tab.c"
     break;
 
-  case 41:
-#line 289 "tiny.y" /* yacc.c:1646  */
-    {
-                        (yyval) = (yyvsp[0]);
+  case 40: /* expression: simple-expression  */
+#line 273 "tiny.y"
+                    {
+                        yyval = yyvsp[0];
                     }
-#line 1698 "tiny.tab.c" /* yacc.c:1646  */
+#line 1570 "tiny.tab.c"
     break;
 
-  case 42:
-#line 295 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = newExpNode(IdK);
-            (yyval)->attr.name = savedName;
+  case 41: /* var: id  */
+#line 279 "tiny.y"
+        {
+            yyval = newExpNode(IdK);
+            yyval->attr.name = savedName;
         }
-#line 1707 "tiny.tab.c" /* yacc.c:1646  */
+#line 1579 "tiny.tab.c"
     break;
 
-  case 43:
-#line 300 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = newExpNode(ArrK);
-            (yyval)->attr.name = savedName;
+  case 42: /* @3: %empty  */
+#line 284 "tiny.y"
+        {
+            yyval = newExpNode(ArrK);
+            yyval->attr.name = savedName;
         }
-#line 1716 "tiny.tab.c" /* yacc.c:1646  */
+#line 1588 "tiny.tab.c"
     break;
 
-  case 44:
-#line 305 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[-3]);
-            (yyval)->child[0] = (yyvsp[-1]);
+  case 43: /* var: id @3 LBRACE expression RBRACE  */
+#line 289 "tiny.y"
+        {
+            yyval = yyvsp[-3];
+            yyval->child[0] = yyvsp[-1];
         }
-#line 1725 "tiny.tab.c" /* yacc.c:1646  */
+#line 1597 "tiny.tab.c"
     break;
 
-  case 46:
-#line 312 "tiny.y" /* yacc.c:1646  */
-    {
-                                    (yyval) = newExpNode(simpleK);
-                                    (yyval)->child[0] = (yyvsp[-2]);
-                                    (yyval)->child[1] = newExpNode(OpK);
-                                    (yyval)->child[1]->attr.op = LE;
-                                    (yyval)->child[2] = (yyvsp[0]);
+  case 44: /* simple-expression: additive-expression LE additive-expression  */
+#line 296 "tiny.y"
+                                {
+                                    yyval = newExpNode(simpleK);
+                                    yyval->child[0] = yyvsp[-2];
+                                    yyval->child[1] = newExpNode(OpK);
+                                    yyval->child[1]->attr.op = LE;
+                                    yyval->child[2] = yyvsp[0];
                                 }
-#line 1737 "tiny.tab.c" /* yacc.c:1646  */
+#line 1609 "tiny.tab.c"
     break;
 
-  case 47:
-#line 320 "tiny.y" /* yacc.c:1646  */
-    {
-                                    (yyval) = newExpNode(simpleK);
-                                    (yyval)->child[0] = (yyvsp[-2]);
-                                    (yyval)->child[1] = newExpNode(OpK);
-                                    (yyval)->child[1]->attr.op = LT;
-                                    (yyval)->child[2] = (yyvsp[0]);
+  case 45: /* simple-expression: additive-expression LT additive-expression  */
+#line 304 "tiny.y"
+                                {
+                                    yyval = newExpNode(simpleK);
+                                    yyval->child[0] = yyvsp[-2];
+                                    yyval->child[1] = newExpNode(OpK);
+                                    yyval->child[1]->attr.op = LT;
+                                    yyval->child[2] = yyvsp[0];
                                 }
-#line 1749 "tiny.tab.c" /* yacc.c:1646  */
+#line 1621 "tiny.tab.c"
     break;
 
-  case 48:
-#line 328 "tiny.y" /* yacc.c:1646  */
-    {
-                                    (yyval) = newExpNode(simpleK);
-                                    (yyval)->child[0] = (yyvsp[-2]);
-                                    (yyval)->child[1] = newExpNode(OpK);
-                                    (yyval)->child[1]->attr.op = GT;
-                                    (yyval)->child[2] = (yyvsp[0]);
+  case 46: /* simple-expression: additive-expression GT additive-expression  */
+#line 312 "tiny.y"
+                                {
+                                    yyval = newExpNode(simpleK);
+                                    yyval->child[0] = yyvsp[-2];
+                                    yyval->child[1] = newExpNode(OpK);
+                                    yyval->child[1]->attr.op = GT;
+                                    yyval->child[2] = yyvsp[0];
                                 }
-#line 1761 "tiny.tab.c" /* yacc.c:1646  */
+#line 1633 "tiny.tab.c"
     break;
 
-  case 49:
-#line 336 "tiny.y" /* yacc.c:1646  */
-    {
-                                    (yyval) = newExpNode(simpleK);
-                                    (yyval)->child[0] = (yyvsp[-2]);
-                                    (yyval)->child[1] = newExpNode(OpK);
-                                    (yyval)->child[1]->attr.op = GE;
-                                    (yyval)->child[2] = (yyvsp[0]);
+  case 47: /* simple-expression: additive-expression GE additive-expression  */
+#line 320 "tiny.y"
+                                {
+                                    yyval = newExpNode(simpleK);
+                                    yyval->child[0] = yyvsp[-2];
+                                    yyval->child[1] = newExpNode(OpK);
+                                    yyval->child[1]->attr.op = GE;
+                                    yyval->child[2] = yyvsp[0];
                                 }
-#line 1773 "tiny.tab.c" /* yacc.c:1646  */
+#line 1645 "tiny.tab.c"
     break;
 
-  case 50:
-#line 344 "tiny.y" /* yacc.c:1646  */
-    {
-                                    (yyval) = newExpNode(simpleK);
-                                    (yyval)->child[0] = (yyvsp[-2]);
-                                    (yyval)->child[1] = newExpNode(OpK);
-                                    (yyval)->child[1]->attr.op = EQ;
-                                    (yyval)->child[2] = (yyvsp[0]);
+  case 48: /* simple-expression: additive-expression EQ additive-expression  */
+#line 328 "tiny.y"
+                                {
+                                    yyval = newExpNode(simpleK);
+                                    yyval->child[0] = yyvsp[-2];
+                                    yyval->child[1] = newExpNode(OpK);
+                                    yyval->child[1]->attr.op = EQ;
+                                    yyval->child[2] = yyvsp[0];
                                 }
-#line 1785 "tiny.tab.c" /* yacc.c:1646  */
+#line 1657 "tiny.tab.c"
     break;
 
-  case 51:
-#line 352 "tiny.y" /* yacc.c:1646  */
-    {
-                                    (yyval) = newExpNode(simpleK);
-                                    (yyval)->child[0] = (yyvsp[-2]);
-                                    (yyval)->child[1] = newExpNode(OpK);
-                                    (yyval)->child[1]->attr.op = NE;
-                                    (yyval)->child[2] = (yyvsp[0]);
+  case 49: /* simple-expression: additive-expression NE additive-expression  */
+#line 336 "tiny.y"
+                                {
+                                    yyval = newExpNode(simpleK);
+                                    yyval->child[0] = yyvsp[-2];
+                                    yyval->child[1] = newExpNode(OpK);
+                                    yyval->child[1]->attr.op = NE;
+                                    yyval->child[2] = yyvsp[0];
                                 }
-#line 1797 "tiny.tab.c" /* yacc.c:1646  */
+#line 1669 "tiny.tab.c"
     break;
 
-  case 52:
-#line 360 "tiny.y" /* yacc.c:1646  */
-    {
-                                    (yyval) = (yyvsp[0]);
+  case 50: /* simple-expression: additive-expression  */
+#line 344 "tiny.y"
+                                {
+                                    yyval = yyvsp[0];
                                 }
-#line 1805 "tiny.tab.c" /* yacc.c:1646  */
+#line 1677 "tiny.tab.c"
     break;
 
-  case 53:
-#line 366 "tiny.y" /* yacc.c:1646  */
-    {
-                                        (yyval) = newExpNode(addK);
-                                        YYSTYPE t = (yyvsp[-2]);
+  case 51: /* additive-expression: additive-expression PLUS term  */
+#line 350 "tiny.y"
+                                    {
+                                        yyval = newExpNode(addK);
+                                        YYSTYPE t = yyvsp[-2];
                                         if (t != NULL){
                                             while (t->sibling != NULL)
                                                 t = t->sibling;
                                             t->sibling = newExpNode(OpK);
                                             t->sibling-> attr.op = PLUS;
-                                            t->sibling->sibling = (yyvsp[0]);
-                                            (yyval)->child[0] = (yyvsp[-2]); }
+                                            t->sibling->sibling = yyvsp[0];
+                                            yyval->child[0] = yyvsp[-2]; }
                                         //else $$ = $2;
                                     }
-#line 1822 "tiny.tab.c" /* yacc.c:1646  */
+#line 1694 "tiny.tab.c"
     break;
 
-  case 54:
-#line 379 "tiny.y" /* yacc.c:1646  */
-    {
-                                        (yyval) = newExpNode(addK);
-                                        YYSTYPE t = (yyvsp[-2]);
+  case 52: /* additive-expression: additive-expression MINUS term  */
+#line 363 "tiny.y"
+                                    {
+                                        yyval = newExpNode(addK);
+                                        YYSTYPE t = yyvsp[-2];
                                         if (t != NULL){
                                             while (t->sibling != NULL)
                                                 t = t->sibling;
                                             t->sibling = newExpNode(OpK);
                                             t->sibling-> attr.op = MINUS;
-                                            t->sibling->sibling = (yyvsp[0]);
-                                            (yyval)->child[0] = (yyvsp[-2]); }
+                                            t->sibling->sibling = yyvsp[0];
+                                            yyval->child[0] = yyvsp[-2]; }
                                         //else $$ = $2;
                                     }
-#line 1839 "tiny.tab.c" /* yacc.c:1646  */
+#line 1711 "tiny.tab.c"
     break;
 
-  case 55:
-#line 392 "tiny.y" /* yacc.c:1646  */
-    {
-                                        (yyval) = (yyvsp[0]);
+  case 53: /* additive-expression: term  */
+#line 376 "tiny.y"
+                                    {
+                                        yyval = yyvsp[0];
                                     }
-#line 1847 "tiny.tab.c" /* yacc.c:1646  */
+#line 1719 "tiny.tab.c"
     break;
 
-  case 56:
-#line 398 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = newExpNode(mulK);
-            YYSTYPE t = (yyvsp[-2]);
+  case 54: /* term: term TIMES factor  */
+#line 382 "tiny.y"
+        {
+            yyval = newExpNode(mulK);
+            YYSTYPE t = yyvsp[-2];
             if (t != NULL){
             while (t->sibling != NULL)
                 t = t->sibling;
             t->sibling = newExpNode(OpK);
             t->sibling-> attr.op = TIMES;
-            t->sibling->sibling = (yyvsp[0]);
-            (yyval)->child[0] = (yyvsp[-2]); }
+            t->sibling->sibling = yyvsp[0];
+            yyval->child[0] = yyvsp[-2]; }
             //else $$ = $2;
         }
-#line 1864 "tiny.tab.c" /* yacc.c:1646  */
+#line 1736 "tiny.tab.c"
     break;
 
-  case 57:
-#line 411 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = newExpNode(mulK);
-            YYSTYPE t = (yyvsp[-2]);
+  case 55: /* term: term OVER factor  */
+#line 395 "tiny.y"
+        {
+            yyval = newExpNode(mulK);
+            YYSTYPE t = yyvsp[-2];
             if (t != NULL){
             while (t->sibling != NULL)
                 t = t->sibling;
             t->sibling = newExpNode(OpK);
             t->sibling-> attr.op = OVER;
-            t->sibling->sibling = (yyvsp[0]);
-            (yyval)->child[0] = (yyvsp[-2]); }
+            t->sibling->sibling = yyvsp[0];
+            yyval->child[0] = yyvsp[-2]; }
             //else $$ = $2;
         }
-#line 1881 "tiny.tab.c" /* yacc.c:1646  */
+#line 1753 "tiny.tab.c"
     break;
 
-  case 58:
-#line 424 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);
+  case 56: /* term: factor  */
+#line 408 "tiny.y"
+        {
+            yyval = yyvsp[0];
         }
-#line 1889 "tiny.tab.c" /* yacc.c:1646  */
+#line 1761 "tiny.tab.c"
     break;
 
-  case 59:
-#line 430 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = (yyvsp[-1]);
+  case 57: /* factor: LPAREN expression RPAREN  */
+#line 414 "tiny.y"
+            {
+                yyval = yyvsp[-1];
             }
-#line 1897 "tiny.tab.c" /* yacc.c:1646  */
+#line 1769 "tiny.tab.c"
     break;
 
-  case 60:
-#line 434 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = (yyvsp[0]);
+  case 58: /* factor: var  */
+#line 418 "tiny.y"
+            {
+                yyval = yyvsp[0];
             }
-#line 1905 "tiny.tab.c" /* yacc.c:1646  */
+#line 1777 "tiny.tab.c"
     break;
 
-  case 61:
-#line 438 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = (yyvsp[0]);
+  case 59: /* factor: call  */
+#line 422 "tiny.y"
+            {
+                yyval = yyvsp[0];
             }
-#line 1913 "tiny.tab.c" /* yacc.c:1646  */
+#line 1785 "tiny.tab.c"
     break;
 
-  case 62:
-#line 442 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = newExpNode(NumK);
-                (yyval)->attr.val = atoi(tokenString);
-                (yyval)->type = Integer;
+  case 60: /* factor: num  */
+#line 426 "tiny.y"
+            {
+                yyval = newExpNode(NumK);
+                yyval->attr.val = atoi(tokenString);
+                yyval->type = Integer;
             }
-#line 1923 "tiny.tab.c" /* yacc.c:1646  */
+#line 1795 "tiny.tab.c"
     break;
 
-  case 63:
-#line 450 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = newExpNode(FunCallK);
-            (yyval)->attr.name = savedName;
+  case 61: /* @4: %empty  */
+#line 434 "tiny.y"
+        {
+            yyval = newExpNode(FunCallK);
+            yyval->attr.name = savedName;
         }
-#line 1932 "tiny.tab.c" /* yacc.c:1646  */
+#line 1804 "tiny.tab.c"
     break;
 
-  case 64:
-#line 455 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[-3]);
-            (yyval)->child[0] = (yyvsp[-1]);
+  case 62: /* call: id @4 LPAREN args RPAREN  */
+#line 439 "tiny.y"
+        {
+            yyval = yyvsp[-3];
+            yyval->child[0] = yyvsp[-1];
         }
-#line 1941 "tiny.tab.c" /* yacc.c:1646  */
+#line 1813 "tiny.tab.c"
     break;
 
-  case 65:
-#line 462 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);
+  case 63: /* args: arg-list  */
+#line 446 "tiny.y"
+        {
+            yyval = reverseList(yyvsp[0]);
         }
-#line 1949 "tiny.tab.c" /* yacc.c:1646  */
+#line 1821 "tiny.tab.c"
     break;
 
-  case 66:
-#line 466 "tiny.y" /* yacc.c:1646  */
-    {
-            (yyval) = NULL;
+  case 64: /* args: %empty  */
+#line 450 "tiny.y"
+        {
+            yyval = NULL;
         }
-#line 1957 "tiny.tab.c" /* yacc.c:1646  */
+#line 1829 "tiny.tab.c"
     break;
 
-  case 67:
-#line 472 "tiny.y" /* yacc.c:1646  */
-    {
-                YYSTYPE t = (yyvsp[-2]);
-                if (t != NULL) {
-                    while (t->sibling != NULL)
-                        t = t->sibling;
-                    t->sibling = (yyvsp[0]);
-                    (yyval) = (yyvsp[-2]);}
-                else 
-                    (yyval) = (yyvsp[0]);
+  case 65: /* arg-list: arg-list COMMA expression  */
+#line 456 "tiny.y"
+            {
+                yyval = pushSibling(yyvsp[-2],yyvsp[0]);
             }
-#line 1972 "tiny.tab.c" /* yacc.c:1646  */
+#line 1837 "tiny.tab.c"
     break;
 
-  case 68:
-#line 483 "tiny.y" /* yacc.c:1646  */
-    {
-                (yyval) = (yyvsp[0]);
+  case 66: /* arg-list: expression  */
+#line 460 "tiny.y"
+            {
+                yyval = yyvsp[0];
             }
-#line 1980 "tiny.tab.c" /* yacc.c:1646  */
+#line 1845 "tiny.tab.c"
     break;
 
 
-#line 1984 "tiny.tab.c" /* yacc.c:1646  */
+#line 1849 "tiny.tab.c"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -1994,25 +1860,23 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -2023,50 +1887,14 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -2095,12 +1923,11 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
-
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -2117,13 +1944,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -2137,7 +1965,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2149,7 +1977,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2160,26 +1988,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
-yyreturn:
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2195,44 +2027,74 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
+
   return yyresult;
 }
-#line 489 "tiny.y" /* yacc.c:1906  */
+
+#line 466 "tiny.y"
 
 
 int yyerror(char * message)
 { 
     fprintf(listing,"Syntax error at line %d: %s\n",lineno,message);
     fprintf(listing,"Current token: ");
-    printToken(yychar,tokenString);
+    printToken(currentToken,tokenString);
     Error = TRUE;
     return 0;
 }
 
+/* Lists are built in reverse: pushSibling puts each new
+ * element in front of the list in constant time, and
+ * reverseList restores source order once the enclosing
+ * construct is reduced. Appending at the end instead
+ * made long lists quadratic to build
+ */
+static TreeNode * pushSibling(TreeNode * list, TreeNode * t)
+{
+    if (t == NULL)
+        return list;
+    t->sibling = list;
+    return t;
+}
+
+static TreeNode * reverseList(TreeNode * list)
+{
+    TreeNode * reversed = NULL;
+    while (list != NULL) {
+        TreeNode * next = list->sibling;
+        list->sibling = reversed;
+        reversed = list;
+        list = next;
+    }
+    return reversed;
+}
+
 /* 
  * yylex calls getToken to make Yacc/Bison output
  * compatible with ealier versions of the TINY scanner
  */
 
-static int yylex(void)
+static int yylex(YYSTYPE * lvalp)
 { 
-    return getToken();
+    currentToken = pipelined ? pipelineToken() : getToken();
+    return currentToken;
 }
 
 TreeNode * parse(void)
 { 
+    savedTree = NULL;
+    declStart = TRACE_MARK();
+    pipelined = PipelineScan && startPipeline();
     yyparse();
+    if (pipelined)
+        stopPipeline();
     return savedTree;
 }
 
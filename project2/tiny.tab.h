@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -30,6 +31,10 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 #ifndef YY_YY_TINY_TAB_H_INCLUDED
 # define YY_YY_TINY_TAB_H_INCLUDED
 /* Debug traces.  */
@@ -40,41 +45,46 @@
 extern int yydebug;
 #endif
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    IF = 258,
-    ELSE = 259,
-    INT = 260,
-    RETURN = 261,
-    VOID = 262,
-    WHILE = 263,
-    ID = 264,
-    NUM = 265,
-    ASSIGN = 266,
-    EQ = 267,
-    NE = 268,
-    LT = 269,
-    LE = 270,
-    GT = 271,
-    GE = 272,
-    PLUS = 273,
-    MINUS = 274,
-    TIMES = 275,
-    OVER = 276,
-    LPAREN = 277,
-    RPAREN = 278,
-    LBRACE = 279,
-    RBRACE = 280,
-    LCURLY = 281,
-    RCURLY = 282,
-    SEMI = 283,
-    COMMA = 284,
-    ERROR = 285,
-    COMMENTERROR = 286
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    IF = 258,                      /* IF  */
+    ELSE = 259,                    /* ELSE  */
+    INT = 260,                     /* INT  */
+    RETURN = 261,                  /* RETURN  */
+    VOID = 262,                    /* VOID  */
+    WHILE = 263,                   /* WHILE  */
+    ID = 264,                      /* ID  */
+    NUM = 265,                     /* NUM  */
+    ASSIGN = 266,                  /* ASSIGN  */
+    EQ = 267,                      /* EQ  */
+    NE = 268,                      /* NE  */
+    LT = 269,                      /* LT  */
+    LE = 270,                      /* LE  */
+    GT = 271,                      /* GT  */
+    GE = 272,                      /* GE  */
+    PLUS = 273,                    /* PLUS  */
+    MINUS = 274,                   /* MINUS  */
+    TIMES = 275,                   /* TIMES  */
+    OVER = 276,                    /* OVER  */
+    LPAREN = 277,                  /* LPAREN  */
+    RPAREN = 278,                  /* RPAREN  */
+    LBRACE = 279,                  /* LBRACE  */
+    RBRACE = 280,                  /* RBRACE  */
+    LCURLY = 281,                  /* LCURLY  */
+    RCURLY = 282,                  /* RCURLY  */
+    SEMI = 283,                    /* SEMI  */
+    COMMA = 284,                   /* COMMA  */
+    ERROR = 285,                   /* ERROR  */
+    COMMENTERROR = 286             /* COMMENTERROR  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type.  */
@@ -85,8 +95,9 @@ typedef int YYSTYPE;
 #endif
 
 
-extern YYSTYPE yylval;
+
 
 int yyparse (void);
 
+
 #endif /* !YY_YY_TINY_TAB_H_INCLUDED  */
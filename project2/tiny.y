@@ -11,16 +11,28 @@
 #include "globals.h"
 #include "util.h"
 #include "parse.h"
+#include "trace.h"
+#include "pipeline.h"
 
 #define YYSTYPE TreeNode *
 
-static char * savedName; /* for use in assignments */
-static int savedLineNo;  /* ditto */
-static TreeNode * savedTree; /* stores syntax tree for later return */
-static int yylex(void);
+static THREADLOCAL char * savedName; /* for use in assignments */
+static THREADLOCAL int savedLineNo;  /* ditto */
+static THREADLOCAL TreeNode * savedTree; /* stores syntax tree for later return */
+static THREADLOCAL TokenType currentToken; /* lookahead for yyerror */
+static THREADLOCAL double declStart; /* trace time the declaration began */
+static THREADLOCAL int pipelined; /* tokens come from the scanner thread */
+static int yylex(YYSTYPE *);
 int yyerror(char *);
+static TreeNode * pushSibling(TreeNode *, TreeNode *);
+static TreeNode * reverseList(TreeNode *);
 
 %}
+/* pure parser: no global parser state, so that
+ * several threads may parse at the same time
+ */
+%define api.pure full
+
 /* reversed words */
 %token IF ELSE INT RETURN VOID WHILE
 /* multicharactor tokens */
@@ -36,13 +48,13 @@ int yyerror(char *);
 
 program     : declaration-list
                     {
-                        savedTree = $1;
+                        savedTree = reverseList($1);
                     }
                     ;
 
 id : ID
     {
-        savedName = copyString(tokenString); 
+        savedName = internString(tokenString); 
     }
     ;
 num : NUM
@@ -54,15 +66,7 @@ num : NUM
 
 declaration-list : declaration-list declaration
                             {
-                                YYSTYPE t = $1;
-                                if (t != NULL){
-                                    while (t->sibling != NULL){
-                                        t = t->sibling;
-                                    }
-                                    t->sibling = $2;
-                                    $$ = $1; 
-                                }
-                                else $$ = $2;
+                                $$ = pushSibling($1,$2);
                             }
                             | declaration
                             {
@@ -73,10 +77,14 @@ declaration-list : declaration-list declaration
 declaration : var-declaration
                     {
                         $$ = $1;
+                        TRACE_SPAN("parse variable",$$->attr.name,declStart);
+                        declStart = TRACE_MARK();
                     }
                     | fun-declaration
                     {
                         $$ = $1;
+                        TRACE_SPAN("parse function",$$->attr.name,declStart);
+                        declStart = TRACE_MARK();
                     }
                     ;
 
@@ -128,7 +136,7 @@ fun-declaration : type-specifier id LPAREN
 
 params : params-list
             {
-                $$ = $1;
+                $$ = reverseList($1);
             }
             | VOID
             {
@@ -138,15 +146,7 @@ params : params-list
 
 params-list : params-list COMMA param
             {
-                YYSTYPE t = $1;
-                if (t != NULL){
-                    while (t->sibling != NULL){
-                        t = t->sibling;
-                    }
-                    t->sibling = $3;
-                    $$ = $1; 
-                }
-                else $$ = $1;
+                $$ = pushSibling($1,$3);
             }
             | param
             {
@@ -171,24 +171,14 @@ param : type-specifier id
 compound-stmt : LCURLY local-declarations statement-list RCURLY
                             {
                                 $$ = newStmtNode(CompoundK);
-                                $$->child[0] = $2;
-                                $$->child[1] = $3;
-                            }
-                            | /* empty */
-                            {
-                                $$ = NULL;
+                                $$->child[0] = reverseList($2);
+                                $$->child[1] = reverseList($3);
                             }
                             ;
 
 local-declarations : local-declarations var-declaration
                                 {
-                                    YYSTYPE t = $1;
-                                    if (t != NULL){
-                                        while (t->sibling != NULL)
-                                            t = t->sibling;
-                                        t->sibling = $2;
-                                        $$ = $1; }
-                                    else $$ = $2;
+                                    $$ = pushSibling($1,$2);
                                 }
                                 | /* empty */
                                 {
@@ -198,13 +188,7 @@ local-declarations : local-declarations var-declaration
 
 statement-list : statement-list statement
                         {
-                            YYSTYPE t = $1;
-                            if (t != NULL){
-                                while (t->sibling != NULL)
-                                    t = t->sibling;
-                                t->sibling = $2;
-                                $$ = $1; }
-                            else $$ = $2;
+                            $$ = pushSibling($1,$2);
                         }
                         | /* empty */
                         {
@@ -308,7 +292,7 @@ var : id
         }
         ;
 
-simple-expression : | additive-expression LE additive-expression
+simple-expression : additive-expression LE additive-expression
                                 {
                                     $$ = newExpNode(simpleK);
                                     $$->child[0] = $1;
@@ -460,7 +444,7 @@ call : id
 
 args : arg-list
         {
-            $$ = $1;
+            $$ = reverseList($1);
         }
         | /* empty */
         {
@@ -470,14 +454,7 @@ args : arg-list
 
 arg-list : arg-list COMMA expression
             {
-                YYSTYPE t = $1;
-                if (t != NULL) {
-                    while (t->sibling != NULL)
-                        t = t->sibling;
-                    t->sibling = $3;
-                    $$ = $1;}
-                else 
-                    $$ = $3;
+                $$ = pushSibling($1,$3);
             }
             | expression
             {
@@ -492,24 +469,56 @@ int yyerror(char * message)
 { 
     fprintf(listing,"Syntax error at line %d: %s\n",lineno,message);
     fprintf(listing,"Current token: ");
-    printToken(yychar,tokenString);
+    printToken(currentToken,tokenString);
     Error = TRUE;
     return 0;
 }
 
+/* Lists are built in reverse: pushSibling puts each new
+ * element in front of the list in constant time, and
+ * reverseList restores source order once the enclosing
+ * construct is reduced. Appending at the end instead
+ * made long lists quadratic to build
+ */
+static TreeNode * pushSibling(TreeNode * list, TreeNode * t)
+{
+    if (t == NULL)
+        return list;
+    t->sibling = list;
+    return t;
+}
+
+static TreeNode * reverseList(TreeNode * list)
+{
+    TreeNode * reversed = NULL;
+    while (list != NULL) {
+        TreeNode * next = list->sibling;
+        list->sibling = reversed;
+        reversed = list;
+        list = next;
+    }
+    return reversed;
+}
+
 /* 
  * yylex calls getToken to make Yacc/Bison output
  * compatible with ealier versions of the TINY scanner
  */
 
-static int yylex(void)
+static int yylex(YYSTYPE * lvalp)
 { 
-    return getToken();
+    currentToken = pipelined ? pipelineToken() : getToken();
+    return currentToken;
 }
 
 TreeNode * parse(void)
 { 
+    savedTree = NULL;
+    declStart = TRACE_MARK();
+    pipelined = PipelineScan && startPipeline();
     yyparse();
+    if (pipelined)
+        stopPipeline();
     return savedTree;
 }
 
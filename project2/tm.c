@@ -0,0 +1,548 @@
+/****************************************************/
+/* File: tm.c                                       */
+/* Simulator for the TM ("Tiny Machine") of         */
+/* Compiler Construction: Principles and Practice   */
+/* The code file is decoded once into an array of   */
+/* instructions that each carry their handler, and  */
+/* runs with direct-threaded dispatch: a handler    */
+/* ends by jumping to the handler of the next one.  */
+/* Reading pc is folded into constants at decode    */
+/* time, and jumps to constant targets are resolved */
+/* then; the rare forms that remain run through one */
+/* generic handler                                  */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* set THREADED to FALSE (-DTHREADED=0) to dispatch
+ * with a switch, for compilers without computed goto
+ */
+#ifndef THREADED
+#ifdef __GNUC__
+#define THREADED TRUE
+#else
+#define THREADED FALSE
+#endif
+#endif
+
+/* default words of data memory (-d) */
+#define DADDR_SIZE 65536
+
+#define NO_REGS 8
+#define PC_REG 7
+
+/* a register that is always 0, for the folded reads of pc */
+#define ZERO_REG NO_REGS
+
+typedef enum {
+    /* RO instructions */
+    opHALT, opIN, opOUT, opADD, opSUB, opMUL, opDIV,
+    /* RM instructions */
+    opLD, opST,
+    /* RA instructions */
+    opLDA, opLDC, opJLT, opJLE, opJGT, opJGE, opJEQ, opJNE,
+    /* decoded forms */
+    opJMP,      /* to a constant target */
+    opJMPR,     /* LDA pc,d(s) */
+    opJMPM,     /* LD pc,d(s) */
+    opGENERIC,  /* any other use of pc */
+    opEND,      /* past the last instruction */
+    NOPS
+} OpCode;
+
+static const char * opNames[] = {
+    "HALT", "IN", "OUT", "ADD", "SUB", "MUL", "DIV",
+    "LD", "ST",
+    "LDA", "LDC", "JLT", "JLE", "JGT", "JGE", "JEQ", "JNE"
+};
+
+#define NTMOPS (opJNE + 1)
+
+typedef enum {srOKAY, srHALT, srIMEM_ERR, srDMEM_ERR, srZERODIVIDE, srIN_ERR} StepResult;
+
+static const char * errorNames[] = {"", "", "IMEM_ERR", "DMEM_ERR", "ZERODIVIDE", "IN_ERR"};
+
+typedef struct instruction
+{
+#if THREADED
+    const void * handler;
+#endif
+    struct instruction * target;  /* constant jump target */
+    int d;
+    unsigned char op, r, s, t;    /* the decoded op; as written for opGENERIC */
+    unsigned char tmop;           /* the op as written */
+} Instruction;
+
+static Instruction * iMem = NULL;
+static int iSize = 0;            /* instructions, then the opEND */
+static int * dMem = NULL;
+static int dSize = DADDR_SIZE;
+static int reg[NO_REGS + 1];
+
+/* Function opNamed returns the opcode called name, or
+ * -1 if there is none
+ */
+static int opNamed(const char * name, int len)
+{
+    int op;
+    for (op = 0; op < NTMOPS; op++)
+        if ((int) strlen(opNames[op]) == len && strncmp(opNames[op],name,len) == 0)
+            return op;
+    return -1;
+}
+
+/* Function readNumber reads an optionally signed
+ * number at *p, skipping blanks; returns FALSE if
+ * there is none
+ */
+static int readNumber(char ** p, int * n)
+{
+    char * end;
+    long v;
+    while (**p == ' ' || **p == '\t')
+        (*p)++;
+    v = strtol(*p,&end,10);
+    if (end == *p)
+        return FALSE;
+    *p = end;
+    *n = (int) v;
+    return TRUE;
+}
+
+/* Function expect skips blanks and the character c at
+ * *p; returns FALSE if c is not there
+ */
+static int expect(char ** p, char c)
+{
+    while (**p == ' ' || **p == '\t')
+        (*p)++;
+    if (**p != c)
+        return FALSE;
+    (*p)++;
+    return TRUE;
+}
+
+/* Function readInstructions parses the code file text
+ * into iMem, unlisted locations holding HALT 0,0,0;
+ * returns FALSE after reporting a malformed line
+ */
+static int readInstructions(char * text)
+{
+    char * line, * next;
+    int lineNo = 0, max = -1, pass;
+    /* the first pass finds the size, the second stores */
+    for (pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            iSize = max + 1;
+            iMem = (Instruction *) calloc(iSize + 1,sizeof(Instruction));
+            if (iMem == NULL) {
+                fprintf(stderr,"Out of memory for %d instructions\n",iSize);
+                return FALSE;
+            }
+        }
+        lineNo = 0;
+        for (line = text; *line != '\0'; line = next) {
+            char * p = line, * name;
+            int loc, op, r, s, t, d = 0;
+            next = strchr(line,'\n');
+            next = next == NULL ? line + strlen(line) : next + 1;
+            lineNo++;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (*p == '*' || *p == '\n' || *p == '\r' || *p == '\0')
+                continue;
+            if (!readNumber(&p,&loc) || loc < 0 || !expect(&p,':'))
+                goto bad;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            for (name = p; isalpha((unsigned char) *p); p++)
+                ;
+            if ((op = opNamed(name,p - name)) < 0)
+                goto bad;
+            if (!readNumber(&p,&r) || !expect(&p,','))
+                goto bad;
+            if (op <= opDIV) {
+                if (!readNumber(&p,&s) || !expect(&p,',') || !readNumber(&p,&t))
+                    goto bad;
+            }
+            else {
+                if (!readNumber(&p,&d) || !expect(&p,'(') || !readNumber(&p,&s) || !expect(&p,')'))
+                    goto bad;
+                t = 0;
+            }
+            if (r < 0 || r >= NO_REGS || s < 0 || s >= NO_REGS || t < 0 || t >= NO_REGS)
+                goto bad;
+            if (pass == 0) {
+                if (loc > max)
+                    max = loc;
+            }
+            else {
+                Instruction * i = &iMem[loc];
+                i->tmop = i->op = op;
+                i->r = r;
+                i->s = s;
+                i->t = t;
+                i->d = d;
+            }
+            continue;
+        bad:
+            fprintf(stderr,"Bad instruction at line %d: %.*s",lineNo,(int) (next - line),line);
+            if (next[-1] != '\n')
+                fprintf(stderr,"\n");
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Procedure decode turns each instruction into the form
+ * the simulator runs. An instruction at loc reads pc as
+ * loc+1, so a base register of pc becomes ZERO_REG with
+ * loc+1 added to the offset
+ */
+static void decode(void)
+{
+    int loc;
+    for (loc = 0; loc < iSize; loc++) {
+        Instruction * i = &iMem[loc];
+        int op = i->tmop;
+        if (op <= opDIV) {
+            if (i->r == PC_REG || i->s == PC_REG || i->t == PC_REG)
+                i->op = opGENERIC;
+            continue;
+        }
+        if (op != opLDC && i->s == PC_REG) {
+            i->s = ZERO_REG;
+            i->d += loc + 1;
+        }
+        if (op == opLDC)
+            i->s = ZERO_REG;
+        if (op == opST ? i->r == PC_REG : op >= opJLT && i->r == PC_REG)
+            i->op = opGENERIC;
+        else if (op >= opJLT || ((op == opLDA || op == opLDC) && i->r == PC_REG)) {
+            /* a jump: to a constant target if it is in range */
+            if (i->s == ZERO_REG && i->d >= 0 && i->d < iSize) {
+                i->target = &iMem[i->d];
+                if (op == opLDA || op == opLDC)
+                    i->op = opJMP;
+            }
+            else if (op == opLDA)
+                i->op = opJMPR;
+            else if (op == opLDC)
+                i->op = opGENERIC;
+        }
+        else if (op == opLD && i->r == PC_REG)
+            i->op = opJMPM;
+    }
+    iMem[iSize].op = opEND;
+}
+
+/* Function execute runs the program from location 0
+ * until it halts or fails, counting the instructions
+ * in *steps; returns the StepResult, and the location
+ * of the failure in *where
+ */
+static StepResult execute(long long * steps, int * where)
+{
+    Instruction * ip = iMem;
+    long long n = 0;
+    StepResult result = srOKAY;
+    int a;
+#if THREADED
+    static const void * handlers[NOPS] = {
+        &&L_HALT, &&L_IN, &&L_OUT, &&L_ADD, &&L_SUB, &&L_MUL, &&L_DIV,
+        &&L_LD, &&L_ST,
+        &&L_LDA, &&L_LDC, &&L_JLT, &&L_JLE, &&L_JGT, &&L_JGE, &&L_JEQ, &&L_JNE,
+        &&L_JMP, &&L_JMPR, &&L_JMPM, &&L_GENERIC, &&L_END
+    };
+    int loc;
+    for (loc = 0; loc <= iSize; loc++)
+        iMem[loc].handler = handlers[iMem[loc].op];
+#define CASE(op) L_##op:
+#define NEXT goto *ip->handler
+#define DISPATCH NEXT;
+#else
+#define CASE(op) case op##_CASE:
+#define NEXT continue
+#define DISPATCH for (;;) switch (ip->op)
+#define HALT_CASE opHALT
+#define IN_CASE opIN
+#define OUT_CASE opOUT
+#define ADD_CASE opADD
+#define SUB_CASE opSUB
+#define MUL_CASE opMUL
+#define DIV_CASE opDIV
+#define LD_CASE opLD
+#define ST_CASE opST
+#define LDA_CASE opLDA
+#define LDC_CASE opLDC
+#define JLT_CASE opJLT
+#define JLE_CASE opJLE
+#define JGT_CASE opJGT
+#define JGE_CASE opJGE
+#define JEQ_CASE opJEQ
+#define JNE_CASE opJNE
+#define JMP_CASE opJMP
+#define JMPR_CASE opJMPR
+#define JMPM_CASE opJMPM
+#define GENERIC_CASE opGENERIC
+#define END_CASE opEND
+#endif
+
+/* a data address, checked */
+#define ADDRESS(i) \
+    a = (i)->d + reg[(i)->s]; \
+    if (a < 0 || a >= dSize) { result = srDMEM_ERR; goto done; }
+
+/* a computed jump to location a, checked */
+#define JUMPTO \
+    if (a < 0 || a >= iSize) { result = srIMEM_ERR; goto done; } \
+    ip = &iMem[a]; \
+    NEXT
+
+/* a conditional jump */
+#define BRANCH(cond) \
+    n++; \
+    if (reg[ip->r] cond 0) { \
+        if (ip->target != NULL) { ip = ip->target; NEXT; } \
+        a = ip->d + reg[ip->s]; \
+        JUMPTO; \
+    } \
+    ip++; \
+    NEXT
+
+    reg[ZERO_REG] = 0;
+    DISPATCH {
+        CASE(HALT)
+            n++;
+            result = srHALT;
+            goto done;
+        CASE(IN)
+            n++;
+            if (isatty(0)) {
+                printf("Enter value for IN instruction: ");
+                fflush(stdout);
+            }
+            if (scanf("%d",&reg[ip->r]) != 1) {
+                result = srIN_ERR;
+                goto done;
+            }
+            ip++;
+            NEXT;
+        CASE(OUT)
+            n++;
+            printf("OUT instruction prints: %d\n",reg[ip->r]);
+            ip++;
+            NEXT;
+        CASE(ADD)
+            n++;
+            reg[ip->r] = (int) ((unsigned) reg[ip->s] + (unsigned) reg[ip->t]);
+            ip++;
+            NEXT;
+        CASE(SUB)
+            n++;
+            reg[ip->r] = (int) ((unsigned) reg[ip->s] - (unsigned) reg[ip->t]);
+            ip++;
+            NEXT;
+        CASE(MUL)
+            n++;
+            reg[ip->r] = (int) ((unsigned) reg[ip->s] * (unsigned) reg[ip->t]);
+            ip++;
+            NEXT;
+        CASE(DIV)
+            n++;
+            if (reg[ip->t] == 0 || (reg[ip->t] == -1 && reg[ip->s] == INT_MIN)) {
+                result = srZERODIVIDE;
+                goto done;
+            }
+            reg[ip->r] = reg[ip->s] / reg[ip->t];
+            ip++;
+            NEXT;
+        CASE(LD)
+            n++;
+            ADDRESS(ip);
+            reg[ip->r] = dMem[a];
+            ip++;
+            NEXT;
+        CASE(ST)
+            n++;
+            ADDRESS(ip);
+            dMem[a] = reg[ip->r];
+            ip++;
+            NEXT;
+        CASE(LDA)
+            n++;
+            reg[ip->r] = ip->d + reg[ip->s];
+            ip++;
+            NEXT;
+        CASE(LDC)
+            n++;
+            reg[ip->r] = ip->d;
+            ip++;
+            NEXT;
+        CASE(JLT)
+            BRANCH(<);
+        CASE(JLE)
+            BRANCH(<=);
+        CASE(JGT)
+            BRANCH(>);
+        CASE(JGE)
+            BRANCH(>=);
+        CASE(JEQ)
+            BRANCH(==);
+        CASE(JNE)
+            BRANCH(!=);
+        CASE(JMP)
+            n++;
+            ip = ip->target;
+            NEXT;
+        CASE(JMPR)
+            n++;
+            a = ip->d + reg[ip->s];
+            JUMPTO;
+        CASE(JMPM)
+            n++;
+            ADDRESS(ip);
+            a = dMem[a];
+            JUMPTO;
+        CASE(GENERIC)
+        {
+            /* the textbook step, with pc in reg[PC_REG] */
+            int r = ip->r, s = ip->s, t = ip->t, m, cond;
+            n++;
+            reg[PC_REG] = (int) (ip - iMem) + 1;
+            switch (ip->tmop) {
+                case opIN:
+                    if (scanf("%d",&reg[r]) != 1) {
+                        result = srIN_ERR;
+                        goto done;
+                    }
+                    break;
+                case opOUT: printf("OUT instruction prints: %d\n",reg[r]); break;
+                case opADD: reg[r] = (int) ((unsigned) reg[s] + (unsigned) reg[t]); break;
+                case opSUB: reg[r] = (int) ((unsigned) reg[s] - (unsigned) reg[t]); break;
+                case opMUL: reg[r] = (int) ((unsigned) reg[s] * (unsigned) reg[t]); break;
+                case opDIV:
+                    if (reg[t] == 0 || (reg[t] == -1 && reg[s] == INT_MIN)) {
+                        result = srZERODIVIDE;
+                        goto done;
+                    }
+                    reg[r] = reg[s] / reg[t];
+                    break;
+                case opST:
+                    ADDRESS(ip);
+                    dMem[a] = reg[r];
+                    break;
+                case opLDA: reg[r] = ip->d + reg[s]; break;
+                case opLDC: reg[r] = ip->d; break;
+                default:
+                    m = ip->d + reg[s];
+                    switch (ip->tmop) {
+                        case opJLT: cond = reg[r] < 0; break;
+                        case opJLE: cond = reg[r] <= 0; break;
+                        case opJGT: cond = reg[r] > 0; break;
+                        case opJGE: cond = reg[r] >= 0; break;
+                        case opJEQ: cond = reg[r] == 0; break;
+                        default: cond = reg[r] != 0; break;
+                    }
+                    if (cond)
+                        reg[PC_REG] = m;
+                    break;
+            }
+            a = reg[PC_REG];
+            JUMPTO;
+        }
+        CASE(END)
+            result = srIMEM_ERR;
+            goto done;
+    }
+done:
+    *steps = n;
+    *where = (int) (ip - iMem);
+    return result;
+}
+
+static void usage(const char * prog)
+{
+    fprintf(stderr,"usage: %s [-d <words>] [-s] <filename>.tm\n",prog);
+    exit(1);
+}
+
+int main(int argc, char * argv[])
+{
+    const char * pgm = NULL;
+    FILE * f;
+    char * text;
+    long size;
+    int i, stats = FALSE, where;
+    long long steps;
+    StepResult result;
+    struct timespec t0, t1;
+    double seconds;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i],"-d") == 0 && i+1 < argc) {
+            dSize = atoi(argv[++i]);
+            if (dSize < 1)
+                usage(argv[0]);
+        }
+        else if (strcmp(argv[i],"-s") == 0)
+            stats = TRUE;
+        else if (argv[i][0] == '-' || pgm != NULL)
+            usage(argv[0]);
+        else
+            pgm = argv[i];
+    }
+    if (pgm == NULL)
+        usage(argv[0]);
+    f = fopen(pgm,"rb");
+    if (f == NULL) {
+        fprintf(stderr,"File %s not found\n",pgm);
+        return 1;
+    }
+    fseek(f,0,SEEK_END);
+    size = ftell(f);
+    fseek(f,0,SEEK_SET);
+    text = (char *) malloc(size + 1);
+    if (text == NULL || fread(text,1,size,f) != (size_t) size) {
+        fprintf(stderr,"Unable to read %s\n",pgm);
+        return 1;
+    }
+    text[size] = '\0';
+    fclose(f);
+    if (!readInstructions(text))
+        return 1;
+    free(text);
+    decode();
+    dMem = (int *) calloc(dSize,sizeof(int));
+    if (dMem == NULL) {
+        fprintf(stderr,"Out of memory for %d words of data\n",dSize);
+        return 1;
+    }
+    dMem[0] = dSize - 1;
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    result = execute(&steps,&where);
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    fflush(stdout);
+    if (result != srHALT)
+        fprintf(stderr,"Simulation error: %s at location %d\n",errorNames[result],where);
+    fprintf(stderr,"Number of instructions executed = %lld\n",steps);
+    if (stats) {
+        seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+        fprintf(stderr,"Time = %.3f s, %.1f MIPS (%s dispatch)\n",seconds,
+                seconds > 0 ? steps / seconds / 1e6 : 0.0,THREADED ? "threaded" : "switch");
+    }
+    return result == srHALT ? 0 : 2;
+}
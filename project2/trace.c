@@ -0,0 +1,181 @@
+/****************************************************/
+/* File: trace.c                                    */
+/* Chrome trace event output of compiler internals  */
+/* Every thread appends to its own event buffer;    */
+/* buffers are registered once and written out      */
+/* together at the end                              */
+/****************************************************/
+
+#include "globals.h"
+#include "trace.h"
+#include <pthread.h>
+#include <time.h>
+
+int TraceEvents = FALSE;
+
+typedef struct
+{
+    char phase; /* 'B', 'E' or 'X' as in the trace format */
+    const char * name;
+    long detail;    /* offset in the details of its buffer, or -1 */
+    double ts, dur; /* microseconds */
+} Event;
+
+typedef struct buffer
+{
+    struct buffer * next;
+    int tid;
+    int size, count;
+    Event * events;
+    char * details; /* copies, since names may not outlive their thread */
+    long detailSize, detailUsed;
+} Buffer;
+
+static THREADLOCAL Buffer * buffer = NULL;
+static Buffer * buffers = NULL; /* every registered buffer */
+static int nthreads = 0;
+static pthread_mutex_t registry = PTHREAD_MUTEX_INITIALIZER;
+
+double traceNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+/* Function newEvent returns a fresh event of the calling
+ * thread, or NULL when memory is exhausted
+ */
+static Event * newEvent(void)
+{
+    if (buffer == NULL) {
+        buffer = (Buffer *) calloc(1,sizeof(Buffer));
+        if (buffer == NULL)
+            return NULL;
+        pthread_mutex_lock(&registry);
+        buffer->tid = ++nthreads;
+        buffer->next = buffers;
+        buffers = buffer;
+        pthread_mutex_unlock(&registry);
+    }
+    if (buffer->count == buffer->size) {
+        int size = buffer->size ? 2 * buffer->size : 1024;
+        Event * events = (Event *) realloc(buffer->events,size * sizeof(Event));
+        if (events == NULL)
+            return NULL;
+        buffer->events = events;
+        buffer->size = size;
+    }
+    return &buffer->events[buffer->count++];
+}
+
+/* Function copyDetail copies detail to the buffer of the
+ * calling thread, which newEvent made; returns its offset,
+ * or -1 if detail is NULL or memory is exhausted
+ */
+static long copyDetail(const char * detail)
+{
+    long n;
+    if (detail == NULL)
+        return -1;
+    n = strlen(detail) + 1;
+    if (buffer->detailUsed + n > buffer->detailSize) {
+        long size = buffer->detailSize ? 2 * buffer->detailSize : 4096;
+        char * details;
+        while (size < buffer->detailUsed + n)
+            size *= 2;
+        details = (char *) realloc(buffer->details,size);
+        if (details == NULL)
+            return -1;
+        buffer->details = details;
+        buffer->detailSize = size;
+    }
+    memcpy(buffer->details + buffer->detailUsed,detail,n);
+    buffer->detailUsed += n;
+    return buffer->detailUsed - n;
+}
+
+void traceBegin(const char * name, const char * detail)
+{
+    Event * e = newEvent();
+    if (e != NULL) {
+        e->phase = 'B';
+        e->name = name;
+        e->detail = copyDetail(detail);
+        e->ts = traceNow();
+    }
+}
+
+void traceEnd(void)
+{
+    Event * e = newEvent();
+    if (e != NULL) {
+        e->phase = 'E';
+        e->name = NULL;
+        e->detail = -1;
+        e->ts = traceNow();
+    }
+}
+
+void traceSpan(const char * name, const char * detail, double start)
+{
+    Event * e = newEvent();
+    if (e != NULL) {
+        e->phase = 'X';
+        e->name = name;
+        e->detail = copyDetail(detail);
+        e->ts = start;
+        e->dur = traceNow() - start;
+    }
+}
+
+static void writeString(FILE * f, const char * s)
+{
+    putc('"',f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            putc('\\',f);
+        if ((unsigned char) *s >= ' ')
+            putc(*s,f);
+    }
+    putc('"',f);
+}
+
+int writeTrace(const char * path)
+{
+    FILE * f = fopen(path,"w");
+    Buffer * b;
+    double origin = -1;
+    int i, first = TRUE;
+    if (f == NULL)
+        return FALSE;
+    pthread_mutex_lock(&registry);
+    for (b = buffers; b != NULL; b = b->next)
+        if (b->count > 0 && (origin < 0 || b->events[0].ts < origin))
+            origin = b->events[0].ts;
+    fprintf(f,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (b = buffers; b != NULL; b = b->next) {
+        fprintf(f,"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                  "\"args\":{\"name\":\"compiler thread %d\"}}",first ? "" : ",\n",b->tid,b->tid);
+        first = FALSE;
+        for (i = 0; i < b->count; i++) {
+            Event * e = &b->events[i];
+            fprintf(f,",\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f",e->phase,b->tid,e->ts - origin);
+            if (e->phase == 'X')
+                fprintf(f,",\"dur\":%.3f",e->dur);
+            if (e->name != NULL) {
+                fprintf(f,",\"name\":");
+                writeString(f,e->name);
+            }
+            if (e->detail >= 0) {
+                fprintf(f,",\"args\":{\"name\":");
+                writeString(f,b->details + e->detail);
+                putc('}',f);
+            }
+            putc('}',f);
+        }
+    }
+    fprintf(f,"\n]}\n");
+    pthread_mutex_unlock(&registry);
+    return fclose(f) == 0;
+}
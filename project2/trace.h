@@ -0,0 +1,51 @@
+/****************************************************/
+/* File: trace.h                                    */
+/* Chrome trace event output of compiler internals  */
+/* (-ftime-trace), readable by chrome://tracing     */
+/* and Perfetto                                     */
+/****************************************************/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+/* TraceEvents = TRUE records a span for every phase,
+ * file and top-level declaration in per-thread buffers
+ */
+extern int TraceEvents;
+
+/* When tracing is off every macro below costs a single
+ * branch that is predicted not taken
+ */
+#define TRACE_BEGIN(name,detail) \
+    do { if (__builtin_expect(TraceEvents,0)) traceBegin(name,detail); } while (0)
+#define TRACE_END() \
+    do { if (__builtin_expect(TraceEvents,0)) traceEnd(); } while (0)
+#define TRACE_MARK() \
+    (__builtin_expect(TraceEvents,0) ? traceNow() : 0.0)
+#define TRACE_SPAN(name,detail,start) \
+    do { if (__builtin_expect(TraceEvents,0)) traceSpan(name,detail,start); } while (0)
+
+/* Procedure traceBegin opens a span of the calling
+ * thread; detail (a file or identifier name, or NULL)
+ * is copied
+ */
+void traceBegin(const char * name, const char * detail);
+
+/* Procedure traceEnd closes the innermost open span */
+void traceEnd(void);
+
+/* Function traceNow returns the current trace time */
+double traceNow(void);
+
+/* Procedure traceSpan records a span that started at
+ * the trace time start and ends now
+ */
+void traceSpan(const char * name, const char * detail, double start);
+
+/* Function writeTrace writes the events of all threads
+ * to the file path as Chrome trace JSON; returns FALSE
+ * if the file cannot be written
+ */
+int writeTrace(const char * path);
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "globals.h"
 #include "util.h"
+#include "stats.h"
 
 /* Procedure printToken prints a token 
  * and its lexeme to the listing file
@@ -50,22 +51,184 @@ void printToken(TokenType token, const char* tokenString )
     }
 }
 
+/* Nodes and strings of a compilation are carved out of
+ * large blocks owned by the compiling thread, so that a
+ * whole syntax tree is released at once by freeNodes.
+ * Released blocks are kept for the next compilation on
+ * the same thread, up to MAXSPARE of them
+ */
+#define BLOCKSIZE (64*1024)
+#define MAXSPARE 64
+
+typedef struct block
+{
+    struct block * next;
+    size_t used;
+    size_t size;
+    double data[1]; /* aligned start of the storage */
+} Block;
+
+static THREADLOCAL Block * blocks = NULL;
+static THREADLOCAL Block * spare = NULL;
+static THREADLOCAL int nspare = 0;
+
+/* Function allocate returns n bytes from the current
+ * block, starting a new block when it is full
+ */
+void * allocate(size_t n)
+{
+    Block * b = blocks;
+    void * p;
+    n = (n + sizeof(double) - 1) & ~(sizeof(double) - 1);
+    if (b == NULL || b->used + n > b->size) {
+        if (spare != NULL && n <= BLOCKSIZE) {
+            b = spare;
+            spare = b->next;
+            nspare--;
+        }
+        else {
+            size_t size = n > BLOCKSIZE ? n : BLOCKSIZE;
+            b = (Block *) malloc(sizeof(Block) + size);
+            if (b == NULL)
+                return NULL;
+            b->size = size;
+        }
+        b->next = blocks;
+        b->used = 0;
+        blocks = b;
+    }
+    p = (char *) b->data + b->used;
+    b->used += n;
+    bytesAllocated += n;
+    return p;
+}
+
+/* Procedure freeNodes releases every node and string
+ * allocated by the calling thread
+ */
+void freeNodes(void)
+{
+    while (blocks != NULL) {
+        Block * b = blocks;
+        blocks = b->next;
+        if (b->size == BLOCKSIZE && nspare < MAXSPARE) {
+            b->next = spare;
+            spare = b;
+            nspare++;
+        }
+        else
+            free(b);
+    }
+}
+
+void * detachNodes(void)
+{
+    Block * b = blocks;
+    blocks = NULL;
+    return b;
+}
+
+void attachNodes(void * detached)
+{
+    Block * b = (Block *) detached, * last;
+    if (b == NULL)
+        return;
+    /* behind the current block, which stays current */
+    for (last = b; last->next != NULL; last = last->next)
+        ;
+    if (blocks == NULL)
+        blocks = b;
+    else {
+        last->next = blocks->next;
+        blocks->next = b;
+    }
+}
+
+/* Identifier names are interned in an open hash table
+ * owned by the compiling thread; it outlives freeNodes,
+ * so the names seen by earlier compilations stay warm
+ */
+static THREADLOCAL char ** interned = NULL;
+static THREADLOCAL unsigned internSize = 0;
+static THREADLOCAL unsigned internCount = 0;
+
+static unsigned hashString(const char * s)
+{
+    unsigned h = 2166136261u;
+    while (*s)
+        h = (h ^ (unsigned char) *s++) * 16777619u;
+    return h;
+}
+
+/* Function internString returns the unique copy of s */
+char * internString(const char * s)
+{
+    unsigned i;
+    if (2 * (internCount + 1) > internSize) {
+        char ** old = interned;
+        unsigned oldSize = internSize;
+        internSize = internSize ? 2 * internSize : 1024;
+        interned = (char **) calloc(internSize,sizeof(char *));
+        if (interned == NULL) {
+            fprintf(listing,"Out of memory error at line %d\n",lineno);
+            interned = old;
+            internSize = oldSize;
+            return NULL;
+        }
+        for (i = 0; i < oldSize; i++)
+            if (old[i] != NULL) {
+                unsigned j = hashString(old[i]) & (internSize - 1);
+                while (interned[j] != NULL)
+                    j = (j + 1) & (internSize - 1);
+                interned[j] = old[i];
+            }
+        free(old);
+    }
+    i = hashString(s) & (internSize - 1);
+    while (interned[i] != NULL) {
+        if (strcmp(interned[i],s) == 0)
+            return interned[i];
+        i = (i + 1) & (internSize - 1);
+    }
+    interned[i] = (char *) malloc(strlen(s) + 1);
+    if (interned[i] == NULL) {
+        fprintf(listing,"Out of memory error at line %d\n",lineno);
+        return NULL;
+    }
+    strcpy(interned[i],s);
+    internCount++;
+    return interned[i];
+}
+
+void releaseNames(void)
+{
+    unsigned i;
+    for (i = 0; i < internSize; i++)
+        free(interned[i]);
+    free(interned);
+    interned = NULL;
+    internSize = internCount = 0;
+}
+
 /* Function newStmtNode creates a new statement
  * node for syntax tree construction
  */
 TreeNode * newStmtNode(StmtKind kind)
 { 
-    TreeNode * t = (TreeNode *) malloc(sizeof(TreeNode));
+    TreeNode * t = (TreeNode *) allocate(sizeof(TreeNode));
     int i;
     if (t==NULL)
         fprintf(listing,"Out of memory error at line %d\n",lineno);
     else {
+        nodeCount++;
         for (i=0;i<MAXCHILDREN;i++)
             t->child[i] = NULL;
         t->sibling = NULL;
         t->nodekind = StmtK;
         t->kind.stmt = kind;
         t->lineno = lineno;
+        t->type = Void;
+        t->symbol = NULL;
     }
     return t;
 }
@@ -75,11 +238,12 @@ TreeNode * newStmtNode(StmtKind kind)
  */
 TreeNode * newExpNode(ExpKind kind)
 {
-    TreeNode * t = (TreeNode *) malloc(sizeof(TreeNode));
+    TreeNode * t = (TreeNode *) allocate(sizeof(TreeNode));
     int i;
     if (t==NULL)
         fprintf(listing,"Out of memory error at line %d\n",lineno);
     else {
+        nodeCount++;
         for (i=0;i<MAXCHILDREN;i++) 
             t->child[i] = NULL;
         t->sibling = NULL;
@@ -87,6 +251,7 @@ TreeNode * newExpNode(ExpKind kind)
         t->kind.exp = kind;
         t->lineno = lineno;
         t->type = Void;
+        t->symbol = NULL;
     }
     return t;
 }
@@ -96,18 +261,20 @@ TreeNode * newExpNode(ExpKind kind)
  */
 TreeNode * newDeclNode(DeclKind kind)
 {
-    TreeNode * t = (TreeNode *) malloc(sizeof(TreeNode));
+    TreeNode * t = (TreeNode *) allocate(sizeof(TreeNode));
     int i;
     if (t==NULL)
         fprintf(listing,"Out of memory error at line %d\n",lineno);
     else {
+        nodeCount++;
         for (i=0;i<MAXCHILDREN;i++) 
             t->child[i] = NULL;
         t->sibling = NULL;
         t->nodekind = DeclK;
-        t->kind.exp = kind;
+        t->kind.decl = kind;
         t->lineno = lineno;
         t->type = Void;
+        t->symbol = NULL;
     }
     return t;
 }
@@ -120,7 +287,7 @@ char * copyString(char * s)
   char * t;
   if (s==NULL) return NULL;
   n = strlen(s)+1;
-  t = malloc(n);
+  t = allocate(n);
   if (t==NULL)
     fprintf(listing,"Out of memory error at line %d\n",lineno);
   else strcpy(t,s);
@@ -130,7 +297,7 @@ char * copyString(char * s)
 /* Variable indentno is used by printTree to
  * store current number of spaces to indent
  */
-static indentno = 0;
+static THREADLOCAL int indentno = 0;
 
 /* macros to increase/decrease indentation */
 #define INDENT indentno+=2
@@ -28,11 +28,44 @@ TreeNode * newExpNode(ExpKind);
  */
 TreeNode * newDeclNode(DeclKind);
 
+/* Function allocate returns n bytes that live until
+ * the next freeNodes of the calling thread
+ */
+void * allocate(size_t n);
+
 /* Function copyString allocates and makes a new
  * copy of an existing string
  */
 char * copyString( char * );
 
+/* Function internString returns the unique copy of
+ * the identifier s; interned names survive freeNodes,
+ * and equal names are equal pointers
+ */
+char * internString( const char * );
+
+/* Procedure releaseNames frees the names interned by
+ * the calling thread, for a thread about to exit
+ * whose names no tree refers to any more
+ */
+void releaseNames(void);
+
+/* Procedure freeNodes releases every node and string
+ * allocated by the calling thread, ending the lifetime
+ * of its current syntax tree
+ */
+void freeNodes(void);
+
+/* Function detachNodes takes the nodes and strings the
+ * calling thread allocated away from it; attachNodes
+ * hands them to the calling thread, whose freeNodes
+ * will release them. Threads helping a compilation
+ * pass their allocations to the compiling thread so
+ * that they live as long as its syntax tree
+ */
+void * detachNodes(void);
+void attachNodes(void *);
+
 /* procedure printTree prints a syntax tree to the 
  * listing file using indentation to indicate subtrees
  */
@@ -0,0 +1,450 @@
+/****************************************************/
+/* File: vgen.c                                     */
+/* Generator of register bytecode for the C- VM     */
+/* Variables are the registers at their frame       */
+/* locations; temporaries are taken above the       */
+/* variables in scope, as a stack within each       */
+/* statement, and the arguments of a call are       */
+/* evaluated into the registers where the frame of  */
+/* the callee starts, so passing them copies        */
+/* nothing                                          */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "bytecode.h"
+#include "vgen.h"
+
+typedef struct
+{
+    int a, b, c;
+    unsigned char op;
+} BcInstruction;
+
+/* a comment line, printed before the instruction at loc */
+typedef struct
+{
+    int loc;
+    const char * text;
+} BcComment;
+
+static THREADLOCAL BcInstruction * insts = NULL;
+static THREADLOCAL int ninsts = 0, maxInsts = 0;
+
+static THREADLOCAL BcComment * comments = NULL;
+static THREADLOCAL int ncomments = 0, maxComments = 0;
+
+/* the registers from scopeTop up hold no variable in
+ * scope; tmp is the next free one, frameTop the highest
+ * used by the function so far plus one
+ */
+static THREADLOCAL int scopeTop = 0;
+static THREADLOCAL int tmp = 0;
+static THREADLOCAL int frameTop = 0;
+
+/* prototypes for internal recursive functions */
+static void cGen(TreeNode * tree);
+static int genExp(TreeNode * tree);
+
+/* Function emit appends an instruction; returns its
+ * location
+ */
+static int emit(int op, int a, int b, int c)
+{
+    BcInstruction * i;
+    if (ninsts == maxInsts) {
+        maxInsts = maxInsts ? 2 * maxInsts : 4096;
+        insts = (BcInstruction *) realloc(insts,maxInsts * sizeof(BcInstruction));
+    }
+    i = &insts[ninsts];
+    i->op = op;
+    i->a = a;
+    i->b = b;
+    i->c = c;
+    return ninsts++;
+}
+
+/* Procedure comment adds the comment line c before the
+ * next instruction, if TraceCode is set
+ */
+static void comment(const char * c)
+{
+    if (!TraceCode)
+        return;
+    if (ncomments == maxComments) {
+        maxComments = maxComments ? 2 * maxComments : 256;
+        comments = (BcComment *) realloc(comments,maxComments * sizeof(BcComment));
+    }
+    comments[ncomments].loc = ninsts;
+    comments[ncomments].text = c;
+    ncomments++;
+}
+
+/* Function newTemp returns the next free register */
+static int newTemp(void)
+{
+    int r = tmp++;
+    if (tmp > frameTop)
+        frameTop = tmp;
+    return r;
+}
+
+/* Function result frees the temporaries from mark up
+ * and returns mark, as the register of a result
+ */
+static int result(int mark)
+{
+    tmp = mark;
+    return newTemp();
+}
+
+/* Function writesA tells whether op sets register a */
+static int writesA(int op)
+{
+    return (op >= bcLI && op <= bcNE) || op == bcLDG || op == bcLEA ||
+           op == bcLDX || op == bcCALL || op == bcIN;
+}
+
+/* Procedure move copies register v to dst. A temporary
+ * just computed is computed into dst instead
+ */
+static void move(int dst, int v)
+{
+    BcInstruction * last = &insts[ninsts-1];
+    if (v == dst)
+        return;
+    if (v >= scopeTop && last->a == v && writesA(last->op))
+        last->a = dst;
+    else
+        emit(bcMOV,dst,v,0);
+}
+
+/* Function genBase returns a register holding the
+ * address of element 0 of the array or array parameter s
+ */
+static int genBase(Symbol * s)
+{
+    int r;
+    if (s->kind == ArrParamSym)
+        return s->memloc;
+    r = newTemp();
+    if (s->depth == 0)
+        emit(bcLI,r,s->memloc,0);
+    else
+        emit(bcLEA,r,s->memloc,0);
+    return r;
+}
+
+/* Function genAssign generates the assignment tree;
+ * if keep is set it returns a register that holds the
+ * value assigned afterwards
+ */
+static int genAssign(TreeNode * tree, int keep)
+{
+    TreeNode * var = tree->child[0];
+    Symbol * s = var->symbol;
+    int mark = tmp, v;
+    if (var->kind.exp == IdK) {
+        v = genExp(tree->child[1]);
+        if (s->depth == 0) {
+            emit(bcSTG,v,s->memloc,0);
+            return v;
+        }
+        move(s->memloc,v);
+        tmp = mark;
+        return s->memloc;
+    }
+    else {
+        int b = genBase(s);
+        int i = genExp(var->child[0]);
+        v = genExp(tree->child[1]);
+        emit(bcSTX,v,b,i);
+        tmp = mark;
+        if (!keep || v < scopeTop)
+            return v;
+        i = newTemp();
+        if (i != v)
+            emit(bcMOV,i,v,0);
+        return i;
+    }
+}
+
+/* Function genCall generates the call t; returns the
+ * register of the value returned. The runtime's input
+ * and output are single instructions
+ */
+static int genCall(TreeNode * t)
+{
+    Symbol * s = t->symbol;
+    TreeNode * arg;
+    int base = tmp, n = 0, v;
+    if (s->decl->child[2] == NULL) {
+        if (t->child[0] == NULL) {
+            v = newTemp();
+            emit(bcIN,v,0,0);
+        }
+        else {
+            v = genExp(t->child[0]);
+            emit(bcOUT,v,0,0);
+        }
+        return v;
+    }
+    for (arg = t->child[0]; arg != NULL; arg = arg->sibling, n++) {
+        tmp = base + n;
+        v = genExp(arg);
+        if (result(base + n) != v)
+            emit(bcMOV,base + n,v,0);
+    }
+    v = result(base);
+    emit(bcCALL,v,s->memloc,base);
+    return v;
+}
+
+/* Function genExp generates code at an expression
+ * node; returns the register of its value, which is
+ * that of a variable or the first temporary free on
+ * entry
+ */
+static int genExp(TreeNode * tree)
+{
+    TreeNode * p;
+    Symbol * s = tree->symbol;
+    int mark = tmp, acc, r, op;
+    if (tree->nodekind == StmtK)
+        return genAssign(tree,TRUE);
+    switch (tree->kind.exp) {
+        case NumK:
+            r = newTemp();
+            emit(bcLI,r,tree->attr.val,0);
+            return r;
+        case IdK:
+            /* an array passes its address */
+            if (s->kind != VarSym && s->kind != ParamSym)
+                return genBase(s);
+            if (s->depth > 0)
+                return s->memloc;
+            r = newTemp();
+            emit(bcLDG,r,s->memloc,0);
+            return r;
+        case ArrK:
+            acc = genBase(s);
+            r = genExp(tree->child[0]);
+            emit(bcLDX,result(mark),acc,r);
+            return mark;
+        case FunCallK:
+            return genCall(tree);
+        case addK:
+        case mulK:
+            /* operand, operator, operand... */
+            acc = genExp(tree->child[0]);
+            for (p = tree->child[0]->sibling; p != NULL && p->sibling != NULL; p = p->sibling->sibling) {
+                TreeNode * right = p->sibling;
+                if ((p->attr.op == PLUS || p->attr.op == MINUS) &&
+                    right->nodekind == ExpK && right->kind.exp == NumK) {
+                    unsigned k = (unsigned) right->attr.val;
+                    emit(bcADDI,result(mark),acc,(int) (p->attr.op == PLUS ? k : 0u - k));
+                }
+                else {
+                    r = genExp(right);
+                    switch (p->attr.op) {
+                        case PLUS: op = bcADD; break;
+                        case MINUS: op = bcSUB; break;
+                        case TIMES: op = bcMUL; break;
+                        default: op = bcDIV; break;
+                    }
+                    emit(op,result(mark),acc,r);
+                }
+                acc = mark;
+            }
+            return acc;
+        case simpleK:
+            acc = genExp(tree->child[0]);
+            r = genExp(tree->child[2]);
+            switch (tree->child[1]->attr.op) {
+                case LT: op = bcLT; break;
+                case LE: op = bcLE; break;
+                case GT: op = bcGT; break;
+                case GE: op = bcGE; break;
+                case EQ: op = bcEQ; break;
+                default: op = bcNE; break;
+            }
+            emit(op,result(mark),acc,r);
+            return mark;
+        default:
+            return mark;
+    }
+}
+
+/* Function genBranch emits a jump to target taken when
+ * the condition tree is true if sense is set, false
+ * otherwise; returns its location. A comparison jumps
+ * on its operands
+ */
+static int genBranch(TreeNode * tree, int sense, int target)
+{
+    int mark = tmp, loc;
+    if (tree->nodekind == ExpK && tree->kind.exp == simpleK) {
+        int l = genExp(tree->child[0]);
+        int r = genExp(tree->child[2]);
+        int op;
+        switch (tree->child[1]->attr.op) {
+            case LT: op = sense ? bcJLT : bcJGE; break;
+            case LE: op = sense ? bcJLE : bcJGT; break;
+            case GT: op = sense ? bcJGT : bcJLE; break;
+            case GE: op = sense ? bcJGE : bcJLT; break;
+            case EQ: op = sense ? bcJEQ : bcJNE; break;
+            default: op = sense ? bcJNE : bcJEQ; break;
+        }
+        loc = emit(op,l,r,target);
+    }
+    else
+        loc = emit(sense ? bcJNZ : bcJZ,genExp(tree),0,target);
+    tmp = mark;
+    return loc;
+}
+
+/* Procedure genStmt generates code at a statement node */
+static void genStmt(TreeNode * tree)
+{
+    TreeNode * d;
+    int savedTop, loc1, loc2;
+    switch (tree->kind.stmt) {
+        case CompoundK:
+            savedTop = scopeTop;
+            for (d = tree->child[0]; d != NULL; d = d->sibling)
+                if (d->symbol->memloc + d->symbol->size > scopeTop)
+                    scopeTop = d->symbol->memloc + d->symbol->size;
+            tmp = scopeTop;
+            if (tmp > frameTop)
+                frameTop = tmp;
+            cGen(tree->child[1]);
+            tmp = scopeTop = savedTop;
+            break;
+        case IfK:
+            comment("-> if");
+            loc1 = genBranch(tree->child[0],FALSE,0);
+            cGen(tree->child[1]);
+            if (tree->child[2] != NULL) {
+                loc2 = emit(bcJMP,0,0,0);
+                insts[loc1].c = ninsts;
+                cGen(tree->child[2]);
+                insts[loc2].c = ninsts;
+            }
+            else
+                insts[loc1].c = ninsts;
+            comment("<- if");
+            break;
+        case WhileK:
+            /* the test comes after the body */
+            comment("-> while");
+            loc1 = emit(bcJMP,0,0,0);
+            loc2 = ninsts;
+            cGen(tree->child[1]);
+            insts[loc1].c = ninsts;
+            genBranch(tree->child[0],TRUE,loc2);
+            comment("<- while");
+            break;
+        case ReturnK:
+            if (tree->child[0] != NULL)
+                emit(bcRET,genExp(tree->child[0]),0,0);
+            else
+                emit(bcRET0,0,0,0);
+            tmp = scopeTop;
+            break;
+        default:
+            genAssign(tree,FALSE);
+            tmp = scopeTop;
+            break;
+    }
+}
+
+/* Procedure cGen generates code for the statement
+ * list tree
+ */
+static void cGen(TreeNode * tree)
+{
+    for (; tree != NULL; tree = tree->sibling) {
+        if (tree->nodekind == StmtK)
+            genStmt(tree);
+        else {
+            genExp(tree);
+            tmp = scopeTop;
+        }
+    }
+}
+
+/* Procedure genFunction generates code for the
+ * function declaration tree, recording its location in
+ * its symbol
+ */
+static void genFunction(TreeNode * tree)
+{
+    TreeNode * p;
+    char * c = NULL;
+    if (TraceCode) {
+        c = (char *) allocate(strlen(tree->attr.name) + 16);
+        if (c != NULL) {
+            sprintf(c,"function %s",tree->attr.name);
+            comment(c);
+        }
+    }
+    scopeTop = 0;
+    for (p = tree->child[1]; p != NULL; p = p->sibling)
+        if (p->nodekind == DeclK && p->symbol != NULL)
+            scopeTop = p->symbol->memloc + p->symbol->size;
+    tmp = frameTop = scopeTop;
+    tree->symbol->memloc = emit(bcFUNC,0,0,0);
+    cGen(tree->child[2]);
+    /* a function may end without return */
+    emit(bcRET0,0,0,0);
+    insts[tree->symbol->memloc].a = frameTop;
+}
+
+/* Function flush writes the code to f; returns FALSE
+ * if the write fails
+ */
+static int flush(FILE * f)
+{
+    int loc, k = 0;
+    for (loc = 0; loc <= ninsts; loc++) {
+        BcInstruction * i = &insts[loc];
+        for (; k < ncomments && comments[k].loc == loc; k++)
+            fprintf(f,"* %s\n",comments[k].text);
+        if (loc < ninsts)
+            fprintf(f,"%3d:  %5s  %d,%d,%d\n",loc,bcNames[i->op],i->a,i->b,i->c);
+    }
+    return fflush(f) == 0 && !ferror(f);
+}
+
+void vmGen(TreeNode * syntaxTree, char * codefile)
+{
+    TreeNode * t, * last = NULL;
+    int globals = 0, callMain;
+    char * s = NULL;
+    ninsts = ncomments = 0;
+    if (TraceCode) {
+        s = (char *) allocate(strlen(codefile) + 7);
+        if (s != NULL)
+            sprintf(s,"File: %s",codefile);
+    }
+    comment("C- Compilation to VM bytecode");
+    if (s != NULL)
+        comment(s);
+    for (t = syntaxTree; t != NULL; t = t->sibling)
+        if (t->kind.decl != FunK && t->symbol->memloc + t->symbol->size > globals)
+            globals = t->symbol->memloc + t->symbol->size;
+    emit(bcENTER,globals,0,0);
+    callMain = emit(bcCALL,0,0,0);
+    emit(bcHALT,0,0,0);
+    /* main comes last */
+    for (t = syntaxTree; t != NULL; t = t->sibling)
+        if (t->kind.decl == FunK) {
+            genFunction(t);
+            last = t;
+        }
+    insts[callMain].b = last->symbol->memloc;
+    comment("End of execution.");
+    if (!flush(code))
+        fprintf(stderr,"Unable to write code file %s\n",codefile);
+}
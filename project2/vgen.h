@@ -0,0 +1,16 @@
+/****************************************************/
+/* File: vgen.h                                     */
+/* Generator of register bytecode for the C- VM     */
+/****************************************************/
+
+#ifndef _VGEN_H_
+#define _VGEN_H_
+
+/* Procedure vmGen writes the bytecode of bytecode.h
+ * for the analyzed syntaxTree to the code file; the
+ * file name codefile is printed as a comment if
+ * TraceCode is set
+ */
+void vmGen(TreeNode * syntaxTree, char * codefile);
+
+#endif
@@ -0,0 +1,550 @@
+/****************************************************/
+/* File: vm.c                                       */
+/* Virtual machine for the register bytecode of the */
+/* C- compiler (-ftarget=vm), described in          */
+/* bytecode.h. The code file is checked once as it  */
+/* is loaded, registers against the frame of their  */
+/* function and calls against their targets, so the */
+/* run only checks memory addresses, the stack and  */
+/* division. Dispatch is direct-threaded, as in the */
+/* TM simulator                                     */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include "bytecode.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* set THREADED to FALSE (-DTHREADED=0) to dispatch
+ * with a switch, for compilers without computed goto
+ */
+#ifndef THREADED
+#ifdef __GNUC__
+#define THREADED TRUE
+#else
+#define THREADED FALSE
+#endif
+#endif
+
+/* default words of memory (-d) */
+#define MEM_SIZE 65536
+
+/* the registers of the code before the first function */
+#define PRELUDE_FRAME 1
+
+typedef enum {srHALT, srMEM_ERR, srSTACK_ERR, srZERODIVIDE, srIN_ERR} StepResult;
+
+static const char * errorNames[] = {"", "MEM_ERR", "STACK_ERR", "ZERODIVIDE", "IN_ERR"};
+
+typedef struct
+{
+#if THREADED
+    const void * handler;
+#endif
+    int a, b, c;
+    int d;              /* the frame of the callee of a CALL */
+    unsigned char op;
+} Instruction;
+
+/* a call in progress */
+typedef struct
+{
+    Instruction * ret;
+    int * regs;
+    int dest;
+} Call;
+
+static Instruction * iMem = NULL;
+static int iSize = 0;
+static int * mem = NULL;
+static int memSize = MEM_SIZE;
+static Call * calls = NULL;
+static int maxCalls = 0;
+
+/* Function opNamed returns the opcode called name, or
+ * -1 if there is none
+ */
+static int opNamed(const char * name, int len)
+{
+    int op;
+    for (op = 0; op < BCOPS; op++)
+        if ((int) strlen(bcNames[op]) == len && strncmp(bcNames[op],name,len) == 0)
+            return op;
+    return -1;
+}
+
+/* Function readNumber reads an optionally signed
+ * number at *p, skipping blanks; returns FALSE if
+ * there is none
+ */
+static int readNumber(char ** p, int * n)
+{
+    char * end;
+    long v;
+    while (**p == ' ' || **p == '\t')
+        (*p)++;
+    v = strtol(*p,&end,10);
+    if (end == *p)
+        return FALSE;
+    *p = end;
+    *n = (int) v;
+    return TRUE;
+}
+
+/* Function expect skips blanks and the character c at
+ * *p; returns FALSE if c is not there
+ */
+static int expect(char ** p, char c)
+{
+    while (**p == ' ' || **p == '\t')
+        (*p)++;
+    if (**p != c)
+        return FALSE;
+    (*p)++;
+    return TRUE;
+}
+
+/* Function readInstructions parses the code file text
+ * into iMem, unlisted locations holding HALT; returns
+ * FALSE after reporting a malformed line
+ */
+static int readInstructions(char * text)
+{
+    char * line, * next;
+    int lineNo, max = -1, pass;
+    /* the first pass finds the size, the second stores */
+    for (pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            iSize = max + 1;
+            iMem = (Instruction *) calloc(iSize + 1,sizeof(Instruction));
+            if (iMem == NULL) {
+                fprintf(stderr,"Out of memory for %d instructions\n",iSize);
+                return FALSE;
+            }
+        }
+        lineNo = 0;
+        for (line = text; *line != '\0'; line = next) {
+            char * p = line, * name;
+            int loc, op, a, b, c;
+            next = strchr(line,'\n');
+            next = next == NULL ? line + strlen(line) : next + 1;
+            lineNo++;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (*p == '*' || *p == '\n' || *p == '\r' || *p == '\0')
+                continue;
+            if (!readNumber(&p,&loc) || loc < 0 || !expect(&p,':'))
+                goto bad;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            for (name = p; isalnum((unsigned char) *p); p++)
+                ;
+            if ((op = opNamed(name,p - name)) < 0)
+                goto bad;
+            if (!readNumber(&p,&a) || !expect(&p,',') || !readNumber(&p,&b) ||
+                !expect(&p,',') || !readNumber(&p,&c))
+                goto bad;
+            if (pass == 0) {
+                if (loc > max)
+                    max = loc;
+            }
+            else {
+                Instruction * i = &iMem[loc];
+                i->op = op;
+                i->a = a;
+                i->b = b;
+                i->c = c;
+            }
+            continue;
+        bad:
+            fprintf(stderr,"Bad instruction at line %d: %.*s",lineNo,(int) (next - line),line);
+            if (next[-1] != '\n')
+                fprintf(stderr,"\n");
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Function check verifies that every instruction only
+ * names registers of the frame of its function, globals
+ * that exist and locations of the code, and that calls
+ * go to functions; returns FALSE after reporting the
+ * first that does not. A CALL gets the frame of its
+ * callee and skips its FUNC
+ */
+static int check(void)
+{
+    int loc, frame = PRELUDE_FRAME, globals = -1;
+    for (loc = 0; loc < iSize; loc++) {
+        Instruction * i = &iMem[loc];
+        int a = i->a, b = i->b, c = i->c, ok = TRUE;
+#define REG(r) ((r) >= 0 && (r) < frame)
+#define LOC(l) ((l) >= 0 && (l) < iSize)
+        switch (i->op) {
+            case bcHALT: case bcRET0:
+                break;
+            case bcENTER:
+                ok = loc == 0 && a >= 0 && a <= memSize - PRELUDE_FRAME;
+                globals = a;
+                break;
+            case bcFUNC:
+                ok = a >= 0;
+                frame = a;
+                break;
+            case bcLI: case bcRET: case bcIN: case bcOUT:
+                ok = REG(a);
+                break;
+            case bcMOV: case bcADDI:
+                ok = REG(a) && REG(b);
+                break;
+            case bcADD: case bcSUB: case bcMUL: case bcDIV:
+            case bcLT: case bcLE: case bcGT: case bcGE: case bcEQ: case bcNE:
+            case bcLDX: case bcSTX:
+                ok = REG(a) && REG(b) && REG(c);
+                break;
+            case bcJMP:
+                ok = LOC(c);
+                break;
+            case bcJZ: case bcJNZ:
+                ok = REG(a) && LOC(c);
+                break;
+            case bcJLT: case bcJLE: case bcJGT: case bcJGE: case bcJEQ: case bcJNE:
+                ok = REG(a) && REG(b) && LOC(c);
+                break;
+            case bcLDG: case bcSTG:
+                ok = REG(a) && b >= 0 && b < globals;
+                break;
+            case bcLEA:
+                ok = REG(a) && REG(b);
+                break;
+            case bcCALL:
+                ok = REG(a) && c >= 0 && LOC(b) && iMem[b].op == bcFUNC && iMem[b].a >= 0;
+                if (ok) {
+                    i->d = iMem[b].a;
+                    i->b = b + 1;
+                }
+                break;
+            default:
+                ok = FALSE;
+                break;
+        }
+#undef REG
+#undef LOC
+        if (!ok) {
+            fprintf(stderr,"Bad instruction at location %d: %s %d,%d,%d\n",loc,bcNames[i->op],a,b,c);
+            return FALSE;
+        }
+    }
+    if (iSize == 0 || iMem[0].op != bcENTER) {
+        fprintf(stderr,"No ENTER at location 0\n");
+        return FALSE;
+    }
+    /* past the last instruction */
+    iMem[iSize].op = bcHALT;
+    return TRUE;
+}
+
+/* Function execute runs the program from location 0
+ * until it halts or fails, counting the instructions
+ * in *steps; returns the StepResult, and the location
+ * of the failure in *where
+ */
+static StepResult execute(long long * steps, int * where)
+{
+    Instruction * ip = iMem;
+    int * R = mem, * memEnd = mem + memSize;
+    Call * call = calls, * callsEnd = calls + maxCalls;
+    long long n = 0;
+    StepResult result = srHALT;
+    int a, v;
+#if THREADED
+    static const void * handlers[BCOPS] = {
+        &&L_HALT, &&L_ENTER, &&L_FUNC, &&L_LI, &&L_MOV,
+        &&L_ADD, &&L_SUB, &&L_MUL, &&L_DIV, &&L_ADDI,
+        &&L_LT, &&L_LE, &&L_GT, &&L_GE, &&L_EQ, &&L_NE,
+        &&L_JMP, &&L_JZ, &&L_JNZ,
+        &&L_JLT, &&L_JLE, &&L_JGT, &&L_JGE, &&L_JEQ, &&L_JNE,
+        &&L_LDG, &&L_STG, &&L_LEA, &&L_LDX, &&L_STX,
+        &&L_CALL, &&L_RET, &&L_RET0, &&L_IN, &&L_OUT
+    };
+    int loc;
+    for (loc = 0; loc <= iSize; loc++)
+        iMem[loc].handler = handlers[iMem[loc].op];
+#define CASE(op) L_##op:
+#define NEXT goto *ip->handler
+#define DISPATCH NEXT;
+#else
+#define CASE(op) case bc##op:
+#define NEXT continue
+#define DISPATCH for (;;) switch (ip->op)
+#endif
+
+/* a word of memory, checked */
+#define ADDRESS(x) \
+    a = (x); \
+    if (a < 0 || a >= memSize) { result = srMEM_ERR; goto done; }
+
+/* an arithmetic operation, wrapping around */
+#define ARITH(op) \
+    n++; \
+    R[ip->a] = (int) ((unsigned) R[ip->b] op (unsigned) R[ip->c]); \
+    ip++; \
+    NEXT
+
+/* the difference of x and y, wrapping around, which a
+ * comparison tests against 0 as on the TM */
+#define DIFF(x,y) ((int) ((unsigned) (x) - (unsigned) (y)))
+
+#define COMPARE(op) \
+    n++; \
+    R[ip->a] = DIFF(R[ip->b],R[ip->c]) op 0; \
+    ip++; \
+    NEXT
+
+#define BRANCH(cond) \
+    n++; \
+    ip = (cond) ? iMem + ip->c : ip + 1; \
+    NEXT
+
+    DISPATCH {
+        CASE(HALT)
+            n++;
+            goto done;
+        CASE(ENTER)
+            n++;
+            R = mem + ip->a;
+            ip++;
+            NEXT;
+        CASE(FUNC)
+            /* only reached by falling into a function */
+            n++;
+            ip++;
+            NEXT;
+        CASE(LI)
+            n++;
+            R[ip->a] = ip->b;
+            ip++;
+            NEXT;
+        CASE(MOV)
+            n++;
+            R[ip->a] = R[ip->b];
+            ip++;
+            NEXT;
+        CASE(ADD)
+            ARITH(+);
+        CASE(SUB)
+            ARITH(-);
+        CASE(MUL)
+            ARITH(*);
+        CASE(DIV)
+            n++;
+            if (R[ip->c] == 0 || (R[ip->c] == -1 && R[ip->b] == INT_MIN)) {
+                result = srZERODIVIDE;
+                goto done;
+            }
+            R[ip->a] = R[ip->b] / R[ip->c];
+            ip++;
+            NEXT;
+        CASE(ADDI)
+            n++;
+            R[ip->a] = (int) ((unsigned) R[ip->b] + (unsigned) ip->c);
+            ip++;
+            NEXT;
+        CASE(LT)
+            COMPARE(<);
+        CASE(LE)
+            COMPARE(<=);
+        CASE(GT)
+            COMPARE(>);
+        CASE(GE)
+            COMPARE(>=);
+        CASE(EQ)
+            COMPARE(==);
+        CASE(NE)
+            COMPARE(!=);
+        CASE(JMP)
+            BRANCH(TRUE);
+        CASE(JZ)
+            BRANCH(R[ip->a] == 0);
+        CASE(JNZ)
+            BRANCH(R[ip->a] != 0);
+        CASE(JLT)
+            BRANCH(DIFF(R[ip->a],R[ip->b]) < 0);
+        CASE(JLE)
+            BRANCH(DIFF(R[ip->a],R[ip->b]) <= 0);
+        CASE(JGT)
+            BRANCH(DIFF(R[ip->a],R[ip->b]) > 0);
+        CASE(JGE)
+            BRANCH(DIFF(R[ip->a],R[ip->b]) >= 0);
+        CASE(JEQ)
+            BRANCH(DIFF(R[ip->a],R[ip->b]) == 0);
+        CASE(JNE)
+            BRANCH(DIFF(R[ip->a],R[ip->b]) != 0);
+        CASE(LDG)
+            n++;
+            R[ip->a] = mem[ip->b];
+            ip++;
+            NEXT;
+        CASE(STG)
+            n++;
+            mem[ip->b] = R[ip->a];
+            ip++;
+            NEXT;
+        CASE(LEA)
+            n++;
+            R[ip->a] = (int) (R - mem) + ip->b;
+            ip++;
+            NEXT;
+        CASE(LDX)
+            n++;
+            ADDRESS((int) ((unsigned) R[ip->b] + (unsigned) R[ip->c]));
+            R[ip->a] = mem[a];
+            ip++;
+            NEXT;
+        CASE(STX)
+            n++;
+            ADDRESS((int) ((unsigned) R[ip->b] + (unsigned) R[ip->c]));
+            mem[a] = R[ip->a];
+            ip++;
+            NEXT;
+        CASE(CALL)
+            n++;
+            if (call == callsEnd || ip->d > memEnd - (R + ip->c)) {
+                result = srSTACK_ERR;
+                goto done;
+            }
+            call->ret = ip + 1;
+            call->regs = R;
+            call->dest = ip->a;
+            call++;
+            R += ip->c;
+            ip = iMem + ip->b;
+            NEXT;
+        CASE(RET)
+            n++;
+            if (call == calls)
+                goto done;
+            v = R[ip->a];
+            call--;
+            R = call->regs;
+            R[call->dest] = v;
+            ip = call->ret;
+            NEXT;
+        CASE(RET0)
+            n++;
+            if (call == calls)
+                goto done;
+            call--;
+            R = call->regs;
+            R[call->dest] = 0;
+            ip = call->ret;
+            NEXT;
+        CASE(IN)
+            n++;
+            if (isatty(0)) {
+                printf("Enter value for IN instruction: ");
+                fflush(stdout);
+            }
+            if (scanf("%d",&R[ip->a]) != 1) {
+                result = srIN_ERR;
+                goto done;
+            }
+            ip++;
+            NEXT;
+        CASE(OUT)
+            n++;
+            printf("OUT instruction prints: %d\n",R[ip->a]);
+            ip++;
+            NEXT;
+    }
+done:
+    *steps = n;
+    *where = (int) (ip - iMem);
+    return result;
+}
+
+static void usage(const char * prog)
+{
+    fprintf(stderr,"usage: %s [-d <words>] [-s] <filename>.vm\n",prog);
+    exit(1);
+}
+
+int main(int argc, char * argv[])
+{
+    const char * pgm = NULL;
+    FILE * f;
+    char * text;
+    long size;
+    int i, stats = FALSE, where;
+    long long steps;
+    StepResult result;
+    struct timespec t0, t1;
+    double seconds;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i],"-d") == 0 && i+1 < argc) {
+            memSize = atoi(argv[++i]);
+            if (memSize < PRELUDE_FRAME)
+                usage(argv[0]);
+        }
+        else if (strcmp(argv[i],"-s") == 0)
+            stats = TRUE;
+        else if (argv[i][0] == '-' || pgm != NULL)
+            usage(argv[0]);
+        else
+            pgm = argv[i];
+    }
+    if (pgm == NULL)
+        usage(argv[0]);
+    f = fopen(pgm,"rb");
+    if (f == NULL) {
+        fprintf(stderr,"File %s not found\n",pgm);
+        return 1;
+    }
+    fseek(f,0,SEEK_END);
+    size = ftell(f);
+    fseek(f,0,SEEK_SET);
+    text = (char *) malloc(size + 1);
+    if (text == NULL || fread(text,1,size,f) != (size_t) size) {
+        fprintf(stderr,"Unable to read %s\n",pgm);
+        return 1;
+    }
+    text[size] = '\0';
+    fclose(f);
+    if (!readInstructions(text) || !check())
+        return 1;
+    free(text);
+    /* calls nest no deeper than there are words, so
+     * that frames of no words cannot recurse forever */
+    maxCalls = memSize;
+    mem = (int *) calloc(memSize,sizeof(int));
+    calls = (Call *) malloc(maxCalls * sizeof(Call));
+    if (mem == NULL || calls == NULL) {
+        fprintf(stderr,"Out of memory for %d words\n",memSize);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    result = execute(&steps,&where);
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    fflush(stdout);
+    if (result != srHALT)
+        fprintf(stderr,"Simulation error: %s at location %d\n",errorNames[result],where);
+    fprintf(stderr,"Number of instructions executed = %lld\n",steps);
+    if (stats) {
+        seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+        fprintf(stderr,"Time = %.3f s, %.1f MIPS (%s dispatch)\n",seconds,
+                seconds > 0 ? steps / seconds / 1e6 : 0.0,THREADED ? "threaded" : "switch");
+    }
+    return result == srHALT ? 0 : 2;
+}
@@ -0,0 +1,132 @@
+/****************************************************/
+/* File: watch.c                                    */
+/* Watch mode: recompiles C- sources as soon as     */
+/* inotify reports that they changed                */
+/* Everything runs on the main thread, so its node  */
+/* blocks and interned names stay warm              */
+/****************************************************/
+
+#include "globals.h"
+#include "compile.h"
+#include <dirent.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+/* directories watched, indexed by watch descriptor */
+static char ** watched = NULL;
+static int nwatched = 0;
+static int inotifyFd;
+
+/* Function isSource tells whether name is a C- source:
+ * .tny as in the rest of the compiler, or .cm
+ */
+static int isSource(const char * name)
+{
+    const char * dot = strrchr(name,'.');
+    return dot != NULL && (strcmp(dot,".tny") == 0 || strcmp(dot,".cm") == 0);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static void recompile(const char * pgm)
+{
+    double start = now();
+    CompileStatus status = compileFile(pgm);
+    if (status == CompileOk || status == CompileError)
+        fprintf(stderr,"Compiled %s in %.2f ms%s\n",pgm,now() - start,
+                status == CompileError ? ", with errors" : "");
+    else
+        reportStatus(pgm,status);
+}
+
+/* Procedure watchTree watches dir and its subdirectories
+ * and compiles the sources found there
+ */
+static void watchTree(const char * dir)
+{
+    char path[FILENAME_MAX];
+    DIR * d;
+    struct dirent * e;
+    int wd = inotify_add_watch(inotifyFd,dir,
+                               IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+    if (wd < 0) {
+        fprintf(stderr,"Unable to watch %s: %s\n",dir,strerror(errno));
+        return;
+    }
+    if (wd >= nwatched) {
+        int n = wd + 64;
+        char ** more = (char **) realloc(watched,n * sizeof(char *));
+        if (more == NULL)
+            return;
+        memset(more + nwatched,0,(n - nwatched) * sizeof(char *));
+        watched = more;
+        nwatched = n;
+    }
+    free(watched[wd]);
+    watched[wd] = strdup(dir);
+    d = opendir(dir);
+    if (d == NULL)
+        return;
+    while ((e = readdir(d)) != NULL) {
+        struct stat st;
+        if (e->d_name[0] == '.')
+            continue;
+        snprintf(path,sizeof(path),"%s/%s",dir,e->d_name);
+        if (stat(path,&st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+            watchTree(path);
+        else if (S_ISREG(st.st_mode) && isSource(e->d_name))
+            recompile(path);
+    }
+    closedir(d);
+}
+
+int watchDirectory(const char * dir)
+{
+    char buf[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    char path[FILENAME_MAX];
+    inotifyFd = inotify_init1(IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        fprintf(stderr,"inotify: %s\n",strerror(errno));
+        return FALSE;
+    }
+    watchTree(dir);
+    if (nwatched == 0)
+        return FALSE;
+    for (;;) {
+        ssize_t len = read(inotifyFd,buf,sizeof(buf));
+        char * p;
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            break;
+        for (p = buf; p < buf + len; ) {
+            struct inotify_event * e = (struct inotify_event *) p;
+            p += sizeof(struct inotify_event) + e->len;
+            if (e->len == 0 || e->wd >= nwatched || watched[e->wd] == NULL)
+                continue;
+            if (e->mask & IN_Q_OVERFLOW)
+                continue;
+            snprintf(path,sizeof(path),"%s/%s",watched[e->wd],e->name);
+            if (e->mask & IN_ISDIR) {
+                if (e->mask & (IN_CREATE | IN_MOVED_TO))
+                    watchTree(path);
+            }
+            /* a source is complete once its writer closes it
+             * or it is renamed into place */
+            else if ((e->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && isSource(e->name))
+                recompile(path);
+        }
+    }
+    fprintf(stderr,"inotify: %s\n",strerror(errno));
+    return FALSE;
+}
@@ -0,0 +1,205 @@
+/****************************************************/
+/* File: writer.c                                   */
+/* Asynchronous listing writer                      */
+/* Listing text is copied into one of two pages;    */
+/* when it is full the page goes to a writer thread */
+/* and the compiler goes on filling the other one   */
+/****************************************************/
+
+#define _GNU_SOURCE /* fopencookie */
+#include "globals.h"
+#include "writer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+int AsyncListing = FALSE;
+
+/* PAGESIZE is the size of each of the two pages */
+#define PAGESIZE (256*1024)
+
+typedef struct asyncFile
+{
+    int fd;
+    char * page[2];
+    size_t len[2];
+    int filling; /* page being filled by the compiler */
+    int pending; /* page handed to the writer, or -1 */
+    int closing; /* no page will follow */
+    int failed; /* a write failed; set by the writer, read
+                 * by the compiler, so accessed atomically */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    FILE * stream;
+    struct asyncFile * next; /* in the list of open files */
+} AsyncFile;
+
+static AsyncFile * openFiles = NULL;
+static pthread_mutex_t openLock = PTHREAD_MUTEX_INITIALIZER;
+static int handlerSet = FALSE;
+
+static void * writer(void * arg)
+{
+    AsyncFile * f = (AsyncFile *) arg;
+    pthread_mutex_lock(&f->lock);
+    for (;;) {
+        int p;
+        char * data;
+        size_t len;
+        while (f->pending < 0 && !f->closing)
+            pthread_cond_wait(&f->cond,&f->lock);
+        if (f->pending < 0)
+            break;
+        p = f->pending;
+        pthread_mutex_unlock(&f->lock);
+        /* the page is written without holding the lock */
+        for (data = f->page[p], len = f->len[p]; len > 0; ) {
+            ssize_t n = write(f->fd,data,len);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                __atomic_store_n(&f->failed,TRUE,__ATOMIC_RELAXED);
+                break;
+            }
+            data += n;
+            len -= n;
+        }
+        pthread_mutex_lock(&f->lock);
+        f->pending = -1;
+        pthread_cond_broadcast(&f->cond);
+    }
+    pthread_mutex_unlock(&f->lock);
+    return NULL;
+}
+
+/* Procedure handOff gives the page being filled to the
+ * writer, once it is done with the previous one
+ */
+static void handOff(AsyncFile * f)
+{
+    pthread_mutex_lock(&f->lock);
+    while (f->pending >= 0)
+        pthread_cond_wait(&f->cond,&f->lock);
+    f->pending = f->filling;
+    f->filling ^= 1;
+    f->len[f->filling] = 0;
+    pthread_cond_broadcast(&f->cond);
+    pthread_mutex_unlock(&f->lock);
+}
+
+static ssize_t asyncWrite(void * cookie, const char * buf, size_t size)
+{
+    AsyncFile * f = (AsyncFile *) cookie;
+    size_t done = 0;
+    while (done < size) {
+        size_t room = PAGESIZE - f->len[f->filling];
+        size_t n = size - done < room ? size - done : room;
+        memcpy(f->page[f->filling] + f->len[f->filling],buf + done,n);
+        f->len[f->filling] += n;
+        done += n;
+        if (f->len[f->filling] == PAGESIZE)
+            handOff(f);
+    }
+    return __atomic_load_n(&f->failed,__ATOMIC_RELAXED) ? -1 : (ssize_t) size;
+}
+
+/* Procedure drain writes out every buffered byte and
+ * stops the writer thread
+ */
+static void drain(AsyncFile * f)
+{
+    if (f->len[f->filling] > 0)
+        handOff(f);
+    pthread_mutex_lock(&f->lock);
+    while (f->pending >= 0)
+        pthread_cond_wait(&f->cond,&f->lock);
+    f->closing = TRUE;
+    pthread_cond_broadcast(&f->cond);
+    pthread_mutex_unlock(&f->lock);
+    pthread_join(f->thread,NULL);
+}
+
+static int asyncClose(void * cookie)
+{
+    AsyncFile * f = (AsyncFile *) cookie;
+    AsyncFile ** p;
+    int failed;
+    pthread_mutex_lock(&openLock);
+    for (p = &openFiles; *p != NULL; p = &(*p)->next)
+        if (*p == f) {
+            *p = f->next;
+            break;
+        }
+    pthread_mutex_unlock(&openLock);
+    drain(f);
+    failed = f->failed | (close(f->fd) != 0);
+    pthread_mutex_destroy(&f->lock);
+    pthread_cond_destroy(&f->cond);
+    free(f->page[0]);
+    free(f->page[1]);
+    free(f);
+    return failed ? EOF : 0;
+}
+
+/* listings left open when the program exits, after an
+ * error for instance, are completed here
+ */
+static void drainAtExit(void)
+{
+    AsyncFile * f;
+    pthread_mutex_lock(&openLock);
+    for (f = openFiles; f != NULL; f = f->next) {
+        fflush(f->stream);
+        drain(f);
+    }
+    openFiles = NULL;
+    pthread_mutex_unlock(&openLock);
+}
+
+FILE * openListing(const char * path)
+{
+    static const cookie_io_functions_t io = { NULL, asyncWrite, NULL, asyncClose };
+    AsyncFile * f;
+    if (!AsyncListing)
+        return fopen(path,"w");
+    f = (AsyncFile *) calloc(1,sizeof(AsyncFile));
+    if (f == NULL)
+        return NULL;
+    f->page[0] = (char *) malloc(PAGESIZE);
+    f->page[1] = (char *) malloc(PAGESIZE);
+    f->fd = open(path,O_WRONLY | O_CREAT | O_TRUNC,0666);
+    f->pending = -1;
+    pthread_mutex_init(&f->lock,NULL);
+    pthread_cond_init(&f->cond,NULL);
+    if (f->page[0] == NULL || f->page[1] == NULL || f->fd < 0 ||
+        pthread_create(&f->thread,NULL,writer,f) != 0) {
+        if (f->fd >= 0)
+            close(f->fd);
+        free(f->page[0]);
+        free(f->page[1]);
+        free(f);
+        return fopen(path,"w");
+    }
+    f->stream = fopencookie(f,"w",io);
+    if (f->stream == NULL) {
+        f->closing = TRUE;
+        pthread_cond_broadcast(&f->cond);
+        pthread_join(f->thread,NULL);
+        close(f->fd);
+        free(f->page[0]);
+        free(f->page[1]);
+        free(f);
+        return NULL;
+    }
+    pthread_mutex_lock(&openLock);
+    if (!handlerSet) {
+        atexit(drainAtExit);
+        handlerSet = TRUE;
+    }
+    f->next = openFiles;
+    openFiles = f;
+    pthread_mutex_unlock(&openLock);
+    return f->stream;
+}
@@ -0,0 +1,23 @@
+/****************************************************/
+/* File: writer.h                                   */
+/* Asynchronous listing writer                      */
+/****************************************************/
+
+#ifndef _WRITER_H_
+#define _WRITER_H_
+
+/* AsyncListing = TRUE makes openListing return streams
+ * whose bytes are written to disk by a background
+ * thread, so that formatting and I/O overlap
+ */
+extern int AsyncListing;
+
+/* Function openListing opens the file path for writing
+ * like fopen(path,"w"). Closing the stream flushes and
+ * waits for every pending write; streams still open at
+ * exit are drained by an exit handler. Returns NULL if
+ * the file cannot be opened
+ */
+FILE * openListing(const char * path);
+
+#endif
@@ -0,0 +1,476 @@
+/****************************************************/
+/* File: xgen.c                                     */
+/* Generator of x86-64 assembly for the C- compiler */
+/* A frame holds the parameters and locals by frame */
+/* location below %rbp, a word of 8 bytes each so   */
+/* that array parameters fit; array elements take   */
+/* 4 bytes. Expressions are evaluated into %eax,    */
+/* pushing the left operand while the right one     */
+/* needs the registers, as the TM code does with    */
+/* its temporaries; the pushes are counted so that  */
+/* every call finds %rsp aligned to 16 bytes        */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "cgen.h"
+#include "xgen.h"
+#include <stdarg.h>
+
+/* the registers of the first arguments, in order */
+static const char * argRegs[] = {"%rdi","%rsi","%rdx","%rcx","%r8","%r9"};
+#define NARGREGS 6
+
+/* next label number */
+static THREADLOCAL int labels = 0;
+
+/* words pushed on the stack since the prologue */
+static THREADLOCAL int depth = 0;
+
+/* whether a division jumps to .Ldivide, the call of
+ * rt_divide emitted after the functions
+ */
+static THREADLOCAL int divides = FALSE;
+
+/* prototypes for internal recursive functions */
+static void cGen(TreeNode * tree);
+static void genExp(TreeNode * tree);
+
+/* Procedure emit prints an instruction, formatted as
+ * by printf, to the code file
+ */
+static void emit(const char * fmt, ...)
+{
+    va_list ap;
+    putc('\t',code);
+    va_start(ap,fmt);
+    vfprintf(code,fmt,ap);
+    va_end(ap);
+    putc('\n',code);
+}
+
+/* Procedure comment prints c as a comment line, if
+ * TraceCode is set
+ */
+static void comment(const char * c)
+{
+    if (TraceCode)
+        fprintf(code,"# %s\n",c);
+}
+
+/* Procedure push pushes %rax */
+static void push(void)
+{
+    emit("pushq %%rax");
+    depth++;
+}
+
+/* Procedure pop pops into reg */
+static void pop(const char * reg)
+{
+    emit("popq %s",reg);
+    depth--;
+}
+
+/* Function offset returns the offset from %rbp of the
+ * parameter or local s, where element 0 of an array is
+ */
+static int offset(Symbol * s)
+{
+    return -8 * (s->memloc + s->size);
+}
+
+/* Function leaf tells whether t is a number or an int
+ * variable, one operand of an instruction; if so it
+ * prints the operand to buf
+ */
+static int leaf(TreeNode * t, char * buf)
+{
+    Symbol * s = t->symbol;
+    if (t->nodekind != ExpK)
+        return FALSE;
+    if (t->kind.exp == NumK)
+        sprintf(buf,"$%d",t->attr.val);
+    else if (t->kind.exp == IdK && (s->kind == VarSym || s->kind == ParamSym)) {
+        if (s->depth == 0)
+            sprintf(buf,"cm_%s(%%rip)",s->name);
+        else
+            sprintf(buf,"%d(%%rbp)",offset(s));
+    }
+    else
+        return FALSE;
+    return TRUE;
+}
+
+/* Procedure genBase leaves in %rax the address of
+ * element 0 of the array or array parameter s
+ */
+static void genBase(Symbol * s)
+{
+    if (s->depth == 0)
+        emit("leaq cm_%s(%%rip),%%rax",s->name);
+    else if (s->kind == ArrParamSym)
+        emit("movq %d(%%rbp),%%rax",offset(s));
+    else
+        emit("leaq %d(%%rbp),%%rax",offset(s));
+}
+
+/* Procedure genIndex leaves in %rax the address of
+ * element 0 of the array t refers to and in %rcx its
+ * index
+ */
+static void genIndex(TreeNode * t)
+{
+    genExp(t->child[0]);
+    emit("movslq %%eax,%%rcx");
+    genBase(t->symbol);
+}
+
+/* Procedure genRight evaluates the right operand t
+ * into %ecx, keeping the left one in %eax
+ */
+static void genRight(TreeNode * t)
+{
+    char operand[64];
+    if (leaf(t,operand))
+        emit("movl %s,%%ecx",operand);
+    else {
+        push();
+        genExp(t);
+        emit("movl %%eax,%%ecx");
+        pop("%rax");
+    }
+}
+
+/* Procedure genDivide divides %eax by %ecx, the right
+ * operand t. A divisor of 0, or of -1 with INT_MIN,
+ * goes to .Ldivide instead of trapping in idivl; a
+ * constant divisor other than 0 and -1 needs no check
+ */
+static void genDivide(TreeNode * t)
+{
+    int label;
+    if (t->nodekind != ExpK || t->kind.exp != NumK || t->attr.val == 0 || t->attr.val == -1) {
+        label = labels++;
+        divides = TRUE;
+        emit("testl %%ecx,%%ecx");
+        emit("je .Ldivide");
+        emit("cmpl $-1,%%ecx");
+        emit("jne .L%d",label);
+        emit("cmpl $-2147483648,%%eax");
+        emit("je .Ldivide");
+        fprintf(code,".L%d:\n",label);
+    }
+    emit("cltd");
+    emit("idivl %%ecx");
+}
+
+/* Procedure genCompare compares the operands of the
+ * comparison t, the left one against the right one. As
+ * on the TM, an ordering tests the sign of their
+ * difference, which wraps around, and not their order
+ */
+static void genCompare(TreeNode * t)
+{
+    char operand[64];
+    TokenType op = t->child[1]->attr.op;
+    const char * insn = op == EQ || op == NE ? "cmpl" : "subl";
+    genExp(t->child[0]);
+    if (leaf(t->child[2],operand))
+        emit("%s %s,%%eax",insn,operand);
+    else {
+        genRight(t->child[2]);
+        emit("%s %%ecx,%%eax",insn);
+    }
+    if (op != EQ && op != NE)
+        emit("testl %%eax,%%eax");
+}
+
+/* Function condition returns the condition code of the
+ * comparison operator op, or of its negation if sense
+ * is not set
+ */
+static const char * condition(TokenType op, int sense)
+{
+    switch (op) {
+        case LT: return sense ? "l" : "ge";
+        case LE: return sense ? "le" : "g";
+        case GT: return sense ? "g" : "le";
+        case GE: return sense ? "ge" : "l";
+        case EQ: return sense ? "e" : "ne";
+        default: return sense ? "ne" : "e";
+    }
+}
+
+/* Procedure genCall generates the call t, leaving the
+ * value returned in %eax. The arguments are pushed as
+ * they are evaluated, left to right, and popped into
+ * their registers, but for the last one evaluated;
+ * those past the sixth are stored where the callee
+ * finds them
+ */
+static void genCall(TreeNode * t)
+{
+    Symbol * s = t->symbol;
+    TreeNode * arg;
+    int n = 0, nstack, pad, i;
+    for (arg = t->child[0]; arg != NULL; arg = arg->sibling)
+        n++;
+    nstack = n > NARGREGS ? n - NARGREGS : 0;
+    pad = (depth + nstack) % 2;
+    if (nstack + pad > 0) {
+        emit("subq $%d,%%rsp",8 * (nstack + pad));
+        depth += nstack + pad;
+    }
+    for (arg = t->child[0], i = 0; arg != NULL; arg = arg->sibling, i++) {
+        genExp(arg);
+        if (i == n - 1 && i < NARGREGS)
+            emit("movq %%rax,%s",argRegs[i]);
+        else if (i < NARGREGS)
+            push();
+        else
+            emit("movq %%rax,%d(%%rsp)",8 * i);
+    }
+    for (i = (n <= NARGREGS ? n - 1 : NARGREGS) - 1; i >= 0; i--)
+        pop(argRegs[i]);
+    /* input and output are in the runtime */
+    emit("call cm_%s",s->name);
+    if (nstack + pad > 0) {
+        emit("addq $%d,%%rsp",8 * (nstack + pad));
+        depth -= nstack + pad;
+    }
+}
+
+/* Procedure genExp generates code at an expression
+ * node, leaving its value in %eax, or in %rax the
+ * address an array passes
+ */
+static void genExp(TreeNode * tree)
+{
+    TreeNode * p;
+    Symbol * s = tree->symbol;
+    char operand[64];
+    if (tree->nodekind == StmtK) {
+        /* an assignment, whose value is the one assigned */
+        TreeNode * var = tree->child[0];
+        if (var->kind.exp == IdK) {
+            genExp(tree->child[1]);
+            leaf(var,operand);
+            emit("movl %%eax,%s",operand);
+        }
+        else if (leaf(tree->child[1],operand)) {
+            genIndex(var);
+            emit("leaq (%%rax,%%rcx,4),%%rdx");
+            emit("movl %s,%%eax",operand);
+            emit("movl %%eax,(%%rdx)");
+        }
+        else {
+            genIndex(var);
+            emit("leaq (%%rax,%%rcx,4),%%rax");
+            push();
+            genExp(tree->child[1]);
+            pop("%rdx");
+            emit("movl %%eax,(%%rdx)");
+        }
+        return;
+    }
+    switch (tree->kind.exp) {
+        case NumK:
+            emit("movl $%d,%%eax",tree->attr.val);
+            break;
+        case IdK:
+            /* an array passes its address */
+            if (leaf(tree,operand))
+                emit("movl %s,%%eax",operand);
+            else
+                genBase(s);
+            break;
+        case ArrK:
+            genIndex(tree);
+            emit("movl (%%rax,%%rcx,4),%%eax");
+            break;
+        case FunCallK:
+            genCall(tree);
+            break;
+        case addK:
+        case mulK:
+            /* operand, operator, operand... */
+            genExp(tree->child[0]);
+            for (p = tree->child[0]->sibling; p != NULL && p->sibling != NULL; p = p->sibling->sibling) {
+                TreeNode * right = p->sibling;
+                if (p->attr.op == OVER) {
+                    genRight(right);
+                    genDivide(right);
+                    continue;
+                }
+                if (!leaf(right,operand)) {
+                    genRight(right);
+                    strcpy(operand,"%ecx");
+                }
+                switch (p->attr.op) {
+                    case PLUS: emit("addl %s,%%eax",operand); break;
+                    case MINUS: emit("subl %s,%%eax",operand); break;
+                    default:
+                        if (operand[0] == '$')
+                            emit("imull %s,%%eax,%%eax",operand);
+                        else
+                            emit("imull %s,%%eax",operand);
+                        break;
+                }
+            }
+            break;
+        case simpleK:
+            genCompare(tree);
+            emit("set%s %%al",condition(tree->child[1]->attr.op,TRUE));
+            emit("movzbl %%al,%%eax");
+            break;
+        default:
+            break;
+    }
+}
+
+/* Procedure genBranch emits a jump to label L<label>
+ * taken when the condition tree is true if sense is
+ * set, false otherwise
+ */
+static void genBranch(TreeNode * tree, int sense, int label)
+{
+    if (tree->nodekind == ExpK && tree->kind.exp == simpleK) {
+        genCompare(tree);
+        emit("j%s .L%d",condition(tree->child[1]->attr.op,sense),label);
+    }
+    else {
+        genExp(tree);
+        emit("testl %%eax,%%eax");
+        emit("j%s .L%d",sense ? "ne" : "e",label);
+    }
+}
+
+/* Procedure genStmt generates code at a statement node */
+static void genStmt(TreeNode * tree)
+{
+    int label1, label2;
+    switch (tree->kind.stmt) {
+        case CompoundK:
+            cGen(tree->child[1]);
+            break;
+        case IfK:
+            comment("-> if");
+            label1 = labels++;
+            genBranch(tree->child[0],FALSE,label1);
+            cGen(tree->child[1]);
+            if (tree->child[2] != NULL) {
+                label2 = labels++;
+                emit("jmp .L%d",label2);
+                fprintf(code,".L%d:\n",label1);
+                cGen(tree->child[2]);
+                fprintf(code,".L%d:\n",label2);
+            }
+            else
+                fprintf(code,".L%d:\n",label1);
+            comment("<- if");
+            break;
+        case WhileK:
+            /* the test comes after the body */
+            comment("-> while");
+            label1 = labels++;
+            label2 = labels++;
+            emit("jmp .L%d",label2);
+            fprintf(code,".L%d:\n",label1);
+            cGen(tree->child[1]);
+            fprintf(code,".L%d:\n",label2);
+            genBranch(tree->child[0],TRUE,label1);
+            comment("<- while");
+            break;
+        case ReturnK:
+            if (tree->child[0] != NULL)
+                genExp(tree->child[0]);
+            emit("leave");
+            emit("ret");
+            break;
+        default:
+            genExp(tree);
+            break;
+    }
+}
+
+/* Procedure cGen generates code for the statement
+ * list tree
+ */
+static void cGen(TreeNode * tree)
+{
+    for (; tree != NULL; tree = tree->sibling) {
+        if (tree->nodekind == StmtK)
+            genStmt(tree);
+        else
+            genExp(tree);
+    }
+}
+
+/* Procedure genFunction generates code for the
+ * function declaration tree. The parameters are stored
+ * in the frame, those in registers and those the
+ * caller left above the return address
+ */
+static void genFunction(TreeNode * tree)
+{
+    TreeNode * p;
+    int params = frameWords(tree->child[1]), locals = frameWords(tree->child[2]);
+    int words = params > locals ? params : locals, i = 0;
+    if (TraceCode)
+        fprintf(code,"# function %s\n",tree->attr.name);
+    if (strcmp(tree->attr.name,"main") == 0)
+        fprintf(code,"\t.globl cm_main\n");
+    fprintf(code,"\t.type cm_%s,@function\ncm_%s:\n",tree->attr.name,tree->attr.name);
+    emit("pushq %%rbp");
+    emit("movq %%rsp,%%rbp");
+    if (words > 0)
+        emit("subq $%d,%%rsp",16 * ((words + 1) / 2));
+    for (p = tree->child[1]; p != NULL; p = p->sibling, i++) {
+        if (p->nodekind != DeclK || p->symbol == NULL)
+            break;
+        if (i < NARGREGS)
+            emit("movq %s,%d(%%rbp)",argRegs[i],offset(p->symbol));
+        else {
+            emit("movq %d(%%rbp),%%rax",16 + 8 * (i - NARGREGS));
+            emit("movq %%rax,%d(%%rbp)",offset(p->symbol));
+        }
+    }
+    depth = 0;
+    cGen(tree->child[2]);
+    /* a function may end without return */
+    emit("leave");
+    emit("ret");
+    fprintf(code,"\t.size cm_%s,.-cm_%s\n",tree->attr.name,tree->attr.name);
+}
+
+void x86Gen(TreeNode * syntaxTree, char * codefile)
+{
+    TreeNode * t;
+    labels = 0;
+    divides = FALSE;
+    if (TraceCode) {
+        fprintf(code,"# C- Compilation to x86-64 assembly\n");
+        fprintf(code,"# File: %s\n",codefile);
+    }
+    fprintf(code,"\t.text\n");
+    for (t = syntaxTree; t != NULL; t = t->sibling)
+        if (t->kind.decl == FunK)
+            genFunction(t);
+    if (divides) {
+        /* rt_divide does not return; the stack is
+         * aligned for it wherever the division was */
+        fprintf(code,".Ldivide:\n");
+        emit("movl %%ecx,%%edi");
+        emit("andq $-16,%%rsp");
+        emit("call rt_divide");
+    }
+    fprintf(code,"\t.bss\n\t.align 4\n");
+    for (t = syntaxTree; t != NULL; t = t->sibling)
+        if (t->kind.decl != FunK)
+            fprintf(code,"cm_%s:\n\t.zero %d\n",t->attr.name,4 * t->symbol->size);
+    fprintf(code,"\t.section .note.GNU-stack,\"\",@progbits\n");
+    if (fflush(code) != 0 || ferror(code))
+        fprintf(stderr,"Unable to write code file %s\n",codefile);
+}
@@ -0,0 +1,19 @@
+/****************************************************/
+/* File: xgen.h                                     */
+/* Generator of x86-64 assembly for the C- compiler */
+/****************************************************/
+
+#ifndef _XGEN_H_
+#define _XGEN_H_
+
+/* Procedure x86Gen writes GNU assembler source for
+ * x86-64 Linux for the analyzed syntaxTree to the code
+ * file. Functions follow the System V calling
+ * convention under their names prefixed with "cm_";
+ * runtime.c provides cm_input, cm_output and the C
+ * main that calls cm_main. The file name codefile is
+ * printed as a comment if TraceCode is set
+ */
+void x86Gen(TreeNode * syntaxTree, char * codefile);
+
+#endif
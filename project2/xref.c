@@ -0,0 +1,278 @@
+/****************************************************/
+/* File: xref.c                                     */
+/* Cross-reference index of a C- source file        */
+/* Built from the syntax tree once names are linked */
+/* to their declarations, and written under a       */
+/* temporary name then renamed, so that a reader    */
+/* maps either the old index or the new one         */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "compile.h"
+#include "xref.h"
+#include <unistd.h>
+
+int WriteXref = FALSE;
+
+/* a declaration or use, as found in the tree */
+typedef struct
+{
+    TreeNode * t;
+    char * name;
+    unsigned line;
+    unsigned rank;  /* of the name in strcmp order */
+    XrefKind kind;
+    int global;
+} Ref;
+
+typedef struct
+{
+    Ref * refs;
+    unsigned n, max;
+    unsigned ndecls;
+} RefList;
+
+/* Procedure collect appends the declarations and uses of
+ * the list t to refs; top is set for the declaration list
+ */
+static void collect(RefList * refs, TreeNode * t, int top)
+{
+    for (; t != NULL; t = t->sibling) {
+        int kind = -1, i;
+        if (t->nodekind == DeclK)
+            kind = t->kind.decl;
+        else if (t->nodekind == ExpK)
+            switch (t->kind.exp) {
+                case IdK: kind = XrefId; break;
+                case ArrK: kind = XrefArr; break;
+                case FunCallK: kind = XrefCall; break;
+                default: break;
+            }
+        if (kind >= 0) {
+            Ref * r;
+            if (refs->n == refs->max) {
+                refs->max = refs->max ? 2 * refs->max : 1024;
+                refs->refs = (Ref *) realloc(refs->refs,refs->max * sizeof(Ref));
+            }
+            r = &refs->refs[refs->n];
+            r->t = t;
+            r->name = t->attr.name;
+            r->line = t->lineno > 0 ? t->lineno : 0;
+            refs->n++;
+            refs->ndecls += t->nodekind == DeclK;
+            r->kind = (XrefKind) kind;
+            r->global = t->nodekind == DeclK ? top
+                      : t->symbol != NULL && t->symbol->depth == 0;
+        }
+        for (i = 0; i < MAXCHILDREN; i++)
+            collect(refs,t->child[i],FALSE);
+    }
+}
+
+/* An open hash table from pointers (nodes, interned
+ * names) to numbers, at most half full
+ */
+typedef struct
+{
+    const void * key;
+    unsigned value;
+} Pair;
+
+typedef struct
+{
+    Pair * pairs;
+    unsigned size, count;
+} PointerMap;
+
+static void mapInit(PointerMap * m, unsigned n)
+{
+    for (m->size = 16; m->size < 2 * n; m->size *= 2)
+        ;
+    m->pairs = (Pair *) calloc(m->size,sizeof(Pair));
+    m->count = 0;
+}
+
+static Pair * mapSlot(Pair * pairs, unsigned size, const void * key)
+{
+    unsigned long h = (unsigned long) key;
+    unsigned i;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDUL;
+    h ^= h >> 33;
+    for (i = (unsigned) h & (size - 1); pairs[i].key != NULL && pairs[i].key != key;
+         i = (i + 1) & (size - 1))
+        ;
+    return &pairs[i];
+}
+
+/* Function mapGet returns the pair of key, or NULL */
+static Pair * mapGet(PointerMap * m, const void * key)
+{
+    Pair * p = mapSlot(m->pairs,m->size,key);
+    return p->key != NULL ? p : NULL;
+}
+
+/* Function mapPut returns the pair of key, adding it
+ * with the value XREFNONE if it is missing
+ */
+static Pair * mapPut(PointerMap * m, const void * key)
+{
+    Pair * p;
+    if (2 * (m->count + 1) > m->size) {
+        Pair * old = m->pairs;
+        unsigned i, oldSize = m->size;
+        m->size *= 2;
+        m->pairs = (Pair *) calloc(m->size,sizeof(Pair));
+        for (i = 0; i < oldSize; i++)
+            if (old[i].key != NULL)
+                *mapSlot(m->pairs,m->size,old[i].key) = old[i];
+        free(old);
+    }
+    p = mapSlot(m->pairs,m->size,key);
+    if (p->key == NULL) {
+        p->key = key;
+        p->value = XREFNONE;
+        m->count++;
+    }
+    return p;
+}
+
+static int compareNames(const void * a, const void * b)
+{
+    return strcmp(*(char * const *) a,*(char * const *) b);
+}
+
+/* Function sortRefs returns refs sorted by line, and in
+ * walk order on a line: a counting sort, the lines being
+ * few and the walk nearly in line order already
+ */
+static Ref * sortRefs(RefList * refs)
+{
+    Ref * sorted = (Ref *) malloc((refs->n + 1) * sizeof(Ref));
+    unsigned * start;
+    unsigned i, maxline = 0;
+    for (i = 0; i < refs->n; i++)
+        if (refs->refs[i].line > maxline)
+            maxline = refs->refs[i].line;
+    start = (unsigned *) calloc(maxline + 2,sizeof(unsigned));
+    for (i = 0; i < refs->n; i++)
+        start[refs->refs[i].line + 1]++;
+    for (i = 1; i <= maxline + 1; i++)
+        start[i] += start[i-1];
+    for (i = 0; i < refs->n; i++)
+        sorted[start[refs->refs[i].line]++] = refs->refs[i];
+    free(start);
+    return sorted;
+}
+
+static unsigned long tmpCounter = 0;
+
+int writeXref(TreeNode * syntaxTree, const char * pgm)
+{
+    RefList refs = {NULL,0,0,0};
+    PointerMap decls, ranks;
+    XrefHeader header;
+    XrefEntry * entries;
+    Ref * sorted;
+    unsigned * byName, * offsets, * start;
+    char ** names;
+    char path[FILENAME_MAX], tmp[FILENAME_MAX + 64];
+    unsigned i, n, nnames = 0, size;
+    FILE * f;
+    int ok;
+    collect(&refs,syntaxTree,TRUE);
+    n = refs.n;
+    sorted = sortRefs(&refs);
+    free(refs.refs);
+
+    /* the strings: the source name, then the names sorted */
+    mapInit(&ranks,0);
+    names = (char **) malloc((n + 1) * sizeof(char *));
+    for (i = 0; i < n; i++) {
+        Pair * p = mapPut(&ranks,sorted[i].name);
+        if (p->value == XREFNONE) {
+            p->value = 0;
+            names[nnames++] = sorted[i].name;
+        }
+    }
+    qsort(names,nnames,sizeof(char *),compareNames);
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,XREFMAGIC,sizeof(header.magic));
+    header.nentries = n;
+    header.entries = sizeof(XrefHeader);
+    header.byName = header.entries + n * sizeof(XrefEntry);
+    header.strings = header.byName + n * sizeof(unsigned);
+    header.source = header.strings;
+    offsets = (unsigned *) malloc((nnames + 1) * sizeof(unsigned));
+    size = strlen(pgm) + 1;
+    for (i = 0; i < nnames; i++) {
+        mapGet(&ranks,names[i])->value = i;
+        offsets[i] = header.strings + size;
+        size += strlen(names[i]) + 1;
+    }
+    header.stringsSize = size;
+    for (i = 0; i < n; i++)
+        sorted[i].rank = mapGet(&ranks,sorted[i].name)->value;
+
+    /* the entries, declarations found by their nodes */
+    mapInit(&decls,refs.ndecls);
+    for (i = 0; i < n; i++)
+        if (sorted[i].kind < XrefId)
+            mapPut(&decls,sorted[i].t)->value = i;
+    entries = (XrefEntry *) malloc((n + 1) * sizeof(XrefEntry));
+    for (i = 0; i < n; i++) {
+        Ref * r = &sorted[i];
+        Pair * d;
+        entries[i].name = offsets[r->rank];
+        entries[i].line = r->line;
+        entries[i].kind = r->kind;
+        entries[i].flags = r->global ? XREFGLOBAL : 0;
+        if (r->kind < XrefId)
+            entries[i].def = i;
+        else if (r->t->symbol != NULL && (d = mapGet(&decls,r->t->symbol->decl)) != NULL)
+            entries[i].def = d->value;
+        else
+            entries[i].def = XREFNONE;
+    }
+
+    /* the name order, by a counting sort on the name ranks
+     * that keeps the line order of each name */
+    start = (unsigned *) calloc(nnames + 1,sizeof(unsigned));
+    for (i = 0; i < n; i++)
+        start[sorted[i].rank + 1]++;
+    for (i = 1; i <= nnames; i++)
+        start[i] += start[i-1];
+    byName = (unsigned *) malloc((n + 1) * sizeof(unsigned));
+    for (i = 0; i < n; i++)
+        byName[start[sorted[i].rank]++] = i;
+    free(start);
+
+    outputName(path,pgm,".xref");
+    snprintf(tmp,sizeof(tmp),"%s.tmp.%ld.%lu",path,(long) getpid(),
+             __atomic_fetch_add(&tmpCounter,1,__ATOMIC_RELAXED));
+    f = fopen(tmp,"wb");
+    ok = f != NULL;
+    if (ok) {
+        ok = fwrite(&header,sizeof(header),1,f) == 1 &&
+             fwrite(entries,sizeof(XrefEntry),n,f) == n &&
+             fwrite(byName,sizeof(unsigned),n,f) == n &&
+             fwrite(pgm,1,strlen(pgm) + 1,f) == strlen(pgm) + 1;
+        for (i = 0; ok && i < nnames; i++)
+            ok = fputs(names[i],f) != EOF && putc('\0',f) != EOF;
+        ok = fclose(f) == 0 && ok;
+        if (!ok || rename(tmp,path) != 0) {
+            unlink(tmp);
+            ok = FALSE;
+        }
+    }
+    free(byName);
+    free(entries);
+    free(offsets);
+    free(decls.pairs);
+    free(ranks.pairs);
+    free(names);
+    free(sorted);
+    return ok;
+}
@@ -0,0 +1,67 @@
+/****************************************************/
+/* File: xref.h                                     */
+/* Cross-reference index of a C- source file        */
+/* The index (-fxref) sits next to the source as    */
+/* <name>.xref; it is meant to be mmap-ed as is and */
+/* searched in place, by name or by position        */
+/****************************************************/
+
+#ifndef _XREF_H_
+#define _XREF_H_
+
+/* Layout, in the byte order of the compiler's machine:
+ *   XrefHeader
+ *   XrefEntry entries[nentries]    sorted by line
+ *   unsigned byName[nentries]      entry indices, sorted
+ *                                  by name, then line
+ *   char strings[stringsSize]      NUL-terminated
+ * The strings start with the source name; the names
+ * follow in strcmp order, so names compare as offsets
+ * too. Offsets are from the start of the file
+ */
+#define XREFMAGIC "CMXREF1"
+#define XREFNONE 0xFFFFFFFFu
+
+typedef struct
+{
+    char magic[8];
+    unsigned nentries;
+    unsigned entries;      /* offset of the entries */
+    unsigned byName;       /* offset of the name order */
+    unsigned strings;      /* offset of the strings */
+    unsigned stringsSize;
+    unsigned source;       /* offset of the source name */
+} XrefHeader;
+
+/* declarations first, in the order of DeclKind */
+typedef enum {XrefVar, XrefFun, XrefArrVar, XrefParam, XrefArrParam,
+              XrefId, XrefArr, XrefCall} XrefKind;
+
+/* the name is global (flags) */
+#define XREFGLOBAL 1
+
+typedef struct
+{
+    unsigned name;         /* offset in the file */
+    unsigned line;
+    unsigned def;          /* index of the declaration entry a
+                            * use refers to, itself for one,
+                            * XREFNONE if undeclared or builtin */
+    unsigned short kind;   /* XrefKind */
+    unsigned short flags;
+} XrefEntry;
+
+/* WriteXref = TRUE makes the compilations that analyze
+ * their source write its index (-fxref)
+ */
+extern int WriteXref;
+
+struct treeNode;
+
+/* Function writeXref writes the index of the analyzed
+ * syntax tree of pgm, replacing the previous index at
+ * once; returns FALSE if it cannot be written
+ */
+int writeXref(struct treeNode * syntaxTree, const char * pgm);
+
+#endif
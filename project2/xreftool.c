@@ -0,0 +1,125 @@
+/****************************************************/
+/* File: xreftool.c                                 */
+/* Queries over cross-reference indexes (-fxref)    */
+/* Maps every index given and searches it in place: */
+/* a name lists its declarations and uses, a :line  */
+/* what the names on that line refer to             */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "xref.h"
+
+static const char * kindNames[] = {"variable","function","array","parameter","array param",
+                                   "use","subscript","call"};
+
+typedef struct
+{
+    const char * base;
+    const XrefHeader * header;
+    const XrefEntry * entries;
+    const unsigned * byName;
+} Index;
+
+/* Function openIndex maps the index file path; returns
+ * FALSE if it is missing or not an index
+ */
+static int openIndex(const char * path, Index * x)
+{
+    struct stat st;
+    int fd = open(path,O_RDONLY);
+    void * p;
+    if (fd < 0 || fstat(fd,&st) != 0 || (size_t) st.st_size < sizeof(XrefHeader)) {
+        if (fd >= 0)
+            close(fd);
+        return 0;
+    }
+    p = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return 0;
+    x->base = (const char *) p;
+    x->header = (const XrefHeader *) p;
+    if (memcmp(x->header->magic,XREFMAGIC,sizeof(x->header->magic)) != 0 ||
+        x->header->strings + (unsigned long) x->header->stringsSize != (unsigned long) st.st_size) {
+        munmap(p,st.st_size);
+        return 0;
+    }
+    x->entries = (const XrefEntry *) (x->base + x->header->entries);
+    x->byName = (const unsigned *) (x->base + x->header->byName);
+    return 1;
+}
+
+static void printEntry(const Index * x, const XrefEntry * e)
+{
+    printf("%s:%u: %s %s%s",x->base + x->header->source,e->line,
+           x->base + e->name,kindNames[e->kind],e->flags & XREFGLOBAL ? " (global)" : "");
+    if (e->def == XREFNONE)
+        printf(", undeclared or builtin\n");
+    else if (e->kind >= XrefId)
+        printf(", declared at line %u\n",x->entries[e->def].line);
+    else
+        printf("\n");
+}
+
+/* Procedure findName prints the entries of name, found
+ * by binary search of the name order
+ */
+static void findName(const Index * x, const char * name)
+{
+    unsigned lo = 0, hi = x->header->nentries;
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (strcmp(x->base + x->entries[x->byName[mid]].name,name) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for (; lo < x->header->nentries && strcmp(x->base + x->entries[x->byName[lo]].name,name) == 0; lo++)
+        printEntry(x,&x->entries[x->byName[lo]]);
+}
+
+/* Procedure findLine prints the entries of line, found
+ * by binary search of the line order
+ */
+static void findLine(const Index * x, unsigned line)
+{
+    unsigned lo = 0, hi = x->header->nentries;
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (x->entries[mid].line < line)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for (; lo < x->header->nentries && x->entries[lo].line == line; lo++)
+        printEntry(x,&x->entries[lo]);
+}
+
+int main(int argc, char * argv[])
+{
+    int i;
+    const char * query;
+    if (argc < 3) {
+        fprintf(stderr,"usage: %s <name> | :<line> <file.xref>...\n",argv[0]);
+        return 1;
+    }
+    query = argv[1];
+    for (i = 2; i < argc; i++) {
+        Index x;
+        if (!openIndex(argv[i],&x)) {
+            fprintf(stderr,"%s is not a cross-reference index\n",argv[i]);
+            return 1;
+        }
+        if (query[0] == ':')
+            findLine(&x,(unsigned) atoi(query + 1));
+        else
+            findName(&x,query);
+    }
+    return 0;
+}